@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdio>
+
+#include "glad/gl.h"
+#include "GLFW/glfw3.h"
+
+
+// hidden window holding the 4.5 core context the gpu side benchmarks upload into, the same context Window creates
+struct BenchmarkContext
+{
+	GLFWwindow*				window = nullptr;
+
+	bool init()
+	{
+		if (!glfwInit())
+		{
+			std::printf("unable to initialize glfw\n");
+			return false;
+		}
+
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+		this->window = glfwCreateWindow(64, 64, "vel3d benchmark", NULL, NULL);
+		if (!this->window)
+		{
+			std::printf("unable to create a 4.5 core context\n");
+			glfwTerminate();
+			return false;
+		}
+
+		glfwMakeContextCurrent(this->window);
+		glfwSwapInterval(0);
+
+		if (!gladLoadGL(glfwGetProcAddress))
+		{
+			std::printf("unable to load gl\n");
+			return false;
+		}
+
+		return true;
+	}
+
+	~BenchmarkContext()
+	{
+		if (this->window)
+			glfwDestroyWindow(this->window);
+
+		glfwTerminate();
+	}
+};
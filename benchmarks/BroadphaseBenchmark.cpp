@@ -0,0 +1,171 @@
+/*
+	Headless comparison of CollisionWorld's broadphases on synthetic scenes. Each scene is stepped on every
+	broadphase with the same seed, reporting the average step time, the overlapping pair count and the time taken by
+	a rayTestBatch, single threaded and on a ThreadPool.
+
+	usage: VEL3D_BROADPHASE_BENCHMARK [objectCount] [stepCount]
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <optional>
+#include <memory>
+#include <string>
+
+#include "btBulletDynamicsCommon.h"
+
+#include "vel/CollisionWorld.h"
+#include "vel/BroadphaseOptions.h"
+#include "vel/RaycastRequest.h"
+#include "vel/RaycastResult.h"
+#include "vel/ThreadPool.h"
+
+
+struct BenchmarkScene
+{
+	const char*				name;
+	float					extent;		// objects are spread over -extent to extent on x and z
+	float					height;		// and 0 to height on y
+	float					gravity;
+};
+
+struct BenchmarkResult
+{
+	double					stepMs;
+	int						pairCount;
+	double					raysMs;
+	double					raysPooledMs;
+};
+
+static const char* broadphaseName(vel::BroadphaseType type)
+{
+	switch (type)
+	{
+	case vel::BroadphaseType::DBVT: return "dbvt";
+	case vel::BroadphaseType::AXIS_SWEEP: return "axis sweep";
+	case vel::BroadphaseType::UNIFORM_GRID: return "uniform grid";
+	}
+
+	return "unknown";
+}
+
+static BenchmarkResult runBenchmark(const BenchmarkScene& scene, vel::BroadphaseType type, int objectCount, int stepCount, vel::ThreadPool* pool)
+{
+	vel::BroadphaseOptions options;
+	options.type = type;
+	options.worldMin = btVector3(-scene.extent - 10.0f, -10.0f, -scene.extent - 10.0f);
+	options.worldMax = btVector3(scene.extent + 10.0f, scene.height + 10.0f, scene.extent + 10.0f);
+	options.maxHandles = (unsigned int)objectCount + 16;
+	options.cellSize = 2.0f;
+
+	vel::CollisionWorld world("benchmark", scene.gravity, false, options);
+	btDiscreteDynamicsWorld* dynamicsWorld = world.getDynamicsWorld();
+
+	// the world owns shapes registered with it, and deletes its bodies and their motion states
+	btCollisionShape* groundShape = new btBoxShape(btVector3(scene.extent + 5.0f, 1.0f, scene.extent + 5.0f));
+	btCollisionShape* sphereShape = new btSphereShape(0.5f);
+	btCollisionShape* boxShape = new btBoxShape(btVector3(0.5f, 0.5f, 0.5f));
+	world.addCollisionShape("ground", groundShape);
+	world.addCollisionShape("sphere", sphereShape);
+	world.addCollisionShape("box", boxShape);
+
+	btTransform groundTransform;
+	groundTransform.setIdentity();
+	groundTransform.setOrigin(btVector3(0.0f, -1.0f, 0.0f));
+	btRigidBody::btRigidBodyConstructionInfo groundInfo(btScalar(0), new btDefaultMotionState(groundTransform), groundShape, btVector3(0, 0, 0));
+	dynamicsWorld->addRigidBody(new btRigidBody(groundInfo));
+
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> spread(-scene.extent, scene.extent);
+	std::uniform_real_distribution<float> rise(0.5f, scene.height);
+	std::uniform_real_distribution<float> speed(-4.0f, 4.0f);
+
+	for (int i = 0; i < objectCount; i++)
+	{
+		btCollisionShape* shape = (i & 1) ? boxShape : sphereShape;
+
+		btVector3 inertia(0, 0, 0);
+		shape->calculateLocalInertia(btScalar(1), inertia);
+
+		btTransform transform;
+		transform.setIdentity();
+		transform.setOrigin(btVector3(spread(rng), rise(rng), spread(rng)));
+
+		btRigidBody::btRigidBodyConstructionInfo info(btScalar(1), new btDefaultMotionState(transform), shape, inertia);
+		btRigidBody* body = new btRigidBody(info);
+		body->setLinearVelocity(btVector3(speed(rng), 0.0f, speed(rng)));
+		body->setActivationState(DISABLE_DEACTIVATION);
+		dynamicsWorld->addRigidBody(body);
+	}
+
+	BenchmarkResult result = {};
+
+	for (int i = 0; i < stepCount; i++)
+	{
+		world.stepSimulation(1.0f / 60.0f);
+		result.stepMs += world.getLastStepTime() * 1000.0;
+	}
+
+	result.stepMs /= stepCount > 0 ? stepCount : 1;
+	result.pairCount = dynamicsWorld->getPairCache()->getNumOverlappingPairs();
+
+	// straight down casts spread over the arena, as a top down game would use for picking / ground checks
+	std::vector<vel::RaycastRequest> rays(4096);
+	for (auto& ray : rays)
+	{
+		btVector3 at(spread(rng), 0.0f, spread(rng));
+		ray.from = at + btVector3(0.0f, scene.height + 5.0f, 0.0f);
+		ray.to = at - btVector3(0.0f, 5.0f, 0.0f);
+	}
+
+	std::vector<std::optional<vel::RaycastResult>> hits(rays.size());
+
+	auto start = std::chrono::steady_clock::now();
+	world.rayTestBatch(rays.data(), rays.size(), hits.data());
+	result.raysMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	start = std::chrono::steady_clock::now();
+	world.rayTestBatch(rays.data(), rays.size(), hits.data(), pool);
+	result.raysPooledMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	return result;
+}
+
+int main(int argc, char** argv)
+{
+	const int objectCount = argc > 1 ? std::atoi(argv[1]) : 5000;
+	const int stepCount = argc > 2 ? std::atoi(argv[2]) : 300;
+
+	const BenchmarkScene scenes[] = {
+		{ "flat arena", 150.0f, 1.0f, 0.0f },		// top down, objects sliding on the ground
+		{ "dense pile", 20.0f, 40.0f, -10.0f },		// many objects falling into a small area
+		{ "sparse volume", 400.0f, 400.0f, 0.0f }	// few neighbours, mostly empty space
+	};
+
+	const vel::BroadphaseType types[] = {
+		vel::BroadphaseType::DBVT,
+		vel::BroadphaseType::AXIS_SWEEP,
+		vel::BroadphaseType::UNIFORM_GRID
+	};
+
+	vel::ThreadPool pool;
+
+	std::printf("%d objects, %d steps\n", objectCount, stepCount);
+
+	for (const auto& scene : scenes)
+	{
+		std::printf("\n%s\n", scene.name);
+		std::printf("  %-14s %12s %10s %12s %14s\n", "broadphase", "step (ms)", "pairs", "rays (ms)", "rays mt (ms)");
+
+		for (auto type : types)
+		{
+			BenchmarkResult r = runBenchmark(scene, type, objectCount, stepCount, &pool);
+			std::printf("  %-14s %12.3f %10d %12.3f %14.3f\n", broadphaseName(type), r.stepMs, r.pairCount, r.raysMs, r.raysPooledMs);
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,223 @@
+/*
+	Headless comparison of a Stage's AABBTree against testing every actor's bounds in turn, the way stages culled
+	before the tree. Actors are synthetic boxes scattered over a large flat world with a small fraction moving each
+	frame, queries are the per frame frustum cull plus the box / sphere / ray queries gameplay code issues. Reported
+	times are per query (per frame for the move column), with the number of actors each query returned.
+
+	usage: VEL3D_CULLING_BENCHMARK [actorCount] [queryCount]
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+#include "vel/AABBTree.h"
+
+
+struct Bounds
+{
+	glm::vec3				minEdge;
+	glm::vec3				maxEdge;
+};
+
+struct QueryResult
+{
+	double					treeMs;
+	double					linearMs;
+	size_t					hits;
+};
+
+// the same inward pointing planes AABBTree uses
+static void extractFrustumPlanes(const glm::mat4& m, glm::vec4 planes[6])
+{
+	const glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+	const glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+	const glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+	const glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+	planes[0] = row3 + row0;
+	planes[1] = row3 - row0;
+	planes[2] = row3 + row1;
+	planes[3] = row3 - row1;
+	planes[4] = row3 + row2;
+	planes[5] = row3 - row2;
+}
+
+static bool insideFrustum(const Bounds& b, const glm::vec4 planes[6])
+{
+	for (int p = 0; p < 6; p++)
+	{
+		const glm::vec3 n(planes[p]);
+		const glm::vec3 positive(n.x >= 0.0f ? b.maxEdge.x : b.minEdge.x, n.y >= 0.0f ? b.maxEdge.y : b.minEdge.y, n.z >= 0.0f ? b.maxEdge.z : b.minEdge.z);
+
+		if (glm::dot(n, positive) + planes[p].w < 0.0f)
+			return false;
+	}
+
+	return true;
+}
+
+static bool overlapsBox(const Bounds& b, const glm::vec3& minEdge, const glm::vec3& maxEdge)
+{
+	return b.minEdge.x <= maxEdge.x && b.maxEdge.x >= minEdge.x &&
+		b.minEdge.y <= maxEdge.y && b.maxEdge.y >= minEdge.y &&
+		b.minEdge.z <= maxEdge.z && b.maxEdge.z >= minEdge.z;
+}
+
+static bool overlapsSphere(const Bounds& b, const glm::vec3& center, float radius)
+{
+	const glm::vec3 d = glm::clamp(center, b.minEdge, b.maxEdge) - center;
+	return glm::dot(d, d) <= radius * radius;
+}
+
+static bool intersectsRay(const Bounds& b, const glm::vec3& origin, const glm::vec3& invDir, float maxDistance)
+{
+	const glm::vec3 t1 = (b.minEdge - origin) * invDir;
+	const glm::vec3 t2 = (b.maxEdge - origin) * invDir;
+	const glm::vec3 tMin = glm::min(t1, t2);
+	const glm::vec3 tMax = glm::max(t1, t2);
+
+	const float enter = glm::max(glm::max(tMin.x, tMin.y), glm::max(tMin.z, 0.0f));
+	const float exit = glm::min(glm::min(tMax.x, tMax.y), glm::min(tMax.z, maxDistance));
+
+	return enter <= exit;
+}
+
+template <typename TreeQuery, typename LinearTest>
+static QueryResult runQuery(const std::vector<Bounds>& bounds, int queryCount, TreeQuery treeQuery, LinearTest linearTest)
+{
+	QueryResult result = {};
+	std::vector<vel::Actor*> out;
+	size_t linearHits = 0;
+
+	auto start = std::chrono::steady_clock::now();
+	for (int q = 0; q < queryCount; q++)
+	{
+		out.clear();
+		treeQuery(q, out);
+	}
+	result.treeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / queryCount;
+	result.hits = out.size();
+
+	start = std::chrono::steady_clock::now();
+	for (int q = 0; q < queryCount; q++)
+	{
+		linearHits = 0;
+		for (const auto& b : bounds)
+			if (linearTest(q, b))
+				linearHits++;
+	}
+	result.linearMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / queryCount;
+
+	if (linearHits != result.hits)
+		std::printf("  (tree returned %zu, linear %zu)\n", result.hits, linearHits);
+
+	return result;
+}
+
+int main(int argc, char** argv)
+{
+	const int actorCount = argc > 1 ? std::atoi(argv[1]) : 100000;
+	const int queryCount = argc > 2 ? std::atoi(argv[2]) : 100;
+	const float extent = 2000.0f;
+
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> spread(-extent, extent);
+	std::uniform_real_distribution<float> rise(0.0f, 50.0f);
+	std::uniform_real_distribution<float> size(0.5f, 4.0f);
+	std::uniform_real_distribution<float> step(-0.5f, 0.5f);
+
+	// actors are left null, the tree only hands them back
+	vel::AABBTree tree;
+	std::vector<Bounds> bounds(actorCount);
+	std::vector<int> proxies(actorCount);
+
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < actorCount; i++)
+	{
+		const glm::vec3 at(spread(rng), rise(rng), spread(rng));
+		const glm::vec3 half(size(rng), size(rng), size(rng));
+
+		bounds[i] = { at - half, at + half };
+		proxies[i] = tree.insert(nullptr, bounds[i].minEdge, bounds[i].maxEdge);
+	}
+	const double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	std::printf("%d actors, %d queries, built in %.3f ms (height %d)\n", actorCount, queryCount, buildMs, tree.getHeight());
+
+	// a tenth of the actors move a little each frame, most stay inside their fat bounds
+	const int moving = actorCount / 10;
+	start = std::chrono::steady_clock::now();
+	int reinserted = 0;
+	for (int q = 0; q < queryCount; q++)
+	{
+		for (int i = 0; i < moving; i++)
+		{
+			const glm::vec3 d(step(rng), 0.0f, step(rng));
+			bounds[i].minEdge += d;
+			bounds[i].maxEdge += d;
+
+			if (tree.move(proxies[i], bounds[i].minEdge, bounds[i].maxEdge))
+				reinserted++;
+		}
+	}
+	const double moveMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / queryCount;
+
+	std::printf("  %d moving actors per frame, %.3f ms, %.1f%% reinserted\n\n", moving, moveMs, 100.0 * reinserted / ((double)moving * queryCount));
+
+	// a camera a few meters off the ground looking across the world, turning a little each query
+	auto viewProjection = [&](int q) {
+		const float angle = (float)q * 0.1f;
+		const glm::vec3 eye(0.0f, 10.0f, 0.0f);
+		const glm::mat4 view = glm::lookAt(eye, eye + glm::vec3(std::sin(angle), -0.1f, std::cos(angle)), glm::vec3(0.0f, 1.0f, 0.0f));
+		return glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 500.0f) * view;
+	};
+
+	std::vector<glm::mat4> frames(queryCount);
+	std::vector<glm::vec4> framePlanes(queryCount * 6);
+	for (int q = 0; q < queryCount; q++)
+	{
+		frames[q] = viewProjection(q);
+		extractFrustumPlanes(frames[q], &framePlanes[q * 6]);
+	}
+
+	std::vector<glm::vec3> centers(queryCount);
+	for (auto& c : centers)
+		c = glm::vec3(spread(rng), 25.0f, spread(rng));
+
+	const float boxHalf = 50.0f;
+	const float radius = 50.0f;
+	const float rayLength = 1000.0f;
+	const glm::vec3 rayDir = glm::normalize(glm::vec3(1.0f, -0.01f, 0.5f));
+	const glm::vec3 invRayDir = 1.0f / rayDir;
+
+	std::printf("  %-10s %12s %14s %10s\n", "query", "tree (ms)", "linear (ms)", "hits");
+
+	auto print = [](const char* name, const QueryResult& r) {
+		std::printf("  %-10s %12.4f %14.4f %10zu\n", name, r.treeMs, r.linearMs, r.hits);
+	};
+
+	print("frustum", runQuery(bounds, queryCount,
+		[&](int q, std::vector<vel::Actor*>& out) { tree.queryFrustum(frames[q], out); },
+		[&](int q, const Bounds& b) { return insideFrustum(b, &framePlanes[q * 6]); }));
+
+	print("box", runQuery(bounds, queryCount,
+		[&](int q, std::vector<vel::Actor*>& out) { tree.queryBox(centers[q] - glm::vec3(boxHalf), centers[q] + glm::vec3(boxHalf), out); },
+		[&](int q, const Bounds& b) { return overlapsBox(b, centers[q] - glm::vec3(boxHalf), centers[q] + glm::vec3(boxHalf)); }));
+
+	print("sphere", runQuery(bounds, queryCount,
+		[&](int q, std::vector<vel::Actor*>& out) { tree.querySphere(centers[q], radius, out); },
+		[&](int q, const Bounds& b) { return overlapsSphere(b, centers[q], radius); }));
+
+	print("ray", runQuery(bounds, queryCount,
+		[&](int q, std::vector<vel::Actor*>& out) { tree.queryRay(centers[q], rayDir, rayLength, out); },
+		[&](int q, const Bounds& b) { return intersectsRay(b, centers[q], invRayDir, rayLength); }));
+
+	return 0;
+}
@@ -0,0 +1,110 @@
+/*
+	Per frame ParticleEmitter::update cost at several pool sizes, on the cpu (simd integration on SoA arrays plus the
+	instance buffer upload) and, when a data directory holding shaders/particle.comp is given, on the compute path
+	(only newly spawned particles are uploaded, particle.comp integrates the pool). Emitters are warmed up until the
+	pool is full so every frame simulates maxParticles particles.
+
+	usage: VEL3D_PARTICLE_BENCHMARK [frameCount] [dataDir]
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "BenchmarkContext.h"
+
+#include "vel/GPU.h"
+#include "vel/Mesh.h"
+#include "vel/Actor.h"
+#include "vel/Shader.h"
+#include "vel/AssetManager.h"
+#include "vel/ParticleEmitter.h"
+
+
+static double runBenchmark(vel::GPU& gpu, vel::Shader* computeShader, size_t maxParticles, size_t frameCount)
+{
+	const float dt = 1.0f / 60.0f;
+
+	vel::ParticleEmitterSettings settings;
+	settings.maxParticles = maxParticles;
+	settings.minLifetime = 2.0f;
+	settings.maxLifetime = 2.0f;
+	settings.spawnRate = (float)maxParticles / settings.minLifetime; // replaces particles as fast as they expire
+	settings.spawnExtents = glm::vec3(1.0f);
+	settings.minVelocity = glm::vec3(-1.0f, 2.0f, -1.0f);
+	settings.maxVelocity = glm::vec3(1.0f, 4.0f, 1.0f);
+	settings.gravity = glm::vec3(0.0f, -9.8f, 0.0f);
+
+	// the emitter attaches its instance buffer to the quad's vao, as Scene::addParticleEmitter sets it up
+	vel::Mesh mesh("particle_mesh");
+	mesh.initBillboardQuad(1.0f, 1.0f);
+	gpu.loadMesh(&mesh);
+
+	vel::Actor actor("particle_actor");
+	actor.setMesh(&mesh);
+
+	double ms = 0.0;
+	{
+		vel::ParticleEmitter emitter("particles", &actor, settings, &gpu, computeShader);
+		emitter.burst(maxParticles);
+
+		for (size_t i = 0; i < 60; i++)
+			emitter.update(dt);
+
+		glFinish();
+		auto start = std::chrono::steady_clock::now();
+
+		for (size_t frame = 0; frame < frameCount; frame++)
+			emitter.update(dt);
+
+		glFinish();
+		ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	gpu.clearMesh(&mesh);
+
+	return ms / (double)frameCount;
+}
+
+int main(int argc, char** argv)
+{
+	const size_t frameCount = argc > 1 ? (size_t)std::atoi(argv[1]) : 600;
+	const std::string dataDir = argc > 2 ? argv[2] : "";
+
+	BenchmarkContext context;
+	if (!context.init())
+		return 1;
+
+	vel::GPU gpu;
+
+	// only the compute shader is loaded through it, no meshes
+	std::unique_ptr<vel::AssetManager> assetManager;
+	vel::Shader* computeShader = nullptr;
+	if (!dataDir.empty())
+	{
+		assetManager = std::make_unique<vel::AssetManager>(dataDir, nullptr, &gpu);
+		computeShader = assetManager->loadComputeShader("particleComputeShader", "particle.comp");
+
+		if (computeShader == nullptr)
+			std::printf("unable to build %s/shaders/particle.comp, skipping the compute path\n", dataDir.c_str());
+	}
+
+	const size_t counts[] = { 1000, 10000, 100000, 500000 };
+
+	std::printf("%zu frames\n", frameCount);
+	std::printf("  %-10s %14s %14s\n", "particles", "cpu (ms)", "compute (ms)");
+
+	for (size_t count : counts)
+	{
+		double cpuMs = runBenchmark(gpu, nullptr, count, frameCount);
+
+		if (computeShader != nullptr)
+			std::printf("  %-10zu %14.3f %14.3f\n", count, cpuMs, runBenchmark(gpu, computeShader, count, frameCount));
+		else
+			std::printf("  %-10zu %14.3f %14s\n", count, cpuMs, "-");
+	}
+
+	return 0;
+}
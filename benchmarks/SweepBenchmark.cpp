@@ -0,0 +1,155 @@
+/*
+	Headless comparison of convexSweepTest called once per sweep against convexSweepTestBatch, single threaded and on
+	a ThreadPool, for 1k / 5k / 10k sphere sweeps through a static scene on each broadphase. Sweeps are short and
+	mostly horizontal, as character / projectile movement would issue them.
+
+	usage: VEL3D_SWEEP_BENCHMARK [objectCount]
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <optional>
+
+#include "btBulletDynamicsCommon.h"
+
+#include "vel/CollisionWorld.h"
+#include "vel/BroadphaseOptions.h"
+#include "vel/ConvexCastRequest.h"
+#include "vel/ConvexCastResult.h"
+#include "vel/ThreadPool.h"
+
+
+struct BenchmarkResult
+{
+	double					singleMs;
+	double					batchMs;
+	double					batchPooledMs;
+	size_t					hitCount;
+};
+
+static const char* broadphaseName(vel::BroadphaseType type)
+{
+	switch (type)
+	{
+	case vel::BroadphaseType::DBVT: return "dbvt";
+	case vel::BroadphaseType::AXIS_SWEEP: return "axis sweep";
+	case vel::BroadphaseType::UNIFORM_GRID: return "uniform grid";
+	}
+
+	return "unknown";
+}
+
+static double elapsedMs(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static BenchmarkResult runSweeps(vel::CollisionWorld& world, const std::vector<vel::ConvexCastRequest>& sweeps, vel::ThreadPool* pool)
+{
+	BenchmarkResult result = {};
+	std::vector<std::optional<vel::ConvexCastResult>> hits(sweeps.size());
+
+	auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < sweeps.size(); i++)
+		hits[i] = world.convexSweepTest(sweeps[i].castShape, sweeps[i].from, sweeps[i].to, sweeps[i].collisionFilterMask);
+	result.singleMs = elapsedMs(start);
+
+	start = std::chrono::steady_clock::now();
+	world.convexSweepTestBatch(sweeps.data(), sweeps.size(), hits.data());
+	result.batchMs = elapsedMs(start);
+
+	start = std::chrono::steady_clock::now();
+	world.convexSweepTestBatch(sweeps.data(), sweeps.size(), hits.data(), pool);
+	result.batchPooledMs = elapsedMs(start);
+
+	for (const auto& hit : hits)
+		if (hit)
+			result.hitCount++;
+
+	return result;
+}
+
+int main(int argc, char** argv)
+{
+	const int objectCount = argc > 1 ? std::atoi(argv[1]) : 5000;
+	const float extent = 150.0f;
+
+	const vel::BroadphaseType types[] = {
+		vel::BroadphaseType::DBVT,
+		vel::BroadphaseType::AXIS_SWEEP,
+		vel::BroadphaseType::UNIFORM_GRID
+	};
+
+	const size_t sweepCounts[] = { 1000, 5000, 10000 };
+
+	vel::ThreadPool pool;
+	btSphereShape castShape(0.4f);
+
+	std::printf("%d static objects\n", objectCount);
+
+	for (auto type : types)
+	{
+		vel::BroadphaseOptions options;
+		options.type = type;
+		options.worldMin = btVector3(-extent - 10.0f, -10.0f, -extent - 10.0f);
+		options.worldMax = btVector3(extent + 10.0f, 20.0f, extent + 10.0f);
+		options.maxHandles = (unsigned int)objectCount + 16;
+		options.cellSize = 2.0f;
+
+		vel::CollisionWorld world("benchmark", -10.0f, false, options);
+		btDiscreteDynamicsWorld* dynamicsWorld = world.getDynamicsWorld();
+
+		// the world owns shapes registered with it, and deletes its bodies and their motion states
+		btCollisionShape* groundShape = new btBoxShape(btVector3(extent + 5.0f, 1.0f, extent + 5.0f));
+		btCollisionShape* boxShape = new btBoxShape(btVector3(0.5f, 1.0f, 0.5f));
+		btCollisionShape* sphereShape = new btSphereShape(0.75f);
+		world.addCollisionShape("ground", groundShape);
+		world.addCollisionShape("box", boxShape);
+		world.addCollisionShape("sphere", sphereShape);
+
+		btTransform groundTransform;
+		groundTransform.setIdentity();
+		groundTransform.setOrigin(btVector3(0.0f, -1.0f, 0.0f));
+		btRigidBody::btRigidBodyConstructionInfo groundInfo(btScalar(0), new btDefaultMotionState(groundTransform), groundShape, btVector3(0, 0, 0));
+		dynamicsWorld->addRigidBody(new btRigidBody(groundInfo));
+
+		std::mt19937 rng(1234);
+		std::uniform_real_distribution<float> spread(-extent, extent);
+
+		for (int i = 0; i < objectCount; i++)
+		{
+			btTransform transform;
+			transform.setIdentity();
+			transform.setOrigin(btVector3(spread(rng), 1.0f, spread(rng)));
+
+			btRigidBody::btRigidBodyConstructionInfo info(btScalar(0), new btDefaultMotionState(transform), (i & 1) ? boxShape : sphereShape, btVector3(0, 0, 0));
+			dynamicsWorld->addRigidBody(new btRigidBody(info));
+		}
+
+		world.stepSimulation(1.0f / 60.0f);
+
+		std::printf("\n%s\n", broadphaseName(type));
+		std::printf("  %-8s %12s %12s %14s %8s\n", "sweeps", "single (ms)", "batch (ms)", "batch mt (ms)", "hits");
+
+		std::uniform_real_distribution<float> reach(-8.0f, 8.0f);
+
+		for (size_t count : sweepCounts)
+		{
+			std::vector<vel::ConvexCastRequest> sweeps(count);
+			for (auto& sweep : sweeps)
+			{
+				sweep.castShape = &castShape;
+				sweep.from = btVector3(spread(rng), 1.0f, spread(rng));
+				sweep.to = sweep.from + btVector3(reach(rng), 0.0f, reach(rng));
+			}
+
+			BenchmarkResult r = runSweeps(world, sweeps, &pool);
+			std::printf("  %-8zu %12.3f %12.3f %14.3f %8zu\n", count, r.singleMs, r.batchMs, r.batchPooledMs, r.hitCount);
+		}
+	}
+
+	return 0;
+}
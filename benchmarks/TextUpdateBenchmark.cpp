@@ -0,0 +1,122 @@
+/*
+	Per frame text updates through GPU::updateMesh, with the label meshes static (every update re-specifies the
+	whole vbo / ebo with glBufferData) and dynamic (grow-only buffers, only the changed range is uploaded, see
+	Mesh::setDynamic). Each frame every label's trailing characters change, as they would for hud timers / counters.
+	Labels are synthetic quads, glyph layout is the same cost either way and is left out.
+
+	usage: VEL3D_TEXT_UPDATE_BENCHMARK [labelCount] [frameCount]
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "BenchmarkContext.h"
+
+#include "vel/GPU.h"
+#include "vel/Mesh.h"
+#include "vel/Vertex.h"
+
+
+static const size_t labelLength = 16;
+
+// one quad per character, laid out like AssetManager::buildTextActorGeometry() does
+static void buildLabel(const std::string& text, std::vector<vel::Vertex>& vertices, std::vector<unsigned int>& indices)
+{
+	vertices.clear();
+	indices.clear();
+
+	for (size_t i = 0; i < text.size(); i++)
+	{
+		const float x = (float)i * 8.0f;
+		const float u = (float)(text[i] % 16) / 16.0f;
+		const float v = (float)(text[i] / 16) / 16.0f;
+
+		const glm::vec3 corners[4] = { { x, 0, 0 }, { x + 8, 0, 0 }, { x + 8, 12, 0 }, { x, 12, 0 } };
+		const glm::vec2 uvs[4] = { { u, v }, { u + 0.0625f, v }, { u + 0.0625f, v + 0.0625f }, { u, v + 0.0625f } };
+
+		for (int c = 0; c < 4; c++)
+		{
+			vel::Vertex vert{};
+			vert.position = corners[c];
+			vert.normal = glm::vec3(0.0f, 0.0f, 1.0f);
+			vert.textureCoordinates = uvs[c];
+			vertices.push_back(vert);
+		}
+
+		unsigned int base = (unsigned int)(i * 4);
+		indices.insert(indices.end(), { base + 1, base, base + 3, base + 1, base + 3, base + 2 });
+	}
+}
+
+static std::string labelText(size_t label, size_t frame)
+{
+	char text[labelLength + 1];
+	std::snprintf(text, sizeof(text), "label %04zu %05zu", label % 10000, frame % 100000);
+	return std::string(text, labelLength);
+}
+
+static double runBenchmark(vel::GPU& gpu, bool dynamic, size_t labelCount, size_t frameCount)
+{
+	std::vector<std::unique_ptr<vel::Mesh>> meshes;
+	std::vector<vel::Vertex> vertices;
+	std::vector<unsigned int> indices;
+
+	for (size_t i = 0; i < labelCount; i++)
+	{
+		buildLabel(labelText(i, 0), vertices, indices);
+
+		std::unique_ptr<vel::Mesh> m = std::make_unique<vel::Mesh>("label_" + std::to_string(i));
+		m->setDynamic(dynamic);
+		m->setVertices(vertices);
+		m->setIndices(indices);
+		gpu.loadMesh(m.get());
+
+		meshes.push_back(std::move(m));
+	}
+
+	glFinish();
+	auto start = std::chrono::steady_clock::now();
+
+	for (size_t frame = 1; frame <= frameCount; frame++)
+	{
+		for (size_t i = 0; i < labelCount; i++)
+		{
+			buildLabel(labelText(i, frame), vertices, indices);
+
+			meshes[i]->setVertices(vertices);
+			meshes[i]->setIndices(indices);
+			gpu.updateMesh(meshes[i].get());
+		}
+	}
+
+	glFinish();
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	for (auto& m : meshes)
+		gpu.clearMesh(m.get());
+
+	return ms / (double)frameCount;
+}
+
+int main(int argc, char** argv)
+{
+	const size_t labelCount = argc > 1 ? (size_t)std::atoi(argv[1]) : 300;
+	const size_t frameCount = argc > 2 ? (size_t)std::atoi(argv[2]) : 600;
+
+	BenchmarkContext context;
+	if (!context.init())
+		return 1;
+
+	vel::GPU gpu;
+
+	std::printf("%zu labels of %zu characters, %zu frames\n", labelCount, labelLength, frameCount);
+	std::printf("  %-10s %14s\n", "meshes", "frame (ms)");
+	std::printf("  %-10s %14.3f\n", "static", runBenchmark(gpu, false, labelCount, frameCount));
+	std::printf("  %-10s %14.3f\n", "dynamic", runBenchmark(gpu, true, labelCount, frameCount));
+
+	return 0;
+}
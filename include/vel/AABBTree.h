@@ -0,0 +1,92 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "glm/glm.hpp"
+
+#include "vel/AABB.h"
+
+
+namespace vel
+{
+	class Actor;
+
+	struct AABBTreeNode
+	{
+		glm::vec3		minEdge; // fattened by the tree's margin for leaves
+		glm::vec3		maxEdge;
+		glm::vec3		tightMin; // leaves only, bounds as given
+		glm::vec3		tightMax;
+		int				parent; // next free node while on the free list
+		int				child1;
+		int				child2;
+		int				height; // leaf = 0, free = -1
+		Actor*			actor;
+		uint32_t		stamp; // see markFrustum()
+
+		bool			isLeaf() const { return child1 == -1; }
+	};
+
+	// Incremental dynamic bounding volume tree (surface area heuristic insertion, AVL style rotations) keyed by integer
+	// proxies. Leaves store a fattened copy of their bounds so that small movements don't require re-insertion, queries
+	// descend through the fat bounds and test leaves against the tight ones. Node storage is a single vector with a free
+	// list, so proxies stay valid until removed.
+	class AABBTree
+	{
+	private:
+		std::vector<AABBTreeNode>	nodes;
+		int							root;
+		int							freeList;
+		size_t						leafCount;
+		float						margin;
+		uint32_t					currentStamp;
+		std::vector<int>			stack; // traversal scratch
+
+		int							allocateNode();
+		void						freeNode(int node);
+		void						insertLeaf(int leaf);
+		void						removeLeaf(int leaf);
+		int							balance(int a);
+
+	public:
+		AABBTree(float margin = 0.1f);
+
+		int							insert(Actor* a, const glm::vec3& minEdge, const glm::vec3& maxEdge);
+		void						remove(int proxy);
+
+		// returns false (and does nothing) while the new bounds are still inside the proxy's fat bounds
+		bool						move(int proxy, const glm::vec3& minEdge, const glm::vec3& maxEdge);
+
+		Actor*						getActor(int proxy) const;
+		void						getBounds(int proxy, glm::vec3& minEdge, glm::vec3& maxEdge) const;
+		size_t						size() const;
+		int							getHeight() const;
+		void						clear();
+
+		template <typename Fn>
+		void						forEachLeaf(Fn fn) const
+		{
+			for (int i = 0; i < (int)this->nodes.size(); i++)
+				if (this->nodes[i].height == 0)
+					fn(i, this->nodes[i].actor);
+		}
+
+		// queries append every actor whose bounds pass the test to out
+		void						queryBox(const glm::vec3& minEdge, const glm::vec3& maxEdge, std::vector<Actor*>& out);
+		void						queryBox(AABB& box, std::vector<Actor*>& out);
+		void						querySphere(const glm::vec3& center, float radius, std::vector<Actor*>& out);
+		void						queryFrustum(const glm::mat4& viewProjection, std::vector<Actor*>& out);
+
+		// sorted nearest first by the distance at which the ray enters each actor's bounds
+		void						queryRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, std::vector<Actor*>& out);
+
+		// stamps every leaf inside the frustum rather than collecting them, test with isMarked()
+		uint32_t					markFrustum(const glm::mat4& viewProjection);
+		bool						isMarked(int proxy, uint32_t stamp) const;
+
+		// bounds of a local space box after transformation, without building the eight corners
+		static void					transformBounds(const glm::mat4& m, const glm::vec3& minEdge, const glm::vec3& maxEdge,
+										glm::vec3& outMin, glm::vec3& outMax);
+	};
+}
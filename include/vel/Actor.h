@@ -17,6 +17,7 @@ namespace vel
 {
 	class	CollisionWorld;
 	class	Material;
+	class	Camera;
 
 
 	class Actor
@@ -27,6 +28,11 @@ namespace vel
 		bool											visible;
 		bool											dynamic;
 		bool											lerpable;
+		bool											staticBatched; // drawn through a StaticBatch instead of on its own
+		bool											cullable;
+		bool											boundsDirty;
+		int												spatialProxy; // leaf within the owning stage's AABBTree, -1 if none
+		std::vector<std::pair<const Camera*, size_t>>	lods; // last selected mesh lod per camera, the starting point for hysteresis
 
 		uint32_t										lastTransformUpdateTick;
 		Transform										transform;
@@ -59,6 +65,7 @@ namespace vel
 		void											_removeChildActor(Actor* child);
 
 		void											_markTransformDirty();
+		void											_markBoundsDirty();
 		
 
 	public:
@@ -77,7 +84,9 @@ namespace vel
 		void											setName(std::string newName);
 		const std::string								getName() const;
 
-		void											setMesh(Mesh* m);
+		// both refuse (returning false) a mesh whose VertexFormat doesn't match the vertex layout the material's
+		// shader variant was built for (MTRL_OPT_COMPACT_VERTEX), which would otherwise draw garbage
+		bool											setMesh(Mesh* m);
 		Mesh*											getMesh();
 		Mesh*											getMesh() const;
 
@@ -85,7 +94,10 @@ namespace vel
 		SkelAnimator*									getAnimator();
 
 
-		void											setMaterial(Material* m);
+		bool											setMaterial(Material* m);
+
+		// false when the material's shader reads vertices in a different layout than the mesh provides
+		bool											hasMatchingVertexFormat() const;
 		Material*										getMaterial();
 		Material*										getMaterial() const;
 		
@@ -96,6 +108,24 @@ namespace vel
 		bool											isAnimated() const;
 		bool											isDynamic() const;
 		bool											isLerpable() const;
+
+		void											setStaticBatched(bool b);
+		bool											isStaticBatched() const;
+
+		// actors that aren't cullable are always drawn (skies, particle emitters whose particles leave the mesh bounds)
+		void											setCullable(bool c);
+		bool											isCullable() const;
+
+		// set whenever the world transform or mesh may have changed, the stage refits the actor's tree leaf and clears it
+		bool											isBoundsDirty() const;
+		void											clearBoundsDirty();
+		void											setSpatialProxy(int p);
+		int												getSpatialProxy() const;
+
+		// kept per camera so cameras at different distances don't reset each other's hysteresis, 0 for a camera
+		// the actor hasn't been drawn by yet
+		void											setLod(const Camera* c, size_t l);
+		size_t											getLod(const Camera* c) const;
 		
 
 		const std::vector<std::pair<unsigned int, unsigned int>>& getActiveBones() const;
@@ -113,6 +143,7 @@ namespace vel
 		//void											updatePreviousTransform();
 
 		glm::mat4										getWorldMatrix();
+		glm::mat4										getParentWorldMatrix(); // what the local transform is relative to, identity when not parented
 		glm::mat4										getWorldRenderMatrix(float alpha); // contains logic for interpolation
 		glm::vec3										getInterpolatedTranslation(float alpha);
 		glm::quat										getInterpolatedRotation(float alpha);
@@ -131,6 +162,7 @@ namespace vel
 		void				setRotation(glm::quat r);
 		void				appendRotation(float angle, glm::vec3 axis);
 		void				setScale(glm::vec3 s);
+		void				setTranslationAndRotation(glm::vec3 t, glm::quat r); // a single dirty / previous transform update for both
 
 		const glm::vec3&	getTranslation() const;
 		const glm::quat&	getRotation() const;
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "btBulletDynamicsCommon.h"
+
+
+namespace vel
+{
+	class Actor;
+	class CollisionWorld;
+
+	/*
+		Motion state binding a rigid body to an Actor. Bullet only calls setWorldTransform for bodies that moved and
+		are awake, so the states it touches during a step are exactly the set that needs syncing, they queue themselves
+		on their CollisionWorld which writes them to their actors in one pass once the step has finished (see
+		CollisionWorld::syncActorTransforms). Sleeping bodies cost nothing. Kinematic bodies read the actor's transform
+		through getWorldTransform instead. Scale is left to the actor. The body always lives in world space, for parented
+		actors it is converted to and from the parent's space so the actor's transform stays local.
+	*/
+	class ActorMotionState : public btMotionState
+	{
+	private:
+		Actor*					actor;
+		CollisionWorld*			collisionWorld;
+		btTransform				centerOfMassOffset;
+		btTransform				pendingTransform; // graphics (actor) space
+		bool					queued;
+
+	public:
+		ActorMotionState(Actor* actor, CollisionWorld* collisionWorld, const btTransform& centerOfMassOffset = btTransform::getIdentity());
+
+		void					getWorldTransform(btTransform& centerOfMassWorldTrans) const;
+		void					setWorldTransform(const btTransform& centerOfMassWorldTrans);
+
+		Actor*					getActor();
+
+		// writes the pending transform to the actor, called by CollisionWorld::syncActorTransforms
+		void					sync();
+	};
+}
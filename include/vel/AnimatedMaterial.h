@@ -10,6 +10,12 @@ namespace vel
 	{
 	private:
 		MaterialAnimator	materialAnimator;
+		std::vector<float>	textureLayers; // reused each draw, current frame of every TXT_OPT_ARRAY texture
+
+	protected:
+		// binds the current frame of every animated texture, per frame handles are swapped in the texture UBO while
+		// array textures keep one handle and have their frame passed through the "textureLayers" uniform
+		void				updateAnimatedTextures(GPU* gpu);
 
 	public:
 		AnimatedMaterial(const std::string& name, Shader* shader);
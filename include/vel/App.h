@@ -50,6 +50,7 @@ namespace vel
         double											averageFrameTime;
         double											averageFrameRate;
 		bool											pauseBufferClearAndSwap;
+		double											assetUploadBudget;
 
         void											calculateAverageFrameTime();
 
@@ -85,6 +86,9 @@ namespace vel
 
 		AssetManager&									getAssetManager();
 
+		// seconds of main thread time per frame spent finishing async asset loads (gpu uploads / registration)
+		void											setAssetUploadBudget(double seconds);
+
 		void											removeScene(const std::string& name);
 		void											swapScene(const std::string& name);
 		bool											sceneExists(const std::string& name);
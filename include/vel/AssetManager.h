@@ -3,6 +3,11 @@
 #include <string>
 #include <unordered_map>
 #include <optional>
+#include <future>
+#include <mutex>
+#include <deque>
+#include <functional>
+#include <atomic>
 
 #include "ozz/animation/runtime/animation.h"
 #include "ozz/animation/runtime/skeleton.h"
@@ -17,6 +22,7 @@
 #include "vel/GPU.h"
 #include "vel/TextActor.h"
 #include "vel/MeshLoaderInterface.h"
+#include "vel/ThreadPool.h"
 
 
 namespace vel
@@ -29,6 +35,20 @@ namespace vel
 		std::string													dataDir;
 		std::unique_ptr<MeshLoaderInterface>						meshLoader;
 		GPU*														gpu;
+
+		// async loading, decode work runs on the pool, anything touching the registries or the gl context is queued
+		// back to the main thread and drained by processPendingUploads()
+		std::unique_ptr<ThreadPool>									workerPool;
+		std::mutex													meshLoaderMutex;
+		std::mutex													uploadQueueMutex;
+		std::deque<std::function<void()>>							uploadQueue;
+		std::atomic<size_t>											pendingAsyncLoads;
+
+		template<typename T, typename D>
+		std::shared_future<T>								loadAsync(std::function<D()> decode, std::function<T(D&)> finalize);
+
+		template<typename T>
+		static std::shared_future<T>						readyFuture(T value);
 		
 
 
@@ -37,6 +57,8 @@ namespace vel
 		std::vector<std::pair<std::unique_ptr<Texture>, int>>		textures;
 		std::vector<std::pair<std::unique_ptr<Material>, int>>		materials;
 		std::vector<std::pair<std::unique_ptr<FontBitmap>, int>>	fontBitmaps;
+
+		std::vector<std::pair<const void*, std::function<void(const Mesh*)>>> meshRemovedListeners;
 		
 		std::unordered_map<std::string, std::pair<std::unique_ptr<ozz::animation::Skeleton>, int>> skeletons;
 		std::unordered_map<std::string, std::pair<std::unique_ptr<ozz::animation::Animation>, int>> animations;
@@ -47,10 +69,14 @@ namespace vel
 
 		int													getMeshIndex(const std::string& name);
 		int													getMeshIndex(const Mesh* m);
+		Mesh*												registerMesh(std::unique_ptr<Mesh> m, VertexFormat format);
 
 		int													getTextureIndex(const std::string& name);
 		int													getTextureIndex(const Texture* t);
-		std::optional<TextureData>							generateTextureData(const std::string& path);
+		std::optional<TextureData>							generateTextureData(const std::string& path, int options);
+		std::unique_ptr<Texture>							decodeTexture(const std::string& name, const std::string& path, int options);
+		void												freeTextureData(Texture* t);
+		Texture*											registerTexture(std::unique_ptr<Texture> texture);
 
 		int													getMaterialIndex(const std::string& name);
 		int													getMaterialIndex(const Material* m);
@@ -58,27 +84,50 @@ namespace vel
 		FontGlyphInfo										getFontGlyphInfo(uint32_t character, float offsetX, float offsetY, FontBitmap* fb);
 		int													getFontBitmapIndex(const std::string& name);
 		int													getFontBitmapIndex(const FontBitmap* m);
+		std::unique_ptr<FontBitmap>							packFontBitmap(const std::string& fontName, int stbFontSize, const std::string& fontPath);
+		FontBitmap*											registerFontBitmap(std::unique_ptr<FontBitmap> fb);
+
+		static std::unique_ptr<ozz::animation::Skeleton>	readSkeleton(const std::string& path);
+		static std::unique_ptr<ozz::animation::Animation>	readAnimation(const std::string& path);
 		
 
 	public:
 		AssetManager(const std::string& dataDir, std::unique_ptr<MeshLoaderInterface> ml, GPU* gpu = nullptr);
 		~AssetManager();
 
+		ThreadPool*					getWorkerPool();
+
+		// runs queued main thread work (gpu uploads / registration) for completed async loads until budgetSeconds
+		// has elapsed, at least one job is always run per call
+		void						processPendingUploads(double budgetSeconds);
+		void						waitForPendingLoads();
+		bool						hasPendingLoads() const;
+
 		std::optional<std::string>	loadShaderFile(const std::string& shaderPath);
 		std::string					getTopShaderLines(const std::string& shaderCode, int numLinesToGet);
 		std::string					getBottomShaderLines(const std::string& shaderCode, int numLinesToSkip);
 		Shader*						loadShader(const std::string& name, const std::string& vertFile, const std::string& geomFile, const std::string& fragFile, std::vector<std::string> defs = {});
+		Shader*						loadComputeShader(const std::string& name, const std::string& compFile, std::vector<std::string> defs = {}); // nullptr if compute is unavailable
 		Shader*						getShader(const std::string& name);
 		void						removeShader(const Shader* pShader);
 
-		std::vector<Mesh*>			loadMesh(const std::string& path);
+		std::vector<Mesh*>			loadMesh(const std::string& path, VertexFormat format = VertexFormat::FULL);
+		std::shared_future<std::vector<Mesh*>>	loadMeshAsync(const std::string& path, VertexFormat format = VertexFormat::FULL);
 		Mesh*						addMesh(std::unique_ptr<Mesh> m);
 		Mesh*						getMesh(const std::string& name);
 		void						updateMesh(Mesh* m);
+		void						updateMeshVertices(Mesh* m);
+		void						updateMeshVertexRange(Mesh* m, size_t firstVertex, size_t vertexCount);
 		void						removeMesh(const Mesh* pMesh);
 		void						incrementMeshUsage(const Mesh* pMesh);
 
+		// fn is called with a mesh right before its last usage is released and it is deleted, for anything keying
+		// state on Mesh* (a later mesh may be allocated at the same address), owner identifies the listener
+		void						addMeshRemovedListener(const void* owner, std::function<void(const Mesh*)> fn);
+		void						removeMeshRemovedListener(const void* owner);
+
 		Texture*					loadTexture(const std::string& name, const std::string& path, int options = 0);
+		std::shared_future<Texture*> loadTextureAsync(const std::string& name, const std::string& path, int options = 0);
 		Texture*					getTexture(const std::string& name);
 		void						removeTexture(const Texture* pTexture);
 
@@ -89,17 +138,21 @@ namespace vel
 		float						measureFontHeight(const std::string& text, FontBitmap* fb);
 		FontBitmap*					loadFontBitmap(const std::string& fontName, int fontSize, const std::string& fontPath); // alias to raw
 		FontBitmap*					loadFontBitmapRaw(const std::string& fontName, int stbFontSize, const std::string& fontPath);
+		std::shared_future<FontBitmap*> loadFontBitmapAsync(const std::string& fontName, int fontSize, const std::string& fontPath);
 		FontBitmap*					loadFontBitmapVisualHeight(const std::string& fontName, int desiredVisiblePx, const std::string& fontPath);
 		FontBitmap*					getFontBitmap(const std::string& name);
 		void						removeFontBitmap(const FontBitmap* pFontBitmap);
 
 		std::unique_ptr<Mesh>		loadTextActorMesh(TextActor* ta);
+		void						buildTextActorGeometry(TextActor* ta, std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
 
 		ozz::animation::Skeleton*	loadSkeleton(const std::string& name, const std::string& path);
+		std::shared_future<ozz::animation::Skeleton*> loadSkeletonAsync(const std::string& name, const std::string& path);
 		ozz::animation::Skeleton*	getSkeleton(const std::string& name);
 		void						removeSkeleton(const std::string& name);
 		
 		ozz::animation::Animation*	loadAnimation(const std::string& name, const std::string& path);
+		std::shared_future<ozz::animation::Animation*> loadAnimationAsync(const std::string& name, const std::string& path);
 		ozz::animation::Animation*	getAnimation(const std::string& name);
 		void						removeAnimation(const std::string& name);
 
@@ -17,6 +17,8 @@
 
 namespace vel
 {
+	// Authored lods are nodes named after their base mesh with a _LOD<n> suffix (n = 1 - 7, "Rock_LOD2" for example).
+	// They are not listed by preload(), and are loaded and attached to their base mesh whenever it is loaded
 	class AssimpMeshLoader : public MeshLoaderInterface
 	{
 	private:
@@ -29,6 +31,17 @@ namespace vel
 		std::vector<std::unique_ptr<Mesh>>		meshes;
 		unsigned int							currentMeshTextureId;
 
+		struct AuthoredLod
+		{
+			std::string							baseName;
+			size_t								level;
+			std::unique_ptr<Mesh>				mesh;
+		};
+		std::vector<AuthoredLod>				authoredLods;
+
+		static size_t	lodLevelFromName(const std::string& nodeName, std::string& baseName); // 0 if not a lod node
+		void			attachAuthoredLods();
+
 		void			preProcessNode(aiNode* node);
 
 		void			processNode(aiNode* node);
@@ -1,16 +1,33 @@
 #pragma once
 
+#include <vector>
+#include <memory>
+
 #include "vel/Actor.h"
 #include "vel/Camera.h"
 
 namespace vel
 {
+	class Billboard;
+
+	// structure of arrays scratch used by Billboard::updateBatch(), padded to a multiple of 4 lanes
+	struct BillboardBatchData
+	{
+		std::vector<float>	objX, objY, objZ;
+		std::vector<float>	camX, camY, camZ;
+		std::vector<float>	keepY; // 0 for billboards with lockXZ, 1 otherwise
+		std::vector<float>	quatX, quatY, quatZ, quatW;
+		std::vector<int>	laneMasks; // per group of 4, bit set = orientation computed, else handled by the scalar path
+		std::vector<Billboard*>	members;
+	};
+
 	class Billboard
 	{
 	private:
 		vel::Actor*		billboardActor;
 		vel::Camera*	parentCamera;
 		bool			lockXZ;
+		bool			gpuOriented;
 
 	public:
 		Billboard(vel::Actor* billboardActor, vel::Camera* parentCamera);
@@ -20,6 +37,11 @@ namespace vel
 		
 		void lockXZRotation(bool b = true);
 
+		// when true the cpu leaves the actor's rotation alone and the quad is expected to be oriented in the vertex
+		// shader, use with a material created with MTRL_OPT_GPU_BILLBOARD
+		void setGpuOriented(bool b = true);
+		bool getGpuOriented() const;
+
 		/*
 			Billboarding orientation notes (OpenGL-style):
 			- Model local axes: +X right, +Y up, -Z forward (mesh faces down -Z by default).
@@ -34,6 +56,11 @@ namespace vel
 		*/
 		void update();
 
+		// Same result as calling update() on each billboard, but positions are gathered into SoA form and the basis /
+		// quaternion math runs 4 billboards at a time using ozz's simd types. The quaternion is built branch free from
+		// the basis, lanes where forward is parallel to world up fall back to update()
+		static void updateBatch(std::vector<std::unique_ptr<Billboard>>& billboards, BillboardBatchData& scratch);
+
 		
 	};
 }
\ No newline at end of file
@@ -0,0 +1,31 @@
+#pragma once
+
+
+#include "btBulletCollisionCommon.h"
+
+
+
+namespace vel
+{
+	enum class BroadphaseType
+	{
+		DBVT,			// btDbvtBroadphase, good general purpose default
+		AXIS_SWEEP,		// btAxisSweep3 / bt32BitAxisSweep3, bounded worlds with mostly coherent motion
+		UNIFORM_GRID	// UniformGridBroadphase, many small evenly sized objects
+	};
+
+	struct BroadphaseOptions
+	{
+		BroadphaseType				type = BroadphaseType::DBVT;
+
+		// AXIS_SWEEP only, bounds are quantized against these, objects leaving them are removed from the simulation.
+		// More than 16384 handles switches to the 32 bit variant
+		btVector3					worldMin = btVector3(-1000, -1000, -1000);
+		btVector3					worldMax = btVector3(1000, 1000, 1000);
+		unsigned int				maxHandles = 16384;
+
+		// UNIFORM_GRID only, cellSize works best at around twice the typical object size
+		float						cellSize = 2.0f;
+		int							maxCellsPerProxy = 64;
+	};
+}
@@ -61,7 +61,9 @@ namespace vel
 		void                    setLookAt(float x, float y, float z);
 		void                    setLookAt(glm::vec3 direction);
 		void					setType(CameraType type);
+		CameraType				getType() const;
 		void					setNearPlane(float np);
+		float					getNearPlane() const;
 		void					setFarPlane(float fp);
 		void					setFovOrScale(float fos);
 
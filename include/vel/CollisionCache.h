@@ -0,0 +1,87 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <cstdint>
+
+#include "btBulletCollisionCommon.h"
+#include "BulletCollision/CollisionShapes/btTriangleInfoMap.h"
+
+
+namespace vel
+{
+	/*
+		Cooked collision layout (native endianness, every section 16 byte aligned):
+
+		CollisionCacheHeader
+		char[]							- btOptimizedBvh::serializeInPlace output, deserialized in place when loaded
+		CollisionCacheTriangleInfo[]	- btTriangleInfoMap entries (internal edge info), may be empty
+
+		The bvh is only valid for the exact triangles it was built from, which is why caches are keyed by a hash of the
+		triangle data rather than by a source file. Any change to this layout requires bumping COLLISION_CACHE_VERSION.
+	*/
+	static const uint32_t COLLISION_CACHE_VERSION = 1;
+
+	struct CollisionCacheHeader
+	{
+		char		magic[8];
+		uint32_t	version;
+		uint32_t	scalarSize;
+		uint64_t	contentHash;
+		uint64_t	bvhOffset;
+		uint64_t	bvhSize;
+		uint64_t	triangleInfoOffset;
+		uint32_t	triangleInfoCount;
+		uint32_t	hasTriangleInfo;
+		float		convexEpsilon;
+		float		planarEpsilon;
+		float		equalVertexThreshold;
+		float		edgeDistanceThreshold;
+		float		maxEdgeAngleThreshold;
+		float		zeroAreaThreshold;
+	};
+
+	struct CollisionCacheTriangleInfo
+	{
+		int32_t		key;
+		int32_t		flags;
+		float		edgeV0V1Angle;
+		float		edgeV1V2Angle;
+		float		edgeV2V0Angle;
+		uint32_t	reserved;
+	};
+
+	// what a btBvhTriangleMeshShape built through the cache points into, must outlive the shape
+	struct CollisionCacheData
+	{
+		uint64_t							contentHash;
+		void*								bvhBuffer;	// btAlignedAlloc'd, only set when the bvh was loaded from a cache
+		btOptimizedBvh*						bvh;		// inside bvhBuffer when loaded, otherwise owned by the shape
+		std::unique_ptr<btTriangleInfoMap>	triangleInfoMap;
+
+		CollisionCacheData();
+		~CollisionCacheData();
+		CollisionCacheData(const CollisionCacheData&) = delete;
+		CollisionCacheData& operator=(const CollisionCacheData&) = delete;
+	};
+
+	/*
+		Cooked bvhs and internal edge info for static triangle mesh shapes (<directory>/<content hash>.velbvh), so that
+		loading a level doesn't rebuild the quantized bvh and re-run btGenerateInternalEdgeInfo every time. Stale caches
+		are never read (the hash changes with the triangles), they are simply left behind.
+	*/
+	class CollisionCache
+	{
+	public:
+		static std::string					getCachePath(const std::string& directory, uint64_t contentHash);
+
+		// hashes positions and indices exactly as the mesh interface exposes them to the bvh builder
+		static uint64_t						contentHash(const btStridingMeshInterface* meshInterface);
+
+		// triangleInfoMap may be nullptr when the edge info has not been generated yet
+		static bool							write(const std::string& cachePath, uint64_t contentHash, const btOptimizedBvh* bvh, const btTriangleInfoMap* triangleInfoMap);
+
+		// nullptr if there is no usable cache for contentHash
+		static std::unique_ptr<CollisionCacheData> load(const std::string& cachePath, uint64_t contentHash);
+	};
+}
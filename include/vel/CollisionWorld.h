@@ -2,6 +2,7 @@
 
 #include <functional>
 #include <optional>
+#include <memory>
 #include <vector>
 #include <unordered_map>
 #include <string>
@@ -15,30 +16,53 @@
 
 #include "vel/Actor.h"
 #include "vel/RaycastResult.h"
+#include "vel/RaycastRequest.h"
 #include "vel/CollisionDebugDrawer.h"
 #include "vel/CollisionObjectTemplate.h"
 #include "vel/ConvexCastResult.h"
+#include "vel/ConvexCastRequest.h"
+#include "vel/CollisionCache.h"
+#include "vel/BroadphaseOptions.h"
+#include "vel/InstancedCollisionShape.h"
+#include "vel/ConvexDecomposition.h"
+#include "vel/ContactEventStream.h"
+#include "vel/TriggerSystem.h"
 
 
 namespace vel
 {
 	class Stage;
 	class Camera;
+	class ThreadPool;
+	class ActorMotionState;
 
 	class CollisionWorld
 	{
 	private:
 		std::string								name;
 		bool									isActive;
+		bool									isMultithreaded;
+		double									lastStepTime;
 		btDefaultCollisionConfiguration*		collisionConfiguration;
 		btCollisionDispatcher*					dispatcher;
 		btBroadphaseInterface*					overlappingPairCache;
-		btSequentialImpulseConstraintSolver*	solver;
+		btConstraintSolver*						solver;
 		btDiscreteDynamicsWorld*				dynamicsWorld;
 		std::unordered_map<std::string, btCollisionShape*> collisionShapes;
 		Camera*									camera; // matrices used for debug drawer
 		CollisionDebugDrawer* 					collisionDebugDrawer;
 		std::unordered_map<std::string, CollisionObjectTemplate> collisionObjectTemplates;
+		std::string								collisionCacheDirectory;
+		std::unordered_map<btCollisionShape*, std::unique_ptr<CollisionCacheData>> collisionCacheData; // released with the shape they back
+		std::vector<ActorMotionState*>			actorSyncQueue; // motion states bullet moved during the current step
+		std::unordered_map<btCollisionShape*, InstancedCollisionShape> instancedShapes;
+		std::unordered_map<InstancedCollisionShapeKey, btCollisionShape*, InstancedCollisionShapeKeyHash> instancedShapeLookup;
+		std::unique_ptr<ContactEventStream>		contactEvents; // nullptr unless enabled
+		std::unique_ptr<TriggerSystem>			triggerSystem; // the pair cache's ghost pair callback, outlives the world
+
+		btBvhTriangleMeshShape*					bvhShapeFromTriangleMesh(btTriangleMesh* triangleMesh, const std::string& debugName);
+		void									generateInternalEdgeInfo(btBvhTriangleMeshShape* bvhShape, const std::string& debugName);
+		btCollisionShape*						acquireInstancedCollisionShape(Mesh* mesh, const glm::vec3& scale);
 
 
 		//void									removeSensorsUsingCollisionObject(btCollisionObject* co);
@@ -46,21 +70,85 @@ namespace vel
 	public:
 		static bool								contactAddedCallback(btManifoldPoint& cp, const btCollisionObjectWrapper* colObj0Wrap, int partId0, int index0, const btCollisionObjectWrapper* colObj1Wrap, int partId1, int index1);
 
-		CollisionWorld(const std::string& name, float gravity = -10);
+		// multithreaded worlds use btDiscreteDynamicsWorldMt / btCollisionDispatcherMt / btConstraintSolverPoolMt on
+		// bullet's task scheduler, which requires bullet and vel3d to be built with BT_THREADSAFE (see
+		// USE_BULLET_MULTITHREADING), otherwise the world falls back to the single threaded configuration
+		CollisionWorld(const std::string& name, float gravity = -10, bool multithreaded = false, BroadphaseOptions broadphase = {});
 		~CollisionWorld();
 		btDiscreteDynamicsWorld* const			getDynamicsWorld();
+
+		void									stepSimulation(float delta);
+		double									getLastStepTime() const; // seconds spent in the last stepSimulation()
+		bool									getIsMultithreaded() const;
+
+		// bullet synchronizes motion states on the stepping thread after the simulation, the queue is emptied by
+		// syncActorTransforms() at the end of every stepSimulation()
+		void									queueActorSync(ActorMotionState* ms);
+		void									syncActorTransforms();
 		void									addCollisionShape(std::string name, btCollisionShape* shape);
 		
 		btRigidBody*							addStaticCollisionBody(Actor* actor, int collisionFilterGroup, int collisionFilterMask);
 		btCollisionShape*						collisionShapeFromActor(Actor* actor, bool applyTransform = true);
 
+		// Every actor using the same mesh shares one mesh space bvh shape, actors with a non unit scale share a
+		// btScaledBvhTriangleMeshShape around it per scale. The actor's rotation and translation are returned in
+		// worldTransform for the body rather than baked into the triangles. Each call takes a reference on the shape,
+		// removeRigidBody() releases it for bodies using one, otherwise call releaseInstancedCollisionShape()
+		btCollisionShape*						instancedCollisionShapeFromActor(Actor* actor, btTransform& worldTransform);
+		void									releaseInstancedCollisionShape(btCollisionShape* shape);
+
+		// drops m from the instanced shape lookup, shapes already handed out keep their own copy of the triangles and
+		// stay alive until released. Called by the owning scene when the AssetManager deletes m
+		void									forgetInstancedMesh(const Mesh* m);
+		btRigidBody*							addInstancedStaticCollisionBody(Actor* actor, int collisionFilterGroup, int collisionFilterMask);
+
+		// Mesh space convex shape for dynamic bodies (see ConvexDecomposition): a single btConvexHullShape, or a
+		// btCompoundShape of them whose children are registered as <name>_<i>. Registered and reused under
+		// convexCollisionShapeName(mesh, params), removing it removes the children too. The decomposition is read from /
+		// written to the collision cache directory when one is set
+		btCollisionShape*						convexCollisionShapeFromMesh(Mesh* mesh, const ConvexDecompositionParams& params = {});
+		static std::string						convexCollisionShapeName(const Mesh* mesh, const ConvexDecompositionParams& params = {});
+
+		// sets cot.collisionShape to convexCollisionShapeFromMesh(mesh, params) and adds the template, false (and no
+		// template) if the mesh couldn't be decomposed
+		bool									addConvexCollisionObjectTemplate(std::string name, Mesh* mesh, CollisionObjectTemplate cot, const ConvexDecompositionParams& params = {});
+
+		// where cooked bvhs / internal edge info for static triangle mesh shapes are read from and written to (see
+		// CollisionCache), typically the directory holding the mesh packs, empty (the default) disables the cache
+		void									setCollisionCacheDirectory(const std::string& directory);
+		const std::string&						getCollisionCacheDirectory();
+
+		// Begin / stay / end events for every touching pair, filled at the end of each stepSimulation() and read in
+		// batch through getContactEvents() (nullptr while disabled). Bodies added through this class from an actor
+		// carry it as their user pointer, which is what the events resolve actors from
+		void									enableContactEvents(size_t capacity = 4096, bool reportStay = true);
+		void									disableContactEvents();
+		ContactEventStream*						getContactEvents();
+
+		// Trigger volumes: collision objects without contact response whose enter / exit transitions are tracked by
+		// the TriggerSystem from broadphase pairs and their bounds, read in batch through getTriggerSystem() after each
+		// stepSimulation(). Moving a trigger has to go through setTriggerTransform() so its bounds are updated
+		btCollisionObject*						addTrigger(btCollisionShape* shape, const btTransform& transform, int collisionFilterGroup, int collisionFilterMask, Actor* actor = nullptr);
+		void									setTriggerTransform(btCollisionObject* trigger, const btTransform& transform);
+		void									removeTrigger(btCollisionObject* trigger);
+		TriggerSystem*							getTriggerSystem();
+
 		void									removeRigidBody(btRigidBody* rb);
 		void									removeGhostObject(btPairCachingGhostObject* go);
 
 
 		std::optional<RaycastResult>			rayTest(btVector3 from, btVector3 to, int collisionFilterMask = 1, std::vector<btCollisionObject*> blackList = {});
+
+		// Casts count rays, results[i] receiving the closest hit of rays[i] (or nothing). With a pool (on a dbvt or
+		// uniform grid broadphase, in BT_THREADSAFE builds) the rays are spread across it, each ray walking the
+		// broadphase and shapes read only, so this must not overlap stepSimulation or any add / remove / move of
+		// collision objects. blackList applies to every ray.
+		void									rayTestBatch(const RaycastRequest* rays, size_t count, std::optional<RaycastResult>* results, ThreadPool* pool = nullptr, std::vector<btCollisionObject*> blackList = {});
 		std::optional<ConvexCastResult>			convexSweepTest(btConvexShape* castShape, btVector3 from, btVector3 to, int collisionFilterMask = 1, std::vector<btCollisionObject*> blackList = {});
 
+		// rayTestBatch for convex sweeps, with the same threading rules. Cast shapes may be shared between requests
+		void									convexSweepTestBatch(const ConvexCastRequest* sweeps, size_t count, std::optional<ConvexCastResult>* results, ThreadPool* pool = nullptr, std::vector<btCollisionObject*> blackList = {});
+
 		void									useDebugDrawer(Shader* s, int debugMode = 1);
 		CollisionDebugDrawer* 					getDebugDrawer();
 		bool									getDebugEnabled();
@@ -75,6 +163,9 @@ namespace vel
 		void									setCamera(Camera* c);
 		Camera*									getCamera();
 
+		// the object's user pointer, or for rigid bodies without one the actor of their ActorMotionState, nullptr if neither
+		static Actor*							actorFromCollisionObject(const btCollisionObject* co);
+
 		static bool								getTriangleVertices(const btStridingMeshInterface* meshInterface, int triangleIndex, btVector3& v0, btVector3& v1, btVector3& v2, int& index0, int& index1, int& index2);
 
 		const std::string&						getName();
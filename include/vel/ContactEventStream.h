@@ -0,0 +1,109 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+#include "btBulletCollisionCommon.h"
+
+
+namespace vel
+{
+	class Actor;
+
+	enum class ContactEventType
+	{
+		BEGIN,
+		STAY,
+		END
+	};
+
+	/*
+		objectA / objectB are ordered by address, so a pair always reports the same way round, actors are resolved
+		through CollisionWorld::actorFromCollisionObject. END events keep the pointers of the last contact but carry no
+		contact data, and objects may already have been removed from the world (and deleted) by the time they are
+		read, so only compare them.
+	*/
+	struct ContactEvent
+	{
+		ContactEventType			type;
+		const btCollisionObject*	objectA;
+		const btCollisionObject*	objectB;
+		Actor*						actorA;
+		Actor*						actorB;
+		btVector3					positionWorldOnB;	// deepest point
+		btVector3					normalWorldOnB;		// points from B towards A
+		btScalar					appliedImpulse;		// summed over every point of the pair
+		int							contactCount;
+	};
+
+	// a pair touching during the last update, kept sorted by (objectA, objectB)
+	struct ContactEventPair
+	{
+		const btCollisionObject*	objectA;
+		const btCollisionObject*	objectB;
+		Actor*						actorA;
+		Actor*						actorB;
+	};
+
+	// a touching manifold before manifolds of the same pair are merged, distance being that of its deepest point
+	struct ContactEventCandidate
+	{
+		ContactEvent				event;
+		btScalar					distance;
+	};
+
+	/*
+		Begin / stay / end contact events for a CollisionWorld (see CollisionWorld::enableContactEvents). After each step
+		update() walks the dispatcher's persistent manifolds once, and diffing the touching pairs against the previous
+		step's (both flat sorted arrays) gives the transitions. Events go into a fixed size ring buffer, once it is full
+		the oldest unread events are overwritten and counted as dropped, so size it for the busiest step between reads.
+		Nothing is allocated once the pair arrays have grown to the world's contact count.
+	*/
+	class ContactEventStream
+	{
+	private:
+		std::vector<ContactEvent>		events;
+		size_t							head;
+		size_t							count;
+		size_t							dropped;
+		bool							reportStay;
+
+		std::vector<ContactEventPair>	previous;
+		std::vector<ContactEventPair>	current;
+		std::vector<ContactEventCandidate> touching; // scratch, one entry per touching manifold before merging
+
+		void							push(const ContactEvent& e);
+
+	public:
+		ContactEventStream(size_t capacity, bool reportStay = true);
+
+		// called by CollisionWorld at the end of every stepSimulation()
+		void							update(btDispatcher* dispatcher);
+
+		// ends every pair co is part of, called by CollisionWorld before removing co
+		void							removeObject(const btCollisionObject* co);
+
+		size_t							size() const;
+		size_t							getCapacity() const;
+		size_t							getDroppedCount() const; // since construction
+		void							clear();
+
+		// moves up to maxCount of the oldest events into out, returning how many were moved
+		size_t							read(ContactEvent* out, size_t maxCount);
+
+		// calls fn(const ContactEvent&) for every pending event, oldest first, and empties the stream. fn may remove
+		// objects from the world, the resulting END events are delivered within the same call
+		template<typename F>
+		void							consume(F&& fn)
+		{
+			while (this->count > 0)
+			{
+				ContactEvent e = this->events[this->head];
+				this->head = (this->head + 1) % this->events.size();
+				this->count--;
+
+				fn(static_cast<const ContactEvent&>(e));
+			}
+		}
+	};
+}
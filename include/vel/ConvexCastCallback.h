@@ -13,11 +13,17 @@ namespace vel
 	class ConvexCastCallback : public btCollisionWorld::ClosestConvexResultCallback
 	{
 	private:
-		std::vector<btCollisionObject*> blackList;
+		std::vector<btCollisionObject*> ownedBlackList;
+		const std::vector<btCollisionObject*>* blackList; // sorted, blacklisted objects are rejected in the broadphase
 
 	public:
 					ConvexCastCallback(btVector3 from, btVector3 to, std::vector<btCollisionObject*> blackList = {});
+					ConvexCastCallback(btVector3 from, btVector3 to, const std::vector<btCollisionObject*>* sortedBlackList); // must outlive the callback
+					ConvexCastCallback(const ConvexCastCallback&) = delete;
+		ConvexCastCallback& operator=(const ConvexCastCallback&) = delete;
+
+		bool		needsCollision(btBroadphaseProxy* proxy0) const;
 		btScalar	addSingleResult(btCollisionWorld::LocalConvexResult& convexResult, bool normalInWorldSpace);
 	};
 
-}
\ No newline at end of file
+}
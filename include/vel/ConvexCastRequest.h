@@ -0,0 +1,17 @@
+#pragma once
+
+
+#include "btBulletCollisionCommon.h"
+
+
+
+namespace vel
+{
+	struct ConvexCastRequest
+	{
+		btConvexShape*				castShape;
+		btVector3					from;
+		btVector3					to;
+		int							collisionFilterMask = 1;
+	};
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "glm/glm.hpp"
+
+
+namespace vel
+{
+	struct ConvexDecompositionParams
+	{
+		int			maxHulls = 16;
+		int			maxHullVertices = 32;	// per hull, after reduction
+		float		maxConcavity = 0.02f;	// parts at or below this (relative to the mesh's bounding box diagonal) aren't split
+		int			maxDepth = 8;			// splits along any one branch
+	};
+
+	/*
+		Cooked convex decomposition layout (native endianness, every section 16 byte aligned):
+
+		ConvexDecompositionCacheHeader
+		uint32_t[hullCount]				- number of points in each hull
+		float[pointCount * 3]			- hull points, hull after hull
+
+		Keyed by a hash of the triangles and the parameters they were decomposed with. Any change to this layout or to
+		the decomposition itself requires bumping CONVEX_DECOMPOSITION_CACHE_VERSION.
+	*/
+	static const uint32_t CONVEX_DECOMPOSITION_CACHE_VERSION = 1;
+
+	struct ConvexDecompositionCacheHeader
+	{
+		char		magic[8];
+		uint32_t	version;
+		uint32_t	hullCount;
+		uint64_t	contentHash;
+		uint64_t	hullSizesOffset;
+		uint64_t	pointsOffset;
+		uint64_t	pointCount;
+	};
+
+	/*
+		Approximate convex decomposition of render meshes for dynamic bodies. The mesh is split recursively by axis
+		aligned planes, always splitting the part furthest from convex first, until every part is within
+		maxConcavity, maxHulls is reached or a branch is maxDepth deep. A part's concavity is how far its hull
+		reaches past its own triangles along their normals, so meshes are expected to be consistently wound. Each part
+		becomes the support points of its triangles along maxHullVertices directions, which keeps hulls small at the
+		cost of shaving corners that fall between directions.
+
+		This is a cook step, decomposing is far too slow to do per spawn, see
+		CollisionWorld::convexCollisionShapeFromMesh() which reads / writes the results under the collision cache
+		directory (<directory>/<content hash>.velhull).
+	*/
+	class ConvexDecomposition
+	{
+	public:
+		static std::vector<std::vector<glm::vec3>> decompose(const std::vector<glm::vec3>& positions, const std::vector<unsigned int>& indices, const ConvexDecompositionParams& params);
+
+		static std::string					getCachePath(const std::string& directory, uint64_t contentHash);
+		static uint64_t						contentHash(const std::vector<glm::vec3>& positions, const std::vector<unsigned int>& indices, const ConvexDecompositionParams& params);
+		static bool							write(const std::string& cachePath, uint64_t contentHash, const std::vector<std::vector<glm::vec3>>& hulls);
+
+		// false if there is no usable cache for contentHash
+		static bool							load(const std::string& cachePath, uint64_t contentHash, std::vector<std::vector<glm::vec3>>& hulls);
+	};
+}
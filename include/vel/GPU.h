@@ -17,6 +17,8 @@
 #include "vel/RenderTarget.h"
 #include "vel/FontBitmap.h"
 #include "vel/FinalRenderTarget.h"
+#include "vel/ParticleData.h"
+#include "vel/GpuTimer.h"
 
 struct __GLsync;
 typedef __GLsync* GLsync;
@@ -58,6 +60,22 @@ namespace vel
 
 		bool								useFXAA;
 
+		std::vector<unsigned char>			packedVertexScratch; // reused when packing compact vertex formats
+		std::vector<unsigned int>			lodIndexScratch; // reused when concatenating lod index lists
+		size_t								activeLod;
+		void								uploadIndices(Mesh* m, GpuMesh& gm); // static meshes, element buffer must be bound
+		void								configureVertexAttributes(VertexFormat format);
+
+		void								setTextureParameters(unsigned int target, int options);
+		bool								loadTextureArray(Texture* t);
+		void								loadCompressedTexture(TextureData& td, int options);
+		bool								loadCompressedTextureArray(Texture* t);
+
+		static size_t						dynamicMeshCapacity(size_t required, size_t current);
+		void								updateDynamicMesh(Mesh* m);
+
+		bool								loadComputeShader(Shader* s);
+
 
 		GLsync								prevFrameFence;
 
@@ -82,8 +100,12 @@ namespace vel
 
 		bool								loadShader(Shader* s);
 		void								loadMesh(Mesh* m);
-		void								updateMesh(Mesh* m);
-		void								loadTexture(Texture* t);
+		void								updateMesh(Mesh* m); // dynamic meshes only upload their dirty ranges, see Mesh::setDynamic()
+		void								updateMeshVertices(Mesh* m); // vertex count must match what was last loaded
+		void								updateMeshVertexRange(Mesh* m, size_t firstVertex, size_t vertexCount); // same, for a sub range
+		// false (nothing uploaded) when TXT_OPT_ARRAY is set and the frames can't share one array texture, as array
+		// materials would sample 2d handles through a sampler2DArray
+		bool								loadTexture(Texture* t);
 		void								loadFontBitmapTexture(FontBitmap* fb);
 
 		RenderTarget						createRenderTarget(const std::string& name, unsigned int width, unsigned int height);
@@ -104,7 +126,31 @@ namespace vel
 		void								setShaderVec3Array(const std::string& name, const std::vector<glm::vec3>& value);
 		void								setShaderVec4(const std::string& name, const glm::vec4& value);
 
+		void								setActiveLod(size_t lod); // level drawn by drawGpuMesh(), ignored for meshes without that many lods
 		void								drawGpuMesh();
+		void								drawGpuMeshInstanced(); // draws activeMesh's instanceCount instances
+
+		void								createInstanceBuffer(Mesh* m, size_t capacity); // ParticleInstance attributes at locations 9 - 11
+		void								updateInstanceBuffer(Mesh* m, const std::vector<ParticleInstance>& instances);
+
+		unsigned int						createParticleStateBuffer(size_t capacity);
+		void								updateParticleStateBuffer(unsigned int buffer, size_t first, const ParticleGpuState* states, size_t count);
+		void								dispatchParticleCompute(unsigned int stateBuffer, Mesh* m); // active shader must be the compute program
+		void								clearBuffer(unsigned int buffer);
+
+		unsigned int						createOcclusionQuery();
+		void								clearOcclusionQuery(unsigned int query);
+		void								beginOcclusionQuery(unsigned int query); // GL_ANY_SAMPLES_PASSED_CONSERVATIVE
+		void								endOcclusionQuery();
+		void								beginConditionalRender(unsigned int query); // draws until endConditionalRender() are dropped if the query passed no samples
+		void								endConditionalRender();
+		void								setOcclusionProxyRenderState(); // depth tested, no color or depth writes
+		void								endOcclusionProxyRenderState();
+
+		GpuTimer							createGpuTimer();
+		void								beginGpuTimer(GpuTimer& t);
+		void								endGpuTimer(GpuTimer& t);
+		void								clearGpuTimer(GpuTimer& t);
 		void								clearDepthBuffer();
 
 		void								finish();
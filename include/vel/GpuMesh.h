@@ -1,14 +1,26 @@
 #pragma once
 
+#include <cstddef>
 
 namespace vel
 {
 	typedef int GLsizei;
+
+	static const size_t MAX_MESH_LODS = 8;
+
 	struct GpuMesh
 	{
 		unsigned int	VAO;
 		unsigned int	VBO;
 		unsigned int    EBO;
 		GLsizei			indiceCount;
+		size_t			vertexCapacity = 0; // dynamic meshes only, in vertices / indices
+		size_t			indexCapacity = 0;
+		unsigned int	instanceVBO = 0; // per instance attributes, see GPU::createInstanceBuffer()
+		size_t			instanceCapacity = 0;
+		GLsizei			instanceCount = 0;
+		size_t			lodCount = 1; // levels past 0 live after the base indices in the same ebo, see GPU::uploadIndices()
+		GLsizei			lodFirstIndex[MAX_MESH_LODS] = {};
+		GLsizei			lodIndexCount[MAX_MESH_LODS] = {};
 	};    
 }
\ No newline at end of file
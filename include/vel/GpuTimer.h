@@ -0,0 +1,14 @@
+#pragma once
+
+namespace vel
+{
+	// GL_TIME_ELAPSED queries used round robin, so results are read latency frames after they were issued and reading
+	// never stalls the pipeline. See GPU::createGpuTimer()
+	struct GpuTimer
+	{
+		static const unsigned int	latency = 3;
+		unsigned int				queries[latency] = { 0, 0, 0 };
+		unsigned int				issued = 0; // begin / end pairs so far
+		double						milliseconds = 0.0; // most recent available result
+	};
+}
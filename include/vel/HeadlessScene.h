@@ -25,23 +25,32 @@ namespace vel
 		AssetManager*							assetManager;
 		std::vector<std::unique_ptr<Stage>>		stages;
 		std::vector<CollisionWorld*> 			collisionWorlds;
+		bool									stepCollisionWorldsConcurrently;
+		std::vector<CollisionWorld*>			concurrentStepScratch;
 		std::vector<Mesh*>						meshesInUse;
 		std::vector<std::string>				skeletonsInUse;
 		std::vector<std::string>				animationsInUse;
 
+		std::vector<std::shared_future<std::vector<Mesh*>>>	pendingMeshLoads;
+		std::vector<std::pair<std::string, std::shared_future<ozz::animation::Skeleton*>>>	pendingSkeletonLoads;
+		std::vector<std::pair<std::string, std::shared_future<ozz::animation::Animation*>>>	pendingAnimationLoads;
+
 
 		int										getCollisionWorldIndex(const std::string& name);
 
-		bool									loadMesh(const std::string& path);
+		bool									loadMesh(const std::string& path, VertexFormat format = VertexFormat::FULL);
+		std::shared_future<std::vector<Mesh*>>	loadMeshAsync(const std::string& path, VertexFormat format = VertexFormat::FULL);
 		Mesh*									getMesh(const std::string& name);
 
 		ozz::animation::Skeleton*				loadSkeleton(const std::string& name, const std::string& path);
+		std::shared_future<ozz::animation::Skeleton*>	loadSkeletonAsync(const std::string& name, const std::string& path);
 		ozz::animation::Skeleton*				getSkeleton(const std::string& name);
 
 		ozz::animation::Animation*				loadAnimation(const std::string& name, const std::string& path);
+		std::shared_future<ozz::animation::Animation*>	loadAnimationAsync(const std::string& name, const std::string& path);
 		ozz::animation::Animation*				getAnimation(const std::string& name);
 
-		CollisionWorld*							addCollisionWorld(const std::string& name, float gravity = -10.0f);
+		CollisionWorld*							addCollisionWorld(const std::string& name, float gravity = -10.0f, bool multithreaded = false, BroadphaseOptions broadphase = {});
 		CollisionWorld*							getCollisionWorld(const std::string& name);
 
 
@@ -63,8 +72,16 @@ namespace vel
 
 		void									setAssetManager(AssetManager* am);
 
+		// moves the results of completed async loads into the in use lists so they are released with the scene
+		virtual void							collectAsyncLoads();
+
 		void									stepPhysics(float delta);
 
+		// Steps independent single threaded collision worlds alongside each other on the asset manager's worker pool
+		// (multithreaded worlds are already spread across every core and are stepped one after the other). Only takes
+		// effect in BT_THREADSAFE builds (USE_BULLET_MULTITHREADING), elsewhere worlds are always stepped in turn.
+		void									setStepCollisionWorldsConcurrently(bool b);
+
 		void									updateAnimators(float delta);
 
 		Stage*									addStage(const std::string& name);
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "btBulletCollisionCommon.h"
+
+
+namespace vel
+{
+	class Mesh;
+
+	// scale is quantized to 1/10000 so that float noise from decomposing world matrices doesn't split instances
+	struct InstancedCollisionShapeKey
+	{
+		const Mesh*			mesh;
+		int32_t				scale[3];
+
+		bool operator==(const InstancedCollisionShapeKey& o) const
+		{
+			return this->mesh == o.mesh && this->scale[0] == o.scale[0] && this->scale[1] == o.scale[1] && this->scale[2] == o.scale[2];
+		}
+	};
+
+	struct InstancedCollisionShapeKeyHash
+	{
+		size_t operator()(const InstancedCollisionShapeKey& k) const
+		{
+			return std::hash<const void*>()(k.mesh) ^ (size_t)((uint32_t)k.scale[0] * 73856093u ^ (uint32_t)k.scale[1] * 19349663u ^ (uint32_t)k.scale[2] * 83492791u);
+		}
+	};
+
+	struct InstancedCollisionShape
+	{
+		InstancedCollisionShapeKey	key; // only in the lookup while key.mesh is alive, see CollisionWorld::forgetInstancedMesh
+		btTriangleMesh*				triangleMesh; // unit scale shapes only, mesh space triangles
+		btCollisionShape*			base; // scaled shapes only, the unit scale shape they hold a reference on
+		size_t						references;
+	};
+}
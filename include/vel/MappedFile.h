@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+namespace vel
+{
+	// Read only memory mapping of an entire file
+	class MappedFile
+	{
+	private:
+		const unsigned char*	data;
+		size_t					size;
+
+#ifdef _WIN32
+		void*					fileHandle;
+		void*					mappingHandle;
+#else
+		int						fileDescriptor;
+#endif
+
+	public:
+		MappedFile();
+		~MappedFile();
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		bool					open(const std::string& path);
+		void					close();
+
+		bool					isOpen() const;
+		const unsigned char*	getData() const;
+		size_t					getSize() const;
+	};
+}
@@ -25,6 +25,7 @@ namespace vel
 		std::vector<Texture*>				textures;
 		bool								hasAlphaChannel;
 		Shader*								shader;
+		int									options; // MaterialOptions the shader variant was built with
 
 	public:
 		Material(const std::string& name, Shader* shader);
@@ -33,6 +34,9 @@ namespace vel
 		bool						getHasAlphaChannel() const;
 		void						setHasAlphaChannel(bool b);
 
+		int							getOptions() const;
+		void						setOptions(int opts);
+
 		void						addTexture(Texture* t);
 		std::vector<Texture*>&		getTextures();
 		
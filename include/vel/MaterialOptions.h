@@ -7,6 +7,9 @@ namespace vel
         MTRL_OPT_NONE = 0,
         MTRL_OPT_TRANSLUCENT = 1 << 0, // 0001
         MTRL_OPT_CUTOUT = 1 << 1, // 0010
+        MTRL_OPT_COMPACT_VERTEX = 1 << 2, // 0100, for meshes loaded with a compact VertexFormat
+        MTRL_OPT_TEXTURE_ARRAY = 1 << 3, // 1000, samples textures as sampler2DArray at "textureLayers", for TXT_OPT_ARRAY textures
+        MTRL_OPT_GPU_BILLBOARD = 1 << 4, // 10000, vertex shader faces the quad toward the camera, see Billboard::setGpuOriented()
         // add more as needed
     };
 }
@@ -16,4 +16,5 @@
 #include "vel/RGBALineMaterial.h"
 #include "vel/RGBALightmapMaterial.h"
 #include "vel/DiffuseCausticMaterial.h"
-#include "vel/DiffuseCausticLightmapMaterial.h"
\ No newline at end of file
+#include "vel/DiffuseCausticLightmapMaterial.h"
+#include "vel/ParticleMaterial.h"
\ No newline at end of file
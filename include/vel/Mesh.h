@@ -9,6 +9,7 @@
 
 #include "vel/Shader.h"
 #include "vel/Vertex.h"
+#include "vel/VertexFormat.h"
 #include "vel/Texture.h"
 #include "vel/GpuMesh.h"
 #include "vel/MeshBone.h"
@@ -17,6 +18,13 @@
 
 namespace vel
 {
+	// an alternate, coarser index list over the same vertices (authored lod vertices are appended to the mesh's own)
+	struct MeshLod
+	{
+		std::vector<unsigned int>			indices;
+		float								screenSize; // used once the projected bounds fall below this fraction of the viewport height
+	};
+
 	class Mesh
 	{
 
@@ -28,6 +36,17 @@ namespace vel
 		std::optional<GpuMesh>              gpuMesh;
 		std::optional<AABB>					aabb;
 		bool								aabbStale;
+		VertexFormat						vertexFormat;
+
+		// dynamic meshes keep grow-only GL_DYNAMIC_DRAW buffers and track which ranges changed since the last upload,
+		// so that GPU::updateMesh() only has to send those
+		bool								dynamic;
+		size_t								dirtyVertexFirst;
+		size_t								dirtyVertexEnd;
+		size_t								dirtyIndexFirst;
+		size_t								dirtyIndexEnd;
+
+		std::vector<MeshLod>				lods; // ordered fine to coarse, level 0 is indices itself
 
 
 	public:
@@ -35,6 +54,8 @@ namespace vel
 		void                                setGpuMesh(GpuMesh gm);
 		void								setVertices(const std::vector<Vertex>& vertices);
 		void								setIndices(const std::vector<unsigned int>& indices);
+		void								setVertices(const Vertex* vertices, size_t count);
+		void								setIndices(const unsigned int* indices, size_t count);
 		void								setBones(const std::vector<MeshBone>& bones);
 		std::optional<GpuMesh>&				getGpuMesh();
 		const std::string                   getName() const;
@@ -48,9 +69,41 @@ namespace vel
 		const std::vector<MeshBone>&		getBones() const;
 
 		AABB&								getAABB();
+		void								setAABB(const AABB& a); // for when the bounds are already known (cooked mesh packs)
+
+		// must be set before the mesh is loaded onto the gpu, see VertexFormat.h
+		void								setVertexFormat(VertexFormat vf);
+		VertexFormat						getVertexFormat() const;
+
+		// must be set before the mesh is loaded onto the gpu, for meshes that are updated often (text, lines)
+		void								setDynamic(bool d);
+		bool								isDynamic() const;
+
+		// set*() mark changed ranges automatically, these are for callers that write through getMutableVertices()
+		void								markVerticesDirty(size_t first, size_t end);
+		void								markIndicesDirty(size_t first, size_t end);
+		bool								hasDirtyVertices() const;
+		size_t								getDirtyVertexFirst() const;
+		size_t								getDirtyVertexEnd() const;
+		bool								hasDirtyIndices() const;
+		size_t								getDirtyIndexFirst() const;
+		size_t								getDirtyIndexEnd() const;
+		void								clearDirtyRanges();
 
 		void								appendVertices(const std::vector<Vertex>& vs);
 
+		// lods are only drawn for static meshes, and must be added before the mesh is loaded onto the gpu (or followed by
+		// GPU::updateMesh()). setVertices() / setIndices() leave them alone, call clearLods() when replacing the geometry
+		bool								addLod(const std::vector<unsigned int>& indices, float screenSize);
+		bool								addLod(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, float screenSize);
+		void								setLodScreenSize(size_t level, float screenSize);
+		const std::vector<MeshLod>&			getLods() const;
+		size_t								getLodCount() const; // including level 0
+		void								clearLods();
+
+		// level to draw at screenSize, only moves away from current once screenSize is past the threshold by hysteresis
+		size_t								selectLod(float screenSize, size_t current, float hysteresis) const;
+
 		bool								initBillboardQuad(float width, float height);
 
 	};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+
+#include "vel/Vertex.h"
+#include "vel/Mesh.h"
+
+
+namespace vel
+{
+	// acmr = transformed vertices per triangle (0.5 is ideal for large regular grids, 3 is no reuse at all),
+	// atvr = transformed vertices per unique vertex (1 is ideal)
+	struct VertexCacheStats
+	{
+		float		acmr;
+		float		atvr;
+	};
+
+	struct MeshOptimizationReport
+	{
+		VertexCacheStats	before;
+		VertexCacheStats	after;
+	};
+
+	/*
+		Cook time reordering of a mesh's triangles and vertices, nothing about what is drawn changes:
+
+		- optimizeVertexCache: Forsyth's linear speed vertex cache optimization, triangles are emitted greedily by a score
+		  favouring vertices that are already in a simulated lru cache and vertices with few remaining triangles
+		- optimizeOverdraw: splits the cache optimized order into clusters at its hard cache boundaries and sorts the
+		  clusters so that outward facing ones (likely occluders) are drawn first, kept only if acmr grows by less than
+		  threshold
+		- optimizeVertexFetch: renumbers vertices in first use order so that the vertex fetch walks memory linearly,
+		  unreferenced vertices are dropped
+	*/
+	class MeshOptimizer
+	{
+	public:
+		static const size_t			cacheSize = 16; // fifo size used when reporting, typical of post transform caches
+
+		static VertexCacheStats		analyzeVertexCache(const std::vector<unsigned int>& indices, size_t vertexCount, size_t cacheSize = MeshOptimizer::cacheSize);
+
+		static void					optimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount);
+		static void					optimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices, float threshold = 1.05f);
+		static void					optimizeVertexFetch(Mesh* m); // remaps every lod as well
+
+		// all of the above on every lod (overdraw on level 0 only), stats are for level 0
+		static MeshOptimizationReport optimize(Mesh* m);
+	};
+}
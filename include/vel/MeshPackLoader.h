@@ -0,0 +1,110 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+
+#include "vel/Mesh.h"
+#include "vel/MeshLoaderInterface.h"
+#include "vel/MappedFile.h"
+
+
+namespace vel
+{
+	/*
+		Binary mesh pack layout (native endianness, every section 16 byte aligned):
+
+		MeshPackHeader
+		MeshPackEntry[meshCount]
+		MeshPackBone[]		- all bones of all meshes, entries index into this by boneOffset
+		MeshPackLod[]		- all lods of all meshes, entries index into this by lodOffset
+		char[]				- all names (not null terminated)
+		Vertex[]			- raw Vertex structs, the layout is guarded by vertexSize in the header
+		unsigned int[]		- indices, followed by each mesh's lod indices
+
+		Any change to this layout, or to Vertex, requires bumping MESH_PACK_VERSION so that existing
+		packs are re-cooked rather than misread.
+	*/
+	static const uint32_t MESH_PACK_VERSION = 3;
+
+	struct MeshPackHeader
+	{
+		char		magic[8];
+		uint32_t	version;
+		uint32_t	vertexSize;
+		uint32_t	meshCount;
+		uint32_t	reserved;
+	};
+
+	struct MeshPackEntry
+	{
+		uint64_t	nameOffset;
+		uint32_t	nameLength;
+		uint32_t	boneCount;
+		uint64_t	boneOffset;
+		uint64_t	vertexOffset;
+		uint64_t	vertexCount;
+		uint64_t	indexOffset;
+		uint64_t	indexCount;
+		float		aabbMin[3];
+		float		aabbMax[3];
+		uint64_t	lodOffset;
+		uint32_t	lodCount;
+		uint32_t	reserved;
+	};
+
+	struct MeshPackLod
+	{
+		uint64_t	indexOffset;
+		uint64_t	indexCount;
+		float		screenSize;
+		uint32_t	reserved;
+	};
+
+	struct MeshPackBone
+	{
+		uint64_t	nameOffset;
+		uint32_t	nameLength;
+		uint32_t	reserved;
+		float		offsetMatrix[16];
+	};
+
+	/*
+		Serves meshes out of a memory mapped pack written next to the source file (<source>.velmesh). The wrapped
+		source loader (AssimpMeshLoader for example) is only used to cook the pack when it does not exist yet, or
+		when the source file is newer than the pack. Meshes that come out of the source loader without authored lods
+		get generatedLodLevels simplified ones (see MeshSimplifier) while cooking, and every mesh has its triangles and
+		vertices reordered for the vertex cache / overdraw / vertex fetch (see MeshOptimizer).
+	*/
+	class MeshPackLoader : public MeshLoaderInterface
+	{
+	private:
+		std::unique_ptr<MeshLoaderInterface>	sourceLoader;
+		MappedFile								pack;
+		const MeshPackEntry*					entries;
+		uint32_t								entryCount;
+		std::vector<std::string>				meshesInFile;
+		size_t									generatedLodLevels;
+
+		// only populated when cooking succeeded but the written pack could not be mapped back in
+		std::vector<std::unique_ptr<Mesh>>		cookedMeshes;
+
+		bool									packIsCurrent(const std::string& sourcePath, const std::string& packPath);
+		bool									mapPack(const std::string& packPath);
+		bool									cook(const std::string& sourcePath, const std::string& packPath);
+		std::unique_ptr<Mesh>					meshFromEntry(const MeshPackEntry& e);
+
+	public:
+		MeshPackLoader(std::unique_ptr<MeshLoaderInterface> sourceLoader, size_t generatedLodLevels = 0);
+		~MeshPackLoader() {};
+
+		static std::string						getPackPath(const std::string& sourcePath);
+		static bool								writePack(const std::string& packPath, const std::vector<std::unique_ptr<Mesh>>& meshes);
+
+		const std::vector<std::string>&			preload(const std::string& filePath);
+		std::vector<std::unique_ptr<Mesh>>		load(const std::vector<std::string>* loadables);
+
+		void reset();
+	};
+}
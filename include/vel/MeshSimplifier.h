@@ -0,0 +1,28 @@
+#pragma once
+
+#include <vector>
+
+#include "vel/Vertex.h"
+#include "vel/Mesh.h"
+
+
+namespace vel
+{
+	/*
+		Quadric error edge collapse (Garland & Heckbert) over an indexed triangle list. Vertices are never moved or
+		created, a collapse folds one vertex onto a neighbour, so the result indexes the same vertex array and can be
+		stored as a MeshLod. Vertices on open borders and on attribute seams (several vertices sharing a position) are
+		locked so that silhouettes and uv / material boundaries stay intact.
+	*/
+	class MeshSimplifier
+	{
+	public:
+		// targetError is relative to the mesh extent, resultError (optional) receives the error actually reached
+		static std::vector<unsigned int>	simplify(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices,
+												size_t targetIndexCount, float targetError, float* resultError = nullptr);
+
+		// appends up to levels lods each reduction times the size of the previous, stopping early once a level no
+		// longer shrinks. Level n switches in below pow(reduction, n) of the viewport height
+		static size_t						generateLods(Mesh* m, size_t levels, float reduction = 0.5f, float maxError = 0.05f);
+	};
+}
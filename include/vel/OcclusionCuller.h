@@ -0,0 +1,71 @@
+#pragma once
+
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#include "glm/glm.hpp"
+
+#include "vel/Actor.h"
+#include "vel/Camera.h"
+#include "vel/Mesh.h"
+#include "vel/Shader.h"
+
+
+namespace vel
+{
+	class GPU;
+
+	struct OcclusionQueryState
+	{
+		unsigned int			query;
+		uint32_t				lastUsedFrame;
+		bool					issued;
+	};
+
+	struct OcclusionProxy
+	{
+		const Actor*			actor;
+		glm::vec3				minEdge;
+		glm::vec3				maxEdge;
+	};
+
+	// Hardware occlusion culling for the opaque pass. Once a camera's opaque actors are drawn, each one's world bounds
+	// are drawn as a depth tested box (no color / depth writes) inside an occlusion query. The next frame that actor's
+	// draw is wrapped in conditional rendering on that query, so the gpu drops it if none of the box was visible,
+	// without the cpu ever waiting on a result. Results lag a frame, actors whose box the camera is inside (or nearly)
+	// are always drawn and never tested since the box would be clipped by the near plane.
+	class OcclusionCuller
+	{
+	private:
+		GPU*					gpu;
+		Mesh*					proxyMesh; // unit cube, 0 - 1 on each axis
+		Shader*					proxyShader;
+		float					inflation; // proxies are grown by this so they never z fight the surfaces they enclose
+		uint32_t				frame;
+
+		std::map<const Camera*, std::unordered_map<const Actor*, OcclusionQueryState>> queries;
+		std::vector<OcclusionProxy>	pendingProxies; // for the camera pass in progress
+
+	public:
+		OcclusionCuller(GPU* gpu, Mesh* proxyMesh, Shader* proxyShader, float inflation = 0.05f);
+		~OcclusionCuller();
+
+		static std::unique_ptr<Mesh> createProxyMesh(const std::string& name);
+
+		void					beginFrame();
+
+		// queues the actor's proxy for this pass, returns true when conditional rendering was started around its draw,
+		// in which case endActor() must follow the draw
+		bool					beginActor(Camera* c, const Actor* a, const glm::vec3& minEdge, const glm::vec3& maxEdge);
+		void					endActor();
+
+		// issues this pass's queries, call after the camera's opaque actors and before its alpha pass
+		void					drawProxies(Camera* c);
+
+		// frees queries of actors that weren't drawn this frame (out of frustum, hidden, removed)
+		void					endFrame();
+	};
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "glm/glm.hpp"
+
+
+namespace vel
+{
+	// per instance attributes of a particle quad, locations 9 - 11. Layout also matches std430 so a compute shader can
+	// write these directly into the instance buffer
+	struct ParticleInstance
+	{
+		glm::vec4		positionSize; // xyz world position, w quad size
+		glm::vec4		color;
+		float			frame; // layer of a TXT_OPT_ARRAY texture
+		float			padding[3];
+	};
+
+	// per particle simulation state for the compute shader path (std430)
+	struct ParticleGpuState
+	{
+		glm::vec4		positionAge; // xyz world position, w seconds alive
+		glm::vec4		velocityLifetime; // xyz velocity, w seconds to live, 0 marks an unused slot
+	};
+}
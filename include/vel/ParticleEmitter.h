@@ -0,0 +1,91 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <random>
+
+#include "glm/glm.hpp"
+
+#include "vel/Actor.h"
+#include "vel/Shader.h"
+#include "vel/ParticleData.h"
+
+
+namespace vel
+{
+	class GPU;
+
+	struct ParticleEmitterSettings
+	{
+		size_t			maxParticles = 1024;
+		float			spawnRate = 64.0f; // particles per second while emitting
+		float			minLifetime = 1.0f;
+		float			maxLifetime = 2.0f;
+		glm::vec3		spawnExtents = glm::vec3(0.0f); // half size of the box around the emitter actor particles spawn within
+		glm::vec3		minVelocity = glm::vec3(-0.5f, 1.0f, -0.5f);
+		glm::vec3		maxVelocity = glm::vec3(0.5f, 2.0f, 0.5f);
+		glm::vec3		gravity = glm::vec3(0.0f, -9.81f, 0.0f);
+		float			startSize = 0.25f;
+		float			endSize = 0.05f;
+		glm::vec4		startColor = glm::vec4(1.0f);
+		glm::vec4		endColor = glm::vec4(1.0f, 1.0f, 1.0f, 0.0f);
+		unsigned int	frameCount = 1; // TXT_OPT_ARRAY layers played over each particle's lifetime
+	};
+
+	// Owns the simulation for a single actor whose quad mesh is drawn once per particle (see ParticleMaterial). State
+	// is kept as structure of arrays and integrated 4 particles at a time with ozz's simd types, dead particles are
+	// swapped out so the live ones stay packed at the front. Particles are simulated in world space, spawning around
+	// the actor's world position.
+	//
+	// When given a compute shader the simulation runs on the gpu instead. The cpu only writes newly spawned particles
+	// into a ring of slots in the state buffer, particle.comp integrates every slot and writes the instance buffer
+	// directly (binding 0 = ParticleGpuState[], binding 1 = ParticleInstance[]), so nothing is read back and
+	// getAliveCount() is not tracked on that path.
+	class ParticleEmitter
+	{
+	private:
+		std::string							name;
+		Actor*								actor; // owned by stage, holds the quad mesh and ParticleMaterial
+		ParticleEmitterSettings				settings;
+		GPU*								gpu;
+		Shader*								computeShader;
+		unsigned int						stateBuffer; // compute path only
+		size_t								nextGpuSlot;
+
+		std::vector<float>					posX, posY, posZ; // sized to maxParticles rounded up to a multiple of 4
+		std::vector<float>					velX, velY, velZ;
+		std::vector<float>					age, lifetime;
+		size_t								aliveCount;
+
+		float								spawnAccumulator;
+		size_t								pendingBurst;
+		bool								emitting;
+		std::mt19937						rng;
+
+		std::vector<ParticleInstance>		instances; // reused each update
+		std::vector<ParticleGpuState>		spawnScratch;
+
+		size_t								takeSpawnCount(float dt);
+		void								randomParticle(glm::vec3& position, glm::vec3& velocity, float& life);
+		void								simulate(float dt);
+		void								simulateCompute(float dt);
+
+	public:
+		ParticleEmitter(const std::string& name, Actor* actor, const ParticleEmitterSettings& settings, GPU* gpu, Shader* computeShader = nullptr);
+		~ParticleEmitter();
+
+		const std::string&					getName() const;
+		Actor*								getActor() const;
+		const ParticleEmitterSettings&		getSettings() const;
+
+		void								setEmitting(bool e);
+		bool								getEmitting() const;
+		void								burst(size_t count); // spawned on the next update regardless of spawnRate / emitting
+		void								clear(); // cpu path only
+
+		size_t								getAliveCount() const;
+		bool								usesComputeShader() const;
+
+		void								update(float dt);
+	};
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "vel/Material.h"
+
+namespace vel
+{
+	// Draws a ParticleEmitter's quad once per live particle. Particles are simulated in world space so the model matrix
+	// is identity, position / size / color / frame come from the per instance attributes. For flipbook particles add a
+	// TXT_OPT_ARRAY texture and MTRL_OPT_TEXTURE_ARRAY, the instance frame then selects the array layer.
+	class ParticleMaterial : public Material
+	{
+	public:
+		static std::vector<std::string> shaderDefs;
+
+		ParticleMaterial(const std::string& name, Shader* shader);
+
+		void preDraw(float frameTime) override;
+		void draw(float alphaTime, GPU* gpu, Actor* actor, const glm::mat4& viewMatrix, const glm::mat4& projMatrix) override;
+		std::unique_ptr<Material> clone() const override;
+	};
+}
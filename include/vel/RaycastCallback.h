@@ -13,13 +13,19 @@ namespace vel
 	class RaycastCallback : public btCollisionWorld::ClosestRayResultCallback
 	{
 	private:
-		std::vector<btCollisionObject*> blackList;
+		std::vector<btCollisionObject*> ownedBlackList;
+		const std::vector<btCollisionObject*>* blackList; // sorted, blacklisted objects are rejected in the broadphase
 
 	public:
 		int m_triangleIndex;
 		RaycastCallback(btVector3 from, btVector3 to, std::vector<btCollisionObject*> blackList = {});
+		RaycastCallback(btVector3 from, btVector3 to, const std::vector<btCollisionObject*>* sortedBlackList); // must outlive the callback
+		RaycastCallback(const RaycastCallback&) = delete;
+		RaycastCallback& operator=(const RaycastCallback&) = delete;
+
+		bool needsCollision(btBroadphaseProxy* proxy0) const;
 		btScalar addSingleResult(btCollisionWorld::LocalRayResult& rayResult, bool normalInWorldSpace);
 		
 	};
 
-}
\ No newline at end of file
+}
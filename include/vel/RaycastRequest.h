@@ -0,0 +1,16 @@
+#pragma once
+
+
+#include "btBulletCollisionCommon.h"
+
+
+
+namespace vel
+{
+	struct RaycastRequest
+	{
+		btVector3					from;
+		btVector3					to;
+		int							collisionFilterMask = 1;
+	};
+}
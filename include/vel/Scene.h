@@ -20,8 +20,12 @@
 #include "vel/AudioDevice.h"
 #include "vel/FinalRenderTarget.h"
 #include "vel/Billboard.h"
+#include "vel/ParticleEmitter.h"
+#include "vel/OcclusionCuller.h"
+#include "vel/GpuTimer.h"
 
 #include "vel/Material.h"
+#include "vel/MaterialOptions.h"
 #include "vel/DiffuseMaterial.h"
 #include "vel/DiffuseLightmapMaterial.h"
 #include "vel/DiffuseAnimatedMaterial.h"
@@ -36,6 +40,7 @@
 #include "vel/RGBALightmapMaterial.h"
 #include "vel/DiffuseCausticMaterial.h"
 #include "vel/DiffuseCausticLightmapMaterial.h"
+#include "vel/ParticleMaterial.h"
 
 
 namespace vel
@@ -55,17 +60,31 @@ namespace vel
 		float								animationTime;
 		glm::vec4							screenTint;
 
+		std::unique_ptr<OcclusionCuller>	occlusionCuller; // null unless enabled
+		std::optional<GpuTimer>				drawTimer; // gpu time of every stage's actor passes
+
+		float								lodBias;
+		float								lodHysteresis;
+
 		std::vector<Shader*>				shadersInUse;
 		std::vector<Texture*> 				texturesInUse;
 		std::vector<Material*> 				materialsInUse;
 		std::vector<FontBitmap*> 			fontBitmapsInUse;
 		std::vector<std::string>			soundsInUse;
+
+		std::vector<std::shared_future<Texture*>>		pendingTextureLoads;
+		std::vector<std::shared_future<FontBitmap*>>	pendingFontBitmapLoads;
 		
 		double								frameTime;
 		double								frameRate;
 
+		unsigned int						textBatchCount; // keeps batch asset names unique
+		unsigned int						staticBatchCount;
+
 		void								freeAssets();
 
+		size_t								selectActorLod(Camera* c, Actor* a, const glm::vec3& boundsMin, const glm::vec3& boundsMax);
+
 		void								setShaderOpts(int opts, std::vector<std::string>& defs, std::string& shaderName);
 
 		
@@ -75,7 +94,9 @@ namespace vel
 		int									audioGroupKey;
 
 		Texture*							loadTexture(const std::string& name, const std::string& path, int options = 0);
+		std::shared_future<Texture*>		loadTextureAsync(const std::string& name, const std::string& path, int options = 0);
 		FontBitmap*							loadFontBitmap(const std::string& fontName, int fontSize, const std::string& fontPath);
+		std::shared_future<FontBitmap*>		loadFontBitmapAsync(const std::string& fontName, int fontSize, const std::string& fontPath);
 		FontBitmap*							loadFontBitmapVisualHeight(const std::string& fontName, int desiredVisiblePx, const std::string& fontPath);
 
 		void								loadBGMSound(const std::string& path);
@@ -100,6 +121,7 @@ namespace vel
 		RGBALightmapMaterial*				addRGBALightmapMaterial(const std::string& name, int opts = 0);
 		DiffuseCausticMaterial*				addDiffuseCausticMaterial(const std::string& name, int opts = 0);
 		DiffuseCausticLightmapMaterial*		addDiffuseCausticLightmapMaterial(const std::string& name, int opts = 0);
+		ParticleMaterial*					addParticleMaterial(const std::string& name, int opts = MTRL_OPT_TRANSLUCENT);
 
 
 		Shader*								getShader(const std::string& name);
@@ -111,6 +133,11 @@ namespace vel
 		TextActor* addTextActor(Stage* stage, const std::string& name, const std::string& theText, FontBitmap* fb,
 			glm::vec4 color, PlaneOrigin originType = PlaneOrigin::LEFT_BOTTOM);
 
+		// same as addTextActor, except the glyphs are packed into the stage's TextBatch for the given font and color so
+		// that all labels sharing them are drawn with a single call, see TextBatch.h
+		TextActor* addBatchedTextActor(Stage* stage, const std::string& name, const std::string& theText, FontBitmap* fb,
+			glm::vec4 color, PlaneOrigin originType = PlaneOrigin::LEFT_BOTTOM);
+
 		LineActor* addLineActor(Stage* stage, const std::string& name, const std::vector<std::tuple<glm::vec2, glm::vec2, unsigned int>>& points,
 			std::vector<glm::vec4> colors);
 
@@ -125,6 +152,21 @@ namespace vel
 		// make 100 extra calls into the graphics driver to swap vaos)
 		Billboard* addBillboard(Stage* stage, const std::string& name, Material* material, Camera* parentCamera, Mesh* mesh);
 
+		// adds an actor drawn as one instanced call of a quad per particle, material should come from addParticleMaterial().
+		// With useComputeShader the simulation runs in particle.comp, falling back to the cpu if it can't be built
+		ParticleEmitter* addParticleEmitter(Stage* stage, const std::string& name, Material* material,
+			const ParticleEmitterSettings& settings = ParticleEmitterSettings(), bool useComputeShader = false);
+
+		// merges the stage's static actors (see StaticBatch::canBatch()) into combined meshes, one per group of compatible
+		// actors whose world bounds are centered in the same cellSize grid cell so batches stay small enough to cull.
+		// Call once the level is loaded, actors added afterwards are drawn individually. Returns the number of batches made
+		unsigned int buildStaticBatches(Stage* stage, float cellSize = 32.0f);
+
+		// skins the actor's mesh once per frame into a mesh of its own which is then drawn with the static variant of
+		// the actor's material shader, worthwhile when a skinned actor is drawn by more than one camera / pass. When
+		// skipUnchangedPose is true, actors whose animator produced the same pose as last frame are not re-skinned
+		SkinnedMeshCache* enablePreSkinning(Stage* stage, Actor* actor, bool skipUnchangedPose = true);
+
 		
 
 	public:
@@ -141,6 +183,8 @@ namespace vel
 
 		void								setInputState(const InputState* is);
 
+		void								collectAsyncLoads() override;
+
 		void								lerpAnimators(float alpha);
 		void								draw(float frameTime, float alpha);
 
@@ -159,6 +203,9 @@ namespace vel
 		FinalRenderTarget*					getSceneRenderTarget();
 
 		void								updateBillboards();
+		void								updateParticleEmitters(float dt);
+		void								updateStaticBatches();
+		void								updateSkinnedMeshCaches();
 
 		void								setFrameTime(double ft);
 		double								getFrameTime() const;
@@ -167,6 +214,21 @@ namespace vel
 
 		void								updateAllCameraResolutions(int x, int y);
 
+		// see OcclusionCuller.h, worthwhile for interiors where walls hide much of what's in the frustum
+		void								setOcclusionCulling(bool b);
+		bool								getOcclusionCulling() const;
+
+		// getDrawGpuMilliseconds() reports a result from a few frames ago, 0 until timers are enabled
+		void								setGpuTimers(bool b);
+		double								getDrawGpuMilliseconds() const;
+
+		// mesh lods are picked per camera from the projected size of each actor's bounds (see Mesh::selectLod()). Bias
+		// scales that size (below 1 switches to coarser levels sooner), hysteresis is the fraction a size has to move
+		// past a threshold before the level changes, so actors sitting on a boundary don't flicker between levels
+		void								setLodBias(float b);
+		float								getLodBias() const;
+		void								setLodHysteresis(float h);
+
 	};
 
 }
\ No newline at end of file
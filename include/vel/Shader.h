@@ -18,6 +18,7 @@ namespace vel
 		std::string vertCode;
 		std::string geomCode;
 		std::string fragCode;
+		std::string compCode; // compute only programs leave the other stages empty
 		std::unordered_map<std::string, GLint> uniformLocations;
 	};
 }
\ No newline at end of file
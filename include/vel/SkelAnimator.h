@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <string>
+#include <cstdint>
 
 #include "ozz/base/maths/simd_math.h"
 #include "ozz/base/maths/simd_quaternion.h"
@@ -24,6 +25,7 @@ namespace vel
 		
 		ozz::vector<ozz::math::SoaTransform>		renderLocalTransforms;
 		ozz::vector<ozz::math::Float4x4>			renderModelMatrices;
+		uint32_t									renderPoseVersion; // bumped whenever renderModelMatrices actually change
 
 		ozz::math::SoaFloat3		lerpSoaFloat3(const ozz::math::SoaFloat3& a, const ozz::math::SoaFloat3& b, const ozz::math::SimdFloat4& t);
 		ozz::math::SoaQuaternion	nLerpSoaQuaternion(const ozz::math::SoaQuaternion& a, ozz::math::SoaQuaternion b, const ozz::math::SimdFloat4& t);
@@ -50,6 +52,7 @@ namespace vel
 		float			getSimTime() const;
 		const ozz::math::Float4x4& getSimBoneMatrix(unsigned int i);
 		const ozz::math::Float4x4& getRenderBoneMatrix(unsigned int i);
+		uint32_t		getRenderPoseVersion() const;
 		int getBoneIndex(const std::string& name);
 		std::vector<std::string> allBoneNames();
 
@@ -4,15 +4,30 @@ namespace vel
 {
 	class Actor;
 	class GPU;
+	class Mesh;
+	class Shader;
 
 	class SkinnedMaterialMixin
 	{
 	private:
-		
+		Mesh*	preSkinnedMesh;
+		Shader*	preSkinnedShader;
 
 	public:
 		SkinnedMaterialMixin();
+
+		// the pre-skinned mesh belongs to one actor's SkinnedMeshCache, so copies (Material::clone(), i.e. copied
+		// actors) start out skinning on the gpu until they are given their own
+		SkinnedMaterialMixin(const SkinnedMaterialMixin& m);
+		SkinnedMaterialMixin& operator=(const SkinnedMaterialMixin& m);
 		void updateBones(float alphaTime, GPU* gpu, Actor* a);
 
+		// when set, draw() binds the already skinned mesh with a static shader variant instead of uploading bones
+		void setPreSkinned(Mesh* skinnedMesh, Shader* staticShader);
+		void clearPreSkinned();
+		bool isPreSkinned() const;
+
+		void prepareSkinning(float alphaTime, GPU* gpu, Actor* a);
+
 	};
-}
\ No newline at end of file
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "glm/glm.hpp"
+
+#include "vel/Actor.h"
+#include "vel/Mesh.h"
+
+namespace vel
+{
+	/*
+		Holds a per-actor copy of a skinned mesh whose vertices are skinned once per frame. Skinned materials
+		that have been pointed at one of these (see SkinnedMaterialMixin::setPreSkinned) bind this mesh along with
+		a static shader variant, so every camera / pass that draws the actor after that point pays the cost of a
+		static draw instead of re-running the skinning for each draw.
+	*/
+	class SkinnedMeshCache
+	{
+	private:
+		Actor*							actor;
+		Mesh*							skinnedMesh;
+		bool							skipUnchangedPose;
+		bool							initialized;
+		uint32_t						lastPoseVersion;
+		std::vector<glm::mat4>			boneMatrices;
+
+	public:
+		SkinnedMeshCache(Actor* actor, Mesh* skinnedMesh, bool skipUnchangedPose = true);
+
+		Actor*							getActor() const;
+		Mesh*							getSkinnedMesh() const;
+
+		void							setSkipUnchangedPose(bool b);
+		bool							getSkipUnchangedPose() const;
+
+		// returns true if the vertices of skinnedMesh were rewritten and need to be sent to the gpu
+		bool							update();
+
+	};
+}
@@ -3,11 +3,16 @@
 #include "spdlog/spdlog.h"
 
 #include "vel/AssetManager.h"
+#include "vel/AABBTree.h"
 #include "vel/Camera.h"
 #include "vel/TextActor.h"
+#include "vel/TextBatch.h"
+#include "vel/StaticBatch.h"
 #include "vel/LineActor.h"
 #include "vel/Billboard.h"
+#include "vel/ParticleEmitter.h"
 #include "vel/SkelAnimator.h"
+#include "vel/SkinnedMeshCache.h"
 
 
 namespace vel 
@@ -38,17 +43,30 @@ namespace vel
 		// FBO:SHADER:VAO:ACTORS - limits opengl state changes (not as bad as you might think the first time you see it)
 		std::map<ActCompositeKey, std::vector<std::unique_ptr<Actor>>> actors;
 
+		// world bounds of every actor, for culling and spatial queries without walking the map above
+		AABBTree										actorTree;
+		std::vector<Actor*>								refitScratch; // reused by updateActorTree()
+
 		// multiple actors can be associated with the same animator (arms, hands, gun1 for example), so lifetime managed here
 		std::vector<std::unique_ptr<SkelAnimator>>		animators;	
 
 		std::vector<std::unique_ptr<TextActor>>			textActors;
+		std::vector<std::unique_ptr<TextBatch>>			textBatches;
+		std::vector<std::unique_ptr<StaticBatch>>		staticBatches;
+		std::vector<Vertex>								textVertexScratch; // reused by updateTextActor()
+		std::vector<unsigned int>						textIndexScratch;
 		std::vector<std::unique_ptr<LineActor>>			lineActors;
 		std::vector<std::unique_ptr<Billboard>>			billboards;
+		BillboardBatchData								billboardScratch; // reused by updateBillboards()
+		std::vector<std::unique_ptr<ParticleEmitter>>	particleEmitters;
+		std::vector<std::unique_ptr<SkinnedMeshCache>>	skinnedMeshCaches;
 
 
 		std::optional<std::pair<ActCompositeKey, unsigned int>>	_getActorLocation(const std::string& name);
 		std::optional<std::pair<ActCompositeKey, unsigned int>>	_getActorLocation(const Actor* a);
 		void _removeActor(std::optional<std::pair<ActCompositeKey, unsigned int>> actorLocation);
+		void _insertActorProxy(Actor* a);
+		void _getActorWorldBounds(Actor* a, glm::vec3& minEdge, glm::vec3& maxEdge);
 
 		int									_getTextActorIndex(const std::string& name);
 		int									_getTextActorIndex(const TextActor*);
@@ -62,6 +80,10 @@ namespace vel
 		int									_getBillboardIndex(const Billboard* a);
 		void								_removeBillboard(int billboardIndex);
 
+		int									_getParticleEmitterIndex(const std::string& name);
+		int									_getParticleEmitterIndex(const ParticleEmitter* pe);
+		void								_removeParticleEmitter(int particleEmitterIndex);
+
 
 	public:
 		Stage::Stage(const std::string& name, AssetManager* assetManager, const uint32_t* logicTickPtr);
@@ -76,6 +98,7 @@ namespace vel
 		Camera*			getCamera(const std::string& name);
 		std::vector<Camera*>& getCameras();
 
+		// nullptr (and nothing added) if the mesh's vertex format isn't the one the material's shader reads
 		Actor*			addActor(const std::string& name, Mesh* mesh = nullptr, Material* material = nullptr);
 		Actor*			addActor(const Actor& actorIn);
 		void			removeActor(const std::string& name);
@@ -83,6 +106,21 @@ namespace vel
 		Actor*			getActor(const std::string& name);
 		std::map<ActCompositeKey, std::vector<std::unique_ptr<Actor>>>& getActors();
 
+		// refits the tree leaves of actors that moved (or are dynamic) since the last call. Scene::draw() calls this
+		// before culling, game code that queries mid-frame after moving actors may want to call it first
+		void			updateActorTree();
+		AABBTree&		getActorTree();
+
+		// visibility for a single camera pass, isActorMarkedVisible() is always true for actors that aren't cullable
+		uint32_t		markVisibleActors(const glm::mat4& viewProjection);
+		bool			isActorMarkedVisible(const Actor* a, uint32_t stamp) const;
+		bool			getActorBounds(const Actor* a, glm::vec3& minEdge, glm::vec3& maxEdge) const; // false if not in the tree
+
+		void			queryActors(Camera* c, std::vector<Actor*>& out); // within the camera's frustum
+		void			queryActors(const glm::vec3& center, float radius, std::vector<Actor*>& out);
+		void			queryActors(AABB& box, std::vector<Actor*>& out);
+		void			queryActorsOnRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, std::vector<Actor*>& out); // nearest first
+
 		void			addSkelAnimator(std::unique_ptr<SkelAnimator> sa);
 		void			updateAnimators(float delta);
 		void			lerpAnimators(float alpha);
@@ -94,6 +132,13 @@ namespace vel
 		void			removeTextActor(const std::string& name);
 		void			updateTextActors();
 
+		TextBatch*		addTextBatch(std::unique_ptr<TextBatch> tb);
+		TextBatch*		getTextBatch(const FontBitmap* fb, const glm::vec4& color);
+
+		StaticBatch*	addStaticBatch(std::unique_ptr<StaticBatch> sb);
+		std::vector<std::unique_ptr<StaticBatch>>& getStaticBatches();
+		void			updateStaticBatches();
+
 
 		LineActor*		addLineActor(std::unique_ptr<LineActor> la);
 		LineActor*		getLineActor(const std::string& name);
@@ -107,7 +152,18 @@ namespace vel
 		void			removeBillboard(const std::string& name);
 		void			updateBillboards();
 
+		ParticleEmitter*	addParticleEmitter(std::unique_ptr<ParticleEmitter> pe);
+		ParticleEmitter*	getParticleEmitter(const std::string& name);
+		void				removeParticleEmitter(ParticleEmitter* pe);
+		void				removeParticleEmitter(const std::string& name);
+		void				updateParticleEmitters(float dt);
+
 		void			updateTextActor(TextActor* ta);
 
+		SkinnedMeshCache*	addSkinnedMeshCache(std::unique_ptr<SkinnedMeshCache> smc);
+		SkinnedMeshCache*	getSkinnedMeshCache(const Actor* a);
+		void				removeSkinnedMeshCache(const Actor* a);
+		void				updateSkinnedMeshCaches();
+
 	};
 }
\ No newline at end of file
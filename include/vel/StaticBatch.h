@@ -0,0 +1,74 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "glm/glm.hpp"
+
+#include "vel/Actor.h"
+#include "vel/Mesh.h"
+#include "vel/Vertex.h"
+#include "vel/Texture.h"
+
+
+namespace vel
+{
+	class AssetManager;
+
+	// range of the batch mesh's indices that came from a single source actor
+	struct StaticBatchMember
+	{
+		Actor*						actor;
+		size_t						firstIndex;
+		size_t						indexCount;
+		bool						lastVisible;
+	};
+
+	// Merges the meshes of static actors that would otherwise be drawn with the same shader / material state into a
+	// single pre-transformed mesh drawn by one actor. Member textures are unioned into the batch material's texture
+	// list and each vertex's materialUBOIndex is remapped into it, so members may use different textures as long as the
+	// union fits in the texture UBO. Source actors stay in the stage (flagged with Actor::setStaticBatched()) so they can
+	// still be found and hidden, hiding one collapses its index range into degenerate triangles.
+	class StaticBatch
+	{
+	private:
+		std::string					name;
+		Actor*						actor; // owned by stage, holds the batch mesh and material
+		std::vector<StaticBatchMember>	members;
+		std::vector<Texture*>		textures;
+		VertexFormat				vertexFormat;
+
+		std::vector<Vertex>			vertices; // released once the mesh is created
+		std::vector<unsigned int>	sourceIndices; // every member visible, used to restore ranges
+
+		void						writeMember(const StaticBatchMember& m, std::vector<unsigned int>& indices, bool visible);
+
+	public:
+		StaticBatch(const std::string& name);
+
+		static const size_t			maxTextures = 250; // MAX_SUPPORTED_TEXTURES in GPU::initTextureUBO()
+
+		// static, visible to the gpu, not skinned / animated and not using an animated or line material
+		static bool					canBatch(Actor* a);
+
+		// same shader, material type, color, lightmap, ambient cube and vertex format
+		static bool					compatible(Actor* a, Actor* b);
+
+		// false when the actor's textures no longer fit in this batch
+		bool						addMember(Actor* a);
+		bool						removeMember(const Actor* a, AssetManager* am);
+
+		// dynamic mesh so that visibility changes can be uploaded as index sub ranges
+		std::unique_ptr<Mesh>		createMesh(const std::string& meshName);
+
+		const std::string&			getName() const;
+		const std::vector<Texture*>& getTextures() const;
+		const std::vector<StaticBatchMember>& getMembers() const;
+
+		void						setActor(Actor* a);
+		Actor*						getActor() const;
+
+		void						update(AssetManager* am);
+	};
+}
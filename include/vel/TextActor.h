@@ -8,6 +8,8 @@
 
 namespace vel 
 {
+	class TextBatch;
+
 	struct TextActor 
 	{
 		std::string					name;
@@ -15,6 +17,7 @@ namespace vel
 		FontBitmap*					fontBitmap;
 		PlaneOrigin					originType;
 		Actor*						actor = nullptr;
+		TextBatch*					batch = nullptr; // when set, glyphs live in the batch mesh and actor only supplies the transform
 		std::vector<glm::vec2>		caretPositions;
 		bool						requiresUpdate = false;
 		
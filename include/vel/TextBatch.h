@@ -0,0 +1,71 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "vel/FontBitmap.h"
+#include "vel/Actor.h"
+#include "vel/Mesh.h"
+#include "vel/Vertex.h"
+#include "vel/TextActor.h"
+
+
+namespace vel
+{
+	class AssetManager;
+
+	// range of glyph quads within a TextBatch's mesh that belongs to a single TextActor
+	struct TextBatchSlot
+	{
+		TextActor*					textActor;
+		size_t						firstGlyph;
+		size_t						glyphCapacity;
+		glm::mat4					lastWorldMatrix;
+		bool						lastVisible;
+	};
+
+	// Packs the glyph quads of every TextActor sharing a FontBitmap and color into one mesh drawn by a single actor
+	// (and so a single draw call). Glyphs are written pre-transformed by each TextActor's world matrix, and only the
+	// slots of labels whose text, transform or visibility changed are rewritten and re-uploaded each frame. Labels are
+	// not interpolated with the render lerp, which is fine for the hud / overlay text this is meant for.
+	class TextBatch
+	{
+	private:
+		std::string					name;
+		FontBitmap*					fontBitmap;
+		glm::vec4					color;
+		Actor*						actor; // owned by stage, holds the batch mesh and material
+		std::vector<TextBatchSlot>	slots;
+		size_t						glyphCapacity;
+		bool						requiresRelayout;
+
+		std::vector<Vertex>			glyphVertices; // scratch for a single label
+		std::vector<unsigned int>	glyphIndices;
+
+		size_t						buildSlotGlyphs(TextBatchSlot& slot, AssetManager* am);
+		void						writeSlot(TextBatchSlot& slot, std::vector<Vertex>& vertices);
+		void						relayout(AssetManager* am);
+
+	public:
+		TextBatch(const std::string& name, FontBitmap* fb, glm::vec4 color);
+
+		static const size_t			initialGlyphCapacity = 64;
+
+		// mesh with room for initialGlyphCapacity glyphs, all degenerate
+		static std::unique_ptr<Mesh> createMesh(const std::string& name);
+
+		const std::string&			getName() const;
+		FontBitmap*					getFontBitmap() const;
+		const glm::vec4&			getColor() const;
+
+		void						setActor(Actor* a);
+		Actor*						getActor() const;
+
+		void						addTextActor(TextActor* ta);
+		void						removeTextActor(const TextActor* ta);
+
+		void						update(AssetManager* am);
+	};
+}
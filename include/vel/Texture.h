@@ -13,13 +13,16 @@ namespace vel
 		TXT_OPT_HAS_ALPHA = 1 << 0, // 0001
 		TXT_OPT_CLAMP_UVS = 1 << 1, // 0010
 		TXT_OPT_CPU_AND_GPU = 1 << 2, // 0100
-		TXT_OPT_DISABLE_FILTER = 1 << 3 // 1000
+		TXT_OPT_DISABLE_FILTER = 1 << 3, // 1000
+		TXT_OPT_ARRAY = 1 << 4, // 10000, upload all frames into a single GL_TEXTURE_2D_ARRAY, frame index = layer
+		TXT_OPT_COMPRESS = 1 << 5, // 100000, load through a block compressed cache cooked next to the source, see TextureCache.h
+		TXT_OPT_NORMAL_MAP = 1 << 6 // 1000000, with TXT_OPT_COMPRESS, keep only red and green (bc5)
 	};
 
 	struct Texture
 	{
 		std::string					name;
-		std::vector<TextureData>	frames;
+		std::vector<TextureData>	frames; // when TXT_OPT_ARRAY is set every frame shares the same id / dsaHandle
 		int							options;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+
+#include "vel/MappedFile.h"
+
+
+namespace vel
+{
+	/*
+		Cooked texture layout (native endianness, every level 16 byte aligned):
+
+		TextureCacheHeader
+		TextureCacheLevel[levelCount]	- full mip chain, largest first, down to 1x1
+		block data for every level
+
+		Any change to this layout, or to the encoders, requires bumping TEXTURE_CACHE_VERSION so that existing caches
+		are re-cooked.
+	*/
+	static const uint32_t TEXTURE_CACHE_VERSION = 1;
+
+	// 4x4 block formats, bc1 = rgb 4bpp, bc3 = rgba 8bpp, bc4 = r 4bpp, bc5 = rg 8bpp
+	enum class BlockFormat : uint32_t
+	{
+		BC1 = 1,
+		BC3 = 3,
+		BC4 = 4,
+		BC5 = 5
+	};
+
+	struct TextureCacheHeader
+	{
+		char			magic[8];
+		uint32_t		version;
+		uint32_t		format;
+		uint32_t		width;
+		uint32_t		height;
+		uint32_t		levelCount;
+		uint32_t		hasAlpha;
+		uint32_t		sourceComponents;
+		uint32_t		reserved;
+	};
+
+	struct TextureCacheLevel
+	{
+		uint64_t		offset;
+		uint64_t		size;
+		uint32_t		width;
+		uint32_t		height;
+	};
+
+	// a mapped cache file, level data is uploaded straight out of the mapping
+	struct CompressedImage
+	{
+		MappedFile					file;
+		BlockFormat					format;
+		bool						hasAlpha;
+		int							sourceComponents;
+		std::vector<TextureCacheLevel> levels;
+
+		const unsigned char*		getLevelData(size_t level) const;
+	};
+
+	/*
+		Block compressed textures cooked next to their source image (<source>.veltex), the same way MeshPackLoader
+		cooks meshes: the cache is (re)built from the source when it is missing or older, and shipping only the cache
+		is allowed. Cooking decodes the source with stb_image, box filters the mip chain and encodes every level with
+		range fit bc1 / bc3 / bc4 / bc5 encoders. Textures only ever read through here have no cpu side pixels.
+	*/
+	class TextureCache
+	{
+	private:
+		static bool						isCurrent(const std::string& sourcePath, const std::string& cachePath);
+
+	public:
+		static std::string				getCachePath(const std::string& sourcePath);
+
+		// bc4 for single channel images, bc5 for normal maps (red and green only, blue samples as 0, so shaders
+		// sampling a normal map must rebuild z themselves: xy = rg * 2 - 1, z = sqrt(1 - dot(xy, xy))), bc3 when there
+		// is an alpha channel (grey + alpha images included), otherwise bc1
+		static BlockFormat				chooseFormat(int components, bool normalMap);
+
+		static bool						cook(const std::string& sourcePath, const std::string& cachePath, bool normalMap);
+
+		// cooks first if required, nullptr if there is neither a usable cache nor a decodable source
+		static std::shared_ptr<CompressedImage> load(const std::string& sourcePath, bool normalMap);
+
+		// rgba8 in, one block out, pixels outside the image are clamped to its edge by the caller
+		static void						encodeBC1Block(const unsigned char* rgba, unsigned char* out);
+		static void						encodeBC3Block(const unsigned char* rgba, unsigned char* out);
+		static void						encodeBC4Block(const unsigned char* rgba, int channel, unsigned char* out);
+		static void						encodeBC5Block(const unsigned char* rgba, unsigned char* out);
+	};
+}
@@ -1,16 +1,20 @@
 #pragma once
 
+#include <memory>
 
 #include "vel/ImageData.h"
 
 
 namespace vel
 {
+	struct CompressedImage;
+
 	struct TextureData
 	{
 		unsigned int				id; // opengl buffer object id 
 		uint64_t					dsaHandle;
 		ImageData					primaryImageData;
 		bool						alphaChannel;
+		std::shared_ptr<CompressedImage> compressed; // set instead of primaryImageData.data when loaded from a TextureCache
 	};
 }
\ No newline at end of file
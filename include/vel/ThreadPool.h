@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <type_traits>
+
+
+namespace vel
+{
+	class ThreadPool
+	{
+	private:
+		std::vector<std::thread>				workers;
+		std::deque<std::function<void()>>		tasks;
+		std::mutex								tasksMutex;
+		std::condition_variable					tasksCondition;
+		bool									stopping;
+
+		void									workerLoop();
+		void									enqueue(std::function<void()> task);
+
+	public:
+		// threadCount of 0 uses one less than the number of hardware threads (minimum of 1), leaving a core for the main thread
+		ThreadPool(unsigned int threadCount = 0);
+		~ThreadPool();
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		unsigned int							getThreadCount() const;
+
+		template<typename F>
+		std::future<std::invoke_result_t<F>>	submit(F&& f)
+		{
+			using R = std::invoke_result_t<F>;
+
+			// std::function requires copyable callables, so the packaged_task lives behind a shared_ptr
+			auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(f));
+			std::future<R> result = task->get_future();
+
+			this->enqueue([task]() { (*task)(); });
+
+			return result;
+		}
+
+		// Splits [0, count) into chunks of grainSize and runs fn(begin, end) for each across the pool, blocking until every
+		// chunk has completed. The calling thread works through chunks as well, so this is safe to call from a worker.
+		void									parallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& fn);
+	};
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <cstddef>
+
+#include "btBulletCollisionCommon.h"
+#include "BulletCollision/CollisionDispatch/btGhostObject.h"
+
+
+namespace vel
+{
+	class Actor;
+
+	enum class TriggerEventType
+	{
+		ENTER,
+		EXIT
+	};
+
+	// like ContactEvent, object may already have been removed from the world (and deleted) by the time an EXIT is read
+	struct TriggerEvent
+	{
+		TriggerEventType			type;
+		const btCollisionObject*	trigger;
+		const btCollisionObject*	object;
+		Actor*						triggerActor;
+		Actor*						actor;
+	};
+
+	struct TriggerOverlap
+	{
+		const btCollisionObject*	object;
+		Actor*						actor; // resolved when the pair was added, while the object was certainly alive
+	};
+
+	struct TriggerVolume
+	{
+		btCollisionObject*			object;
+		Actor*						actor;
+		std::vector<TriggerOverlap>	overlaps;	// sorted by object, the broadphase's pairs, kept current by the pair callbacks
+		std::vector<TriggerOverlap>	reported;	// sorted by object, overlaps whose bounds overlapped as of the last update()
+		bool						dirty;		// overlaps changed since the last update()
+	};
+
+	/*
+		Enter / exit tracking for trigger volumes (see CollisionWorld::addTrigger). Installed as the broadphase pair
+		cache's internal ghost pair callback (forwarding to btGhostPairCallback so btGhostObjects keep working), it is
+		told about every pair the broadphase adds or removes and only does work for pairs with a trigger in them. Each
+		trigger keeps its pairs in a flat sorted array. Overlaps are of the objects' bounds: since btDbvtBroadphase only
+		drops separated pairs a few at a time, update() tests the bounds of every pair a trigger holds itself and diffs
+		the ones still overlapping against what was last reported. A step costs one bounds test per object inside a
+		trigger (empty triggers cost nothing), exits are reported the step the bounds separate on any broadphase and an
+		object leaving and re-entering within one step reports nothing.
+	*/
+	class TriggerSystem : public btOverlappingPairCallback
+	{
+	private:
+		btGhostPairCallback									ghostPairCallback;
+		std::unordered_map<const btCollisionObject*, TriggerVolume> triggers; // node based, so pointers stay valid
+		std::vector<TriggerVolume*>							volumes; // in the order added, which update() reports them in
+		std::vector<TriggerOverlap>							overlapScratch;
+		std::vector<TriggerEvent>							events;
+
+		TriggerVolume*										findTrigger(const btBroadphaseProxy* proxy);
+		void												addOverlap(TriggerVolume* trigger, const btCollisionObject* object);
+		void												removeOverlap(TriggerVolume* trigger, const btCollisionObject* object);
+
+	public:
+		btBroadphasePair*									addOverlappingPair(btBroadphaseProxy* proxy0, btBroadphaseProxy* proxy1);
+		void*												removeOverlappingPair(btBroadphaseProxy* proxy0, btBroadphaseProxy* proxy1, btDispatcher* dispatcher);
+		void												removeOverlappingPairsContainingProxy(btBroadphaseProxy* proxy0, btDispatcher* dispatcher);
+
+		// trigger must have CF_NO_CONTACT_RESPONSE set, which is what keeps the pair callbacks cheap for everything else
+		void												addTrigger(btCollisionObject* trigger, Actor* actor);
+
+		// reports an EXIT for everything last reported as inside, call after removing trigger from the world
+		void												removeTrigger(const btCollisionObject* trigger);
+
+		bool												isTrigger(const btCollisionObject* co) const;
+
+		// sorted by object, as of the last update(), nullptr if co isn't a trigger
+		const std::vector<TriggerOverlap>*					getOverlaps(const btCollisionObject* co) const;
+
+		// called by CollisionWorld at the end of every stepSimulation()
+		void												update();
+
+		size_t												size() const;
+		void												clear();
+
+		// calls fn(const TriggerEvent&) for every pending event, oldest first, and empties the list
+		template<typename F>
+		void												consume(F&& fn)
+		{
+			// index based, fn may remove triggers / objects which appends more events
+			for (size_t i = 0; i < this->events.size(); i++)
+			{
+				TriggerEvent e = this->events[i];
+				fn(static_cast<const TriggerEvent&>(e));
+			}
+
+			this->events.clear();
+		}
+	};
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#include "btBulletCollisionCommon.h"
+
+
+namespace vel
+{
+	struct UniformGridProxy : public btBroadphaseProxy
+	{
+		int			liveIndex; // position within UniformGridBroadphase::live, -1 while on the free list
+
+		UniformGridProxy() : liveIndex(-1) {}
+	};
+
+	// a proxy's bounds and cell range, gathered contiguously every calculateOverlappingPairs
+	struct UniformGridItem
+	{
+		btVector3			aabbMin;
+		btVector3			aabbMax;
+		int					cellMin[3];
+		int					cellMax[3];
+		UniformGridProxy*	proxy;
+	};
+
+	struct UniformGridEntry
+	{
+		int			cell[3];
+		int			item;
+	};
+
+	/*
+		Broadphase for many small, evenly sized objects (uniform crowds, debris, projectiles), where dbvt spends most
+		of its time refitting and sweep and prune keeps resorting. Nothing persists between frames except the pairs:
+		every calculateOverlappingPairs bins all proxies into a hashed grid of cellSize cells with a counting sort (flat
+		arrays, no per cell allocation), tests proxies sharing a cell, and reports each overlapping pair only from the
+		cell holding the minimum corner of their intersection so that pairs spanning several cells aren't repeated.
+		Proxies covering more than maxCellsPerProxy cells (level geometry, large triggers) are kept out of the grid and
+		tested against everything instead. Ray and aabb queries scan the proxies linearly, they hold no state and may
+		be run from several threads at once.
+	*/
+	class UniformGridBroadphase : public btBroadphaseInterface
+	{
+	private:
+		btScalar									cellSize;
+		btScalar									inverseCellSize;
+		int											maxCellsPerProxy;
+		btOverlappingPairCache*						pairCache;
+
+		std::vector<std::unique_ptr<UniformGridProxy>> proxies; // stable storage, freed proxies are reused
+		std::vector<int>							freeProxies;
+		std::vector<UniformGridProxy*>				live;
+
+		std::vector<UniformGridItem>				items;
+		std::vector<int>							largeItems;
+		std::vector<uint32_t>						bucketStarts;
+		std::vector<UniformGridEntry>				entries;
+
+		int											cellCoordinate(btScalar v) const;
+		uint32_t									cellHash(int x, int y, int z, uint32_t mask) const;
+		void										addPair(const UniformGridItem& a, const UniformGridItem& b);
+
+	public:
+		UniformGridBroadphase(btScalar cellSize = 2.0f, int maxCellsPerProxy = 64);
+		~UniformGridBroadphase();
+		UniformGridBroadphase(const UniformGridBroadphase&) = delete;
+		UniformGridBroadphase& operator=(const UniformGridBroadphase&) = delete;
+
+		btBroadphaseProxy*							createProxy(const btVector3& aabbMin, const btVector3& aabbMax, int shapeType, void* userPtr, int collisionFilterGroup, int collisionFilterMask, btDispatcher* dispatcher);
+		void										destroyProxy(btBroadphaseProxy* proxy, btDispatcher* dispatcher);
+		void										setAabb(btBroadphaseProxy* proxy, const btVector3& aabbMin, const btVector3& aabbMax, btDispatcher* dispatcher);
+		void										getAabb(btBroadphaseProxy* proxy, btVector3& aabbMin, btVector3& aabbMax) const;
+
+		void										rayTest(const btVector3& rayFrom, const btVector3& rayTo, btBroadphaseRayCallback& rayCallback, const btVector3& aabbMin = btVector3(0, 0, 0), const btVector3& aabbMax = btVector3(0, 0, 0));
+		void										aabbTest(const btVector3& aabbMin, const btVector3& aabbMax, btBroadphaseAabbCallback& callback);
+
+		void										calculateOverlappingPairs(btDispatcher* dispatcher);
+
+		btOverlappingPairCache*						getOverlappingPairCache();
+		const btOverlappingPairCache*				getOverlappingPairCache() const;
+
+		void										getBroadphaseAabb(btVector3& aabbMin, btVector3& aabbMax) const;
+		void										printStats();
+
+		btScalar									getCellSize() const;
+	};
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+#include "glm/glm.hpp"
+
+#include "vel/Vertex.h"
+
+
+namespace vel
+{
+	/*
+		Layout a Mesh's vertices take once they are sent to the gpu. The cpu side copy of a mesh is always a
+		std::vector<Vertex>, the format only decides how GPU::loadMesh packs it and configures the VAO.
+
+		FULL				- Vertex as is (~120 bytes)
+		STATIC_COMPACT		- float position, octahedral snorm16x2 normal, half float uvs, material index (28 bytes)
+		SKINNED_COMPACT		- STATIC_COMPACT + 4 uint8 bone ids and 4 unorm8 weights, keeping the 4 heaviest
+							  influences of each vertex and renormalizing them (36 bytes)
+
+		Shaders drawing compact meshes must be built with the defines returned by getVertexFormatShaderDefs():
+		OCT_NORMALS			- location 1 is a vec2 holding the octahedral encoded normal
+		FOUR_BONE_WEIGHTS	- only locations 5 (ivec4 ids) and 7 (vec4 weights) are populated, 6 and 8 are not
+	*/
+	enum class VertexFormat
+	{
+		FULL,
+		STATIC_COMPACT,
+		SKINNED_COMPACT
+	};
+
+	struct CompactStaticVertex
+	{
+		glm::vec3		position;
+		uint32_t		normal;					// packSnorm2x16(octahedral encoded normal)
+		uint32_t		textureCoordinates;		// packHalf2x16
+		uint32_t		lightmapCoordinates;	// packHalf2x16
+		uint32_t		materialUBOIndex;
+	};
+
+	struct CompactSkinnedVertex
+	{
+		glm::vec3		position;
+		uint32_t		normal;
+		uint32_t		textureCoordinates;
+		uint32_t		lightmapCoordinates;
+		uint32_t		materialUBOIndex;
+		uint8_t			boneIds[4];
+		uint8_t			boneWeights[4];			// unorm8, sums to 255
+	};
+
+	size_t						getVertexFormatStride(VertexFormat format);
+	std::vector<std::string>	getVertexFormatShaderDefs(VertexFormat format);
+
+	// picks the compact layout matching the mesh's contents, or FULL if the mesh can not be represented by it
+	// (more than 256 bones can not be addressed by uint8 ids)
+	VertexFormat				resolveVertexFormat(VertexFormat requested, bool hasBones, size_t boneCount);
+
+	glm::vec2					octEncodeNormal(const glm::vec3& n);
+	glm::vec3					octDecodeNormal(const glm::vec2& e);
+
+	// writes the 4 heaviest influences of bd into ids/weights with weights renormalized to sum to 255
+	void						packTopFourBoneWeights(const VertexBoneData& bd, uint8_t ids[4], uint8_t weights[4]);
+
+	// packs count vertices starting at first into out (resized to count * stride) using the given format
+	void						packVertices(const std::vector<Vertex>& vertices, VertexFormat format, size_t first, size_t count,
+									std::vector<unsigned char>& out);
+}
@@ -31,6 +31,7 @@ namespace vel
 	glm::mat4 bulletTransformToGlmMat4(btTransform t);
 	btMatrix3x3 glmMat3ToBulletMat3(const glm::mat3& m);
 	btTransform glmMat4ToBulletTransform(const glm::mat4& m);
+	btTransform glmMat4ToBulletRigidTransform(const glm::mat4& m, glm::vec3& outScale);
 	bool isPowerOfTwo(int n);
 	float lerpf(float a, float b, float f);
 	bool randomFiftyFifty();
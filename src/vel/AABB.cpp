@@ -3,11 +3,19 @@
 namespace vel
 {
 	AABB::AABB(glm::vec3 min, glm::vec3 max) :
-		firstPass(true),
+		firstPass(false),
 		minEdge(min),
 		maxEdge(max)
 	{
-
+		// calculate all eight corner vectors
+		this->corners.push_back(maxEdge);
+		this->corners.push_back(minEdge);
+		this->corners.push_back(glm::vec3(minEdge.x, maxEdge.y, maxEdge.z));
+		this->corners.push_back(glm::vec3(minEdge.x, minEdge.y, maxEdge.z));
+		this->corners.push_back(glm::vec3(maxEdge.x, minEdge.y, maxEdge.z));
+		this->corners.push_back(glm::vec3(maxEdge.x, maxEdge.y, minEdge.z));
+		this->corners.push_back(glm::vec3(minEdge.x, maxEdge.y, minEdge.z));
+		this->corners.push_back(glm::vec3(maxEdge.x, minEdge.y, minEdge.z));
 	}
 
 	AABB::AABB(const std::vector<glm::vec3>& inputVectors) :
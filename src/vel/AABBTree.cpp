@@ -0,0 +1,617 @@
+#include <algorithm>
+#include <cmath>
+
+#include "vel/AABBTree.h"
+
+
+namespace vel
+{
+	static float surfaceArea(const glm::vec3& minEdge, const glm::vec3& maxEdge)
+	{
+		glm::vec3 d = maxEdge - minEdge;
+		return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+	}
+
+	static bool overlaps(const glm::vec3& aMin, const glm::vec3& aMax, const glm::vec3& bMin, const glm::vec3& bMax)
+	{
+		return aMin.x <= bMax.x && aMax.x >= bMin.x &&
+			aMin.y <= bMax.y && aMax.y >= bMin.y &&
+			aMin.z <= bMax.z && aMax.z >= bMin.z;
+	}
+
+	static bool overlapsSphere(const glm::vec3& minEdge, const glm::vec3& maxEdge, const glm::vec3& center, float radiusSq)
+	{
+		glm::vec3 closest = glm::clamp(center, minEdge, maxEdge);
+		glm::vec3 d = closest - center;
+		return glm::dot(d, d) <= radiusSq;
+	}
+
+	// slab test, entry distance written to tEnter
+	static bool intersectsRay(const glm::vec3& minEdge, const glm::vec3& maxEdge, const glm::vec3& origin, const glm::vec3& invDir, float maxDistance, float& tEnter)
+	{
+		glm::vec3 t1 = (minEdge - origin) * invDir;
+		glm::vec3 t2 = (maxEdge - origin) * invDir;
+		glm::vec3 tMin = glm::min(t1, t2);
+		glm::vec3 tMax = glm::max(t1, t2);
+
+		float enter = std::max(std::max(tMin.x, tMin.y), std::max(tMin.z, 0.0f));
+		float exit = std::min(std::min(tMax.x, tMax.y), std::min(tMax.z, maxDistance));
+
+		tEnter = enter;
+		return enter <= exit;
+	}
+
+	// planes point inward, box is outside when its most positive corner is behind any of them
+	static void extractFrustumPlanes(const glm::mat4& m, glm::vec4 planes[6])
+	{
+		glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+		glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+		glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+		glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+		planes[0] = row3 + row0;
+		planes[1] = row3 - row0;
+		planes[2] = row3 + row1;
+		planes[3] = row3 - row1;
+		planes[4] = row3 + row2;
+		planes[5] = row3 - row2;
+	}
+
+	// returns -1 when outside, otherwise the subset of mask whose planes still cut the box (0 = fully inside)
+	static int classifyFrustum(const glm::vec3& minEdge, const glm::vec3& maxEdge, const glm::vec4 planes[6], int mask)
+	{
+		int remaining = 0;
+
+		for (int p = 0; p < 6; p++)
+		{
+			if (!(mask & (1 << p)))
+				continue;
+
+			const glm::vec3 n(planes[p]);
+			const glm::vec3 positive(n.x >= 0.0f ? maxEdge.x : minEdge.x, n.y >= 0.0f ? maxEdge.y : minEdge.y, n.z >= 0.0f ? maxEdge.z : minEdge.z);
+			const glm::vec3 negative(n.x >= 0.0f ? minEdge.x : maxEdge.x, n.y >= 0.0f ? minEdge.y : maxEdge.y, n.z >= 0.0f ? minEdge.z : maxEdge.z);
+
+			if (glm::dot(n, positive) + planes[p].w < 0.0f)
+				return -1;
+
+			if (glm::dot(n, negative) + planes[p].w < 0.0f)
+				remaining |= (1 << p);
+		}
+
+		return remaining;
+	}
+
+	AABBTree::AABBTree(float margin) :
+		root(-1),
+		freeList(-1),
+		leafCount(0),
+		margin(margin),
+		currentStamp(0)
+	{}
+
+	int AABBTree::allocateNode()
+	{
+		if (this->freeList == -1)
+		{
+			AABBTreeNode n;
+			n.parent = -1;
+			this->nodes.push_back(n);
+			this->freeList = (int)this->nodes.size() - 1;
+		}
+
+		int node = this->freeList;
+		AABBTreeNode& n = this->nodes[node];
+		this->freeList = n.parent;
+
+		n.minEdge = glm::vec3(0.0f);
+		n.maxEdge = glm::vec3(0.0f);
+		n.tightMin = glm::vec3(0.0f);
+		n.tightMax = glm::vec3(0.0f);
+		n.parent = -1;
+		n.child1 = -1;
+		n.child2 = -1;
+		n.height = 0;
+		n.actor = nullptr;
+		n.stamp = 0;
+
+		return node;
+	}
+
+	void AABBTree::freeNode(int node)
+	{
+		this->nodes[node].parent = this->freeList;
+		this->nodes[node].height = -1;
+		this->nodes[node].actor = nullptr;
+		this->freeList = node;
+	}
+
+	void AABBTree::insertLeaf(int leaf)
+	{
+		if (this->root == -1)
+		{
+			this->root = leaf;
+			this->nodes[leaf].parent = -1;
+			return;
+		}
+
+		const glm::vec3 leafMin = this->nodes[leaf].minEdge;
+		const glm::vec3 leafMax = this->nodes[leaf].maxEdge;
+
+		// descend toward the sibling that minimizes the added surface area
+		int index = this->root;
+		while (!this->nodes[index].isLeaf())
+		{
+			const AABBTreeNode& n = this->nodes[index];
+
+			const float area = surfaceArea(n.minEdge, n.maxEdge);
+			const float combinedArea = surfaceArea(glm::min(n.minEdge, leafMin), glm::max(n.maxEdge, leafMax));
+
+			const float cost = 2.0f * combinedArea;
+			const float inheritanceCost = 2.0f * (combinedArea - area);
+
+			auto childCost = [&](int c) {
+				const AABBTreeNode& cn = this->nodes[c];
+				float a = surfaceArea(glm::min(cn.minEdge, leafMin), glm::max(cn.maxEdge, leafMax));
+				if (!cn.isLeaf())
+					a -= surfaceArea(cn.minEdge, cn.maxEdge);
+				return a + inheritanceCost;
+			};
+
+			const float cost1 = childCost(n.child1);
+			const float cost2 = childCost(n.child2);
+
+			if (cost < cost1 && cost < cost2)
+				break;
+
+			index = cost1 < cost2 ? n.child1 : n.child2;
+		}
+
+		const int sibling = index;
+		const int oldParent = this->nodes[sibling].parent;
+		const int newParent = this->allocateNode(); // may reallocate, no node references held across this
+
+		this->nodes[newParent].parent = oldParent;
+		this->nodes[newParent].minEdge = glm::min(leafMin, this->nodes[sibling].minEdge);
+		this->nodes[newParent].maxEdge = glm::max(leafMax, this->nodes[sibling].maxEdge);
+		this->nodes[newParent].height = this->nodes[sibling].height + 1;
+		this->nodes[newParent].child1 = sibling;
+		this->nodes[newParent].child2 = leaf;
+		this->nodes[sibling].parent = newParent;
+		this->nodes[leaf].parent = newParent;
+
+		if (oldParent != -1)
+		{
+			if (this->nodes[oldParent].child1 == sibling)
+				this->nodes[oldParent].child1 = newParent;
+			else
+				this->nodes[oldParent].child2 = newParent;
+		}
+		else
+		{
+			this->root = newParent;
+		}
+
+		// walk back up refitting bounds and heights
+		index = this->nodes[leaf].parent;
+		while (index != -1)
+		{
+			index = this->balance(index);
+
+			AABBTreeNode& n = this->nodes[index];
+			const AABBTreeNode& c1 = this->nodes[n.child1];
+			const AABBTreeNode& c2 = this->nodes[n.child2];
+
+			n.height = 1 + std::max(c1.height, c2.height);
+			n.minEdge = glm::min(c1.minEdge, c2.minEdge);
+			n.maxEdge = glm::max(c1.maxEdge, c2.maxEdge);
+
+			index = n.parent;
+		}
+	}
+
+	void AABBTree::removeLeaf(int leaf)
+	{
+		if (leaf == this->root)
+		{
+			this->root = -1;
+			return;
+		}
+
+		const int parent = this->nodes[leaf].parent;
+		const int grandParent = this->nodes[parent].parent;
+		const int sibling = this->nodes[parent].child1 == leaf ? this->nodes[parent].child2 : this->nodes[parent].child1;
+
+		if (grandParent == -1)
+		{
+			this->root = sibling;
+			this->nodes[sibling].parent = -1;
+			this->freeNode(parent);
+			return;
+		}
+
+		if (this->nodes[grandParent].child1 == parent)
+			this->nodes[grandParent].child1 = sibling;
+		else
+			this->nodes[grandParent].child2 = sibling;
+
+		this->nodes[sibling].parent = grandParent;
+		this->freeNode(parent);
+
+		int index = grandParent;
+		while (index != -1)
+		{
+			index = this->balance(index);
+
+			AABBTreeNode& n = this->nodes[index];
+			const AABBTreeNode& c1 = this->nodes[n.child1];
+			const AABBTreeNode& c2 = this->nodes[n.child2];
+
+			n.minEdge = glm::min(c1.minEdge, c2.minEdge);
+			n.maxEdge = glm::max(c1.maxEdge, c2.maxEdge);
+			n.height = 1 + std::max(c1.height, c2.height);
+
+			index = n.parent;
+		}
+	}
+
+	// rotates a's taller grandchild up when its children's heights differ by more than one, returns the subtree's new root
+	int AABBTree::balance(int iA)
+	{
+		AABBTreeNode* A = &this->nodes[iA];
+		if (A->isLeaf() || A->height < 2)
+			return iA;
+
+		const int iB = A->child1;
+		const int iC = A->child2;
+		AABBTreeNode* B = &this->nodes[iB];
+		AABBTreeNode* C = &this->nodes[iC];
+
+		const int heightDelta = C->height - B->height;
+
+		auto rotate = [&](int iUp, AABBTreeNode* up, int iOther, AABBTreeNode* other, bool upIsChild2) -> int {
+			const int iF = up->child1;
+			const int iG = up->child2;
+			AABBTreeNode* F = &this->nodes[iF];
+			AABBTreeNode* G = &this->nodes[iG];
+
+			// swap A and up
+			up->child1 = iA;
+			up->parent = A->parent;
+			A->parent = iUp;
+
+			if (up->parent != -1)
+			{
+				if (this->nodes[up->parent].child1 == iA)
+					this->nodes[up->parent].child1 = iUp;
+				else
+					this->nodes[up->parent].child2 = iUp;
+			}
+			else
+			{
+				this->root = iUp;
+			}
+
+			// the taller of up's children stays with up, the other takes up's old place under A
+			int iKeep = iF, iMove = iG;
+			AABBTreeNode* keep = F;
+			AABBTreeNode* move = G;
+			if (F->height <= G->height)
+			{
+				iKeep = iG; keep = G;
+				iMove = iF; move = F;
+			}
+
+			up->child2 = iKeep;
+			if (upIsChild2)
+				A->child2 = iMove;
+			else
+				A->child1 = iMove;
+			move->parent = iA;
+
+			A->minEdge = glm::min(other->minEdge, move->minEdge);
+			A->maxEdge = glm::max(other->maxEdge, move->maxEdge);
+			up->minEdge = glm::min(A->minEdge, keep->minEdge);
+			up->maxEdge = glm::max(A->maxEdge, keep->maxEdge);
+
+			A->height = 1 + std::max(other->height, move->height);
+			up->height = 1 + std::max(A->height, keep->height);
+
+			return iUp;
+		};
+
+		if (heightDelta > 1)
+			return rotate(iC, C, iB, B, true);
+
+		if (heightDelta < -1)
+			return rotate(iB, B, iC, C, false);
+
+		return iA;
+	}
+
+	int AABBTree::insert(Actor* a, const glm::vec3& minEdge, const glm::vec3& maxEdge)
+	{
+		const int proxy = this->allocateNode();
+		AABBTreeNode& n = this->nodes[proxy];
+
+		n.tightMin = minEdge;
+		n.tightMax = maxEdge;
+		n.minEdge = minEdge - glm::vec3(this->margin);
+		n.maxEdge = maxEdge + glm::vec3(this->margin);
+		n.actor = a;
+		n.height = 0;
+
+		this->insertLeaf(proxy);
+		this->leafCount++;
+
+		return proxy;
+	}
+
+	void AABBTree::remove(int proxy)
+	{
+		if (proxy < 0 || proxy >= (int)this->nodes.size() || !this->nodes[proxy].isLeaf() || this->nodes[proxy].height != 0)
+			return;
+
+		this->removeLeaf(proxy);
+		this->freeNode(proxy);
+		this->leafCount--;
+	}
+
+	bool AABBTree::move(int proxy, const glm::vec3& minEdge, const glm::vec3& maxEdge)
+	{
+		AABBTreeNode& n = this->nodes[proxy];
+
+		n.tightMin = minEdge;
+		n.tightMax = maxEdge;
+
+		if (glm::all(glm::greaterThanEqual(minEdge, n.minEdge)) && glm::all(glm::lessThanEqual(maxEdge, n.maxEdge)))
+			return false;
+
+		this->removeLeaf(proxy);
+
+		AABBTreeNode& moved = this->nodes[proxy];
+		moved.minEdge = minEdge - glm::vec3(this->margin);
+		moved.maxEdge = maxEdge + glm::vec3(this->margin);
+
+		this->insertLeaf(proxy);
+
+		return true;
+	}
+
+	Actor* AABBTree::getActor(int proxy) const
+	{
+		return this->nodes[proxy].actor;
+	}
+
+	void AABBTree::getBounds(int proxy, glm::vec3& minEdge, glm::vec3& maxEdge) const
+	{
+		minEdge = this->nodes[proxy].tightMin;
+		maxEdge = this->nodes[proxy].tightMax;
+	}
+
+	size_t AABBTree::size() const
+	{
+		return this->leafCount;
+	}
+
+	int AABBTree::getHeight() const
+	{
+		return this->root == -1 ? 0 : this->nodes[this->root].height;
+	}
+
+	void AABBTree::clear()
+	{
+		this->nodes.clear();
+		this->root = -1;
+		this->freeList = -1;
+		this->leafCount = 0;
+	}
+
+	void AABBTree::queryBox(const glm::vec3& minEdge, const glm::vec3& maxEdge, std::vector<Actor*>& out)
+	{
+		if (this->root == -1)
+			return;
+
+		this->stack.clear();
+		this->stack.push_back(this->root);
+
+		while (!this->stack.empty())
+		{
+			const AABBTreeNode& n = this->nodes[this->stack.back()];
+			this->stack.pop_back();
+
+			if (!overlaps(n.minEdge, n.maxEdge, minEdge, maxEdge))
+				continue;
+
+			if (n.isLeaf())
+			{
+				if (overlaps(n.tightMin, n.tightMax, minEdge, maxEdge))
+					out.push_back(n.actor);
+
+				continue;
+			}
+
+			this->stack.push_back(n.child1);
+			this->stack.push_back(n.child2);
+		}
+	}
+
+	void AABBTree::queryBox(AABB& box, std::vector<Actor*>& out)
+	{
+		this->queryBox(box.getMinEdge(), box.getMaxEdge(), out);
+	}
+
+	void AABBTree::querySphere(const glm::vec3& center, float radius, std::vector<Actor*>& out)
+	{
+		if (this->root == -1)
+			return;
+
+		const float radiusSq = radius * radius;
+
+		this->stack.clear();
+		this->stack.push_back(this->root);
+
+		while (!this->stack.empty())
+		{
+			const AABBTreeNode& n = this->nodes[this->stack.back()];
+			this->stack.pop_back();
+
+			if (!overlapsSphere(n.minEdge, n.maxEdge, center, radiusSq))
+				continue;
+
+			if (n.isLeaf())
+			{
+				if (overlapsSphere(n.tightMin, n.tightMax, center, radiusSq))
+					out.push_back(n.actor);
+
+				continue;
+			}
+
+			this->stack.push_back(n.child1);
+			this->stack.push_back(n.child2);
+		}
+	}
+
+	void AABBTree::queryFrustum(const glm::mat4& viewProjection, std::vector<Actor*>& out)
+	{
+		if (this->root == -1)
+			return;
+
+		glm::vec4 planes[6];
+		extractFrustumPlanes(viewProjection, planes);
+
+		// node index and the planes that still need testing packed together, subtrees fully inside skip all tests
+		this->stack.clear();
+		this->stack.push_back((this->root << 6) | 0x3F);
+
+		while (!this->stack.empty())
+		{
+			const int entry = this->stack.back();
+			this->stack.pop_back();
+
+			const AABBTreeNode& n = this->nodes[entry >> 6];
+			int mask = entry & 0x3F;
+
+			if (mask != 0)
+			{
+				mask = classifyFrustum(n.isLeaf() ? n.tightMin : n.minEdge, n.isLeaf() ? n.tightMax : n.maxEdge, planes, mask);
+				if (mask == -1)
+					continue;
+			}
+
+			if (n.isLeaf())
+			{
+				out.push_back(n.actor);
+				continue;
+			}
+
+			this->stack.push_back((n.child1 << 6) | mask);
+			this->stack.push_back((n.child2 << 6) | mask);
+		}
+	}
+
+	void AABBTree::queryRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, std::vector<Actor*>& out)
+	{
+		if (this->root == -1)
+			return;
+
+		// nudge zero components so axis aligned rays never produce 0 * inf in the slab test
+		glm::vec3 dir = direction;
+		for (int i = 0; i < 3; i++)
+			if (std::abs(dir[i]) < 1e-12f)
+				dir[i] = 1e-12f;
+
+		const glm::vec3 invDir = 1.0f / dir;
+		std::vector<std::pair<float, Actor*>> hits;
+
+		this->stack.clear();
+		this->stack.push_back(this->root);
+
+		while (!this->stack.empty())
+		{
+			const AABBTreeNode& n = this->nodes[this->stack.back()];
+			this->stack.pop_back();
+
+			float t;
+			if (!intersectsRay(n.minEdge, n.maxEdge, origin, invDir, maxDistance, t))
+				continue;
+
+			if (n.isLeaf())
+			{
+				if (intersectsRay(n.tightMin, n.tightMax, origin, invDir, maxDistance, t))
+					hits.push_back({ t, n.actor });
+
+				continue;
+			}
+
+			this->stack.push_back(n.child1);
+			this->stack.push_back(n.child2);
+		}
+
+		std::sort(hits.begin(), hits.end(), [](const std::pair<float, Actor*>& a, const std::pair<float, Actor*>& b) { return a.first < b.first; });
+
+		for (auto& h : hits)
+			out.push_back(h.second);
+	}
+
+	uint32_t AABBTree::markFrustum(const glm::mat4& viewProjection)
+	{
+		const uint32_t stamp = ++this->currentStamp;
+
+		if (this->root == -1)
+			return stamp;
+
+		glm::vec4 planes[6];
+		extractFrustumPlanes(viewProjection, planes);
+
+		this->stack.clear();
+		this->stack.push_back((this->root << 6) | 0x3F);
+
+		while (!this->stack.empty())
+		{
+			const int entry = this->stack.back();
+			this->stack.pop_back();
+
+			AABBTreeNode& n = this->nodes[entry >> 6];
+			int mask = entry & 0x3F;
+
+			if (mask != 0)
+			{
+				mask = classifyFrustum(n.isLeaf() ? n.tightMin : n.minEdge, n.isLeaf() ? n.tightMax : n.maxEdge, planes, mask);
+				if (mask == -1)
+					continue;
+			}
+
+			if (n.isLeaf())
+			{
+				n.stamp = stamp;
+				continue;
+			}
+
+			this->stack.push_back((n.child1 << 6) | mask);
+			this->stack.push_back((n.child2 << 6) | mask);
+		}
+
+		return stamp;
+	}
+
+	bool AABBTree::isMarked(int proxy, uint32_t stamp) const
+	{
+		return this->nodes[proxy].stamp == stamp;
+	}
+
+	void AABBTree::transformBounds(const glm::mat4& m, const glm::vec3& minEdge, const glm::vec3& maxEdge, glm::vec3& outMin, glm::vec3& outMax)
+	{
+		const glm::vec3 center = (minEdge + maxEdge) * 0.5f;
+		const glm::vec3 extents = (maxEdge - minEdge) * 0.5f;
+
+		const glm::vec3 worldCenter = glm::vec3(m * glm::vec4(center, 1.0f));
+		const glm::vec3 worldExtents(
+			std::abs(m[0][0]) * extents.x + std::abs(m[1][0]) * extents.y + std::abs(m[2][0]) * extents.z,
+			std::abs(m[0][1]) * extents.x + std::abs(m[1][1]) * extents.y + std::abs(m[2][1]) * extents.z,
+			std::abs(m[0][2]) * extents.x + std::abs(m[1][2]) * extents.y + std::abs(m[2][2]) * extents.z
+		);
+
+		outMin = worldCenter - worldExtents;
+		outMax = worldCenter + worldExtents;
+	}
+}
@@ -4,6 +4,8 @@
 
 #include "vel/functions.h"
 #include "vel/EmptyMaterial.h"
+#include "vel/SkinnedMaterialMixin.h"
+#include "vel/MaterialOptions.h"
 #include "vel/Actor.h"
 #include "vel/Scene.h"
 
@@ -16,6 +18,10 @@ namespace vel
 		visible(true),
 		dynamic(false),
 		lerpable(false),
+		staticBatched(false),
+		cullable(true),
+		boundsDirty(true),
+		spatialProxy(-1),
 		lastTransformUpdateTick(0),
 		transform(Transform()),
 		previousTransform(Transform()),
@@ -33,6 +39,10 @@ namespace vel
 		visible(a.isVisible()),
 		dynamic(a.isDynamic()),
 		lerpable(a.isLerpable()),
+		staticBatched(false),
+		cullable(a.isCullable()),
+		boundsDirty(true),
+		spatialProxy(-1),
 		lastTransformUpdateTick(0),
 		transform(a.getTransform()),
 		previousTransform(a.getPreviousTransform()),
@@ -61,6 +71,14 @@ namespace vel
 		return *this;
 	}
 
+	void Actor::_markBoundsDirty()
+	{
+		this->boundsDirty = true;
+
+		for (auto& ca : this->childActors)
+			ca->_markBoundsDirty();
+	}
+
 	void Actor::_markTransformDirty()
 	{
 		if (!this->dynamic || (this->dynamic && !this->lerpable) || !this->updateTick)
@@ -75,6 +93,8 @@ namespace vel
 
 	void Actor::setTranslation(glm::vec3 t)
 	{
+		this->_markBoundsDirty();
+
 		if (*this->updateTick == 0)
 		{
 			this->transform.setTranslation(t);
@@ -89,6 +109,8 @@ namespace vel
 
 	void Actor::setRotation(float angle, glm::vec3 axis)
 	{
+		this->_markBoundsDirty();
+
 		if (*this->updateTick == 0)
 		{
 			this->transform.setRotation(angle, axis);
@@ -103,6 +125,8 @@ namespace vel
 
 	void Actor::setRotation(glm::quat r)
 	{
+		this->_markBoundsDirty();
+
 		if (*this->updateTick == 0)
 		{
 			this->transform.setRotation(r);
@@ -117,6 +141,8 @@ namespace vel
 
 	void Actor::appendRotation(float angle, glm::vec3 axis)
 	{
+		this->_markBoundsDirty();
+
 		if (*this->updateTick == 0)
 		{
 			this->transform.appendRotation(angle, axis);
@@ -131,6 +157,8 @@ namespace vel
 
 	void Actor::setScale(glm::vec3 s)
 	{
+		this->_markBoundsDirty();
+
 		if (*this->updateTick == 0)
 		{
 			this->transform.setScale(s);
@@ -143,6 +171,24 @@ namespace vel
 		this->transform.setScale(s);
 	}
 
+	void Actor::setTranslationAndRotation(glm::vec3 t, glm::quat r)
+	{
+		this->_markBoundsDirty();
+
+		if (*this->updateTick == 0)
+		{
+			this->transform.setTranslation(t);
+			this->transform.setRotation(r);
+			this->previousTransform = this->transform;
+
+			return;
+		}
+
+		this->_markTransformDirty();
+		this->transform.setTranslation(t);
+		this->transform.setRotation(r);
+	}
+
 	const glm::vec3& Actor::getTranslation() const
 	{
 		return this->transform.getTranslation();
@@ -183,9 +229,35 @@ namespace vel
 		this->userPointer = p;
 	}
 
-	void Actor::setMaterial(Material* m)
+	// the layout the material's shader reads vertices in, materials without a shader (EMPTY) accept anything
+	static bool vertexFormatMatches(const Mesh* mesh, Material* material)
+	{
+		if (!mesh || !material || !material->getShader())
+			return true;
+
+		VertexFormat expected = VertexFormat::FULL;
+		if (material->getOptions() & MTRL_OPT_COMPACT_VERTEX)
+			expected = dynamic_cast<SkinnedMaterialMixin*>(material) ? VertexFormat::SKINNED_COMPACT : VertexFormat::STATIC_COMPACT;
+
+		return mesh->getVertexFormat() == expected;
+	}
+
+	bool Actor::hasMatchingVertexFormat() const
+	{
+		return vertexFormatMatches(this->mesh, this->material.get());
+	}
+
+	bool Actor::setMaterial(Material* m)
 	{
+		if (!vertexFormatMatches(this->mesh, m))
+		{
+			SPDLOG_DEBUG("Actor::setMaterial: material {} does not match the vertex format of {}'s mesh {}", m->getName(), this->name, this->mesh->getName());
+			return false;
+		}
+
 		this->material = m->clone();
+
+		return true;
 	}
 
 	Material* Actor::getMaterial()
@@ -209,6 +281,7 @@ namespace vel
 
 	void Actor::_removeParentActor()
 	{
+		this->_markBoundsDirty();
 		this->parentActor = nullptr;
 	}
 
@@ -240,9 +313,19 @@ namespace vel
 		this->name = newName;
 	}
 
-	void Actor::setMesh(Mesh* m)
+	bool Actor::setMesh(Mesh* m)
 	{
+		if (!vertexFormatMatches(m, this->material.get()))
+		{
+			SPDLOG_DEBUG("Actor::setMesh: mesh {} does not match the vertex format of {}'s material {}", m->getName(), this->name, this->material->getName());
+			return false;
+		}
+
+		this->_markBoundsDirty();
 		this->mesh = m;
+		this->lods.clear();
+
+		return true;
 	}
 
 	Mesh* Actor::getMesh()
@@ -261,14 +344,21 @@ namespace vel
 		if (this->parentActor == nullptr && this->parentActorBone == -1)
 			return this->transform.getMatrix();
 
+		return this->getParentWorldMatrix() * this->transform.getMatrix();
+	}
+
+	glm::mat4 Actor::getParentWorldMatrix()
+	{
+		if (this->parentActor == nullptr && this->parentActorBone == -1)
+			return glm::mat4(1.0f);
+
 		// if this actor is parented to another actor, and not to that actor's bone
 		if (this->parentActorBone == -1)
-			return this->parentActor->getWorldMatrix() * this->transform.getMatrix();
+			return this->parentActor->getWorldMatrix();
 
 		// if this actor is parented to the bone of its parent actor
 		return this->parentActor->getWorldMatrix() * 
-			ozzFloat4x4ToGlmMat4(this->parentActor->getAnimator()->getSimBoneMatrix(this->parentActorBone)) * 
-			this->transform.getMatrix();
+			ozzFloat4x4ToGlmMat4(this->parentActor->getAnimator()->getSimBoneMatrix(this->parentActorBone));
 	}
 
 	glm::mat4 Actor::getWorldRenderMatrix(float alpha)
@@ -319,6 +409,70 @@ namespace vel
 		return this->dynamic;
 	}
 
+	void Actor::setStaticBatched(bool b)
+	{
+		this->staticBatched = b;
+	}
+
+	bool Actor::isStaticBatched() const
+	{
+		return this->staticBatched;
+	}
+
+	void Actor::setCullable(bool c)
+	{
+		this->cullable = c;
+	}
+
+	bool Actor::isCullable() const
+	{
+		return this->cullable;
+	}
+
+	bool Actor::isBoundsDirty() const
+	{
+		// bone parented actors follow the animator every frame
+		return this->boundsDirty || this->parentActorBone != -1;
+	}
+
+	void Actor::clearBoundsDirty()
+	{
+		this->boundsDirty = false;
+	}
+
+	void Actor::setSpatialProxy(int p)
+	{
+		this->spatialProxy = p;
+	}
+
+	int Actor::getSpatialProxy() const
+	{
+		return this->spatialProxy;
+	}
+
+	void Actor::setLod(const Camera* c, size_t l)
+	{
+		for (auto& lod : this->lods)
+		{
+			if (lod.first == c)
+			{
+				lod.second = l;
+				return;
+			}
+		}
+
+		this->lods.push_back(std::make_pair(c, l));
+	}
+
+	size_t Actor::getLod(const Camera* c) const
+	{
+		for (auto& lod : this->lods)
+			if (lod.first == c)
+				return lod.second;
+
+		return 0;
+	}
+
 	bool Actor::isLerpable() const
 	{
 		return this->lerpable;
@@ -326,6 +480,8 @@ namespace vel
 
 	void Actor::setParentActor(Actor* a)
 	{
+		this->_markBoundsDirty();
+
 		// set the parent relationship
 		if(a != nullptr)
 		{
@@ -346,6 +502,8 @@ namespace vel
 
 	void Actor::setParentActorBone(Actor* a, int boneId)
 	{
+		this->_markBoundsDirty();
+
 		// set the parent relationship
 		if(boneId != -1)
 		{
@@ -0,0 +1,58 @@
+#include "vel/ActorMotionState.h"
+#include "vel/Actor.h"
+#include "vel/CollisionWorld.h"
+#include "vel/functions.h"
+
+
+namespace vel
+{
+	ActorMotionState::ActorMotionState(Actor* actor, CollisionWorld* collisionWorld, const btTransform& centerOfMassOffset) :
+		actor(actor),
+		collisionWorld(collisionWorld),
+		centerOfMassOffset(centerOfMassOffset),
+		pendingTransform(btTransform::getIdentity()),
+		queued(false)
+	{}
+
+	void ActorMotionState::getWorldTransform(btTransform& centerOfMassWorldTrans) const
+	{
+		// the world matrix rather than the local translation / rotation, so that parented actors start where they're drawn
+		glm::vec3 scale;
+		btTransform graphicsWorldTrans = glmMat4ToBulletRigidTransform(this->actor->getWorldMatrix(), scale);
+		centerOfMassWorldTrans = graphicsWorldTrans * this->centerOfMassOffset.inverse();
+	}
+
+	void ActorMotionState::setWorldTransform(const btTransform& centerOfMassWorldTrans)
+	{
+		this->pendingTransform = centerOfMassWorldTrans * this->centerOfMassOffset;
+
+		if (!this->queued)
+		{
+			this->queued = true;
+			this->collisionWorld->queueActorSync(this);
+		}
+	}
+
+	Actor* ActorMotionState::getActor()
+	{
+		return this->actor;
+	}
+
+	void ActorMotionState::sync()
+	{
+		this->queued = false;
+
+		btTransform localTransform = this->pendingTransform;
+
+		// the body moves in world space while the actor's transform is relative to its parent, which would otherwise be
+		// applied a second time on top. Any scale the parent carries is left to the actor's own, as with getWorldTransform
+		const glm::mat4 parentWorld = this->actor->getParentWorldMatrix();
+		if (parentWorld != glm::mat4(1.0f))
+		{
+			glm::vec3 scale;
+			localTransform = glmMat4ToBulletRigidTransform(glm::inverse(parentWorld) * bulletTransformToGlmMat4(this->pendingTransform), scale);
+		}
+
+		this->actor->setTranslationAndRotation(bulletToGlmVec3(localTransform.getOrigin()), bulletToGlmQuat(localTransform.getRotation()));
+	}
+}
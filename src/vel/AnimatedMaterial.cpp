@@ -1,5 +1,6 @@
 #include "vel/Shader.h"
 #include "vel/AnimatedMaterial.h"
+#include "vel/GPU.h"
 
 namespace vel
 {
@@ -17,6 +18,33 @@ namespace vel
 		//	this->setHasAlphaChannel(true);
 	}
 
+	void AnimatedMaterial::updateAnimatedTextures(GPU* gpu)
+	{
+		bool hasArrayTexture = false;
+		this->textureLayers.resize(this->getTextures().size());
+
+		for (unsigned int i = 0; i < this->getTextures().size(); i++)
+		{
+			Texture* t = this->getTextures().at(i);
+			auto currentTextureFrame = this->getMaterialAnimator().getTextureCurrentFrame(i);
+
+			if (t->options & TXT_OPT_ARRAY)
+			{
+				hasArrayTexture = true;
+				this->textureLayers.at(i) = (float)currentTextureFrame;
+				gpu->updateTextureUBO(i, t->frames.at(0).dsaHandle);
+			}
+			else
+			{
+				this->textureLayers.at(i) = 0.0f;
+				gpu->updateTextureUBO(i, t->frames.at(currentTextureFrame).dsaHandle);
+			}
+		}
+
+		if (hasArrayTexture)
+			gpu->setShaderFloatArray("textureLayers", this->textureLayers);
+	}
+
 	void AnimatedMaterial::pauseAnimatedTextureAfterCycles(unsigned int textureId, unsigned int cycles)
 	{
 		this->materialAnimator.setTextureAnimatorPauseAfterCycles(textureId, cycles);
@@ -59,7 +59,8 @@ namespace vel
 		lastFrameTimeCalculation(0.0),
 		averageFrameTime(0.0),
 		averageFrameRate(0.0),
-		pauseBufferClearAndSwap(false)
+		pauseBufferClearAndSwap(false),
+		assetUploadBudget(0.002)
     {		
 #ifdef _WIN32
 
@@ -233,6 +234,11 @@ namespace vel
 		return *this->assetManager;
 	}
 
+	void App::setAssetUploadBudget(double seconds)
+	{
+		this->assetUploadBudget = seconds;
+	}
+
 	double App::getDeltaTime()
 	{
 		return this->deltaTime;
@@ -405,13 +411,22 @@ namespace vel
 
 			float dt = static_cast<float>(this->deltaTime);
 			
+			this->assetManager->processPendingUploads(this->assetUploadBudget);
+			this->activeScene->collectAsyncLoads();
+
 			//double t1 = this->getRuntimeSec();
 			this->activeScene->lerpAnimators(renderLerp);
 			//double t2 = this->getRuntimeSec();
 			//SPDLOG_TRACE("{:.15f}", t2 - t1);
 
+			this->activeScene->updateSkinnedMeshCaches();
+
 			this->activeScene->updateBillboards();
 
+			this->activeScene->updateParticleEmitters(dt);
+
+			this->activeScene->updateStaticBatches();
+
 			this->activeScene->internalImmediateLoop(dt, renderLerp);
 
 			this->activeScene->updateTextActors();
@@ -5,6 +5,8 @@
 #include <fstream>
 #include <filesystem>
 #include <memory>
+#include <limits>
+#include <algorithm>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_headers/stb_image.h"
@@ -21,6 +23,7 @@
 
 #include "vel/AssetManager.h"
 #include "vel/AssimpMeshLoader.h"
+#include "vel/TextureCache.h"
 #include "vel/functions.h"
 
 
@@ -32,9 +35,127 @@ namespace vel
 	AssetManager::AssetManager(const std::string& dataDir, std::unique_ptr<MeshLoaderInterface> ml, GPU* gpu) :
 		dataDir(dataDir),
 		meshLoader(std::move(ml)),
-		gpu(gpu)
+		gpu(gpu),
+		workerPool(std::make_unique<ThreadPool>()),
+		pendingAsyncLoads(0)
 	{}
-	AssetManager::~AssetManager(){}
+	AssetManager::~AssetManager()
+	{
+		// joins workers before the loader / registries they reference go away, anything decoded but never
+		// uploaded is dropped along with the upload queue
+		this->workerPool.reset();
+	}
+
+
+
+	/***********************************************************************************************
+	* ASYNC LOADING
+	************************************************************************************************/
+	ThreadPool* AssetManager::getWorkerPool()
+	{
+		return this->workerPool.get();
+	}
+
+	template<typename T, typename D>
+	std::shared_future<T> AssetManager::loadAsync(std::function<D()> decode, std::function<T(D&)> finalize)
+	{
+		auto promise = std::make_shared<std::promise<T>>();
+		std::shared_future<T> future = promise->get_future().share();
+
+		this->pendingAsyncLoads++;
+
+		this->workerPool->submit([this, promise, decode, finalize]() {
+			std::shared_ptr<D> decoded;
+
+			// a throwing decode resolves like any other failed load (nullptr / empty), anything waiting on the future
+			// or on waitForPendingLoads() must still be released
+			try
+			{
+				decoded = std::make_shared<D>(decode());
+			}
+			catch (const std::exception& e)
+			{
+				SPDLOG_DEBUG("AssetManager::loadAsync: decode failed: {}", e.what());
+			}
+			catch (...)
+			{
+				SPDLOG_DEBUG("AssetManager::loadAsync: decode failed");
+			}
+
+			// registries and the gl context are only touched from the main thread, see processPendingUploads()
+			std::lock_guard<std::mutex> lock(this->uploadQueueMutex);
+			this->uploadQueue.push_back([this, promise, decoded, finalize]() {
+				T result{};
+
+				if (decoded)
+				{
+					try
+					{
+						result = finalize(*decoded);
+					}
+					catch (const std::exception& e)
+					{
+						SPDLOG_DEBUG("AssetManager::loadAsync: finalize failed: {}", e.what());
+					}
+				}
+
+				promise->set_value(result);
+				this->pendingAsyncLoads--;
+			});
+		});
+
+		return future;
+	}
+
+	template<typename T>
+	std::shared_future<T> AssetManager::readyFuture(T value)
+	{
+		std::promise<T> p;
+		p.set_value(value);
+		return p.get_future().share();
+	}
+
+	void AssetManager::processPendingUploads(double budgetSeconds)
+	{
+		auto start = std::chrono::steady_clock::now();
+
+		// always run at least one upload per call so a single oversized asset can not stall the queue forever
+		while (true)
+		{
+			std::function<void()> upload;
+
+			{
+				std::lock_guard<std::mutex> lock(this->uploadQueueMutex);
+				if (this->uploadQueue.empty())
+					return;
+
+				upload = std::move(this->uploadQueue.front());
+				this->uploadQueue.pop_front();
+			}
+
+			upload();
+
+			std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+			if (elapsed.count() >= budgetSeconds)
+				return;
+		}
+	}
+
+	void AssetManager::waitForPendingLoads()
+	{
+		while (this->pendingAsyncLoads > 0)
+		{
+			this->processPendingUploads(std::numeric_limits<double>::max());
+
+			if (this->pendingAsyncLoads > 0)
+				std::this_thread::sleep_for(1ms);
+		}
+	}
+
+	bool AssetManager::hasPendingLoads() const
+	{
+		return this->pendingAsyncLoads > 0;
+	}
 
 	
 
@@ -206,6 +327,53 @@ namespace vel
 		return loadedShader;
 	}
 
+	Shader* AssetManager::loadComputeShader(const std::string& name, const std::string& compFile, std::vector<std::string> defs)
+	{
+		int shaderIndex = this->getShaderIndex(name);
+
+		if (shaderIndex > -1)
+		{
+			SPDLOG_DEBUG("Existing Shader, bypass reload: {}", name);
+
+			this->shaders.at(shaderIndex).second++;
+
+			return this->shaders.at(shaderIndex).first.get();
+		}
+
+		SPDLOG_DEBUG("Loading new compute Shader: {}", name);
+
+		std::optional<std::string> ccOpt = this->loadShaderFile(this->dataDir + "/shaders/" + compFile);
+		if (!ccOpt)
+			return nullptr;
+
+		std::string computeCode = ccOpt.value();
+		std::string topComputeLines = this->getTopShaderLines(computeCode, 10);
+		std::string bottomComputeLines = this->getBottomShaderLines(computeCode, 10);
+		std::stringstream preprocessedComputeCode;
+		preprocessedComputeCode << topComputeLines;
+
+		for (const auto& def : defs) // preload defs into scripts
+			preprocessedComputeCode << "#define " << def << "\n";
+
+		preprocessedComputeCode << bottomComputeLines;
+
+
+		std::unique_ptr<Shader> s = std::make_unique<Shader>();
+		s->name = name;
+		s->compCode = preprocessedComputeCode.str();
+
+		// unlike the graphics shaders callers are expected to fall back to a cpu path, so don't register a broken program
+		if (!this->gpu->loadShader(s.get()))
+		{
+			SPDLOG_DEBUG("AssetManager::loadComputeShader(): Unable to build compute shader: {}", name);
+			return nullptr;
+		}
+
+		this->shaders.push_back(std::pair<std::unique_ptr<Shader>, int>(std::move(s), 1));
+
+		return this->shaders.back().first.get();
+	}
+
 	Shader* AssetManager::getShader(const std::string& name)
 	{
 		int shaderIndex = this->getShaderIndex(name);
@@ -265,12 +433,16 @@ namespace vel
 		return -1;
 	}
 
-	std::vector<Mesh*> AssetManager::loadMesh(const std::string& path)
+	std::vector<Mesh*> AssetManager::loadMesh(const std::string& path, VertexFormat format)
 	{
+		// the loader holds per-file state, and may be in use by an async load on a worker
+		std::lock_guard<std::mutex> lock(this->meshLoaderMutex);
+
 		const std::vector<std::string>& preLoadData = this->meshLoader->preload(path);
 		if (preLoadData.size() == 0)
 		{
 			SPDLOG_DEBUG("AssetManager::loadMesh: failed to preload required data for loading of mesh");
+			this->meshLoader->reset();
 			return {};
 		}
 
@@ -297,19 +469,70 @@ namespace vel
 		std::vector<std::unique_ptr<Mesh>> loadedAssets = this->meshLoader->load(&requiredData);
 
 		for (auto& lam : loadedAssets)
-		{
-			this->meshes.push_back(std::pair<std::unique_ptr<Mesh>, int>(std::move(lam), 1));
-			out.push_back(this->meshes.back().first.get());
-
-			if (this->gpu != nullptr)
-				this->gpu->loadMesh(this->meshes.back().first.get());
-		}
+			out.push_back(this->registerMesh(std::move(lam), format));
 
 		this->meshLoader->reset();
 			
 		return out;
 	}
 
+	Mesh* AssetManager::registerMesh(std::unique_ptr<Mesh> m, VertexFormat format)
+	{
+		m->setVertexFormat(resolveVertexFormat(format, m->hasBones(), m->getBones().size()));
+
+		this->meshes.push_back(std::pair<std::unique_ptr<Mesh>, int>(std::move(m), 1));
+
+		if (this->gpu != nullptr)
+			this->gpu->loadMesh(this->meshes.back().first.get());
+
+		return this->meshes.back().first.get();
+	}
+
+	std::shared_future<std::vector<Mesh*>> AssetManager::loadMeshAsync(const std::string& path, VertexFormat format)
+	{
+		SPDLOG_DEBUG("Queue async load of Mesh file: {}", path);
+
+		// duplicate checks can only happen on the main thread, so every mesh in the file is parsed and any that
+		// turn out to already be loaded are discarded in favour of the existing instance
+		return this->loadAsync<std::vector<Mesh*>, std::vector<std::unique_ptr<Mesh>>>(
+			[this, path]() {
+				std::lock_guard<std::mutex> lock(this->meshLoaderMutex);
+
+				std::vector<std::string> names = this->meshLoader->preload(path);
+				std::vector<std::unique_ptr<Mesh>> loaded;
+
+				if (names.size() == 0)
+					SPDLOG_DEBUG("AssetManager::loadMeshAsync: failed to preload required data for loading of mesh");
+				else
+					loaded = this->meshLoader->load(&names);
+
+				this->meshLoader->reset();
+
+				return loaded;
+			},
+			[this, format](std::vector<std::unique_ptr<Mesh>>& loaded) -> std::vector<Mesh*> {
+				std::vector<Mesh*> out;
+
+				for (auto& lam : loaded)
+				{
+					int meshIndex = this->getMeshIndex(lam->getName());
+
+					if (meshIndex > -1)
+					{
+						SPDLOG_DEBUG("Existing Mesh, bypass reload: {}", lam->getName());
+						this->meshes.at(meshIndex).second++;
+						out.push_back(this->meshes.at(meshIndex).first.get());
+						continue;
+					}
+
+					out.push_back(this->registerMesh(std::move(lam), format));
+				}
+
+				return out;
+			}
+		);
+	}
+
 	// This method assumes that the caller understands no duplication checks are occuring
 	Mesh* AssetManager::addMesh(std::unique_ptr<Mesh> m)
 	{		
@@ -321,6 +544,17 @@ namespace vel
 		return this->meshes.back().first.get();
 	}
 
+	void AssetManager::addMeshRemovedListener(const void* owner, std::function<void(const Mesh*)> fn)
+	{
+		this->meshRemovedListeners.push_back(std::make_pair(owner, std::move(fn)));
+	}
+
+	void AssetManager::removeMeshRemovedListener(const void* owner)
+	{
+		this->meshRemovedListeners.erase(std::remove_if(this->meshRemovedListeners.begin(), this->meshRemovedListeners.end(),
+			[owner](const std::pair<const void*, std::function<void(const Mesh*)>>& l) { return l.first == owner; }), this->meshRemovedListeners.end());
+	}
+
 	void AssetManager::incrementMeshUsage(const Mesh* pMesh)
 	{
 		for (auto& meshUsagePair : this->meshes)
@@ -342,6 +576,18 @@ namespace vel
 			this->gpu->updateMesh(m);
 	}
 
+	void AssetManager::updateMeshVertexRange(Mesh* m, size_t firstVertex, size_t vertexCount)
+	{
+		if (this->gpu != nullptr)
+			this->gpu->updateMeshVertexRange(m, firstVertex, vertexCount);
+	}
+
+	void AssetManager::updateMeshVertices(Mesh* m)
+	{
+		if (this->gpu != nullptr)
+			this->gpu->updateMeshVertices(m);
+	}
+
 	Mesh* AssetManager::getMesh(const std::string& name)
 	{
 		int meshIndex = this->getMeshIndex(name);
@@ -369,6 +615,9 @@ namespace vel
 		{
 			SPDLOG_DEBUG("Full remove Mesh: {}", pMesh->getName());
 
+			for (auto& listener : this->meshRemovedListeners)
+				listener.second(pMesh);
+
 			if (this->gpu != nullptr)
 				this->gpu->clearMesh(m.first.get());
 
@@ -402,9 +651,29 @@ namespace vel
 		return -1;
 	}
 
-	std::optional<TextureData> AssetManager::generateTextureData(const std::string& path)
+	std::optional<TextureData> AssetManager::generateTextureData(const std::string& path, int options)
 	{
 		TextureData td;
+
+		// cpu side pixels are only available from the source image
+		if ((options & TXT_OPT_COMPRESS) && !(options & TXT_OPT_CPU_AND_GPU))
+		{
+			td.compressed = TextureCache::load(path, (options & TXT_OPT_NORMAL_MAP) != 0);
+
+			if (td.compressed)
+			{
+				td.alphaChannel = td.compressed->hasAlpha;
+				td.primaryImageData.width = (int)td.compressed->levels.at(0).width;
+				td.primaryImageData.height = (int)td.compressed->levels.at(0).height;
+				td.primaryImageData.nrComponents = td.compressed->sourceComponents;
+				td.primaryImageData.sizedFormat = 0; // resolved by the gpu from the block format
+				td.primaryImageData.format = 0;
+				return td;
+			}
+
+			SPDLOG_DEBUG("AssetManager::generateTextureData(): no usable texture cache for {}, falling back to the source image", path);
+		}
+
 		td.primaryImageData.data = stbi_load(
 			path.c_str(),
 			&td.primaryImageData.width,
@@ -438,21 +707,9 @@ namespace vel
 		return td;
 	}
 
-	Texture* AssetManager::loadTexture(const std::string& name, const std::string& path, int options)
+	// cpu side only, safe to call from a worker thread
+	std::unique_ptr<Texture> AssetManager::decodeTexture(const std::string& name, const std::string& path, int options)
 	{
-		int textureIndex = this->getTextureIndex(name);
-
-		if (textureIndex > -1)
-		{
-			SPDLOG_DEBUG("Existing Texture, bypass reload: {}", name);
-
-			this->textures.at(textureIndex).second++;
-
-			return this->textures.at(textureIndex).first.get();
-		}
-
-		SPDLOG_DEBUG("Load new Texture: {}", name);
-
 		std::unique_ptr<Texture> texture = std::make_unique<Texture>();
 		texture->name = name;
 		texture->options = options;
@@ -463,24 +720,46 @@ namespace vel
 			std::map<int, std::string> orderedFiles;
 
 			for (const auto& entry : std::filesystem::directory_iterator(path))
+			{
+				// cooked caches (and interrupted cooks) sit next to the frames they were made from
+				const std::string extension = entry.path().extension().string();
+				if (extension == ".veltex" || extension == ".tmp")
+					continue;
+
 				orderedFiles[std::stoi(vel::explode_string(entry.path().filename().string(), '.')[0])] = entry.path().string();
+			}
 
+			std::vector<std::string> framePaths;
 			for (auto& of : orderedFiles)
+				framePaths.push_back(of.second);
+
+			// frames are independent, so decode them across the worker pool (the calling thread takes part, which
+			// keeps this safe when decodeTexture itself is running on a worker for an async load)
+			std::vector<std::optional<TextureData>> decoded(framePaths.size());
+			this->workerPool->parallelFor(framePaths.size(), 1, [&](size_t begin, size_t end) {
+				for (size_t i = begin; i < end; i++)
+					decoded.at(i) = this->generateTextureData(framePaths.at(i), options);
+			});
+
+			bool allDecoded = true;
+			for (auto& td : decoded)
 			{
-				std::optional<TextureData> td = this->generateTextureData(of.second);
-
-				if (!td)
-				{
-					SPDLOG_DEBUG("AssetManager::loadTexture(): failed to load all files in directory: {}", path);
-					return nullptr;
-				}
+				if (td)
+					texture->frames.push_back(td.value());
+				else
+					allDecoded = false;
+			}
 
-				texture->frames.push_back(td.value());
+			if (!allDecoded)
+			{
+				SPDLOG_DEBUG("AssetManager::loadTexture(): failed to load all files in directory: {}", path);
+				this->freeTextureData(texture.get());
+				return nullptr;
 			}
 		}
 		else
 		{
-			std::optional<TextureData> td = this->generateTextureData(path);
+			std::optional<TextureData> td = this->generateTextureData(path, options);
 
 			if (!td)
 			{
@@ -502,13 +781,95 @@ namespace vel
 			}
 		}
 
-		this->textures.push_back(std::pair<std::unique_ptr<Texture>, int>(std::move(texture), 1));
+		return texture;
+	}
+
+	void AssetManager::freeTextureData(Texture* t)
+	{
+		for (auto& td : t->frames)
+		{
+			stbi_image_free(td.primaryImageData.data);
+			td.primaryImageData.data = nullptr;
+			td.compressed.reset();
+		}
+	}
 
-		this->gpu->loadTexture(this->textures.back().first.get());
+	Texture* AssetManager::registerTexture(std::unique_ptr<Texture> texture)
+	{
+		if (!this->gpu->loadTexture(texture.get()))
+		{
+			SPDLOG_DEBUG("AssetManager::registerTexture: unable to upload {}", texture->name);
+
+			for (auto& td : texture->frames)
+				if (td.primaryImageData.data)
+					stbi_image_free(td.primaryImageData.data);
+
+			return nullptr;
+		}
+
+		this->textures.push_back(std::pair<std::unique_ptr<Texture>, int>(std::move(texture), 1));
 
 		return this->textures.back().first.get();
 	}
 
+	Texture* AssetManager::loadTexture(const std::string& name, const std::string& path, int options)
+	{
+		int textureIndex = this->getTextureIndex(name);
+
+		if (textureIndex > -1)
+		{
+			SPDLOG_DEBUG("Existing Texture, bypass reload: {}", name);
+
+			this->textures.at(textureIndex).second++;
+
+			return this->textures.at(textureIndex).first.get();
+		}
+
+		SPDLOG_DEBUG("Load new Texture: {}", name);
+
+		std::unique_ptr<Texture> texture = this->decodeTexture(name, path, options);
+		if (!texture)
+			return nullptr;
+
+		return this->registerTexture(std::move(texture));
+	}
+
+	std::shared_future<Texture*> AssetManager::loadTextureAsync(const std::string& name, const std::string& path, int options)
+	{
+		int textureIndex = this->getTextureIndex(name);
+
+		if (textureIndex > -1)
+		{
+			SPDLOG_DEBUG("Existing Texture, bypass reload: {}", name);
+
+			this->textures.at(textureIndex).second++;
+
+			return readyFuture(this->textures.at(textureIndex).first.get());
+		}
+
+		SPDLOG_DEBUG("Queue async load of new Texture: {}", name);
+
+		return this->loadAsync<Texture*, std::unique_ptr<Texture>>(
+			[this, name, path, options]() { return this->decodeTexture(name, path, options); },
+			[this](std::unique_ptr<Texture>& texture) -> Texture* {
+				if (!texture)
+					return nullptr;
+
+				// a synchronous load, or another async load of the same name, may have finished first
+				int existingIndex = this->getTextureIndex(texture->name);
+				if (existingIndex > -1)
+				{
+					SPDLOG_DEBUG("Existing Texture, bypass reload: {}", texture->name);
+					this->freeTextureData(texture.get());
+					this->textures.at(existingIndex).second++;
+					return this->textures.at(existingIndex).first.get();
+				}
+
+				return this->registerTexture(std::move(texture));
+			}
+		);
+	}
+
 	Texture* AssetManager::getTexture(const std::string& name)
 	{
 		int textureIndex = this->getTextureIndex(name);
@@ -748,21 +1109,9 @@ namespace vel
 		return this->loadFontBitmapRaw(fontName, correctedSize, fontPath);
 	}
 
-	FontBitmap* AssetManager::loadFontBitmapRaw(const std::string& fontName, int stbFontSize, const std::string& fontPath)
+	// cpu side only, safe to call from a worker thread
+	std::unique_ptr<FontBitmap> AssetManager::packFontBitmap(const std::string& fontName, int stbFontSize, const std::string& fontPath)
 	{
-		int fbIndex = this->getFontBitmapIndex(fontName);
-
-		if (fbIndex > -1)
-		{
-			SPDLOG_DEBUG("Existing FontBitmap, bypass reload: {}", fontName);
-
-			this->fontBitmaps.at(fbIndex).second++;
-
-			return this->fontBitmaps.at(fbIndex).first.get();
-		}
-
-		SPDLOG_DEBUG("Load new FontBitmap: {}", fontName);
-
 		std::ifstream file(fontPath, std::ios::binary | std::ios::ate);
 		if (!file.is_open())
 		{
@@ -820,6 +1169,11 @@ namespace vel
 			return nullptr;
 		}
 
+		return fb;
+	}
+
+	FontBitmap* AssetManager::registerFontBitmap(std::unique_ptr<FontBitmap> fb)
+	{
 		this->fontBitmaps.push_back(std::pair<std::unique_ptr<FontBitmap>, int>(std::move(fb), 1));
 
 		FontBitmap* loadedFontBitmap = this->fontBitmaps.back().first.get();
@@ -829,6 +1183,62 @@ namespace vel
 		return loadedFontBitmap;
 	}
 
+	FontBitmap* AssetManager::loadFontBitmapRaw(const std::string& fontName, int stbFontSize, const std::string& fontPath)
+	{
+		int fbIndex = this->getFontBitmapIndex(fontName);
+
+		if (fbIndex > -1)
+		{
+			SPDLOG_DEBUG("Existing FontBitmap, bypass reload: {}", fontName);
+
+			this->fontBitmaps.at(fbIndex).second++;
+
+			return this->fontBitmaps.at(fbIndex).first.get();
+		}
+
+		SPDLOG_DEBUG("Load new FontBitmap: {}", fontName);
+
+		std::unique_ptr<FontBitmap> fb = this->packFontBitmap(fontName, stbFontSize, fontPath);
+		if (!fb)
+			return nullptr;
+
+		return this->registerFontBitmap(std::move(fb));
+	}
+
+	std::shared_future<FontBitmap*> AssetManager::loadFontBitmapAsync(const std::string& fontName, int fontSize, const std::string& fontPath)
+	{
+		int fbIndex = this->getFontBitmapIndex(fontName);
+
+		if (fbIndex > -1)
+		{
+			SPDLOG_DEBUG("Existing FontBitmap, bypass reload: {}", fontName);
+
+			this->fontBitmaps.at(fbIndex).second++;
+
+			return readyFuture(this->fontBitmaps.at(fbIndex).first.get());
+		}
+
+		SPDLOG_DEBUG("Queue async load of new FontBitmap: {}", fontName);
+
+		return this->loadAsync<FontBitmap*, std::unique_ptr<FontBitmap>>(
+			[this, fontName, fontSize, fontPath]() { return this->packFontBitmap(fontName, fontSize, fontPath); },
+			[this](std::unique_ptr<FontBitmap>& fb) -> FontBitmap* {
+				if (!fb)
+					return nullptr;
+
+				int existingIndex = this->getFontBitmapIndex(fb->fontName);
+				if (existingIndex > -1)
+				{
+					SPDLOG_DEBUG("Existing FontBitmap, bypass reload: {}", fb->fontName);
+					this->fontBitmaps.at(existingIndex).second++;
+					return this->fontBitmaps.at(existingIndex).first.get();
+				}
+
+				return this->registerFontBitmap(std::move(fb));
+			}
+		);
+	}
+
 	FontBitmap* AssetManager::getFontBitmap(const std::string& name)
 	{
 		int fbIndex = this->getFontBitmapIndex(name);
@@ -896,6 +1306,20 @@ namespace vel
 	{
 		std::vector<Vertex> meshVertices = {};
 		std::vector<unsigned int> meshIndices = {};
+
+		this->buildTextActorGeometry(ta, meshVertices, meshIndices);
+
+		std::unique_ptr<Mesh> m = std::make_unique<Mesh>(ta->name + "_mesh");
+		m->setVertices(meshVertices);
+		m->setIndices(meshIndices);
+
+		return m;
+	}
+
+	void AssetManager::buildTextActorGeometry(TextActor* ta, std::vector<Vertex>& meshVertices, std::vector<unsigned int>& meshIndices)
+	{
+		meshVertices.clear();
+		meshIndices.clear();
 		ta->caretPositions.clear();
 
 		unsigned int lastIndex = 0;
@@ -987,11 +1411,10 @@ namespace vel
 			ta->caretPositions.push_back({ offsetX, -offsetY });
 		}
 
-		std::unique_ptr<Mesh> m = std::make_unique<Mesh>(ta->name + "_mesh");
-		m->setVertices(meshVertices);
-		m->setIndices(meshIndices);
+		if (meshVertices.empty())
+			return;
 
-		AABB maabb = m->getAABB();
+		AABB maabb = AABB(meshVertices);
 
 		float minX = maabb.getMinEdge().x;
 		float maxX = maabb.getMaxEdge().x;
@@ -1029,7 +1452,7 @@ namespace vel
 			yOffset = (minY + maxY) * 0.5f;
 		}
 
-		for (auto& v : m->getMutableVertices())
+		for (auto& v : meshVertices)
 		{
 			v.position.x -= xOffset;
 			v.position.y -= yOffset;
@@ -1040,28 +1463,15 @@ namespace vel
 			p.x -= xOffset;
 			p.y -= yOffset;
 		}
-
-		return m;
 	}
 
 
 	/***********************************************************************************************
 	* SKELETONS
 	************************************************************************************************/
-	ozz::animation::Skeleton* AssetManager::loadSkeleton(const std::string& name, const std::string& path)
+	// cpu side only, safe to call from a worker thread
+	std::unique_ptr<ozz::animation::Skeleton> AssetManager::readSkeleton(const std::string& path)
 	{
-		auto it = this->skeletons.find(name);
-		if (it != this->skeletons.end()) 
-		{
-			SPDLOG_DEBUG("Existing Skeleton, bypass reload: {}", name);
-
-			it->second.second++;
-
-			return it->second.first.get();
-		}
-		
-		SPDLOG_DEBUG("Load new Skeleton: {}", name);
-
 		std::unique_ptr<ozz::animation::Skeleton> skel = std::make_unique<ozz::animation::Skeleton>();
 		
 		ozz::io::File file(path.c_str(), "rb");
@@ -1080,6 +1490,27 @@ namespace vel
 
 		// Once the tag is validated ^^, reading cannot fail.
 		archive >> *skel;
+
+		return skel;
+	}
+
+	ozz::animation::Skeleton* AssetManager::loadSkeleton(const std::string& name, const std::string& path)
+	{
+		auto it = this->skeletons.find(name);
+		if (it != this->skeletons.end()) 
+		{
+			SPDLOG_DEBUG("Existing Skeleton, bypass reload: {}", name);
+
+			it->second.second++;
+
+			return it->second.first.get();
+		}
+		
+		SPDLOG_DEBUG("Load new Skeleton: {}", name);
+
+		std::unique_ptr<ozz::animation::Skeleton> skel = readSkeleton(path);
+		if (!skel)
+			return nullptr;
 		
 		ozz::animation::Skeleton* rawSkelPtr = skel.get();
 		this->skeletons[name] = std::pair<std::unique_ptr<ozz::animation::Skeleton>, int>(std::move(skel), 1);
@@ -1087,6 +1518,42 @@ namespace vel
 		return rawSkelPtr;
 	}
 
+	std::shared_future<ozz::animation::Skeleton*> AssetManager::loadSkeletonAsync(const std::string& name, const std::string& path)
+	{
+		auto it = this->skeletons.find(name);
+		if (it != this->skeletons.end())
+		{
+			SPDLOG_DEBUG("Existing Skeleton, bypass reload: {}", name);
+
+			it->second.second++;
+
+			return readyFuture(it->second.first.get());
+		}
+
+		SPDLOG_DEBUG("Queue async load of new Skeleton: {}", name);
+
+		return this->loadAsync<ozz::animation::Skeleton*, std::unique_ptr<ozz::animation::Skeleton>>(
+			[path]() { return readSkeleton(path); },
+			[this, name](std::unique_ptr<ozz::animation::Skeleton>& skel) -> ozz::animation::Skeleton* {
+				if (!skel)
+					return nullptr;
+
+				auto existing = this->skeletons.find(name);
+				if (existing != this->skeletons.end())
+				{
+					SPDLOG_DEBUG("Existing Skeleton, bypass reload: {}", name);
+					existing->second.second++;
+					return existing->second.first.get();
+				}
+
+				ozz::animation::Skeleton* rawSkelPtr = skel.get();
+				this->skeletons[name] = std::pair<std::unique_ptr<ozz::animation::Skeleton>, int>(std::move(skel), 1);
+
+				return rawSkelPtr;
+			}
+		);
+	}
+
 	ozz::animation::Skeleton* AssetManager::getSkeleton(const std::string& name)
 	{
 		auto it = this->skeletons.find(name);
@@ -1118,20 +1585,9 @@ namespace vel
 	/***********************************************************************************************
 	* ANIMATIONS
 	************************************************************************************************/
-	ozz::animation::Animation* AssetManager::loadAnimation(const std::string& name, const std::string& path)
+	// cpu side only, safe to call from a worker thread
+	std::unique_ptr<ozz::animation::Animation> AssetManager::readAnimation(const std::string& path)
 	{
-		auto it = this->animations.find(name);
-		if (it != this->animations.end())
-		{
-			SPDLOG_DEBUG("Existing Animation, bypass reload: {}", name);
-
-			it->second.second++;
-
-			return it->second.first.get();
-		}
-
-		SPDLOG_DEBUG("Load new Animation: {}", name);
-
 		std::unique_ptr<ozz::animation::Animation> anim = std::make_unique<ozz::animation::Animation>();
 
 		ozz::io::File file(path.c_str(), "rb");
@@ -1151,12 +1607,69 @@ namespace vel
 		// Once the tag is validated ^^, reading cannot fail.
 		archive >> *anim;
 
+		return anim;
+	}
+
+	ozz::animation::Animation* AssetManager::loadAnimation(const std::string& name, const std::string& path)
+	{
+		auto it = this->animations.find(name);
+		if (it != this->animations.end())
+		{
+			SPDLOG_DEBUG("Existing Animation, bypass reload: {}", name);
+
+			it->second.second++;
+
+			return it->second.first.get();
+		}
+
+		SPDLOG_DEBUG("Load new Animation: {}", name);
+
+		std::unique_ptr<ozz::animation::Animation> anim = readAnimation(path);
+		if (!anim)
+			return nullptr;
+
 		ozz::animation::Animation* rawAnimPtr = anim.get();
 		this->animations[name] = std::pair<std::unique_ptr<ozz::animation::Animation>, int>(std::move(anim), 1);
 
 		return rawAnimPtr;
 	}
 
+	std::shared_future<ozz::animation::Animation*> AssetManager::loadAnimationAsync(const std::string& name, const std::string& path)
+	{
+		auto it = this->animations.find(name);
+		if (it != this->animations.end())
+		{
+			SPDLOG_DEBUG("Existing Animation, bypass reload: {}", name);
+
+			it->second.second++;
+
+			return readyFuture(it->second.first.get());
+		}
+
+		SPDLOG_DEBUG("Queue async load of new Animation: {}", name);
+
+		return this->loadAsync<ozz::animation::Animation*, std::unique_ptr<ozz::animation::Animation>>(
+			[path]() { return readAnimation(path); },
+			[this, name](std::unique_ptr<ozz::animation::Animation>& anim) -> ozz::animation::Animation* {
+				if (!anim)
+					return nullptr;
+
+				auto existing = this->animations.find(name);
+				if (existing != this->animations.end())
+				{
+					SPDLOG_DEBUG("Existing Animation, bypass reload: {}", name);
+					existing->second.second++;
+					return existing->second.first.get();
+				}
+
+				ozz::animation::Animation* rawAnimPtr = anim.get();
+				this->animations[name] = std::pair<std::unique_ptr<ozz::animation::Animation>, int>(std::move(anim), 1);
+
+				return rawAnimPtr;
+			}
+		);
+	}
+
 	ozz::animation::Animation* AssetManager::getAnimation(const std::string& name)
 	{
 		auto it = this->animations.find(name);
@@ -1,4 +1,6 @@
 #include <iostream>
+#include <algorithm>
+#include <cmath>
 
 #include "glm/gtc/type_ptr.hpp"
 
@@ -25,14 +27,90 @@ namespace vel
 		this->currentAssetFile = "";
 		this->meshesInFile.clear();
 		this->meshes.clear();
+		this->authoredLods.clear();
 		this->currentMeshTextureId = 0;
 	}
 
+	size_t AssimpMeshLoader::lodLevelFromName(const std::string& nodeName, std::string& baseName)
+	{
+		const std::string suffix = "_LOD";
+		size_t pos = nodeName.rfind(suffix);
+
+		if (pos == std::string::npos || pos == 0 || pos + suffix.size() + 1 != nodeName.size())
+			return 0;
+
+		char digit = nodeName.back();
+		if (digit < '1' || digit > ('0' + (char)(MAX_MESH_LODS - 1)))
+			return 0;
+
+		baseName = nodeName.substr(0, pos);
+		return (size_t)(digit - '0');
+	}
+
+	void AssimpMeshLoader::attachAuthoredLods()
+	{
+		std::sort(this->authoredLods.begin(), this->authoredLods.end(),
+			[](const AuthoredLod& a, const AuthoredLod& b) { return a.level < b.level; });
+
+		for (auto& al : this->authoredLods)
+		{
+			Mesh* base = nullptr;
+			for (auto& m : this->meshes)
+			{
+				if (m->getName() == al.baseName)
+				{
+					base = m.get();
+					break;
+				}
+			}
+
+			if (!base)
+				continue;
+
+			// the lod was imported with its own bone list, point its weights at the base mesh's bones instead
+			std::vector<Vertex> vertices = al.mesh->getVertices();
+			const std::vector<MeshBone>& lodBones = al.mesh->getBones();
+			bool bonesMatch = true;
+
+			std::vector<unsigned int> boneRemap(lodBones.size());
+			for (size_t i = 0; i < lodBones.size() && bonesMatch; i++)
+			{
+				bonesMatch = false;
+				for (size_t j = 0; j < base->getBones().size(); j++)
+				{
+					if (base->getBones()[j].name == lodBones[i].name)
+					{
+						boneRemap[i] = (unsigned int)j;
+						bonesMatch = true;
+						break;
+					}
+				}
+			}
+
+			if (!bonesMatch)
+			{
+				SPDLOG_DEBUG("AssimpMeshLoader::attachAuthoredLods: {} lod {} references bones {} does not have, skipped", al.baseName, al.level, al.baseName);
+				continue;
+			}
+
+			for (auto& v : vertices)
+				for (size_t k = 0; k < sizeof(v.weights.ids) / sizeof(v.weights.ids[0]); k++)
+					if (v.weights.weights[k] > 0.0f)
+						v.weights.ids[k] = boneRemap[v.weights.ids[k]];
+
+			// levels are attached in order, so a gap (LOD1 and LOD3 only) simply shifts the later ones down
+			base->addLod(vertices, al.mesh->getIndices(), std::pow(0.5f, (float)base->getLodCount()));
+		}
+
+		this->authoredLods.clear();
+	}
+
 	void AssimpMeshLoader::preProcessNode(aiNode* node)
 	{
 		std::string nodeName = node->mName.C_Str();
 
-		if (nodeName != "RootNode" && node->mNumMeshes > 0)
+		std::string baseName;
+		if (nodeName != "RootNode" && node->mNumMeshes > 0 && lodLevelFromName(nodeName, baseName) == 0)
 			this->meshesInFile.push_back(nodeName);
 
 		for (unsigned int i = 0; i < node->mNumChildren; i++)
@@ -62,6 +140,7 @@ namespace vel
 		this->meshesToLoad = loadables;
 
 		this->processNode(this->impScene->mRootNode);
+		this->attachAuthoredLods();
 
 		return std::move(this->meshes);
 	}
@@ -186,10 +265,15 @@ namespace vel
 		{
 			// use node name for mesh name...
 
+			// lod nodes load along with their base mesh
+			std::string lodBaseName;
+			size_t lodLevel = lodLevelFromName(nodeName, lodBaseName);
+			const std::string& loadName = lodLevel > 0 ? lodBaseName : nodeName;
+
 			bool shouldLoadMesh = false;
 			for (auto& mn : *this->meshesToLoad)
 			{
-				if (mn == nodeName)
+				if (mn == loadName)
 				{
 					shouldLoadMesh = true;
 					break;
@@ -255,7 +339,10 @@ namespace vel
 			finalMesh->setIndices(meshIndices);
 			finalMesh->setBones(meshBones);
 
-			this->meshes.push_back(std::move(finalMesh));
+			if (lodLevel > 0)
+				this->authoredLods.push_back({ lodBaseName, lodLevel, std::move(finalMesh) });
+			else
+				this->meshes.push_back(std::move(finalMesh));
 			
 		}
 
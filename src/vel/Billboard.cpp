@@ -4,13 +4,16 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtx/quaternion.hpp>
 
+#include "ozz/base/maths/simd_math.h"
+
 namespace vel 
 {
 
 	Billboard::Billboard(vel::Actor* billboardActor, vel::Camera* parentCamera) : 
 		billboardActor(billboardActor), 
 		parentCamera(parentCamera), 
-		lockXZ(false) 
+		lockXZ(false),
+		gpuOriented(false)
 	{}
 
 	vel::Camera* Billboard::getCamera() const
@@ -28,6 +31,19 @@ namespace vel
 		this->lockXZ = b;
 	}
 
+	void Billboard::setGpuOriented(bool b)
+	{
+		this->gpuOriented = b;
+
+		if (b && this->billboardActor)
+			this->billboardActor->setRotation(glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+	}
+
+	bool Billboard::getGpuOriented() const
+	{
+		return this->gpuOriented;
+	}
+
 	void Billboard::update()
 	{
 		if (!billboardActor || !parentCamera) 
@@ -77,4 +93,118 @@ namespace vel
 		billboardActor->setRotation(q);
 	}
 
+	void Billboard::updateBatch(std::vector<std::unique_ptr<Billboard>>& billboards, BillboardBatchData& scratch)
+	{
+		using namespace ozz::math;
+
+		scratch.members.clear();
+		for (auto& b : billboards)
+			if (b->billboardActor && b->parentCamera && !b->gpuOriented)
+				scratch.members.push_back(b.get());
+
+		const size_t count = scratch.members.size();
+		if (count == 0)
+			return;
+
+		const size_t paddedCount = (count + 3) & ~size_t(3);
+
+		for (auto* v : { &scratch.objX, &scratch.objY, &scratch.objZ, &scratch.camX, &scratch.camY, &scratch.camZ, &scratch.keepY,
+			&scratch.quatX, &scratch.quatY, &scratch.quatZ, &scratch.quatW })
+			v->resize(paddedCount);
+		scratch.laneMasks.resize(paddedCount / 4);
+
+		// gather
+		for (size_t i = 0; i < count; i++)
+		{
+			const Billboard* b = scratch.members[i];
+			const glm::vec3 camPos = b->parentCamera->getPosition();
+			const glm::vec3 objPos = b->billboardActor->getTransform().getTranslation();
+
+			scratch.objX[i] = objPos.x;
+			scratch.objY[i] = objPos.y;
+			scratch.objZ[i] = objPos.z;
+			scratch.camX[i] = camPos.x;
+			scratch.camY[i] = camPos.y;
+			scratch.camZ[i] = camPos.z;
+			scratch.keepY[i] = b->lockXZ ? 0.0f : 1.0f;
+		}
+
+		// padding lanes get a valid direction so they never produce nans, results are ignored
+		for (size_t i = count; i < paddedCount; i++)
+		{
+			scratch.objX[i] = scratch.objY[i] = scratch.objZ[i] = 0.0f;
+			scratch.camX[i] = scratch.camY[i] = 0.0f;
+			scratch.camZ[i] = 1.0f;
+			scratch.keepY[i] = 1.0f;
+		}
+
+		const SimdFloat4 eps = simd_float4::Load1(1e-6f);
+		const SimdFloat4 zero = simd_float4::zero();
+		const SimdFloat4 one = simd_float4::one();
+		const SimdFloat4 half = simd_float4::Load1(0.5f);
+
+		for (size_t i = 0; i < paddedCount; i += 4)
+		{
+			// direction from object to camera, y zeroed for yaw only billboards
+			const SimdFloat4 dx = simd_float4::LoadPtrU(&scratch.camX[i]) - simd_float4::LoadPtrU(&scratch.objX[i]);
+			const SimdFloat4 dy = (simd_float4::LoadPtrU(&scratch.camY[i]) - simd_float4::LoadPtrU(&scratch.objY[i])) * 
+				simd_float4::LoadPtrU(&scratch.keepY[i]);
+			const SimdFloat4 dz = simd_float4::LoadPtrU(&scratch.camZ[i]) - simd_float4::LoadPtrU(&scratch.objZ[i]);
+
+			const SimdFloat4 dirLen2 = dx * dx + dy * dy + dz * dz;
+			const SimdFloat4 invDirLen = one / Sqrt(Max(dirLen2, eps));
+
+			// forward = -normalize(dir), local -Z ends up facing the camera
+			const SimdFloat4 fx = (zero - dx) * invDirLen;
+			const SimdFloat4 fy = (zero - dy) * invDirLen;
+			const SimdFloat4 fz = (zero - dz) * invDirLen;
+
+			// right = normalize(cross(worldUp, forward)) = (fz, 0, -fx) / |..|
+			const SimdFloat4 rightLen2 = fx * fx + fz * fz;
+			const SimdFloat4 invRightLen = one / Sqrt(Max(rightLen2, eps));
+			const SimdFloat4 rx = fz * invRightLen;
+			const SimdFloat4 rz = (zero - fx) * invRightLen;
+
+			// up = cross(forward, right), already unit length
+			const SimdFloat4 ux = fy * rz;
+			const SimdFloat4 uy = fz * rx - fx * rz;
+			const SimdFloat4 uz = (zero - fy) * rx;
+
+			// quaternion from the basis matrix [right | up | forward], each component's magnitude comes from the diagonal
+			// and its sign from the matching off diagonal difference, so no branching on the largest component
+			const SimdFloat4 m00 = rx;
+			const SimdFloat4 m11 = uy;
+			const SimdFloat4 m22 = fz;
+
+			const SimdFloat4 qw = half * Sqrt(Max(zero, one + m00 + m11 + m22));
+			const SimdFloat4 qx = Or(half * Sqrt(Max(zero, one + m00 - m11 - m22)), Sign(uz - fy));
+			const SimdFloat4 qy = Or(half * Sqrt(Max(zero, one - m00 + m11 - m22)), Sign(fx - rz));
+			const SimdFloat4 qz = Or(half * Sqrt(Max(zero, one - m00 - m11 + m22)), Sign(zero - ux));
+
+			StorePtrU(qx, &scratch.quatX[i]);
+			StorePtrU(qy, &scratch.quatY[i]);
+			StorePtrU(qz, &scratch.quatZ[i]);
+			StorePtrU(qw, &scratch.quatW[i]);
+
+			const SimdInt4 valid = And(CmpGe(dirLen2, eps), CmpGe(rightLen2, eps));
+			scratch.laneMasks[i / 4] = MoveMask(valid);
+		}
+
+		// scatter
+		for (size_t i = 0; i < count; i++)
+		{
+			Billboard* b = scratch.members[i];
+
+			if (scratch.laneMasks[i / 4] & (1 << (i & 3)))
+			{
+				b->billboardActor->setRotation(glm::quat(scratch.quatW[i], scratch.quatX[i], scratch.quatY[i], scratch.quatZ[i]));
+				continue;
+			}
+
+			// camera on top of the object (update() leaves rotation alone), or looking straight up / down, rare enough
+			// to leave to the scalar path
+			b->update();
+		}
+	}
+
 }
\ No newline at end of file
@@ -73,6 +73,11 @@ namespace vel
 		this->nearPlane = np;
 	}
 
+	float Camera::getNearPlane() const
+	{
+		return this->nearPlane;
+	}
+
 	void Camera::setFarPlane(float fp)
 	{
 		this->farPlane = fp;
@@ -83,6 +88,11 @@ namespace vel
 		this->type = type;
 	}
 
+	CameraType Camera::getType() const
+	{
+		return this->type;
+	}
+
 	const std::string& Camera::getName() const
 	{
 		return this->name;
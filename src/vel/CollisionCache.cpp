@@ -0,0 +1,306 @@
+#include <vector>
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+#include <cstdio>
+#include <atomic>
+#include <thread>
+#include <functional>
+
+#include "spdlog/spdlog.h"
+
+#include "vel/MappedFile.h"
+#include "vel/CollisionCache.h"
+
+
+namespace vel
+{
+	static const char COLLISION_CACHE_MAGIC[8] = { 'V', 'E', 'L', 'B', 'V', 'H', '\0', '\0' };
+
+	static uint64_t alignTo16(uint64_t v)
+	{
+		return (v + 15) & ~uint64_t(15);
+	}
+
+	// fnv-1a over whole words
+	static void hashWord(uint64_t& h, uint64_t word)
+	{
+		h ^= word;
+		h *= 0x100000001b3ull;
+	}
+
+	CollisionCacheData::CollisionCacheData() :
+		contentHash(0),
+		bvhBuffer(nullptr),
+		bvh(nullptr)
+	{}
+
+	CollisionCacheData::~CollisionCacheData()
+	{
+		// the in place bvh only references the buffer, nothing of its own to release
+		if (this->bvhBuffer)
+			btAlignedFree(this->bvhBuffer);
+	}
+
+	std::string CollisionCache::getCachePath(const std::string& directory, uint64_t contentHash)
+	{
+		char name[32];
+		std::snprintf(name, sizeof(name), "%016llx.velbvh", (unsigned long long)contentHash);
+
+		return (std::filesystem::path(directory) / name).string();
+	}
+
+	uint64_t CollisionCache::contentHash(const btStridingMeshInterface* meshInterface)
+	{
+		uint64_t h = 0xcbf29ce484222325ull;
+
+		hashWord(h, (uint64_t)meshInterface->getNumSubParts());
+
+		for (int part = 0; part < meshInterface->getNumSubParts(); part++)
+		{
+			const unsigned char* vertexBase;
+			int numVerts;
+			PHY_ScalarType vertexType;
+			int vertexStride;
+			const unsigned char* indexBase;
+			int indexStride;
+			int numFaces;
+			PHY_ScalarType indexType;
+
+			meshInterface->getLockedReadOnlyVertexIndexBase(
+				&vertexBase, numVerts, vertexType, vertexStride,
+				&indexBase, indexStride, numFaces, indexType, part
+			);
+
+			hashWord(h, (uint64_t)numVerts);
+			hashWord(h, (uint64_t)numFaces);
+			hashWord(h, (uint64_t)vertexType);
+
+			for (int v = 0; v < numVerts; v++)
+			{
+				const unsigned char* vertex = vertexBase + (size_t)v * vertexStride;
+
+				for (int c = 0; c < 3; c++)
+				{
+					if (vertexType == PHY_DOUBLE)
+					{
+						uint64_t bits;
+						std::memcpy(&bits, vertex + c * sizeof(double), sizeof(bits));
+						hashWord(h, bits);
+					}
+					else
+					{
+						uint32_t bits;
+						std::memcpy(&bits, vertex + c * sizeof(float), sizeof(bits));
+						hashWord(h, bits);
+					}
+				}
+			}
+
+			for (int f = 0; f < numFaces; f++)
+			{
+				const unsigned char* face = indexBase + (size_t)f * indexStride;
+
+				for (int c = 0; c < 3; c++)
+				{
+					uint64_t index;
+					if (indexType == PHY_SHORT)
+						index = reinterpret_cast<const unsigned short*>(face)[c];
+					else if (indexType == PHY_UCHAR)
+						index = face[c];
+					else
+						index = (uint32_t)reinterpret_cast<const int*>(face)[c];
+
+					hashWord(h, index);
+				}
+			}
+
+			meshInterface->unLockReadOnlyVertexBase(part);
+		}
+
+		return h;
+	}
+
+	bool CollisionCache::write(const std::string& cachePath, uint64_t contentHash, const btOptimizedBvh* bvh, const btTriangleInfoMap* triangleInfoMap)
+	{
+		if (!bvh)
+			return false;
+
+		const unsigned int bvhSize = bvh->calculateSerializeBufferSize();
+
+		// serializeInPlace writes a relocatable copy of the bvh object and its node arrays, the target must be aligned
+		void* bvhBuffer = btAlignedAlloc(bvhSize, 16);
+		if (!bvh->serializeInPlace(bvhBuffer, bvhSize, false))
+		{
+			SPDLOG_DEBUG("CollisionCache::write: unable to serialize bvh for {}", cachePath);
+			btAlignedFree(bvhBuffer);
+			return false;
+		}
+
+		std::vector<CollisionCacheTriangleInfo> infos;
+
+		CollisionCacheHeader header;
+		std::memset(&header, 0, sizeof(CollisionCacheHeader));
+		std::memcpy(header.magic, COLLISION_CACHE_MAGIC, sizeof(COLLISION_CACHE_MAGIC));
+		header.version = COLLISION_CACHE_VERSION;
+		header.scalarSize = sizeof(btScalar);
+		header.contentHash = contentHash;
+		header.bvhOffset = alignTo16(sizeof(CollisionCacheHeader));
+		header.bvhSize = bvhSize;
+		header.triangleInfoOffset = alignTo16(header.bvhOffset + bvhSize);
+
+		if (triangleInfoMap)
+		{
+			header.hasTriangleInfo = 1;
+			header.convexEpsilon = (float)triangleInfoMap->m_convexEpsilon;
+			header.planarEpsilon = (float)triangleInfoMap->m_planarEpsilon;
+			header.equalVertexThreshold = (float)triangleInfoMap->m_equalVertexThreshold;
+			header.edgeDistanceThreshold = (float)triangleInfoMap->m_edgeDistanceThreshold;
+			header.maxEdgeAngleThreshold = (float)triangleInfoMap->m_maxEdgeAngleThreshold;
+			header.zeroAreaThreshold = (float)triangleInfoMap->m_zeroAreaThreshold;
+
+			infos.resize(triangleInfoMap->size());
+			for (int i = 0; i < triangleInfoMap->size(); i++)
+			{
+				const btTriangleInfo* info = triangleInfoMap->getAtIndex(i);
+
+				CollisionCacheTriangleInfo& ci = infos[i];
+				ci.key = triangleInfoMap->getKeyAtIndex(i).getUid1();
+				ci.flags = info->m_flags;
+				ci.edgeV0V1Angle = (float)info->m_edgeV0V1Angle;
+				ci.edgeV1V2Angle = (float)info->m_edgeV1V2Angle;
+				ci.edgeV2V0Angle = (float)info->m_edgeV2V0Angle;
+				ci.reserved = 0;
+			}
+
+			header.triangleInfoCount = (uint32_t)infos.size();
+		}
+
+		// write to a temporary file first so that an interrupted write never leaves a valid looking, partial cache, named
+		// per writer so that concurrent writes of the same cache never write into each other's file
+		static std::atomic<uint32_t> tmpCounter(0);
+		std::string tmpPath = cachePath + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) +
+			"_" + std::to_string(tmpCounter++) + ".tmp";
+		{
+			std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+			if (!out)
+			{
+				SPDLOG_DEBUG("CollisionCache::write: unable to open {} for writing", tmpPath);
+				btAlignedFree(bvhBuffer);
+				return false;
+			}
+
+			auto padTo = [&out](uint64_t offset) {
+				static const char zeros[16] = {};
+				uint64_t pos = (uint64_t)out.tellp();
+				if (offset > pos)
+					out.write(zeros, (std::streamsize)(offset - pos));
+			};
+
+			out.write(reinterpret_cast<const char*>(&header), sizeof(CollisionCacheHeader));
+
+			padTo(header.bvhOffset);
+			out.write(reinterpret_cast<const char*>(bvhBuffer), bvhSize);
+
+			padTo(header.triangleInfoOffset);
+			if (!infos.empty())
+				out.write(reinterpret_cast<const char*>(infos.data()), infos.size() * sizeof(CollisionCacheTriangleInfo));
+
+			btAlignedFree(bvhBuffer);
+
+			if (!out)
+			{
+				SPDLOG_DEBUG("CollisionCache::write: failed writing {}", tmpPath);
+				return false;
+			}
+		}
+
+		std::error_code ec;
+		std::filesystem::rename(tmpPath, cachePath, ec);
+		if (ec)
+		{
+			SPDLOG_DEBUG("CollisionCache::write: unable to move {} into place: {}", tmpPath, ec.message());
+			std::filesystem::remove(tmpPath, ec);
+			return false;
+		}
+
+		return true;
+	}
+
+	std::unique_ptr<CollisionCacheData> CollisionCache::load(const std::string& cachePath, uint64_t contentHash)
+	{
+		std::error_code ec;
+		if (!std::filesystem::exists(cachePath, ec))
+			return nullptr;
+
+		MappedFile file;
+		if (!file.open(cachePath))
+			return nullptr;
+
+		const unsigned char* base = file.getData();
+		const size_t size = file.getSize();
+
+		if (size < sizeof(CollisionCacheHeader))
+		{
+			SPDLOG_DEBUG("CollisionCache::load: {} is truncated", cachePath);
+			return nullptr;
+		}
+
+		const CollisionCacheHeader* header = reinterpret_cast<const CollisionCacheHeader*>(base);
+
+		if (std::memcmp(header->magic, COLLISION_CACHE_MAGIC, sizeof(COLLISION_CACHE_MAGIC)) != 0 ||
+			header->version != COLLISION_CACHE_VERSION || header->scalarSize != sizeof(btScalar) ||
+			header->contentHash != contentHash)
+		{
+			SPDLOG_DEBUG("CollisionCache::load: {} is not a compatible collision cache", cachePath);
+			return nullptr;
+		}
+
+		if (header->bvhOffset + header->bvhSize > size ||
+			header->triangleInfoOffset + (uint64_t)header->triangleInfoCount * sizeof(CollisionCacheTriangleInfo) > size)
+		{
+			SPDLOG_DEBUG("CollisionCache::load: {} is truncated", cachePath);
+			return nullptr;
+		}
+
+		auto data = std::make_unique<CollisionCacheData>();
+		data->contentHash = contentHash;
+
+		// deserializing patches the buffer in place (the bvh object is constructed at its start), so it can't stay
+		// in the read only mapping
+		data->bvhBuffer = btAlignedAlloc((size_t)header->bvhSize, 16);
+		std::memcpy(data->bvhBuffer, base + header->bvhOffset, (size_t)header->bvhSize);
+
+		data->bvh = btOptimizedBvh::deSerializeInPlace(data->bvhBuffer, (unsigned int)header->bvhSize, false);
+		if (!data->bvh)
+		{
+			SPDLOG_DEBUG("CollisionCache::load: unable to deserialize bvh from {}", cachePath);
+			return nullptr;
+		}
+
+		if (header->hasTriangleInfo)
+		{
+			data->triangleInfoMap = std::make_unique<btTriangleInfoMap>();
+			data->triangleInfoMap->m_convexEpsilon = header->convexEpsilon;
+			data->triangleInfoMap->m_planarEpsilon = header->planarEpsilon;
+			data->triangleInfoMap->m_equalVertexThreshold = header->equalVertexThreshold;
+			data->triangleInfoMap->m_edgeDistanceThreshold = header->edgeDistanceThreshold;
+			data->triangleInfoMap->m_maxEdgeAngleThreshold = header->maxEdgeAngleThreshold;
+			data->triangleInfoMap->m_zeroAreaThreshold = header->zeroAreaThreshold;
+
+			const CollisionCacheTriangleInfo* infos = reinterpret_cast<const CollisionCacheTriangleInfo*>(base + header->triangleInfoOffset);
+			for (uint32_t i = 0; i < header->triangleInfoCount; i++)
+			{
+				btTriangleInfo info;
+				info.m_flags = infos[i].flags;
+				info.m_edgeV0V1Angle = infos[i].edgeV0V1Angle;
+				info.m_edgeV1V2Angle = infos[i].edgeV1V2Angle;
+				info.m_edgeV2V0Angle = infos[i].edgeV2V0Angle;
+
+				data->triangleInfoMap->insert(btHashInt(infos[i].key), info);
+			}
+		}
+
+		return data;
+	}
+}
@@ -1,5 +1,17 @@
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
 #include "BulletCollision/CollisionDispatch/btInternalEdgeUtility.h"
+#include "BulletCollision/BroadphaseCollision/btDbvtBroadphase.h"
+#if BT_THREADSAFE
+#include "LinearMath/btThreads.h"
+#include "LinearMath/btGeometryUtil.h"
+#include "BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h"
+#include "BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h"
+#endif
 #include "glm/glm.hpp"
 
 #include "spdlog/spdlog.h"
@@ -12,23 +24,97 @@
 #include "vel/ConvexCastCallback.h"
 #include "vel/CustomTriangleMesh.h"
 #include "vel/SimpleCollisionCallback.h"
+#include "vel/ThreadPool.h"
+#include "vel/ActorMotionState.h"
+#include "vel/UniformGridBroadphase.h"
 
 
 
 namespace vel
 {
-	CollisionWorld::CollisionWorld(const std::string& name, float gravity) :
+	// bullet's task scheduler is process wide, the first multithreaded world installs the default one and it then
+	// lives as long as the process
+	static bool useBulletTaskScheduler()
+	{
+#if BT_THREADSAFE
+		static const bool ready = []() {
+			btITaskScheduler* scheduler = btCreateDefaultTaskScheduler();
+			if (!scheduler)
+				return false;
+
+			btSetTaskScheduler(scheduler);
+			SPDLOG_DEBUG("CollisionWorld: using bullet task scheduler {} with {} threads", scheduler->getName(), scheduler->getNumThreads());
+			return true;
+		}();
+
+		return ready;
+#else
+		return false;
+#endif
+	}
+
+	static btBroadphaseInterface* createBroadphase(const BroadphaseOptions& options)
+	{
+		switch (options.type)
+		{
+		case BroadphaseType::AXIS_SWEEP:
+			if (options.maxHandles > 16384)
+				return new bt32BitAxisSweep3(options.worldMin, options.worldMax, options.maxHandles);
+
+			return new btAxisSweep3(options.worldMin, options.worldMax, (unsigned short)options.maxHandles);
+
+		case BroadphaseType::UNIFORM_GRID:
+			return new UniformGridBroadphase(options.cellSize, options.maxCellsPerProxy);
+
+		default:
+			return new btDbvtBroadphase();
+		}
+	}
+
+	CollisionWorld::CollisionWorld(const std::string& name, float gravity, bool multithreaded, BroadphaseOptions broadphase) :
 		name(name),
 		isActive(true),
-		collisionConfiguration(new btDefaultCollisionConfiguration()),
-		dispatcher(new btCollisionDispatcher(collisionConfiguration)),
-		overlappingPairCache(new btDbvtBroadphase()),
-		solver(new btSequentialImpulseConstraintSolver),
-		dynamicsWorld(new btDiscreteDynamicsWorld(dispatcher, overlappingPairCache, solver, collisionConfiguration)),
+		isMultithreaded(false),
+		lastStepTime(0.0),
+		collisionConfiguration(nullptr),
+		dispatcher(nullptr),
+		overlappingPairCache(createBroadphase(broadphase)),
+		solver(nullptr),
+		dynamicsWorld(nullptr),
 		camera(nullptr),
 		collisionDebugDrawer(nullptr)
 	{
-		this->dynamicsWorld->getPairCache()->setInternalGhostPairCallback(new btGhostPairCallback());
+		if (multithreaded && !useBulletTaskScheduler())
+			SPDLOG_DEBUG("CollisionWorld: {} requested multithreading but bullet was not built with BT_THREADSAFE, using a single thread", name);
+
+#if BT_THREADSAFE
+		if (multithreaded && useBulletTaskScheduler())
+		{
+			// the per thread pools are shared by every thread that may add manifolds / algorithms, size them up front
+			btDefaultCollisionConstructionInfo cci;
+			cci.m_defaultMaxPersistentManifoldPoolSize = 80000;
+			cci.m_defaultMaxCollisionAlgorithmPoolSize = 80000;
+
+			this->collisionConfiguration = new btDefaultCollisionConfiguration(cci);
+			this->dispatcher = new btCollisionDispatcherMt(this->collisionConfiguration);
+			this->solver = new btConstraintSolverPoolMt(BT_MAX_THREAD_COUNT);
+			this->dynamicsWorld = new btDiscreteDynamicsWorldMt(this->dispatcher, this->overlappingPairCache,
+				static_cast<btConstraintSolverPoolMt*>(this->solver), nullptr, this->collisionConfiguration);
+			this->isMultithreaded = true;
+		}
+#endif
+
+		if (!this->dynamicsWorld)
+		{
+			this->collisionConfiguration = new btDefaultCollisionConfiguration();
+			this->dispatcher = new btCollisionDispatcher(this->collisionConfiguration);
+			this->solver = new btSequentialImpulseConstraintSolver();
+			this->dynamicsWorld = new btDiscreteDynamicsWorld(this->dispatcher, this->overlappingPairCache, this->solver, this->collisionConfiguration);
+		}
+
+		// forwards to btGhostPairCallback for ghost objects
+		this->triggerSystem = std::make_unique<TriggerSystem>();
+		this->dynamicsWorld->getPairCache()->setInternalGhostPairCallback(this->triggerSystem.get());
 		
 		btVector3 gravityVec(0.0f, gravity, 0.0f);
 		this->dynamicsWorld->setGravity(gravityVec);
@@ -61,6 +147,17 @@ namespace vel
 			delete shape;
 		}
 
+		for (auto& is : this->instancedShapes)
+		{
+			delete is.first;
+			delete is.second.triangleMesh;
+		}
+		this->instancedShapes.clear();
+		this->instancedShapeLookup.clear();
+
+		// cached bvhs / edge info the shapes pointed into
+		this->collisionCacheData.clear();
+
 		//delete dynamics world
 		delete this->dynamicsWorld;
 
@@ -82,11 +179,75 @@ namespace vel
 	void CollisionWorld::removeCollisionShape(const std::string& name)
 	{
 		auto it = this->collisionShapes.find(name);
-		if (it != this->collisionShapes.end())
+		if (it == this->collisionShapes.end())
+			return;
+
+		btCollisionShape* shape = it->second;
+		this->collisionShapes.erase(it);
+
+		// children registered alongside the compound as <name>_<i>, see convexCollisionShapeFromMesh
+		if (shape->isCompound())
 		{
-			delete it->second;
-			this->collisionShapes.erase(it);
+			btCompoundShape* compound = static_cast<btCompoundShape*>(shape);
+			for (int i = 0; i < compound->getNumChildShapes(); i++)
+			{
+				auto child = this->collisionShapes.find(name + "_" + std::to_string(i));
+				if (child != this->collisionShapes.end() && child->second == compound->getChildShape(i))
+					this->removeCollisionShape(child->first);
+			}
 		}
+
+		delete shape;
+		this->collisionCacheData.erase(shape);
+	}
+
+	void CollisionWorld::setCollisionCacheDirectory(const std::string& directory)
+	{
+		this->collisionCacheDirectory = directory;
+	}
+
+	const std::string& CollisionWorld::getCollisionCacheDirectory()
+	{
+		return this->collisionCacheDirectory;
+	}
+
+	void CollisionWorld::stepSimulation(float delta)
+	{
+		auto start = std::chrono::steady_clock::now();
+
+		this->dynamicsWorld->stepSimulation(delta, 0);
+
+		this->lastStepTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		this->syncActorTransforms();
+
+		if (this->contactEvents)
+			this->contactEvents->update(this->dispatcher);
+
+		this->triggerSystem->update();
+	}
+
+	void CollisionWorld::queueActorSync(ActorMotionState* ms)
+	{
+		this->actorSyncQueue.push_back(ms);
+	}
+
+	void CollisionWorld::syncActorTransforms()
+	{
+		for (auto ms : this->actorSyncQueue)
+			ms->sync();
+
+		this->actorSyncQueue.clear();
+	}
+
+	double CollisionWorld::getLastStepTime() const
+	{
+		return this->lastStepTime;
+	}
+
+	bool CollisionWorld::getIsMultithreaded() const
+	{
+		return this->isMultithreaded;
 	}
 
 	const std::string& CollisionWorld::getName()
@@ -143,8 +304,75 @@ namespace vel
 		return this->collisionDebugDrawer != nullptr;
 	}
 
+	void CollisionWorld::enableContactEvents(size_t capacity, bool reportStay)
+	{
+		this->contactEvents = std::make_unique<ContactEventStream>(capacity, reportStay);
+	}
+
+	void CollisionWorld::disableContactEvents()
+	{
+		this->contactEvents.reset();
+	}
+
+	ContactEventStream* CollisionWorld::getContactEvents()
+	{
+		return this->contactEvents.get();
+	}
+
+	btCollisionObject* CollisionWorld::addTrigger(btCollisionShape* shape, const btTransform& transform, int collisionFilterGroup, int collisionFilterMask, Actor* actor)
+	{
+		btCollisionObject* trigger = new btCollisionObject();
+		trigger->setCollisionShape(shape);
+		trigger->setWorldTransform(transform);
+		trigger->setUserPointer(actor);
+		trigger->setCollisionFlags(trigger->getCollisionFlags() | btCollisionObject::CF_NO_CONTACT_RESPONSE);
+
+		this->triggerSystem->addTrigger(trigger, actor);
+		this->dynamicsWorld->addCollisionObject(trigger, collisionFilterGroup, collisionFilterMask);
+
+		return trigger;
+	}
+
+	void CollisionWorld::setTriggerTransform(btCollisionObject* trigger, const btTransform& transform)
+	{
+		trigger->setWorldTransform(transform);
+		this->dynamicsWorld->updateSingleAabb(trigger);
+	}
+
+	void CollisionWorld::removeTrigger(btCollisionObject* trigger)
+	{
+		if (this->contactEvents)
+			this->contactEvents->removeObject(trigger);
+
+		this->dynamicsWorld->removeCollisionObject(trigger);
+		this->triggerSystem->removeTrigger(trigger);
+
+		delete trigger;
+	}
+
+	TriggerSystem* CollisionWorld::getTriggerSystem()
+	{
+		return this->triggerSystem.get();
+	}
+
+	Actor* CollisionWorld::actorFromCollisionObject(const btCollisionObject* co)
+	{
+		if (co->getUserPointer())
+			return static_cast<Actor*>(co->getUserPointer());
+
+		const btRigidBody* rb = btRigidBody::upcast(co);
+		if (rb && rb->getMotionState())
+			if (auto ms = dynamic_cast<ActorMotionState*>(const_cast<btMotionState*>(rb->getMotionState())))
+				return ms->getActor();
+
+		return nullptr;
+	}
+
 	void CollisionWorld::removeGhostObject(btPairCachingGhostObject* go)
 	{
+		if (this->contactEvents)
+			this->contactEvents->removeObject(go);
+
 		this->dynamicsWorld->removeCollisionObject(go);
 		delete go;
 	}
@@ -152,11 +380,25 @@ namespace vel
 	void CollisionWorld::removeRigidBody(btRigidBody* rb)
 	{
 		if (rb->getMotionState())
-			delete rb->getMotionState();
+		{
+			// only non empty if the world was stepped without going through stepSimulation()
+			btMotionState* ms = rb->getMotionState();
+			this->actorSyncQueue.erase(std::remove_if(this->actorSyncQueue.begin(), this->actorSyncQueue.end(),
+				[ms](ActorMotionState* q) { return static_cast<btMotionState*>(q) == ms; }), this->actorSyncQueue.end());
+
+			delete ms;
+		}
+
+		btCollisionShape* shape = rb->getCollisionShape();
+
+		if (this->contactEvents)
+			this->contactEvents->removeObject(rb);
 
 		this->dynamicsWorld->removeCollisionObject(rb);
 
 		delete rb;
+
+		this->releaseInstancedCollisionShape(shape);
 	}
 
 	bool CollisionWorld::contactAddedCallback(btManifoldPoint& cp, const btCollisionObjectWrapper* colObj0Wrap, int partId0, int index0, const btCollisionObjectWrapper* colObj1Wrap, int partId1, int index1)
@@ -181,6 +423,70 @@ namespace vel
 	}
 
 
+	btBvhTriangleMeshShape* CollisionWorld::bvhShapeFromTriangleMesh(btTriangleMesh* triangleMesh, const std::string& debugName)
+	{
+		btBvhTriangleMeshShape* bvhShape = nullptr;
+		std::unique_ptr<CollisionCacheData> cached;
+		uint64_t contentHash = 0;
+		std::string cachePath;
+
+		if (!this->collisionCacheDirectory.empty())
+		{
+			contentHash = CollisionCache::contentHash(triangleMesh);
+			cachePath = CollisionCache::getCachePath(this->collisionCacheDirectory, contentHash);
+			cached = CollisionCache::load(cachePath, contentHash);
+		}
+
+		if (cached)
+		{
+			bvhShape = new btBvhTriangleMeshShape(triangleMesh, true, false);
+			bvhShape->setOptimizedBvh(cached->bvh);
+
+			if (cached->triangleInfoMap)
+				bvhShape->setTriangleInfoMap(cached->triangleInfoMap.get());
+		}
+		else
+		{
+			bvhShape = new btBvhTriangleMeshShape(triangleMesh, true);
+
+			// still recorded without a cache directory, it owns the internal edge info once generated
+			cached = std::make_unique<CollisionCacheData>();
+			cached->contentHash = contentHash;
+			cached->bvh = bvhShape->getOptimizedBvh();
+
+			if (!cachePath.empty() && !CollisionCache::write(cachePath, contentHash, cached->bvh, nullptr))
+				SPDLOG_DEBUG("CollisionWorld::bvhShapeFromTriangleMesh: unable to write collision cache for {}", debugName);
+		}
+
+		this->collisionCacheData[bvhShape] = std::move(cached);
+
+		return bvhShape;
+	}
+
+	void CollisionWorld::generateInternalEdgeInfo(btBvhTriangleMeshShape* bvhShape, const std::string& debugName)
+	{
+		if (bvhShape->getTriangleInfoMap())
+			return;
+
+		btTriangleInfoMap* triangleInfoMap = new btTriangleInfoMap();
+		btGenerateInternalEdgeInfo(bvhShape, triangleInfoMap);
+
+		auto cached = this->collisionCacheData.find(bvhShape);
+		if (cached == this->collisionCacheData.end())
+			return;
+
+		cached->second->triangleInfoMap.reset(triangleInfoMap);
+
+		// complete the cache written by bvhShapeFromTriangleMesh so the next load skips this as well, shapes built
+		// while no cache directory was set have no hash to write under
+		if (this->collisionCacheDirectory.empty() || cached->second->contentHash == 0)
+			return;
+
+		std::string cachePath = CollisionCache::getCachePath(this->collisionCacheDirectory, cached->second->contentHash);
+		if (!CollisionCache::write(cachePath, cached->second->contentHash, cached->second->bvh, triangleInfoMap))
+			SPDLOG_DEBUG("CollisionWorld::generateInternalEdgeInfo: unable to write collision cache for {}", debugName);
+	}
+
 	btCollisionShape* CollisionWorld::collisionShapeFromActor(Actor* actor, bool applyTransform)
 	{
 		if (actor->getMesh() == nullptr)
@@ -216,7 +522,9 @@ namespace vel
 			mergedTriangleMesh->addTriangle(p0, p1, p2);
 		}
 
-		btBvhTriangleMeshShape* bvhShape = new btBvhTriangleMeshShape(mergedTriangleMesh, true);
+		// the hash covers the transformed triangles, so the same mesh placed differently gets its own cache
+		btBvhTriangleMeshShape* bvhShape = this->bvhShapeFromTriangleMesh(mergedTriangleMesh, actor->getName());
+
 		bvhShape->setMargin(0);
 		btCollisionShape* staticCollisionShape = bvhShape;
 		this->collisionShapes[actor->getName() + "_shape"] = staticCollisionShape;
@@ -289,6 +597,257 @@ namespace vel
 	//	return staticCollisionShape;
 	//}
 
+	btCollisionShape* CollisionWorld::acquireInstancedCollisionShape(Mesh* mesh, const glm::vec3& scale)
+	{
+		InstancedCollisionShapeKey key;
+		key.mesh = mesh;
+		for (int i = 0; i < 3; i++)
+			key.scale[i] = (int32_t)std::lround(scale[i] * 10000.0f);
+
+		const bool unitScale = key.scale[0] == 10000 && key.scale[1] == 10000 && key.scale[2] == 10000;
+
+		auto found = this->instancedShapeLookup.find(key);
+		if (found != this->instancedShapeLookup.end())
+		{
+			this->instancedShapes.at(found->second).references++;
+			return found->second;
+		}
+
+		InstancedCollisionShape instance;
+		instance.key = key;
+		instance.triangleMesh = nullptr;
+		instance.base = nullptr;
+		instance.references = 1;
+
+		btCollisionShape* shape = nullptr;
+
+		if (unitScale)
+		{
+			const std::vector<Vertex>& vertices = mesh->getVertices();
+			const std::vector<unsigned int>& indices = mesh->getIndices();
+
+			instance.triangleMesh = new btTriangleMesh();
+			for (size_t i = 0; i + 2 < indices.size(); i += 3)
+			{
+				instance.triangleMesh->addTriangle(
+					glmToBulletVec3(vertices[indices[i]].position),
+					glmToBulletVec3(vertices[indices[i + 1]].position),
+					glmToBulletVec3(vertices[indices[i + 2]].position)
+				);
+			}
+
+			// mesh space triangles hash the same wherever the mesh is placed, so instances share a cache entry too
+			btBvhTriangleMeshShape* bvhShape = this->bvhShapeFromTriangleMesh(instance.triangleMesh, mesh->getName());
+			bvhShape->setMargin(0);
+			this->generateInternalEdgeInfo(bvhShape, mesh->getName());
+
+			shape = bvhShape;
+		}
+		else
+		{
+			instance.base = this->acquireInstancedCollisionShape(mesh, glm::vec3(1.0f));
+			shape = new btScaledBvhTriangleMeshShape(static_cast<btBvhTriangleMeshShape*>(instance.base), glmToBulletVec3(scale));
+		}
+
+		this->instancedShapes[shape] = instance;
+		this->instancedShapeLookup[key] = shape;
+
+		return shape;
+	}
+
+	btCollisionShape* CollisionWorld::instancedCollisionShapeFromActor(Actor* actor, btTransform& worldTransform)
+	{
+		Mesh* mesh = actor->getMesh();
+		if (mesh == nullptr)
+			return nullptr;
+
+		// the body takes the world matrix's rigid part, the shape its scale
+		glm::vec3 scale;
+		worldTransform = glmMat4ToBulletRigidTransform(actor->getWorldMatrix(), scale);
+
+		return this->acquireInstancedCollisionShape(mesh, scale);
+	}
+
+	void CollisionWorld::forgetInstancedMesh(const Mesh* m)
+	{
+		for (auto it = this->instancedShapeLookup.begin(); it != this->instancedShapeLookup.end();)
+		{
+			if (it->first.mesh == m)
+				it = this->instancedShapeLookup.erase(it);
+			else
+				it++;
+		}
+	}
+
+	void CollisionWorld::releaseInstancedCollisionShape(btCollisionShape* shape)
+	{
+		auto it = this->instancedShapes.find(shape);
+		if (it == this->instancedShapes.end() || --it->second.references > 0)
+			return;
+
+		auto lookup = this->instancedShapeLookup.find(it->second.key);
+		if (lookup != this->instancedShapeLookup.end() && lookup->second == shape)
+			this->instancedShapeLookup.erase(lookup);
+
+		btTriangleMesh* triangleMesh = it->second.triangleMesh;
+		btCollisionShape* base = it->second.base;
+		this->instancedShapes.erase(it);
+
+		delete shape;
+		this->collisionCacheData.erase(shape);
+		delete triangleMesh;
+
+		if (base)
+			this->releaseInstancedCollisionShape(base);
+	}
+
+	btRigidBody* CollisionWorld::addInstancedStaticCollisionBody(Actor* actor, int collisionFilterGroup, int collisionFilterMask)
+	{
+		btTransform worldTransform;
+		btCollisionShape* shape = this->instancedCollisionShapeFromActor(actor, worldTransform);
+		if (!shape)
+		{
+			SPDLOG_DEBUG("CollisionWorld::addInstancedStaticCollisionBody: {} has no mesh", actor->getName());
+			return nullptr;
+		}
+
+		btDefaultMotionState* defaultMotionState = new btDefaultMotionState(worldTransform);
+		btRigidBody::btRigidBodyConstructionInfo rbInfo(btScalar(0), defaultMotionState, shape, btVector3(0, 0, 0));
+		btRigidBody* body = new btRigidBody(rbInfo);
+		body->setUserPointer(actor);
+
+		// internal edge info lives on the shared mesh space shape, see addStaticCollisionBody
+		gContactAddedCallback = &CollisionWorld::contactAddedCallback;
+		body->setCollisionFlags(body->getCollisionFlags() | btCollisionObject::CF_CUSTOM_MATERIAL_CALLBACK);
+
+		this->dynamicsWorld->addRigidBody(body, collisionFilterGroup, collisionFilterMask);
+
+		return body;
+	}
+
+	std::string CollisionWorld::convexCollisionShapeName(const Mesh* mesh, const ConvexDecompositionParams& params)
+	{
+		// every parameter, so that decompositions of one mesh with different params never share an entry
+		char suffix[96];
+		std::snprintf(suffix, sizeof(suffix), "_convex_%d_%d_%g_%d", params.maxHulls, params.maxHullVertices, params.maxConcavity, params.maxDepth);
+
+		return mesh->getName() + suffix;
+	}
+
+	btCollisionShape* CollisionWorld::convexCollisionShapeFromMesh(Mesh* mesh, const ConvexDecompositionParams& params)
+	{
+		if (mesh == nullptr)
+			return nullptr;
+
+		const std::string shapeName = CollisionWorld::convexCollisionShapeName(mesh, params);
+
+		auto existing = this->collisionShapes.find(shapeName);
+		if (existing != this->collisionShapes.end())
+			return existing->second;
+
+		std::vector<glm::vec3> positions;
+		positions.reserve(mesh->getVertices().size());
+		for (auto& vert : mesh->getVertices())
+			positions.push_back(vert.position);
+
+		const std::vector<unsigned int>& indices = mesh->getIndices();
+
+		std::vector<std::vector<glm::vec3>> hulls;
+		std::string cachePath;
+
+		if (!this->collisionCacheDirectory.empty())
+		{
+			uint64_t contentHash = ConvexDecomposition::contentHash(positions, indices, params);
+			cachePath = ConvexDecomposition::getCachePath(this->collisionCacheDirectory, contentHash);
+
+			if (!ConvexDecomposition::load(cachePath, contentHash, hulls))
+			{
+				hulls = ConvexDecomposition::decompose(positions, indices, params);
+
+				if (!hulls.empty() && !ConvexDecomposition::write(cachePath, contentHash, hulls))
+					SPDLOG_DEBUG("CollisionWorld::convexCollisionShapeFromMesh: unable to write convex decomposition cache for {}", mesh->getName());
+			}
+		}
+		else
+		{
+			hulls = ConvexDecomposition::decompose(positions, indices, params);
+		}
+
+		if (hulls.empty())
+		{
+			SPDLOG_DEBUG("CollisionWorld::convexCollisionShapeFromMesh: unable to decompose {}", mesh->getName());
+			return nullptr;
+		}
+
+		std::vector<btConvexHullShape*> hullShapes;
+		for (auto& hull : hulls)
+		{
+			btAlignedObjectArray<btVector3> points;
+			for (auto& p : hull)
+				points.push_back(glmToBulletVec3(p));
+
+			// hull points lie on the mesh's surface already, so the hull is shrunk by bullet's default margin (which gjk /
+			// epa need to stay reliable) rather than the margin being zeroed, and bodies still rest on the surface. Parts
+			// thinner than twice the margin collapse when shrunk and keep their points, resting a margin off it
+			btConvexHullShape* hullShape = new btConvexHullShape();
+			const btScalar margin = hullShape->getMargin();
+
+			btAlignedObjectArray<btVector3> planes;
+			btGeometryUtil::getPlaneEquationsFromVertices(points, planes);
+			for (int i = 0; i < planes.size(); i++)
+				planes[i][3] += margin;
+
+			btAlignedObjectArray<btVector3> shrunkPoints;
+			btGeometryUtil::getVerticesFromPlaneEquations(planes, shrunkPoints);
+
+			const btAlignedObjectArray<btVector3>& hullPoints = shrunkPoints.size() >= 4 ? shrunkPoints : points;
+			for (int i = 0; i < hullPoints.size(); i++)
+				hullShape->addPoint(hullPoints[i], false);
+
+			hullShape->recalcLocalAabb();
+
+			hullShapes.push_back(hullShape);
+		}
+
+		btCollisionShape* shape = nullptr;
+
+		if (hullShapes.size() == 1)
+		{
+			shape = hullShapes[0];
+		}
+		else
+		{
+			btCompoundShape* compound = new btCompoundShape(true, (int)hullShapes.size());
+
+			btTransform identity;
+			identity.setIdentity();
+
+			for (size_t i = 0; i < hullShapes.size(); i++)
+			{
+				compound->addChildShape(identity, hullShapes[i]);
+				this->collisionShapes[shapeName + "_" + std::to_string(i)] = hullShapes[i];
+			}
+
+			shape = compound;
+		}
+
+		this->collisionShapes[shapeName] = shape;
+
+		return shape;
+	}
+
+	bool CollisionWorld::addConvexCollisionObjectTemplate(std::string name, Mesh* mesh, CollisionObjectTemplate cot, const ConvexDecompositionParams& params)
+	{
+		btCollisionShape* shape = this->convexCollisionShapeFromMesh(mesh, params);
+		if (!shape)
+			return false;
+
+		cot.collisionShape = shape;
+		this->addCollisionObjectTemplate(name, cot);
+
+		return true;
+	}
+
 	btRigidBody* CollisionWorld::addStaticCollisionBody(Actor* actor, int collisionFilterGroup, int collisionFilterMask)
 	{
 		auto staticCollisionShape = this->collisionShapeFromActor(actor);
@@ -298,26 +857,21 @@ namespace vel
 		btDefaultMotionState* defaultMotionState = new btDefaultMotionState();
 		btRigidBody::btRigidBodyConstructionInfo rbInfo(mass, defaultMotionState, staticCollisionShape, localInertia);
 		btRigidBody* body = new btRigidBody(rbInfo);
+		body->setUserPointer(actor);
 
 		///////// added below to handle jitter when objects sliding across faces
 		// https://stackoverflow.com/questions/25605659/avoid-ground-collision-with-bullet/25725502#25725502
 		gContactAddedCallback = &CollisionWorld::contactAddedCallback;
 		body->setCollisionFlags(body->getCollisionFlags() | btCollisionObject::CF_CUSTOM_MATERIAL_CALLBACK);
-		btTriangleInfoMap* triangleInfoMap = new btTriangleInfoMap();
-		btGenerateInternalEdgeInfo((btBvhTriangleMeshShape*)staticCollisionShape, triangleInfoMap);
+		this->generateInternalEdgeInfo((btBvhTriangleMeshShape*)staticCollisionShape, actor->getName());
 
 		this->dynamicsWorld->addRigidBody(body, collisionFilterGroup, collisionFilterMask);
 
 		return body;
 	}
 
-	std::optional<RaycastResult> CollisionWorld::rayTest(btVector3 from, btVector3 to, int collisionFilterMask, std::vector<btCollisionObject*> blackList)
+	static std::optional<RaycastResult> raycastResult(const RaycastCallback& raycast, const btVector3& from)
 	{
-		RaycastCallback raycast = RaycastCallback(from, to, blackList);
-		raycast.m_collisionFilterGroup = 1;
-		raycast.m_collisionFilterMask = collisionFilterMask;
-		this->dynamicsWorld->rayTest(from, to, raycast);
-
 		if (!raycast.hasHit() || !raycast.m_collisionObject)
 			return {};
 
@@ -332,6 +886,126 @@ namespace vel
 		return r;
 	}
 
+	// narrow phase for every dbvt leaf a batched ray passes through, what btCollisionWorld::rayTest does internally
+	// but without the broadphase's shared traversal stack, so that many can run at once
+	struct BatchRayCollider : btDbvt::ICollide
+	{
+		btTransform			rayFromTrans;
+		btTransform			rayToTrans;
+		RaycastCallback*	raycast;
+
+		void Process(const btDbvtNode* leaf)
+		{
+			btBroadphaseProxy* proxy = static_cast<btBroadphaseProxy*>(leaf->data);
+
+			if (this->raycast->m_closestHitFraction == btScalar(0.f) || !this->raycast->needsCollision(proxy))
+				return;
+
+			btCollisionObject* co = static_cast<btCollisionObject*>(proxy->m_clientObject);
+			btCollisionWorld::rayTestSingle(this->rayFromTrans, this->rayToTrans, co, co->getCollisionShape(), co->getWorldTransform(), *this->raycast);
+		}
+	};
+
+	std::optional<RaycastResult> CollisionWorld::rayTest(btVector3 from, btVector3 to, int collisionFilterMask, std::vector<btCollisionObject*> blackList)
+	{
+		RaycastCallback raycast(from, to, std::move(blackList));
+		raycast.m_collisionFilterGroup = 1;
+		raycast.m_collisionFilterMask = collisionFilterMask;
+		this->dynamicsWorld->rayTest(from, to, raycast);
+
+		return raycastResult(raycast, from);
+	}
+
+	void CollisionWorld::rayTestBatch(const RaycastRequest* rays, size_t count, std::optional<RaycastResult>* results, ThreadPool* pool, std::vector<btCollisionObject*> blackList)
+	{
+		if (count == 0)
+			return;
+
+		std::sort(blackList.begin(), blackList.end());
+
+		// btDbvtBroadphase::rayTest shares one traversal stack between all callers, btDbvt::rayTest allocates its own.
+		// UniformGridBroadphase holds no query state, so the world's own rayTest can run concurrently on it. Either way
+		// rayTestSingle and the compound shape narrowphase open BT_PROFILE samples, which are only safe to enter from
+		// several threads at once when bullet is built with BT_THREADSAFE
+		btDbvtBroadphase* dbvt = dynamic_cast<btDbvtBroadphase*>(this->overlappingPairCache);
+#if BT_THREADSAFE
+		const bool reentrant = dbvt || dynamic_cast<UniformGridBroadphase*>(this->overlappingPairCache);
+#else
+		const bool reentrant = false;
+#endif
+
+		auto castRange = [this, rays, results, dbvt, &blackList](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++)
+			{
+				const RaycastRequest& ray = rays[i];
+
+				RaycastCallback raycast(ray.from, ray.to, &blackList);
+				raycast.m_collisionFilterGroup = 1;
+				raycast.m_collisionFilterMask = ray.collisionFilterMask;
+
+				if (dbvt)
+				{
+					BatchRayCollider collider;
+					collider.rayFromTrans.setIdentity();
+					collider.rayFromTrans.setOrigin(ray.from);
+					collider.rayToTrans.setIdentity();
+					collider.rayToTrans.setOrigin(ray.to);
+					collider.raycast = &raycast;
+
+					// dynamic and static sets
+					btDbvt::rayTest(dbvt->m_sets[0].m_root, ray.from, ray.to, collider);
+					btDbvt::rayTest(dbvt->m_sets[1].m_root, ray.from, ray.to, collider);
+				}
+				else
+				{
+					this->dynamicsWorld->rayTest(ray.from, ray.to, raycast);
+				}
+
+				results[i] = raycastResult(raycast, ray.from);
+			}
+		};
+
+		// other broadphases (and builds without BT_THREADSAFE) give no such guarantee, so are only queried from one thread
+		if (pool && reentrant)
+			pool->parallelFor(count, 64, castRange);
+		else
+			castRange(0, count);
+	}
+
+	static std::optional<ConvexCastResult> convexCastResult(const ConvexCastCallback& convexCast)
+	{
+		if (!convexCast.hasHit() || !convexCast.m_hitCollisionObject)
+			return {};
+
+		ConvexCastResult ccr;
+		ccr.collisionObject = convexCast.m_hitCollisionObject;
+		ccr.hitpoint = convexCast.m_hitPointWorld;
+		ccr.normal = convexCast.m_hitNormalWorld.normalized();
+		ccr.normalUpDot = ccr.normal.dot(btVector3(0, 1, 0));
+
+		return ccr;
+	}
+
+	// BatchRayCollider for sweeps, leaves come from the swept aabb of the cast shape
+	struct BatchSweepCollider : btDbvt::ICollide
+	{
+		const btConvexShape*	castShape;
+		btTransform				convexFromTrans;
+		btTransform				convexToTrans;
+		ConvexCastCallback*		convexCast;
+
+		void Process(const btDbvtNode* leaf)
+		{
+			btBroadphaseProxy* proxy = static_cast<btBroadphaseProxy*>(leaf->data);
+
+			if (this->convexCast->m_closestHitFraction == btScalar(0.f) || !this->convexCast->needsCollision(proxy))
+				return;
+
+			btCollisionObject* co = static_cast<btCollisionObject*>(proxy->m_clientObject);
+			btCollisionWorld::objectQuerySingle(this->castShape, this->convexFromTrans, this->convexToTrans, co, co->getCollisionShape(), co->getWorldTransform(), *this->convexCast, btScalar(0.f));
+		}
+	};
+
 	std::optional<ConvexCastResult> CollisionWorld::convexSweepTest(btConvexShape* castShape, btVector3 from, btVector3 to, int collisionFilterMask, std::vector<btCollisionObject*> blackList)
 	{
 		btTransform convexFromWorld;
@@ -342,22 +1016,73 @@ namespace vel
 		convexToWorld.setIdentity();
 		convexToWorld.setOrigin(to);
 
-		ConvexCastCallback convexCast(from, to, blackList);
+		ConvexCastCallback convexCast(from, to, std::move(blackList));
 		convexCast.m_collisionFilterGroup = 1;
 		convexCast.m_collisionFilterMask = collisionFilterMask;
 
 		this->dynamicsWorld->convexSweepTest(castShape, convexFromWorld, convexToWorld, convexCast);
 
-		if (!convexCast.hasHit() || !convexCast.m_hitCollisionObject)
-			return {};
+		return convexCastResult(convexCast);
+	}
 
-		ConvexCastResult ccr;
-		ccr.collisionObject = convexCast.m_hitCollisionObject;
-		ccr.hitpoint = convexCast.m_hitPointWorld;
-		ccr.normal = convexCast.m_hitNormalWorld.normalized();
-		ccr.normalUpDot = ccr.normal.dot(btVector3(0, 1, 0));
-		
-		return ccr;
+	void CollisionWorld::convexSweepTestBatch(const ConvexCastRequest* sweeps, size_t count, std::optional<ConvexCastResult>* results, ThreadPool* pool, std::vector<btCollisionObject*> blackList)
+	{
+		if (count == 0)
+			return;
+
+		std::sort(blackList.begin(), blackList.end());
+
+		// same broadphases as rayTestBatch. objectQuerySingle and the compound shape narrowphase open BT_PROFILE samples,
+		// so sweeps only run concurrently when bullet is built with BT_THREADSAFE
+		btDbvtBroadphase* dbvt = dynamic_cast<btDbvtBroadphase*>(this->overlappingPairCache);
+#if BT_THREADSAFE
+		const bool reentrant = dbvt || dynamic_cast<UniformGridBroadphase*>(this->overlappingPairCache);
+#else
+		const bool reentrant = false;
+#endif
+
+		auto sweepRange = [this, sweeps, results, dbvt, &blackList](size_t begin, size_t end) {
+			BatchSweepCollider collider;
+			collider.convexFromTrans.setIdentity();
+			collider.convexToTrans.setIdentity();
+
+			for (size_t i = begin; i < end; i++)
+			{
+				const ConvexCastRequest& sweep = sweeps[i];
+
+				ConvexCastCallback convexCast(sweep.from, sweep.to, &blackList);
+				convexCast.m_collisionFilterGroup = 1;
+				convexCast.m_collisionFilterMask = sweep.collisionFilterMask;
+
+				collider.castShape = sweep.castShape;
+				collider.convexFromTrans.setOrigin(sweep.from);
+				collider.convexToTrans.setOrigin(sweep.to);
+				collider.convexCast = &convexCast;
+
+				if (dbvt)
+				{
+					// btDbvt::collideTV keeps its stack local, unlike the broadphase's own ray / sweep traversal
+					btVector3 aabbMin, aabbMax;
+					sweep.castShape->calculateTemporalAabb(collider.convexFromTrans, sweep.to - sweep.from, btVector3(0, 0, 0), btScalar(1.f), aabbMin, aabbMax);
+					btDbvtVolume sweptVolume = btDbvtVolume::FromMM(aabbMin, aabbMax);
+
+					dbvt->m_sets[0].collideTV(dbvt->m_sets[0].m_root, sweptVolume, collider);
+					dbvt->m_sets[1].collideTV(dbvt->m_sets[1].m_root, sweptVolume, collider);
+				}
+				else
+				{
+					this->dynamicsWorld->convexSweepTest(sweep.castShape, collider.convexFromTrans, collider.convexToTrans, convexCast);
+				}
+
+				results[i] = convexCastResult(convexCast);
+			}
+		};
+
+		// sweeps cost a lot more than rays, so they are handed out in smaller chunks
+		if (pool && reentrant)
+			pool->parallelFor(count, 16, sweepRange);
+		else
+			sweepRange(0, count);
 	}
 
 
@@ -0,0 +1,227 @@
+#include <algorithm>
+#include <functional>
+
+#include "spdlog/spdlog.h"
+
+#include "vel/ContactEventStream.h"
+#include "vel/CollisionWorld.h"
+
+
+namespace vel
+{
+	static bool pairLess(const btCollisionObject* a0, const btCollisionObject* b0, const btCollisionObject* a1, const btCollisionObject* b1)
+	{
+		std::less<const btCollisionObject*> less;
+
+		if (a0 != a1)
+			return less(a0, a1);
+
+		return less(b0, b1);
+	}
+
+	ContactEventStream::ContactEventStream(size_t capacity, bool reportStay) :
+		events(std::max<size_t>(capacity, 1)),
+		head(0),
+		count(0),
+		dropped(0),
+		reportStay(reportStay)
+	{}
+
+	void ContactEventStream::push(const ContactEvent& e)
+	{
+		if (this->count == this->events.size())
+		{
+			// overwrite the oldest
+			this->head = (this->head + 1) % this->events.size();
+			this->count--;
+			this->dropped++;
+		}
+
+		this->events[(this->head + this->count) % this->events.size()] = e;
+		this->count++;
+	}
+
+	void ContactEventStream::update(btDispatcher* dispatcher)
+	{
+		const size_t droppedBefore = this->dropped;
+
+		this->touching.clear();
+
+		const int manifoldCount = dispatcher->getNumManifolds();
+		for (int i = 0; i < manifoldCount; i++)
+		{
+			const btPersistentManifold* manifold = dispatcher->getManifoldByIndexInternal(i);
+
+			// manifolds outlive their contacts for as long as the bounds overlap
+			const int contactCount = manifold->getNumContacts();
+			if (contactCount == 0)
+				continue;
+
+			ContactEventCandidate candidate;
+			ContactEvent& e = candidate.event;
+			e.type = ContactEventType::STAY;
+			e.objectA = manifold->getBody0();
+			e.objectB = manifold->getBody1();
+			e.actorA = nullptr;
+			e.actorB = nullptr;
+			e.appliedImpulse = btScalar(0);
+			e.contactCount = contactCount;
+
+			int deepest = 0;
+			for (int c = 0; c < contactCount; c++)
+			{
+				const btManifoldPoint& point = manifold->getContactPoint(c);
+				e.appliedImpulse += point.getAppliedImpulse();
+
+				if (point.getDistance() < manifold->getContactPoint(deepest).getDistance())
+					deepest = c;
+			}
+
+			const btManifoldPoint& point = manifold->getContactPoint(deepest);
+			candidate.distance = point.getDistance();
+			e.positionWorldOnB = point.m_positionWorldOnB;
+			e.normalWorldOnB = point.m_normalWorldOnB;
+
+			if (std::less<const btCollisionObject*>()(e.objectB, e.objectA))
+			{
+				std::swap(e.objectA, e.objectB);
+				e.positionWorldOnB = point.m_positionWorldOnA;
+				e.normalWorldOnB = -point.m_normalWorldOnB;
+			}
+
+			this->touching.push_back(candidate);
+		}
+
+		std::sort(this->touching.begin(), this->touching.end(), [](const ContactEventCandidate& a, const ContactEventCandidate& b) {
+			return pairLess(a.event.objectA, a.event.objectB, b.event.objectA, b.event.objectB);
+		});
+
+		// compound and multi manifold algorithms can produce several manifolds for one pair, the merged event keeps
+		// the deepest point of all of them
+		size_t merged = 0;
+		for (size_t i = 0; i < this->touching.size(); i++)
+		{
+			const ContactEventCandidate& from = this->touching[i];
+
+			if (merged > 0 && this->touching[merged - 1].event.objectA == from.event.objectA && this->touching[merged - 1].event.objectB == from.event.objectB)
+			{
+				ContactEventCandidate& into = this->touching[merged - 1];
+				into.event.appliedImpulse += from.event.appliedImpulse;
+				into.event.contactCount += from.event.contactCount;
+
+				if (from.distance < into.distance)
+				{
+					into.distance = from.distance;
+					into.event.positionWorldOnB = from.event.positionWorldOnB;
+					into.event.normalWorldOnB = from.event.normalWorldOnB;
+				}
+
+				continue;
+			}
+
+			this->touching[merged++] = this->touching[i];
+		}
+		this->touching.resize(merged);
+
+		// diff against the previous step
+		this->current.clear();
+
+		size_t p = 0;
+		for (auto& candidate : this->touching)
+		{
+			ContactEvent& e = candidate.event;
+
+			while (p < this->previous.size() && pairLess(this->previous[p].objectA, this->previous[p].objectB, e.objectA, e.objectB))
+			{
+				const ContactEventPair& ended = this->previous[p++];
+				this->push({ ContactEventType::END, ended.objectA, ended.objectB, ended.actorA, ended.actorB, btVector3(0, 0, 0), btVector3(0, 0, 0), btScalar(0), 0 });
+			}
+
+			const bool continuing = p < this->previous.size() && this->previous[p].objectA == e.objectA && this->previous[p].objectB == e.objectB;
+			if (continuing)
+			{
+				e.type = ContactEventType::STAY;
+				e.actorA = this->previous[p].actorA;
+				e.actorB = this->previous[p].actorB;
+				p++;
+			}
+			else
+			{
+				e.type = ContactEventType::BEGIN;
+				e.actorA = CollisionWorld::actorFromCollisionObject(e.objectA);
+				e.actorB = CollisionWorld::actorFromCollisionObject(e.objectB);
+			}
+
+			this->current.push_back({ e.objectA, e.objectB, e.actorA, e.actorB });
+
+			if (!continuing || this->reportStay)
+				this->push(e);
+		}
+
+		for (; p < this->previous.size(); p++)
+		{
+			const ContactEventPair& ended = this->previous[p];
+			this->push({ ContactEventType::END, ended.objectA, ended.objectB, ended.actorA, ended.actorB, btVector3(0, 0, 0), btVector3(0, 0, 0), btScalar(0), 0 });
+		}
+
+		std::swap(this->previous, this->current);
+
+		if (this->dropped != droppedBefore)
+			SPDLOG_DEBUG("ContactEventStream::update: ring buffer full, dropped {} events", this->dropped - droppedBefore);
+	}
+
+	void ContactEventStream::removeObject(const btCollisionObject* co)
+	{
+		size_t kept = 0;
+		for (size_t i = 0; i < this->previous.size(); i++)
+		{
+			const ContactEventPair& pair = this->previous[i];
+
+			if (pair.objectA == co || pair.objectB == co)
+			{
+				this->push({ ContactEventType::END, pair.objectA, pair.objectB, pair.actorA, pair.actorB, btVector3(0, 0, 0), btVector3(0, 0, 0), btScalar(0), 0 });
+				continue;
+			}
+
+			this->previous[kept++] = pair;
+		}
+
+		this->previous.resize(kept);
+	}
+
+	size_t ContactEventStream::size() const
+	{
+		return this->count;
+	}
+
+	size_t ContactEventStream::getCapacity() const
+	{
+		return this->events.size();
+	}
+
+	size_t ContactEventStream::getDroppedCount() const
+	{
+		return this->dropped;
+	}
+
+	void ContactEventStream::clear()
+	{
+		this->head = 0;
+		this->count = 0;
+	}
+
+	size_t ContactEventStream::read(ContactEvent* out, size_t maxCount)
+	{
+		size_t n = std::min(maxCount, this->count);
+
+		for (size_t i = 0; i < n; i++)
+		{
+			out[i] = this->events[this->head];
+			this->head = (this->head + 1) % this->events.size();
+		}
+
+		this->count -= n;
+
+		return n;
+	}
+}
@@ -1,3 +1,4 @@
+#include <algorithm>
 
 #include "vel/ConvexCastCallback.h"
 
@@ -5,20 +6,31 @@ namespace vel
 {
 	ConvexCastCallback::ConvexCastCallback(btVector3 from, btVector3 to, std::vector<btCollisionObject*> blackList) :
 		btCollisionWorld::ClosestConvexResultCallback(from, to),
-		blackList(blackList)
+		ownedBlackList(std::move(blackList)),
+		blackList(&this->ownedBlackList)
+	{
+		std::sort(this->ownedBlackList.begin(), this->ownedBlackList.end());
+	}
+
+	ConvexCastCallback::ConvexCastCallback(btVector3 from, btVector3 to, const std::vector<btCollisionObject*>* sortedBlackList) :
+		btCollisionWorld::ClosestConvexResultCallback(from, to),
+		blackList(sortedBlackList)
 	{
 
 	}
 
-	btScalar ConvexCastCallback::addSingleResult(btCollisionWorld::LocalConvexResult& convexResult, bool normalInWorldSpace)
+	bool ConvexCastCallback::needsCollision(btBroadphaseProxy* proxy0) const
 	{
-		for (auto& co : this->blackList)
-		{
-			if (convexResult.m_hitCollisionObject == co)
-				return 1.0f;
-		}
+		if (!ClosestConvexResultCallback::needsCollision(proxy0))
+			return false;
 
+		return this->blackList->empty() ||
+			!std::binary_search(this->blackList->begin(), this->blackList->end(), static_cast<btCollisionObject*>(proxy0->m_clientObject));
+	}
+
+	btScalar ConvexCastCallback::addSingleResult(btCollisionWorld::LocalConvexResult& convexResult, bool normalInWorldSpace)
+	{
 		return ClosestConvexResultCallback::addSingleResult(convexResult, normalInWorldSpace);
 	}
 
-}
\ No newline at end of file
+}
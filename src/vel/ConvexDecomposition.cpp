@@ -0,0 +1,492 @@
+#include <algorithm>
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+
+#include "spdlog/spdlog.h"
+
+#include "vel/MappedFile.h"
+#include "vel/ConvexDecomposition.h"
+
+
+namespace vel
+{
+	static const char CONVEX_DECOMPOSITION_CACHE_MAGIC[8] = { 'V', 'E', 'L', 'H', 'U', 'L', 'L', '\0' };
+
+	// directions hulls are measured along while deciding where to split, more than the final hulls get
+	static const int CONCAVITY_DIRECTIONS = 128;
+
+	// triangles checked per part when measuring concavity, spread evenly over the part
+	static const size_t CONCAVITY_SAMPLES = 256;
+
+	static uint64_t alignTo16(uint64_t v)
+	{
+		return (v + 15) & ~uint64_t(15);
+	}
+
+	// fnv-1a over whole words
+	static void hashWord(uint64_t& h, uint64_t word)
+	{
+		h ^= word;
+		h *= 0x100000001b3ull;
+	}
+
+	static uint32_t floatBits(float f)
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &f, sizeof(bits));
+		return bits;
+	}
+
+	// the six axes first so hulls keep their bounding box, then evenly spread directions on a fibonacci sphere
+	static std::vector<glm::vec3> supportDirections(int count)
+	{
+		count = std::max(count, 6);
+
+		std::vector<glm::vec3> directions = {
+			glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f),
+			glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f),
+			glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 0.0f, -1.0f)
+		};
+
+		const int sphereCount = count - 6;
+		const float goldenAngle = 2.39996323f;
+
+		for (int i = 0; i < sphereCount; i++)
+		{
+			float y = 1.0f - 2.0f * (i + 0.5f) / sphereCount;
+			float r = std::sqrt(std::max(0.0f, 1.0f - y * y));
+			float phi = goldenAngle * i;
+
+			directions.push_back(glm::vec3(r * std::cos(phi), y, r * std::sin(phi)));
+		}
+
+		return directions;
+	}
+
+	struct DecompositionMesh
+	{
+		const std::vector<glm::vec3>&	positions;
+		const std::vector<unsigned int>& indices;
+		std::vector<glm::vec3>			centroids;
+		std::vector<glm::vec3>			normals;
+		std::vector<float>				areas;
+		float							extent;
+	};
+
+	struct DecompositionPart
+	{
+		std::vector<uint32_t>	triangles;
+		float					concavity;
+		int						depth;
+	};
+
+	static std::vector<unsigned int> partVertices(const DecompositionMesh& mesh, const std::vector<uint32_t>& triangles)
+	{
+		std::vector<unsigned int> vertices;
+		vertices.reserve(triangles.size() * 3);
+
+		for (auto t : triangles)
+			for (int c = 0; c < 3; c++)
+				vertices.push_back(mesh.indices[t * 3 + c]);
+
+		std::sort(vertices.begin(), vertices.end());
+		vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+
+		return vertices;
+	}
+
+	// indices of the vertices furthest along each direction, without repeats
+	static std::vector<unsigned int> supportVertices(const std::vector<glm::vec3>& positions, const std::vector<unsigned int>& vertices, const std::vector<glm::vec3>& directions)
+	{
+		std::vector<unsigned int> support;
+		support.reserve(directions.size());
+
+		for (auto& d : directions)
+		{
+			unsigned int best = vertices[0];
+			float bestDistance = glm::dot(d, positions[best]);
+
+			for (auto v : vertices)
+			{
+				float distance = glm::dot(d, positions[v]);
+				if (distance > bestDistance)
+				{
+					bestDistance = distance;
+					best = v;
+				}
+			}
+
+			support.push_back(best);
+		}
+
+		std::sort(support.begin(), support.end());
+		support.erase(std::unique(support.begin(), support.end()), support.end());
+
+		return support;
+	}
+
+	// how far the part's (approximate) hull reaches past its triangles along their normals, relative to the mesh size
+	static float partConcavity(const DecompositionMesh& mesh, const std::vector<uint32_t>& triangles, const std::vector<glm::vec3>& directions)
+	{
+		std::vector<unsigned int> vertices = partVertices(mesh, triangles);
+		std::vector<unsigned int> hull = supportVertices(mesh.positions, vertices, directions);
+
+		const size_t sampleCount = std::min(triangles.size(), CONCAVITY_SAMPLES);
+
+		float concavity = 0.0f;
+
+		for (size_t s = 0; s < sampleCount; s++)
+		{
+			const uint32_t t = triangles[s * triangles.size() / sampleCount];
+
+			if (mesh.areas[t] <= 0.0f)
+				continue;
+
+			const glm::vec3& n = mesh.normals[t];
+			const float face = glm::dot(n, mesh.centroids[t]);
+
+			for (auto v : hull)
+				concavity = std::max(concavity, glm::dot(n, mesh.positions[v]) - face);
+		}
+
+		return concavity / mesh.extent;
+	}
+
+	// tries planes at a quarter, half and three quarters along each axis of the part's triangle centroids, keeping
+	// the one leaving the least concavity behind
+	static bool splitPart(const DecompositionMesh& mesh, const DecompositionPart& part, const std::vector<glm::vec3>& directions, DecompositionPart& left, DecompositionPart& right)
+	{
+		glm::vec3 boundsMin = mesh.centroids[part.triangles[0]];
+		glm::vec3 boundsMax = boundsMin;
+
+		for (auto t : part.triangles)
+		{
+			boundsMin = glm::min(boundsMin, mesh.centroids[t]);
+			boundsMax = glm::max(boundsMax, mesh.centroids[t]);
+		}
+
+		static const float fractions[3] = { 0.25f, 0.5f, 0.75f };
+
+		bool found = false;
+		float bestCost = 0.0f;
+		std::vector<uint32_t> below;
+		std::vector<uint32_t> above;
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			if (boundsMax[axis] <= boundsMin[axis])
+				continue;
+
+			for (float fraction : fractions)
+			{
+				const float plane = boundsMin[axis] + (boundsMax[axis] - boundsMin[axis]) * fraction;
+
+				below.clear();
+				above.clear();
+
+				for (auto t : part.triangles)
+				{
+					if (mesh.centroids[t][axis] < plane)
+						below.push_back(t);
+					else
+						above.push_back(t);
+				}
+
+				if (below.empty() || above.empty())
+					continue;
+
+				float belowConcavity = partConcavity(mesh, below, directions);
+				float aboveConcavity = partConcavity(mesh, above, directions);
+				float cost = belowConcavity + aboveConcavity;
+
+				if (!found || cost < bestCost)
+				{
+					found = true;
+					bestCost = cost;
+
+					left.triangles = below;
+					left.concavity = belowConcavity;
+					right.triangles = above;
+					right.concavity = aboveConcavity;
+				}
+			}
+		}
+
+		left.depth = part.depth + 1;
+		right.depth = part.depth + 1;
+
+		return found;
+	}
+
+	std::vector<std::vector<glm::vec3>> ConvexDecomposition::decompose(const std::vector<glm::vec3>& positions, const std::vector<unsigned int>& indices, const ConvexDecompositionParams& params)
+	{
+		std::vector<std::vector<glm::vec3>> hulls;
+
+		const size_t triangleCount = indices.size() / 3;
+		if (triangleCount == 0)
+			return hulls;
+
+		for (size_t i = 0; i < triangleCount * 3; i++)
+		{
+			if (indices[i] >= positions.size())
+			{
+				SPDLOG_DEBUG("ConvexDecomposition::decompose: index {} out of range of {} positions", indices[i], positions.size());
+				return hulls;
+			}
+		}
+
+		DecompositionMesh mesh{ positions, indices, {}, {}, {}, 0.0f };
+		mesh.centroids.resize(triangleCount);
+		mesh.normals.resize(triangleCount);
+		mesh.areas.resize(triangleCount);
+
+		glm::vec3 boundsMin = positions[indices[0]];
+		glm::vec3 boundsMax = boundsMin;
+
+		for (size_t t = 0; t < triangleCount; t++)
+		{
+			const glm::vec3& p0 = positions[indices[t * 3]];
+			const glm::vec3& p1 = positions[indices[t * 3 + 1]];
+			const glm::vec3& p2 = positions[indices[t * 3 + 2]];
+
+			glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+			float length = glm::length(n);
+
+			mesh.centroids[t] = (p0 + p1 + p2) / 3.0f;
+			mesh.normals[t] = length > 0.0f ? n / length : glm::vec3(0.0f);
+			mesh.areas[t] = length * 0.5f;
+
+			boundsMin = glm::min(boundsMin, glm::min(p0, glm::min(p1, p2)));
+			boundsMax = glm::max(boundsMax, glm::max(p0, glm::max(p1, p2)));
+		}
+
+		mesh.extent = glm::length(boundsMax - boundsMin);
+		if (mesh.extent <= 0.0f)
+		{
+			SPDLOG_DEBUG("ConvexDecomposition::decompose: mesh has no extent");
+			return hulls;
+		}
+
+		const std::vector<glm::vec3> directions = supportDirections(CONCAVITY_DIRECTIONS);
+		const size_t maxHulls = (size_t)std::max(params.maxHulls, 1);
+
+		DecompositionPart root;
+		root.triangles.resize(triangleCount);
+		for (size_t t = 0; t < triangleCount; t++)
+			root.triangles[t] = (uint32_t)t;
+		root.concavity = partConcavity(mesh, root.triangles, directions);
+		root.depth = 0;
+
+		// a heap on concavity, so the hull budget goes to the parts furthest from convex
+		auto lessConcave = [](const DecompositionPart& a, const DecompositionPart& b) { return a.concavity < b.concavity; };
+
+		std::vector<DecompositionPart> open;
+		std::vector<DecompositionPart> done;
+		open.push_back(std::move(root));
+
+		while (!open.empty())
+		{
+			std::pop_heap(open.begin(), open.end(), lessConcave);
+			DecompositionPart part = std::move(open.back());
+			open.pop_back();
+
+			// splitting replaces one part with two
+			const bool budgetLeft = open.size() + done.size() + 2 <= maxHulls;
+
+			DecompositionPart left;
+			DecompositionPart right;
+
+			if (!budgetLeft || part.concavity <= params.maxConcavity || part.depth >= params.maxDepth || part.triangles.size() < 2 ||
+				!splitPart(mesh, part, directions, left, right))
+			{
+				done.push_back(std::move(part));
+				continue;
+			}
+
+			open.push_back(std::move(left));
+			std::push_heap(open.begin(), open.end(), lessConcave);
+			open.push_back(std::move(right));
+			std::push_heap(open.begin(), open.end(), lessConcave);
+		}
+
+		const std::vector<glm::vec3> hullDirections = supportDirections(params.maxHullVertices);
+
+		for (auto& part : done)
+		{
+			std::vector<unsigned int> vertices = partVertices(mesh, part.triangles);
+
+			std::vector<glm::vec3> hull;
+			for (auto v : supportVertices(positions, vertices, hullDirections))
+				hull.push_back(positions[v]);
+
+			hulls.push_back(std::move(hull));
+		}
+
+		return hulls;
+	}
+
+	std::string ConvexDecomposition::getCachePath(const std::string& directory, uint64_t contentHash)
+	{
+		char name[32];
+		std::snprintf(name, sizeof(name), "%016llx.velhull", (unsigned long long)contentHash);
+
+		return (std::filesystem::path(directory) / name).string();
+	}
+
+	uint64_t ConvexDecomposition::contentHash(const std::vector<glm::vec3>& positions, const std::vector<unsigned int>& indices, const ConvexDecompositionParams& params)
+	{
+		uint64_t h = 0xcbf29ce484222325ull;
+
+		hashWord(h, (uint64_t)(uint32_t)params.maxHulls);
+		hashWord(h, (uint64_t)(uint32_t)params.maxHullVertices);
+		hashWord(h, floatBits(params.maxConcavity));
+		hashWord(h, (uint64_t)(uint32_t)params.maxDepth);
+
+		hashWord(h, (uint64_t)positions.size());
+		for (auto& p : positions)
+			for (int c = 0; c < 3; c++)
+				hashWord(h, floatBits(p[c]));
+
+		hashWord(h, (uint64_t)indices.size());
+		for (auto i : indices)
+			hashWord(h, i);
+
+		return h;
+	}
+
+	bool ConvexDecomposition::write(const std::string& cachePath, uint64_t contentHash, const std::vector<std::vector<glm::vec3>>& hulls)
+	{
+		std::vector<uint32_t> hullSizes;
+		std::vector<float> points;
+
+		for (auto& hull : hulls)
+		{
+			hullSizes.push_back((uint32_t)hull.size());
+			for (auto& p : hull)
+			{
+				points.push_back(p.x);
+				points.push_back(p.y);
+				points.push_back(p.z);
+			}
+		}
+
+		ConvexDecompositionCacheHeader header;
+		std::memset(&header, 0, sizeof(ConvexDecompositionCacheHeader));
+		std::memcpy(header.magic, CONVEX_DECOMPOSITION_CACHE_MAGIC, sizeof(CONVEX_DECOMPOSITION_CACHE_MAGIC));
+		header.version = CONVEX_DECOMPOSITION_CACHE_VERSION;
+		header.hullCount = (uint32_t)hulls.size();
+		header.contentHash = contentHash;
+		header.hullSizesOffset = alignTo16(sizeof(ConvexDecompositionCacheHeader));
+		header.pointsOffset = alignTo16(header.hullSizesOffset + hullSizes.size() * sizeof(uint32_t));
+		header.pointCount = points.size() / 3;
+
+		// write to a temporary file first so that an interrupted write never leaves a valid looking, partial cache
+		std::string tmpPath = cachePath + ".tmp";
+		{
+			std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+			if (!out)
+			{
+				SPDLOG_DEBUG("ConvexDecomposition::write: unable to open {} for writing", tmpPath);
+				return false;
+			}
+
+			auto padTo = [&out](uint64_t offset) {
+				static const char zeros[16] = {};
+				uint64_t pos = (uint64_t)out.tellp();
+				if (offset > pos)
+					out.write(zeros, (std::streamsize)(offset - pos));
+			};
+
+			out.write(reinterpret_cast<const char*>(&header), sizeof(ConvexDecompositionCacheHeader));
+
+			padTo(header.hullSizesOffset);
+			if (!hullSizes.empty())
+				out.write(reinterpret_cast<const char*>(hullSizes.data()), hullSizes.size() * sizeof(uint32_t));
+
+			padTo(header.pointsOffset);
+			if (!points.empty())
+				out.write(reinterpret_cast<const char*>(points.data()), points.size() * sizeof(float));
+
+			if (!out)
+			{
+				SPDLOG_DEBUG("ConvexDecomposition::write: failed writing {}", tmpPath);
+				return false;
+			}
+		}
+
+		std::error_code ec;
+		std::filesystem::rename(tmpPath, cachePath, ec);
+		if (ec)
+		{
+			SPDLOG_DEBUG("ConvexDecomposition::write: unable to move {} into place: {}", tmpPath, ec.message());
+			std::filesystem::remove(tmpPath, ec);
+			return false;
+		}
+
+		return true;
+	}
+
+	bool ConvexDecomposition::load(const std::string& cachePath, uint64_t contentHash, std::vector<std::vector<glm::vec3>>& hulls)
+	{
+		std::error_code ec;
+		if (!std::filesystem::exists(cachePath, ec))
+			return false;
+
+		MappedFile file;
+		if (!file.open(cachePath))
+			return false;
+
+		const unsigned char* base = file.getData();
+		const size_t size = file.getSize();
+
+		if (size < sizeof(ConvexDecompositionCacheHeader))
+		{
+			SPDLOG_DEBUG("ConvexDecomposition::load: {} is truncated", cachePath);
+			return false;
+		}
+
+		const ConvexDecompositionCacheHeader* header = reinterpret_cast<const ConvexDecompositionCacheHeader*>(base);
+
+		if (std::memcmp(header->magic, CONVEX_DECOMPOSITION_CACHE_MAGIC, sizeof(CONVEX_DECOMPOSITION_CACHE_MAGIC)) != 0 ||
+			header->version != CONVEX_DECOMPOSITION_CACHE_VERSION || header->contentHash != contentHash)
+		{
+			SPDLOG_DEBUG("ConvexDecomposition::load: {} is not a compatible convex decomposition cache", cachePath);
+			return false;
+		}
+
+		if (header->hullSizesOffset + (uint64_t)header->hullCount * sizeof(uint32_t) > size ||
+			header->pointsOffset + header->pointCount * 3 * sizeof(float) > size)
+		{
+			SPDLOG_DEBUG("ConvexDecomposition::load: {} is truncated", cachePath);
+			return false;
+		}
+
+		const uint32_t* hullSizes = reinterpret_cast<const uint32_t*>(base + header->hullSizesOffset);
+		const float* points = reinterpret_cast<const float*>(base + header->pointsOffset);
+
+		uint64_t total = 0;
+		for (uint32_t i = 0; i < header->hullCount; i++)
+			total += hullSizes[i];
+
+		if (total != header->pointCount)
+		{
+			SPDLOG_DEBUG("ConvexDecomposition::load: {} has inconsistent hull sizes", cachePath);
+			return false;
+		}
+
+		hulls.clear();
+		hulls.resize(header->hullCount);
+
+		for (uint32_t i = 0; i < header->hullCount; i++)
+		{
+			hulls[i].resize(hullSizes[i]);
+			for (uint32_t p = 0; p < hullSizes[i]; p++, points += 3)
+				hulls[i][p] = glm::vec3(points[0], points[1], points[2]);
+		}
+
+		return true;
+	}
+}
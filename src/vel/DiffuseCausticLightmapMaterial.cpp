@@ -20,11 +20,7 @@ namespace vel
 
 	void DiffuseCausticLightmapMaterial::draw(float alphaTime, GPU* gpu, Actor* actor, const glm::mat4& viewMatrix, const glm::mat4& projMatrix)
 	{
-		for (unsigned int i = 0; i < this->getTextures().size(); i++)
-		{
-			auto currentTextureFrame = this->getMaterialAnimator().getTextureCurrentFrame(i);
-			gpu->updateTextureUBO(i, this->getTextures().at(i)->frames.at(currentTextureFrame).dsaHandle);
-		}
+		this->updateAnimatedTextures(gpu);
 
 		gpu->updateLightmapTextureUBO(this->getLightmapTexture()->frames.at(0).dsaHandle);
 
@@ -17,7 +17,7 @@ namespace vel
 		for (unsigned int i = 0; i < this->getTextures().size(); i++)
 			gpu->updateTextureUBO(i, this->getTextures().at(i)->frames.at(0).dsaHandle);
 
-		this->updateBones(alphaTime, gpu, actor);
+		this->prepareSkinning(alphaTime, gpu, actor);
 
 		gpu->setShaderVec4("color", this->getColor());
 		gpu->setShaderMat4("model", actor->getWorldRenderMatrix(alphaTime));
@@ -2,6 +2,7 @@
 #include <fstream>
 #include <sstream>
 #include <filesystem>
+#include <algorithm>
 
 #include "spdlog/spdlog.h"
 
@@ -17,8 +18,18 @@
 
 #include "vel/GPU.h"
 #include "vel/Vertex.h"
+#include "vel/TextureCache.h"
 #include "vel/functions.h"
 
+// s3tc is an extension in name only on desktop hardware, the loader may not have been generated with it
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
 
 
 namespace vel
@@ -38,6 +49,7 @@ namespace vel
 		activeCameraViewportSize(glm::ivec2(1280, 720)),
 		activeFramebuffer(-1),
 		useFXAA(fxaa),
+		activeLod(0),
 		prevFrameFence(0)
 	{
 		//glClearColor(0.0f, 0.0f, 0.0f, 0.0f); // why?
@@ -450,11 +462,22 @@ namespace vel
 			glDeleteVertexArrays(1, &m->getGpuMesh().value().VAO);
 			glDeleteBuffers(1, &m->getGpuMesh().value().VBO);
 			glDeleteBuffers(1, &m->getGpuMesh().value().EBO);
+
+			if (m->getGpuMesh()->instanceVBO > 0)
+				glDeleteBuffers(1, &m->getGpuMesh().value().instanceVBO);
 		}
 	}
 
 	void GPU::clearTexture(Texture* t)
 	{
+		if (t->options & TXT_OPT_ARRAY)
+		{
+			// all frames are layers of the same texture object
+			glMakeTextureHandleNonResidentARB(t->frames.at(0).dsaHandle);
+			glDeleteTextures(1, &t->frames.at(0).id);
+			return;
+		}
+
 		for (auto& td : t->frames)
 		{
 			glMakeTextureHandleNonResidentARB(td.dsaHandle);
@@ -480,6 +503,9 @@ namespace vel
 
 	bool GPU::loadShader(Shader* s)
 	{
+		if (s->compCode != "")
+			return this->loadComputeShader(s);
+
 		int success;
 		char infoLog[512];
 		std::string infoLogStr = "";
@@ -584,6 +610,51 @@ namespace vel
 		return true;
 	}
 
+	bool GPU::loadComputeShader(Shader* s)
+	{
+		int success;
+		char infoLog[512];
+		std::string infoLogStr = "";
+
+		const char* cShaderCode = s->compCode.c_str();
+		unsigned int compute = glCreateShader(GL_COMPUTE_SHADER);
+		glShaderSource(compute, 1, &cShaderCode, NULL);
+		glCompileShader(compute);
+
+		glGetShaderiv(compute, GL_COMPILE_STATUS, &success);
+		if (!success)
+		{
+			glGetShaderInfoLog(compute, 512, NULL, infoLog);
+			infoLogStr = infoLog;
+
+			SPDLOG_DEBUG("GPU::loadComputeShader: COMPUTE::COMPILATION_FAILED: {}", infoLogStr);
+			glDeleteShader(compute);
+			return false;
+		}
+
+		unsigned int id = glCreateProgram();
+		glAttachShader(id, compute);
+		glLinkProgram(id);
+
+		glGetProgramiv(id, GL_LINK_STATUS, &success);
+		if (!success)
+		{
+			glGetProgramInfoLog(id, 512, NULL, infoLog);
+			infoLogStr = infoLog;
+
+			SPDLOG_DEBUG("GPU::loadComputeShader: PROGRAM::LINKING_FAILED: {}", infoLogStr);
+			glDeleteShader(compute);
+			glDeleteProgram(id);
+			return false;
+		}
+
+		glDeleteShader(compute);
+
+		s->id = id;
+
+		return true;
+	}
+
 	RenderTarget GPU::createRenderTarget(const std::string& name, unsigned int width, unsigned int height)
 	{
 		RenderTarget rt;
@@ -714,6 +785,75 @@ namespace vel
 		return true;
 	}
 
+	void GPU::configureVertexAttributes(VertexFormat format)
+	{
+		if (format == VertexFormat::FULL)
+		{
+			// Assign vertex positions to location = 0
+			glEnableVertexAttribArray(0);
+			glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+
+			// Assign vertex normals to location = 1
+			glEnableVertexAttribArray(1);
+			glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+
+			// Assign vertex texture coordinates to location = 2
+			glEnableVertexAttribArray(2);
+			glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, textureCoordinates));
+
+			// Assign vertex lightmap texture coordinates to location = 3
+			glEnableVertexAttribArray(3);
+			glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, lightmapCoordinates));
+
+			// Assign texture id to location = 4
+			glEnableVertexAttribArray(4);
+			glVertexAttribIPointer(4, 1, GL_INT, sizeof(Vertex), (void*)offsetof(Vertex, materialUBOIndex));
+
+			// Assign vertex bone ids to location = 5 (and 6 for second array element)
+			glEnableVertexAttribArray(5);
+			glVertexAttribIPointer(5, 4, GL_INT, sizeof(Vertex), (void*)offsetof(Vertex, weights.ids));
+			glEnableVertexAttribArray(6);
+			glVertexAttribIPointer(6, 4, GL_INT, sizeof(Vertex), (void*)(offsetof(Vertex, weights.ids) + 16));
+
+			// Assign vertex weights to location = 7 (and 8 for second array element)
+			glEnableVertexAttribArray(7);
+			glVertexAttribPointer(7, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, weights.weights));
+			glEnableVertexAttribArray(8);
+			glVertexAttribPointer(8, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(offsetof(Vertex, weights.weights) + 16));
+
+			return;
+		}
+
+		// compact layouts, the static layout is a prefix of the skinned one so the offsets are shared
+		GLsizei stride = (GLsizei)getVertexFormatStride(format);
+
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(CompactSkinnedVertex, position));
+
+		// octahedral encoded normal, decoded in the shader (OCT_NORMALS)
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, stride, (void*)offsetof(CompactSkinnedVertex, normal));
+
+		glEnableVertexAttribArray(2);
+		glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride, (void*)offsetof(CompactSkinnedVertex, textureCoordinates));
+
+		glEnableVertexAttribArray(3);
+		glVertexAttribPointer(3, 2, GL_HALF_FLOAT, GL_FALSE, stride, (void*)offsetof(CompactSkinnedVertex, lightmapCoordinates));
+
+		glEnableVertexAttribArray(4);
+		glVertexAttribIPointer(4, 1, GL_INT, stride, (void*)offsetof(CompactSkinnedVertex, materialUBOIndex));
+
+		if (format == VertexFormat::SKINNED_COMPACT)
+		{
+			// 4 bone ids at location = 5 and 4 unorm weights at location = 7 (FOUR_BONE_WEIGHTS)
+			glEnableVertexAttribArray(5);
+			glVertexAttribIPointer(5, 4, GL_UNSIGNED_BYTE, stride, (void*)offsetof(CompactSkinnedVertex, boneIds));
+
+			glEnableVertexAttribArray(7);
+			glVertexAttribPointer(7, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void*)offsetof(CompactSkinnedVertex, boneWeights));
+		}
+	}
+
 	void GPU::loadMesh(Mesh* m)
 	{
 		GpuMesh gm = GpuMesh();
@@ -726,53 +866,118 @@ namespace vel
 		// Generate and bind vertex buffer object
 		glGenBuffers(1, &gm.VBO);
 		glBindBuffer(GL_ARRAY_BUFFER, gm.VBO);
-		glBufferData(GL_ARRAY_BUFFER, m->getVertices().size() * sizeof(Vertex), &m->getVertices()[0], GL_STATIC_DRAW);
+
+		if (m->isDynamic())
+		{
+			// storage sized to capacity and filled below once the ebo exists
+			gm.vertexCapacity = dynamicMeshCapacity(m->getVertices().size(), 0);
+			glBufferData(GL_ARRAY_BUFFER, gm.vertexCapacity * getVertexFormatStride(m->getVertexFormat()), nullptr, GL_DYNAMIC_DRAW);
+		}
+		else if (m->getVertexFormat() == VertexFormat::FULL)
+		{
+			glBufferData(GL_ARRAY_BUFFER, m->getVertices().size() * sizeof(Vertex), &m->getVertices()[0], GL_STATIC_DRAW);
+		}
+		else
+		{
+			packVertices(m->getVertices(), m->getVertexFormat(), 0, m->getVertices().size(), this->packedVertexScratch);
+			glBufferData(GL_ARRAY_BUFFER, this->packedVertexScratch.size(), this->packedVertexScratch.data(), GL_STATIC_DRAW);
+		}
 
 		// Generate and bind element buffer object
 		glGenBuffers(1, &gm.EBO);
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gm.EBO);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, m->getIndices().size() * sizeof(unsigned int), &m->getIndices()[0], GL_STATIC_DRAW);
 
-		// Assign vertex positions to location = 0
-		glEnableVertexAttribArray(0);
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+		if (m->isDynamic())
+		{
+			gm.indexCapacity = dynamicMeshCapacity(m->getIndices().size(), 0);
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, gm.indexCapacity * sizeof(unsigned int), nullptr, GL_DYNAMIC_DRAW);
 
-		// Assign vertex normals to location = 1
-		glEnableVertexAttribArray(1);
-		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+			if (m->getIndices().size() > 0)
+				glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, m->getIndices().size() * sizeof(unsigned int), &m->getIndices()[0]);
+		}
+		else
+		{
+			this->uploadIndices(m, gm);
+		}
 
-		// Assign vertex texture coordinates to location = 2
-		glEnableVertexAttribArray(2);
-		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, textureCoordinates));
+		this->configureVertexAttributes(m->getVertexFormat());
 
-		// Assign vertex lightmap texture coordinates to location = 3
-		glEnableVertexAttribArray(3);
-		glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, lightmapCoordinates));
+		// Unbind the vertex array to prevent accidental operations
+		glBindVertexArray(0);
 
-		// Assign texture id to location = 4
-		glEnableVertexAttribArray(4);
-		glVertexAttribIPointer(4, 1, GL_INT, sizeof(Vertex), (void*)offsetof(Vertex, materialUBOIndex));
+		m->setGpuMesh(gm);
+
+		if (m->isDynamic())
+		{
+			this->updateMeshVertexRange(m, 0, m->getVertices().size());
+			m->clearDirtyRanges();
+		}
+	}
 
-		// Assign vertex bone ids to location = 5 (and 6 for second array element)
-		glEnableVertexAttribArray(5);
-		glVertexAttribIPointer(5, 4, GL_INT, sizeof(Vertex), (void*)offsetof(Vertex, weights.ids));
-		glEnableVertexAttribArray(6);
-		glVertexAttribIPointer(6, 4, GL_INT, sizeof(Vertex), (void*)(offsetof(Vertex, weights.ids) + 16));
+	size_t GPU::dynamicMeshCapacity(size_t required, size_t current)
+	{
+		// grow by half again so a mesh that creeps up in size (text being typed) doesn't reallocate on every change
+		size_t capacity = std::max<size_t>(current, 64);
+		while (capacity < required)
+			capacity += capacity / 2;
 
-		// Assign vertex weights to location = 7 (and 8 for second array element)
-		glEnableVertexAttribArray(7);
-		glVertexAttribPointer(7, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, weights.weights));
-		glEnableVertexAttribArray(8);
-		glVertexAttribPointer(8, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(offsetof(Vertex, weights.weights) + 16));
+		return capacity;
+	}
 
-		// Unbind the vertex array to prevent accidental operations
-		glBindVertexArray(0);
+	void GPU::updateDynamicMesh(Mesh* m)
+	{
+		auto& gm = m->getGpuMesh().value();
+		gm.indiceCount = (GLsizei)m->getIndices().size();
 
-		m->setGpuMesh(gm);
+		const size_t vertexCount = m->getVertices().size();
+		const size_t indexCount = m->getIndices().size();
+
+		if (vertexCount > gm.vertexCapacity)
+		{
+			// reallocating keeps the buffer name, so the vao binding stays valid
+			gm.vertexCapacity = dynamicMeshCapacity(vertexCount, gm.vertexCapacity);
+			glNamedBufferData(gm.VBO, gm.vertexCapacity * getVertexFormatStride(m->getVertexFormat()), nullptr, GL_DYNAMIC_DRAW);
+			this->updateMeshVertexRange(m, 0, vertexCount);
+		}
+		else if (m->hasDirtyVertices())
+		{
+			size_t end = std::min(m->getDirtyVertexEnd(), vertexCount);
+
+			// the whole live range is being replaced, orphan the old storage so the driver does not have to wait on any
+			// draw still reading it
+			if (m->getDirtyVertexFirst() == 0 && end == vertexCount)
+				glInvalidateBufferData(gm.VBO);
+
+			if (end > m->getDirtyVertexFirst())
+				this->updateMeshVertexRange(m, m->getDirtyVertexFirst(), end - m->getDirtyVertexFirst());
+		}
+
+		if (indexCount > gm.indexCapacity)
+		{
+			gm.indexCapacity = dynamicMeshCapacity(indexCount, gm.indexCapacity);
+			glNamedBufferData(gm.EBO, gm.indexCapacity * sizeof(unsigned int), nullptr, GL_DYNAMIC_DRAW);
+			glNamedBufferSubData(gm.EBO, 0, indexCount * sizeof(unsigned int), &m->getIndices()[0]);
+		}
+		else if (m->hasDirtyIndices())
+		{
+			size_t first = m->getDirtyIndexFirst();
+			size_t end = std::min(m->getDirtyIndexEnd(), indexCount);
+
+			if (end > first)
+				glNamedBufferSubData(gm.EBO, first * sizeof(unsigned int), (end - first) * sizeof(unsigned int), &m->getIndices()[first]);
+		}
+
+		m->clearDirtyRanges();
 	}
 
 	void GPU::updateMesh(Mesh* m)
 	{
+		if (m->isDynamic())
+		{
+			this->updateDynamicMesh(m);
+			return;
+		}
+
 		auto& gm = m->getGpuMesh().value();
 		gm.indiceCount = (GLsizei)m->getIndices().size();
 
@@ -781,16 +986,72 @@ namespace vel
 
 		// Bind and update vertex buffer
 		glBindBuffer(GL_ARRAY_BUFFER, gm.VBO);
-		glBufferData(GL_ARRAY_BUFFER, m->getVertices().size() * sizeof(Vertex), &m->getVertices()[0], GL_STATIC_DRAW);
+
+		if (m->getVertexFormat() == VertexFormat::FULL)
+		{
+			glBufferData(GL_ARRAY_BUFFER, m->getVertices().size() * sizeof(Vertex), &m->getVertices()[0], GL_STATIC_DRAW);
+		}
+		else
+		{
+			packVertices(m->getVertices(), m->getVertexFormat(), 0, m->getVertices().size(), this->packedVertexScratch);
+			glBufferData(GL_ARRAY_BUFFER, this->packedVertexScratch.size(), this->packedVertexScratch.data(), GL_STATIC_DRAW);
+		}
 
 		// Bind and update indices buffer
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gm.EBO);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, m->getIndices().size() * sizeof(unsigned int), &m->getIndices()[0], GL_STATIC_DRAW);
+		this->uploadIndices(m, gm);
 
 		// Unbind the vertex array to prevent accidental operations
 		glBindVertexArray(0);
 	}
 
+	void GPU::uploadIndices(Mesh* m, GpuMesh& gm)
+	{
+		gm.lodCount = 1;
+
+		if (m->getLods().empty())
+		{
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, m->getIndices().size() * sizeof(unsigned int), &m->getIndices()[0], GL_STATIC_DRAW);
+			return;
+		}
+
+		// every level shares the vao, a lod switch is only a different offset into the element buffer
+		this->lodIndexScratch.assign(m->getIndices().begin(), m->getIndices().end());
+
+		for (auto& l : m->getLods())
+		{
+			gm.lodFirstIndex[gm.lodCount] = (GLsizei)this->lodIndexScratch.size();
+			gm.lodIndexCount[gm.lodCount] = (GLsizei)l.indices.size();
+			gm.lodCount++;
+
+			this->lodIndexScratch.insert(this->lodIndexScratch.end(), l.indices.begin(), l.indices.end());
+		}
+
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, this->lodIndexScratch.size() * sizeof(unsigned int), this->lodIndexScratch.data(), GL_STATIC_DRAW);
+	}
+
+	void GPU::updateMeshVertices(Mesh* m)
+	{
+		this->updateMeshVertexRange(m, 0, m->getVertices().size());
+	}
+
+	void GPU::updateMeshVertexRange(Mesh* m, size_t firstVertex, size_t vertexCount)
+	{
+		if (vertexCount == 0)
+			return;
+
+		// re-uploads the vertex buffer contents in place, leaving the index buffer and the buffer storage alone
+		if (m->getVertexFormat() == VertexFormat::FULL)
+		{
+			glNamedBufferSubData(m->getGpuMesh()->VBO, firstVertex * sizeof(Vertex), vertexCount * sizeof(Vertex), &m->getVertices()[firstVertex]);
+			return;
+		}
+
+		packVertices(m->getVertices(), m->getVertexFormat(), firstVertex, vertexCount, this->packedVertexScratch);
+		glNamedBufferSubData(m->getGpuMesh()->VBO, firstVertex * getVertexFormatStride(m->getVertexFormat()), 
+			this->packedVertexScratch.size(), this->packedVertexScratch.data());
+	}
+
 	void GPU::copyGPUTexture(unsigned int sourceId, unsigned int destinationId, unsigned int width, unsigned int height)
 	{
 		glCopyImageSubData(
@@ -835,10 +1096,221 @@ namespace vel
 		return t;
 	}
 
-	void GPU::loadTexture(Texture* t)
+	void GPU::setTextureParameters(unsigned int target, int options)
+	{
+		if (options & TXT_OPT_CLAMP_UVS)
+		{
+			glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		}
+		else
+		{
+			glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_REPEAT);
+			glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		}
+		
+		if (options & TXT_OPT_DISABLE_FILTER)
+		{
+			glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+			//glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+			glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+		}
+		else
+		{
+			glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		}
+	}
+
+	static GLenum compressedInternalFormat(BlockFormat format)
+	{
+		switch (format)
+		{
+		case BlockFormat::BC1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+		case BlockFormat::BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		case BlockFormat::BC4: return GL_COMPRESSED_RED_RGTC1;
+		case BlockFormat::BC5: return GL_COMPRESSED_RG_RGTC2;
+		}
+
+		return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+	}
+
+	void GPU::loadCompressedTexture(TextureData& td, int options)
+	{
+		const CompressedImage& img = *td.compressed;
+		const GLenum internalFormat = compressedInternalFormat(img.format);
+
+		glGenTextures(1, &td.id);
+		glBindTexture(GL_TEXTURE_2D, td.id);
+
+		// the whole precomputed mip chain goes up as is, no decode and no glGenerateMipmap
+		glTexStorage2D(GL_TEXTURE_2D, (GLsizei)img.levels.size(), internalFormat, (GLsizei)img.levels[0].width, (GLsizei)img.levels[0].height);
+
+		for (size_t level = 0; level < img.levels.size(); level++)
+		{
+			glCompressedTexSubImage2D(
+				GL_TEXTURE_2D,
+				(GLint)level,
+				0, 0,
+				(GLsizei)img.levels[level].width,
+				(GLsizei)img.levels[level].height,
+				internalFormat,
+				(GLsizei)img.levels[level].size,
+				img.getLevelData(level)
+			);
+		}
+
+		this->setTextureParameters(GL_TEXTURE_2D, options);
+
+		td.dsaHandle = glGetTextureHandleARB(td.id);
+		glMakeTextureHandleResidentARB(td.dsaHandle);
+
+		// unmaps the cache
+		td.compressed.reset();
+	}
+
+	bool GPU::loadCompressedTextureArray(Texture* t)
+	{
+		const CompressedImage& first = *t->frames.at(0).compressed;
+
+		for (auto& td : t->frames)
+		{
+			if (!td.compressed || td.compressed->format != first.format || td.compressed->levels.size() != first.levels.size() ||
+				td.compressed->levels[0].width != first.levels[0].width || td.compressed->levels[0].height != first.levels[0].height)
+			{
+				SPDLOG_DEBUG("GPU::loadCompressedTextureArray(): frames of {} differ in size or format", t->name);
+				return false;
+			}
+		}
+
+		const GLenum internalFormat = compressedInternalFormat(first.format);
+
+		unsigned int id;
+		glGenTextures(1, &id);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, id);
+
+		glTexStorage3D(GL_TEXTURE_2D_ARRAY, (GLsizei)first.levels.size(), internalFormat,
+			(GLsizei)first.levels[0].width, (GLsizei)first.levels[0].height, (GLsizei)t->frames.size());
+
+		for (size_t layer = 0; layer < t->frames.size(); layer++)
+		{
+			const CompressedImage& img = *t->frames.at(layer).compressed;
+
+			for (size_t level = 0; level < img.levels.size(); level++)
+			{
+				glCompressedTexSubImage3D(
+					GL_TEXTURE_2D_ARRAY,
+					(GLint)level,
+					0, 0, (GLint)layer,
+					(GLsizei)img.levels[level].width,
+					(GLsizei)img.levels[level].height,
+					1,
+					internalFormat,
+					(GLsizei)img.levels[level].size,
+					img.getLevelData(level)
+				);
+			}
+		}
+
+		this->setTextureParameters(GL_TEXTURE_2D_ARRAY, t->options);
+
+		GLuint64 dsaHandle = glGetTextureHandleARB(id);
+		glMakeTextureHandleResidentARB(dsaHandle);
+
+		for (auto& td : t->frames)
+		{
+			td.id = id;
+			td.dsaHandle = dsaHandle;
+			td.compressed.reset();
+		}
+
+		return true;
+	}
+
+	bool GPU::loadTextureArray(Texture* t)
+	{
+		if (t->frames.at(0).compressed)
+			return this->loadCompressedTextureArray(t);
+
+		const ImageData& first = t->frames.at(0).primaryImageData;
+
+		// every layer of an array texture shares dimensions and format
+		for (auto& td : t->frames)
+		{
+			if (td.primaryImageData.width != first.width || td.primaryImageData.height != first.height ||
+				td.primaryImageData.sizedFormat != first.sizedFormat)
+			{
+				SPDLOG_DEBUG("GPU::loadTextureArray(): frames of {} differ in size or format", t->name);
+				return false;
+			}
+		}
+
+		GLsizei levels = 1;
+		for (int size = std::max(first.width, first.height); size > 1; size >>= 1)
+			levels++;
+
+		unsigned int id;
+		glGenTextures(1, &id);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, id);
+
+		glTexStorage3D(GL_TEXTURE_2D_ARRAY, levels, first.sizedFormat, first.width, first.height, (GLsizei)t->frames.size());
+
+		for (size_t layer = 0; layer < t->frames.size(); layer++)
+		{
+			glTexSubImage3D(
+				GL_TEXTURE_2D_ARRAY,
+				0,
+				0, 0, (GLint)layer,
+				first.width,
+				first.height,
+				1,
+				first.format,
+				GL_UNSIGNED_BYTE,
+				t->frames.at(layer).primaryImageData.data
+			);
+		}
+
+		glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+
+		this->setTextureParameters(GL_TEXTURE_2D_ARRAY, t->options);
+
+		GLuint64 dsaHandle = glGetTextureHandleARB(id);
+		glMakeTextureHandleResidentARB(dsaHandle);
+
+		for (auto& td : t->frames)
+		{
+			td.id = id;
+			td.dsaHandle = dsaHandle;
+
+			if (!(t->options & TXT_OPT_CPU_AND_GPU))
+			{
+				stbi_image_free(td.primaryImageData.data);
+				td.primaryImageData.data = nullptr;
+			}
+		}
+
+		return true;
+	}
+
+	bool GPU::loadTexture(Texture* t)
 	{
+		if (t->options & TXT_OPT_ARRAY)
+		{
+			if (this->loadTextureArray(t))
+				return true;
+
+			SPDLOG_DEBUG("GPU::loadTexture(): {} was requested as an array texture but its frames can't form one, refusing it", t->name);
+			return false;
+		}
+
 		for (auto& td : t->frames)
 		{
+			if (td.compressed)
+			{
+				this->loadCompressedTexture(td, t->options);
+				continue;
+			}
+
 			//// create a texture buffer and bind it to context
 			glGenTextures(1, &td.id);
 			glBindTexture(GL_TEXTURE_2D, td.id);
@@ -860,28 +1332,7 @@ namespace vel
 			glGenerateMipmap(GL_TEXTURE_2D);
 
 			// set texture parameters
-			if (t->options & TXT_OPT_CLAMP_UVS)
-			{
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-			}
-			else
-			{
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-			}
-			
-			if (t->options & TXT_OPT_DISABLE_FILTER)
-			{
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-				//glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
-			}
-			else
-			{
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-			}
+			this->setTextureParameters(GL_TEXTURE_2D, t->options);
 
 			// obtain texture's DSA handle
 			td.dsaHandle = glGetTextureHandleARB(td.id);
@@ -892,6 +1343,8 @@ namespace vel
 			if(!(t->options & TXT_OPT_CPU_AND_GPU))
 				stbi_image_free(td.primaryImageData.data);
 		}	
+
+		return true;
 	}
 
 	void GPU::loadFontBitmapTexture(FontBitmap* fb)
@@ -1170,7 +1623,207 @@ namespace vel
 		// I spoke of above, but honestly...if I can accomplish what I want to accomplish with this paradigm, then
 		// it really doesn't necessitate the extra work, because I would have to rework quite a bit of logic, and
 		// it's just not worth the time if it's not required
-		glDrawElements(GL_TRIANGLES, this->activeMesh->getGpuMesh()->indiceCount, GL_UNSIGNED_INT, 0);
+		const GpuMesh& gm = this->activeMesh->getGpuMesh().value();
+
+		if (this->activeLod > 0 && this->activeLod < gm.lodCount)
+		{
+			glDrawElements(GL_TRIANGLES, gm.lodIndexCount[this->activeLod], GL_UNSIGNED_INT,
+				(void*)(gm.lodFirstIndex[this->activeLod] * sizeof(unsigned int)));
+			return;
+		}
+
+		glDrawElements(GL_TRIANGLES, gm.indiceCount, GL_UNSIGNED_INT, 0);
+	}
+
+	void GPU::setActiveLod(size_t lod)
+	{
+		this->activeLod = lod;
+	}
+
+	void GPU::drawGpuMeshInstanced()
+	{
+		const GpuMesh& gm = this->activeMesh->getGpuMesh().value();
+		if (gm.instanceCount == 0)
+			return;
+
+		glDrawElementsInstanced(GL_TRIANGLES, gm.indiceCount, GL_UNSIGNED_INT, 0, gm.instanceCount);
+	}
+
+	void GPU::createInstanceBuffer(Mesh* m, size_t capacity)
+	{
+		GpuMesh& gm = m->getGpuMesh().value();
+
+		if (gm.instanceVBO > 0)
+			glDeleteBuffers(1, &gm.instanceVBO);
+
+		glCreateBuffers(1, &gm.instanceVBO);
+		glNamedBufferData(gm.instanceVBO, capacity * sizeof(ParticleInstance), nullptr, GL_DYNAMIC_DRAW);
+		gm.instanceCapacity = capacity;
+		gm.instanceCount = 0;
+
+		// dsa so the vao doesn't have to be bound (and activeMesh stays valid). Binding index 9 keeps clear of the
+		// implicit per attribute bindings 0 - 8 set up by configureVertexAttributes()
+		const unsigned int binding = 9;
+		glVertexArrayVertexBuffer(gm.VAO, binding, gm.instanceVBO, 0, sizeof(ParticleInstance));
+		glVertexArrayBindingDivisor(gm.VAO, binding, 1);
+
+		glEnableVertexArrayAttrib(gm.VAO, 9);
+		glVertexArrayAttribFormat(gm.VAO, 9, 4, GL_FLOAT, GL_FALSE, offsetof(ParticleInstance, positionSize));
+		glVertexArrayAttribBinding(gm.VAO, 9, binding);
+
+		glEnableVertexArrayAttrib(gm.VAO, 10);
+		glVertexArrayAttribFormat(gm.VAO, 10, 4, GL_FLOAT, GL_FALSE, offsetof(ParticleInstance, color));
+		glVertexArrayAttribBinding(gm.VAO, 10, binding);
+
+		glEnableVertexArrayAttrib(gm.VAO, 11);
+		glVertexArrayAttribFormat(gm.VAO, 11, 1, GL_FLOAT, GL_FALSE, offsetof(ParticleInstance, frame));
+		glVertexArrayAttribBinding(gm.VAO, 11, binding);
+	}
+
+	void GPU::updateInstanceBuffer(Mesh* m, const std::vector<ParticleInstance>& instances)
+	{
+		GpuMesh& gm = m->getGpuMesh().value();
+
+		const size_t count = std::min(instances.size(), gm.instanceCapacity);
+		gm.instanceCount = (GLsizei)count;
+
+		if (count > 0)
+			glNamedBufferSubData(gm.instanceVBO, 0, count * sizeof(ParticleInstance), instances.data());
+	}
+
+	unsigned int GPU::createParticleStateBuffer(size_t capacity)
+	{
+		// zeroed lifetimes mark every slot as unused until the cpu spawns into it
+		std::vector<ParticleGpuState> empty(capacity, ParticleGpuState{ glm::vec4(0.0f), glm::vec4(0.0f) });
+
+		unsigned int buffer;
+		glCreateBuffers(1, &buffer);
+		glNamedBufferData(buffer, capacity * sizeof(ParticleGpuState), empty.data(), GL_DYNAMIC_DRAW);
+
+		return buffer;
+	}
+
+	void GPU::updateParticleStateBuffer(unsigned int buffer, size_t first, const ParticleGpuState* states, size_t count)
+	{
+		if (count == 0)
+			return;
+
+		glNamedBufferSubData(buffer, first * sizeof(ParticleGpuState), count * sizeof(ParticleGpuState), states);
+	}
+
+	void GPU::dispatchParticleCompute(unsigned int stateBuffer, Mesh* m)
+	{
+		GpuMesh& gm = m->getGpuMesh().value();
+
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, stateBuffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, gm.instanceVBO);
+
+		// 64 matches local_size_x in particle.comp
+		glDispatchCompute((GLuint)((gm.instanceCapacity + 63) / 64), 1, 1);
+
+		// the instance buffer is consumed as vertex attributes, the state buffer again by next frame's dispatch
+		glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+
+		// dead slots are written as zero size instances, so every slot is drawn
+		gm.instanceCount = (GLsizei)gm.instanceCapacity;
+	}
+
+	void GPU::clearBuffer(unsigned int buffer)
+	{
+		glDeleteBuffers(1, &buffer);
+	}
+
+	unsigned int GPU::createOcclusionQuery()
+	{
+		unsigned int query;
+		glGenQueries(1, &query);
+		return query;
+	}
+
+	void GPU::clearOcclusionQuery(unsigned int query)
+	{
+		glDeleteQueries(1, &query);
+	}
+
+	void GPU::beginOcclusionQuery(unsigned int query)
+	{
+		glBeginQuery(GL_ANY_SAMPLES_PASSED_CONSERVATIVE, query);
+	}
+
+	void GPU::endOcclusionQuery()
+	{
+		glEndQuery(GL_ANY_SAMPLES_PASSED_CONSERVATIVE);
+	}
+
+	void GPU::beginConditionalRender(unsigned int query)
+	{
+		// NO_WAIT, if last frame's result hasn't arrived yet the draw simply happens
+		glBeginConditionalRender(query, GL_QUERY_NO_WAIT);
+	}
+
+	void GPU::endConditionalRender()
+	{
+		glEndConditionalRender();
+	}
+
+	void GPU::setOcclusionProxyRenderState()
+	{
+		glEnable(GL_DEPTH_TEST);
+		glDepthFunc(GL_LEQUAL);
+		glDepthMask(GL_FALSE);
+		glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+
+		// a proxy the camera has entered (near plane clipping its front faces) must still pass
+		this->disableBackfaceCulling();
+	}
+
+	void GPU::endOcclusionProxyRenderState()
+	{
+		this->enableBackfaceCulling();
+		glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+		glDepthMask(GL_TRUE);
+		glDepthFunc(GL_LESS);
+	}
+
+	GpuTimer GPU::createGpuTimer()
+	{
+		GpuTimer t;
+		glGenQueries(GpuTimer::latency, t.queries);
+		return t;
+	}
+
+	void GPU::beginGpuTimer(GpuTimer& t)
+	{
+		glBeginQuery(GL_TIME_ELAPSED, t.queries[t.issued % GpuTimer::latency]);
+	}
+
+	void GPU::endGpuTimer(GpuTimer& t)
+	{
+		glEndQuery(GL_TIME_ELAPSED);
+		t.issued++;
+
+		if (t.issued < GpuTimer::latency)
+			return;
+
+		// the slot reused by the next begin is the oldest one in flight
+		unsigned int oldest = t.queries[t.issued % GpuTimer::latency];
+
+		int available = 0;
+		glGetQueryObjectiv(oldest, GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available)
+			return;
+
+		GLuint64 nanoseconds = 0;
+		glGetQueryObjectui64v(oldest, GL_QUERY_RESULT, &nanoseconds);
+		t.milliseconds = (double)nanoseconds / 1000000.0;
+	}
+
+	void GPU::clearGpuTimer(GpuTimer& t)
+	{
+		if (t.queries[0] != 0)
+			glDeleteQueries(GpuTimer::latency, t.queries);
+
+		t = GpuTimer();
 	}
 
 	void GPU::drawLines(unsigned int pointCount)
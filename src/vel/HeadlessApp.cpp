@@ -1,3 +1,4 @@
+#include <limits>
 
 #include "spdlog/spdlog.h"
 
@@ -87,6 +88,10 @@ namespace vel
 		this->currentSimTick++;
 		this->activeScene->setTick(this->currentSimTick);
 
+		// no frame to protect here, so finish every async load that has completed decoding
+		this->assetManager->processPendingUploads(std::numeric_limits<double>::max());
+		this->activeScene->collectAsyncLoads();
+
 		this->activeScene->stepPhysics(dt);
 		this->activeScene->updateAnimators(dt);
 		this->activeScene->internalFixedLoop(dt);
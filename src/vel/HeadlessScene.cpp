@@ -1,4 +1,6 @@
 
+#include <chrono>
+
 #include "spdlog/spdlog.h"
 
 #include "vel/HeadlessScene.h"
@@ -10,7 +12,8 @@ namespace vel
 		tick(0),
 		dataDir(dataDir),
 		name(""),
-		assetManager(nullptr)
+		assetManager(nullptr),
+		stepCollisionWorldsConcurrently(false)
 	{}
 
 	HeadlessScene::~HeadlessScene() {}
@@ -57,14 +60,45 @@ namespace vel
 
 	void HeadlessScene::stepPhysics(float delta)
 	{
+		this->concurrentStepScratch.clear();
+
 		for (auto& cw : this->collisionWorlds)
-			if (cw->getIsActive())
-				cw->getDynamicsWorld()->stepSimulation(delta, 0);
+		{
+			if (!cw->getIsActive())
+				continue;
+
+			if (this->stepCollisionWorldsConcurrently && !cw->getIsMultithreaded())
+				this->concurrentStepScratch.push_back(cw);
+			else
+				cw->stepSimulation(delta);
+		}
+
+		// stepping opens BT_PROFILE samples, which are only safe to enter from several threads at once when bullet is
+		// built with BT_THREADSAFE, otherwise the worlds are stepped one after the other
+#if BT_THREADSAFE
+		if (this->concurrentStepScratch.size() > 1 && this->assetManager)
+		{
+			this->assetManager->getWorkerPool()->parallelFor(this->concurrentStepScratch.size(), 1, [this, delta](size_t begin, size_t end) {
+				for (size_t i = begin; i < end; i++)
+					this->concurrentStepScratch[i]->stepSimulation(delta);
+			});
+
+			return;
+		}
+#endif
+
+		for (auto& cw : this->concurrentStepScratch)
+			cw->stepSimulation(delta);
 	}
 
-	bool HeadlessScene::loadMesh(const std::string& path)
+	void HeadlessScene::setStepCollisionWorldsConcurrently(bool b)
 	{
-		std::vector<Mesh*> loadedMeshes = this->assetManager->loadMesh(path);
+		this->stepCollisionWorldsConcurrently = b;
+	}
+
+	bool HeadlessScene::loadMesh(const std::string& path, VertexFormat format)
+	{
+		std::vector<Mesh*> loadedMeshes = this->assetManager->loadMesh(path, format);
 		if (loadedMeshes.size() == 0)
 		{
 			SPDLOG_DEBUG("HeadlessScene::loadMesh: call to assetManager->loadMesh resulted in nullopt");
@@ -77,6 +111,63 @@ namespace vel
 		return true;
 	}
 
+	std::shared_future<std::vector<Mesh*>> HeadlessScene::loadMeshAsync(const std::string& path, VertexFormat format)
+	{
+		std::shared_future<std::vector<Mesh*>> f = this->assetManager->loadMeshAsync(path, format);
+
+		this->pendingMeshLoads.push_back(f);
+
+		return f;
+	}
+
+	void HeadlessScene::collectAsyncLoads()
+	{
+		for (size_t i = 0; i < this->pendingMeshLoads.size();)
+		{
+			auto& f = this->pendingMeshLoads.at(i);
+			if (f.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			{
+				i++;
+				continue;
+			}
+
+			for (auto& m : f.get())
+				this->meshesInUse.push_back(m);
+
+			this->pendingMeshLoads.erase(this->pendingMeshLoads.begin() + i);
+		}
+
+		for (size_t i = 0; i < this->pendingSkeletonLoads.size();)
+		{
+			auto& p = this->pendingSkeletonLoads.at(i);
+			if (p.second.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			{
+				i++;
+				continue;
+			}
+
+			if (p.second.get())
+				this->skeletonsInUse.push_back(p.first);
+
+			this->pendingSkeletonLoads.erase(this->pendingSkeletonLoads.begin() + i);
+		}
+
+		for (size_t i = 0; i < this->pendingAnimationLoads.size();)
+		{
+			auto& p = this->pendingAnimationLoads.at(i);
+			if (p.second.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			{
+				i++;
+				continue;
+			}
+
+			if (p.second.get())
+				this->animationsInUse.push_back(p.first);
+
+			this->pendingAnimationLoads.erase(this->pendingAnimationLoads.begin() + i);
+		}
+	}
+
 	Mesh* HeadlessScene::getMesh(const std::string& name)
 	{
 		return this->assetManager->getMesh(name);
@@ -91,6 +182,16 @@ namespace vel
 		return s;
 	}
 
+	std::shared_future<ozz::animation::Skeleton*> HeadlessScene::loadSkeletonAsync(const std::string& name, const std::string& path)
+	{
+		std::shared_future<ozz::animation::Skeleton*> f = this->assetManager->loadSkeletonAsync(name, path);
+
+		// tracked by collectAsyncLoads() once it has actually loaded
+		this->pendingSkeletonLoads.push_back({ name, f });
+
+		return f;
+	}
+
 	ozz::animation::Skeleton* HeadlessScene::getSkeleton(const std::string& name)
 	{
 		return this->assetManager->getSkeleton(name);
@@ -105,18 +206,31 @@ namespace vel
 		return s;
 	}
 
+	std::shared_future<ozz::animation::Animation*> HeadlessScene::loadAnimationAsync(const std::string& name, const std::string& path)
+	{
+		std::shared_future<ozz::animation::Animation*> f = this->assetManager->loadAnimationAsync(name, path);
+
+		this->pendingAnimationLoads.push_back({ name, f });
+
+		return f;
+	}
+
 	ozz::animation::Animation* HeadlessScene::getAnimation(const std::string& name)
 	{
 		return this->assetManager->getAnimation(name);
 	}
 
-	CollisionWorld* HeadlessScene::addCollisionWorld(const std::string& name, float gravity)
+	CollisionWorld* HeadlessScene::addCollisionWorld(const std::string& name, float gravity, bool multithreaded, BroadphaseOptions broadphase)
 	{
 		// for some reason CollisionWorld has to be a pointer or bullet has read access violation issues
 		// delete in destructor
-		CollisionWorld* cw = new CollisionWorld(name, gravity);
+		CollisionWorld* cw = new CollisionWorld(name, gravity, multithreaded, broadphase);
 		this->collisionWorlds.push_back(cw);
 
+		// instanced collision shapes are looked up by Mesh*, which must not outlive the mesh
+		if (this->assetManager)
+			this->assetManager->addMeshRemovedListener(cw, [cw](const Mesh* m) { cw->forgetInstancedMesh(m); });
+
 		return cw;
 	}
 
@@ -0,0 +1,174 @@
+#ifdef _WIN32
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <windows.h>
+
+#else
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#endif
+
+#include "spdlog/spdlog.h"
+
+#include "vel/MappedFile.h"
+
+
+namespace vel
+{
+	MappedFile::MappedFile() :
+		data(nullptr),
+		size(0),
+#ifdef _WIN32
+		fileHandle(nullptr),
+		mappingHandle(nullptr)
+#else
+		fileDescriptor(-1)
+#endif
+	{}
+
+	MappedFile::~MappedFile()
+	{
+		this->close();
+	}
+
+	bool MappedFile::isOpen() const
+	{
+		return this->data != nullptr;
+	}
+
+	const unsigned char* MappedFile::getData() const
+	{
+		return this->data;
+	}
+
+	size_t MappedFile::getSize() const
+	{
+		return this->size;
+	}
+
+#ifdef _WIN32
+
+	bool MappedFile::open(const std::string& path)
+	{
+		this->close();
+
+		HANDLE fh = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (fh == INVALID_HANDLE_VALUE)
+		{
+			SPDLOG_DEBUG("MappedFile::open: unable to open {}", path);
+			return false;
+		}
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(fh, &fileSize) || fileSize.QuadPart == 0)
+		{
+			SPDLOG_DEBUG("MappedFile::open: unable to map empty file {}", path);
+			CloseHandle(fh);
+			return false;
+		}
+
+		HANDLE mh = CreateFileMappingA(fh, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mh == nullptr)
+		{
+			SPDLOG_DEBUG("MappedFile::open: CreateFileMapping failed for {}", path);
+			CloseHandle(fh);
+			return false;
+		}
+
+		void* view = MapViewOfFile(mh, FILE_MAP_READ, 0, 0, 0);
+		if (view == nullptr)
+		{
+			SPDLOG_DEBUG("MappedFile::open: MapViewOfFile failed for {}", path);
+			CloseHandle(mh);
+			CloseHandle(fh);
+			return false;
+		}
+
+		this->fileHandle = fh;
+		this->mappingHandle = mh;
+		this->data = static_cast<const unsigned char*>(view);
+		this->size = static_cast<size_t>(fileSize.QuadPart);
+
+		return true;
+	}
+
+	void MappedFile::close()
+	{
+		if (this->data)
+			UnmapViewOfFile(this->data);
+
+		if (this->mappingHandle)
+			CloseHandle(this->mappingHandle);
+
+		if (this->fileHandle)
+			CloseHandle(this->fileHandle);
+
+		this->data = nullptr;
+		this->size = 0;
+		this->fileHandle = nullptr;
+		this->mappingHandle = nullptr;
+	}
+
+#else
+
+	bool MappedFile::open(const std::string& path)
+	{
+		this->close();
+
+		int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd == -1)
+		{
+			SPDLOG_DEBUG("MappedFile::open: unable to open {}", path);
+			return false;
+		}
+
+		struct stat st;
+		if (fstat(fd, &st) != 0 || st.st_size == 0)
+		{
+			SPDLOG_DEBUG("MappedFile::open: unable to map empty file {}", path);
+			::close(fd);
+			return false;
+		}
+
+		void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+		if (view == MAP_FAILED)
+		{
+			SPDLOG_DEBUG("MappedFile::open: mmap failed for {}", path);
+			::close(fd);
+			return false;
+		}
+
+		this->fileDescriptor = fd;
+		this->data = static_cast<const unsigned char*>(view);
+		this->size = static_cast<size_t>(st.st_size);
+
+		return true;
+	}
+
+	void MappedFile::close()
+	{
+		if (this->data)
+			munmap(const_cast<unsigned char*>(this->data), this->size);
+
+		if (this->fileDescriptor != -1)
+			::close(this->fileDescriptor);
+
+		this->data = nullptr;
+		this->size = 0;
+		this->fileDescriptor = -1;
+	}
+
+#endif
+
+}
@@ -9,7 +9,8 @@ namespace vel
 		name(name),
 		shader(shader),
 		color(glm::vec4(1.0f)),
-		hasAlphaChannel(false)
+		hasAlphaChannel(false),
+		options(0)
 	{}
 
 	const std::string& Material::getName() const
@@ -27,6 +28,16 @@ namespace vel
 		this->hasAlphaChannel = b;
 	}
 
+	int Material::getOptions() const
+	{
+		return this->options;
+	}
+
+	void Material::setOptions(int opts)
+	{
+		this->options = opts;
+	}
+
 	void Material::addTexture(Texture* t)
 	{
 		this->textures.push_back(t);
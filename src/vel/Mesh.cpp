@@ -1,4 +1,6 @@
 #include <iostream>
+#include <cstring>
+#include <algorithm>
 
 #include "spdlog/spdlog.h"
 
@@ -10,9 +12,140 @@ namespace vel
 
     Mesh::Mesh(std::string name) :
         name(name),
-		aabbStale(true)
+		aabbStale(true),
+		vertexFormat(VertexFormat::FULL),
+		dynamic(false),
+		dirtyVertexFirst(0),
+		dirtyVertexEnd(0),
+		dirtyIndexFirst(0),
+		dirtyIndexEnd(0)
     {}
 
+	// returns [first, end) of the elements that differ between current and incoming, incoming elements past the end of
+	// current always count as changed
+	template<typename T>
+	static std::pair<size_t, size_t> changedRange(const std::vector<T>& current, const T* incoming, size_t count)
+	{
+		// Vertex and unsigned int have no padding, so a byte compare is a full compare
+		const size_t common = std::min(current.size(), count);
+
+		size_t first = 0;
+		while (first < common && std::memcmp(&current[first], &incoming[first], sizeof(T)) == 0)
+			first++;
+
+		if (first == common && count <= current.size())
+			return { 0, 0 };
+
+		size_t end = count;
+		if (count <= current.size())
+			while (end > first && std::memcmp(&current[end - 1], &incoming[end - 1], sizeof(T)) == 0)
+				end--;
+
+		return { first, end };
+	}
+
+	void Mesh::setVertexFormat(VertexFormat vf)
+	{
+		if (this->gpuMesh.has_value())
+		{
+			SPDLOG_DEBUG("Mesh::setVertexFormat: {} is already loaded onto the gpu, format unchanged", this->name);
+			return;
+		}
+
+		this->vertexFormat = vf;
+	}
+
+	VertexFormat Mesh::getVertexFormat() const
+	{
+		return this->vertexFormat;
+	}
+
+	void Mesh::setDynamic(bool d)
+	{
+		if (this->gpuMesh.has_value())
+		{
+			SPDLOG_DEBUG("Mesh::setDynamic: {} is already loaded onto the gpu, unchanged", this->name);
+			return;
+		}
+
+		this->dynamic = d;
+	}
+
+	bool Mesh::isDynamic() const
+	{
+		return this->dynamic;
+	}
+
+	void Mesh::markVerticesDirty(size_t first, size_t end)
+	{
+		if (first >= end)
+			return;
+
+		if (!this->hasDirtyVertices())
+		{
+			this->dirtyVertexFirst = first;
+			this->dirtyVertexEnd = end;
+			return;
+		}
+
+		this->dirtyVertexFirst = std::min(this->dirtyVertexFirst, first);
+		this->dirtyVertexEnd = std::max(this->dirtyVertexEnd, end);
+	}
+
+	void Mesh::markIndicesDirty(size_t first, size_t end)
+	{
+		if (first >= end)
+			return;
+
+		if (!this->hasDirtyIndices())
+		{
+			this->dirtyIndexFirst = first;
+			this->dirtyIndexEnd = end;
+			return;
+		}
+
+		this->dirtyIndexFirst = std::min(this->dirtyIndexFirst, first);
+		this->dirtyIndexEnd = std::max(this->dirtyIndexEnd, end);
+	}
+
+	bool Mesh::hasDirtyVertices() const
+	{
+		return this->dirtyVertexEnd > this->dirtyVertexFirst;
+	}
+
+	size_t Mesh::getDirtyVertexFirst() const
+	{
+		return this->dirtyVertexFirst;
+	}
+
+	size_t Mesh::getDirtyVertexEnd() const
+	{
+		return this->dirtyVertexEnd;
+	}
+
+	bool Mesh::hasDirtyIndices() const
+	{
+		return this->dirtyIndexEnd > this->dirtyIndexFirst;
+	}
+
+	size_t Mesh::getDirtyIndexFirst() const
+	{
+		return this->dirtyIndexFirst;
+	}
+
+	size_t Mesh::getDirtyIndexEnd() const
+	{
+		return this->dirtyIndexEnd;
+	}
+
+	void Mesh::clearDirtyRanges()
+	{
+		this->dirtyVertexFirst = 0;
+		this->dirtyVertexEnd = 0;
+		this->dirtyIndexFirst = 0;
+		this->dirtyIndexEnd = 0;
+	}
+
 	AABB& Mesh::getAABB()
 	{
 		if (this->aabb.has_value() && !this->aabbStale)
@@ -54,13 +187,41 @@ namespace vel
 
 	void Mesh::setVertices(const std::vector<Vertex>& vertices)
 	{
-		this->vertices = vertices;
-		this->aabbStale = true;
+		this->setVertices(vertices.data(), vertices.size());
 	}
 
 	void Mesh::setIndices(const std::vector<unsigned int>& indices)
 	{
-		this->indices = indices;
+		this->setIndices(indices.data(), indices.size());
+	}
+
+	void Mesh::setVertices(const Vertex* vertices, size_t count)
+	{
+		if (this->dynamic)
+		{
+			auto range = changedRange(this->vertices, vertices, count);
+			this->markVerticesDirty(range.first, range.second);
+		}
+
+		this->vertices.assign(vertices, vertices + count);
+		this->aabbStale = true;
+	}
+
+	void Mesh::setIndices(const unsigned int* indices, size_t count)
+	{
+		if (this->dynamic)
+		{
+			auto range = changedRange(this->indices, indices, count);
+			this->markIndicesDirty(range.first, range.second);
+		}
+
+		this->indices.assign(indices, indices + count);
+	}
+
+	void Mesh::setAABB(const AABB& a)
+	{
+		this->aabb = a;
+		this->aabbStale = false;
 	}
 
 	void Mesh::setBones(const std::vector<MeshBone>& bones)
@@ -112,6 +273,85 @@ namespace vel
 		this->vertices.insert(this->vertices.end(), vs.begin(), vs.end());
 	}
 
+	bool Mesh::addLod(const std::vector<unsigned int>& indices, float screenSize)
+	{
+		if (this->lods.size() + 1 >= MAX_MESH_LODS)
+		{
+			SPDLOG_DEBUG("Mesh::addLod: {} already has the maximum of {} levels", this->name, MAX_MESH_LODS);
+			return false;
+		}
+
+		for (auto i : indices)
+		{
+			if (i >= this->vertices.size())
+			{
+				SPDLOG_DEBUG("Mesh::addLod: {} lod index {} is out of range", this->name, i);
+				return false;
+			}
+		}
+
+		MeshLod l;
+		l.indices = indices;
+		l.screenSize = screenSize;
+		this->lods.push_back(std::move(l));
+
+		return true;
+	}
+
+	bool Mesh::addLod(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, float screenSize)
+	{
+		const unsigned int base = (unsigned int)this->vertices.size();
+
+		std::vector<unsigned int> rebased(indices.size());
+		for (size_t i = 0; i < indices.size(); i++)
+			rebased[i] = indices[i] + base;
+
+		this->appendVertices(vertices);
+		this->aabbStale = true;
+
+		if (this->addLod(rebased, screenSize))
+			return true;
+
+		this->vertices.resize(base);
+		return false;
+	}
+
+	void Mesh::setLodScreenSize(size_t level, float screenSize)
+	{
+		if (level == 0 || level > this->lods.size())
+			return;
+
+		this->lods[level - 1].screenSize = screenSize;
+	}
+
+	const std::vector<MeshLod>& Mesh::getLods() const
+	{
+		return this->lods;
+	}
+
+	size_t Mesh::getLodCount() const
+	{
+		return this->lods.size() + 1;
+	}
+
+	void Mesh::clearLods()
+	{
+		this->lods.clear();
+	}
+
+	size_t Mesh::selectLod(float screenSize, size_t current, float hysteresis) const
+	{
+		size_t lod = std::min(current, this->lods.size());
+
+		while (lod < this->lods.size() && screenSize < this->lods[lod].screenSize * (1.0f - hysteresis))
+			lod++;
+
+		while (lod > 0 && screenSize > this->lods[lod - 1].screenSize * (1.0f + hysteresis))
+			lod--;
+
+		return lod;
+	}
+
 	bool Mesh::initBillboardQuad(float width, float height)
 	{
 		if (!(width > 0.0f && height > 0.0f))
@@ -0,0 +1,362 @@
+#include <algorithm>
+#include <cmath>
+
+#include "spdlog/spdlog.h"
+
+#include "vel/MeshOptimizer.h"
+
+
+namespace vel
+{
+	static const unsigned int NO_VERTEX = 0xffffffffu;
+	static const unsigned int NO_TRIANGLE = 0xffffffffu;
+
+	// lru size the forsyth scores are tuned for, larger than the reporting fifo on purpose
+	static const size_t FORSYTH_CACHE_SIZE = 32;
+	static const size_t FORSYTH_VALENCE_TABLE_SIZE = 32;
+
+	static float forsythCacheScore(size_t cachePosition)
+	{
+		// the last triangle's vertices score the same whichever order they were used in
+		if (cachePosition < 3)
+			return 0.75f;
+
+		return std::pow(1.0f - (float)(cachePosition - 3) / (float)(FORSYTH_CACHE_SIZE - 3), 1.5f);
+	}
+
+	static float forsythValenceScore(unsigned int remaining)
+	{
+		// boosts vertices with few triangles left so they get finished off instead of lingering
+		return 2.0f / std::sqrt((float)remaining);
+	}
+
+	static void replaceLodIndices(Mesh* m, const std::vector<MeshLod>& lods)
+	{
+		m->clearLods();
+		for (auto& l : lods)
+			m->addLod(l.indices, l.screenSize);
+	}
+
+	VertexCacheStats MeshOptimizer::analyzeVertexCache(const std::vector<unsigned int>& indices, size_t vertexCount, size_t cacheSize)
+	{
+		VertexCacheStats stats = { 0.0f, 0.0f };
+
+		if (indices.empty() || vertexCount == 0)
+			return stats;
+
+		// fifo emulation, a vertex is still cached while fewer than cacheSize misses happened since it was loaded
+		std::vector<size_t> loadedAt(vertexCount, 0);
+		size_t time = cacheSize + 1;
+		size_t misses = 0;
+		size_t unique = 0;
+
+		for (auto i : indices)
+		{
+			if (loadedAt[i] == 0)
+				unique++;
+
+			if (time - loadedAt[i] > cacheSize)
+			{
+				loadedAt[i] = time++;
+				misses++;
+			}
+		}
+
+		stats.acmr = (float)misses / (float)(indices.size() / 3);
+		stats.atvr = (float)misses / (float)unique;
+
+		return stats;
+	}
+
+	void MeshOptimizer::optimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount)
+	{
+		const size_t triangleCount = indices.size() / 3;
+		if (triangleCount < 2)
+			return;
+
+		float cacheScores[FORSYTH_CACHE_SIZE];
+		for (size_t i = 0; i < FORSYTH_CACHE_SIZE; i++)
+			cacheScores[i] = forsythCacheScore(i);
+
+		float valenceScores[FORSYTH_VALENCE_TABLE_SIZE];
+		for (size_t i = 1; i < FORSYTH_VALENCE_TABLE_SIZE; i++)
+			valenceScores[i] = forsythValenceScore((unsigned int)i);
+
+		auto vertexScore = [&](int cachePosition, unsigned int remaining) -> float {
+			if (remaining == 0)
+				return -1.0f;
+
+			float score = cachePosition >= 0 ? cacheScores[cachePosition] : 0.0f;
+			score += remaining < FORSYTH_VALENCE_TABLE_SIZE ? valenceScores[remaining] : forsythValenceScore(remaining);
+			return score;
+		};
+
+		// vertex -> live triangles, a vertex's live triangles are the first remaining[v] of its range
+		std::vector<unsigned int> remaining(vertexCount, 0);
+		for (auto i : indices)
+			remaining[i]++;
+
+		std::vector<unsigned int> offsets(vertexCount + 1, 0);
+		for (size_t v = 0; v < vertexCount; v++)
+			offsets[v + 1] = offsets[v] + remaining[v];
+
+		std::vector<unsigned int> adjacency(indices.size());
+		{
+			std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+			for (size_t i = 0; i < indices.size(); i++)
+				adjacency[fill[indices[i]]++] = (unsigned int)(i / 3);
+		}
+
+		std::vector<int> cachePosition(vertexCount, -1);
+		std::vector<float> scores(vertexCount);
+		for (size_t v = 0; v < vertexCount; v++)
+			scores[v] = vertexScore(-1, remaining[v]);
+
+		std::vector<float> triangleScores(triangleCount);
+		for (size_t t = 0; t < triangleCount; t++)
+			triangleScores[t] = scores[indices[t * 3]] + scores[indices[t * 3 + 1]] + scores[indices[t * 3 + 2]];
+
+		std::vector<char> emitted(triangleCount, 0);
+		std::vector<unsigned int> output;
+		output.reserve(indices.size());
+
+		std::vector<unsigned int> cache;
+		std::vector<unsigned int> nextCache;
+		cache.reserve(FORSYTH_CACHE_SIZE + 3);
+		nextCache.reserve(FORSYTH_CACHE_SIZE + 3);
+
+		unsigned int best = (unsigned int)(std::max_element(triangleScores.begin(), triangleScores.end()) - triangleScores.begin());
+		size_t cursor = 0;
+
+		while (output.size() < indices.size())
+		{
+			if (best == NO_TRIANGLE)
+			{
+				// nothing adjacent to the cache is left, restart from the next triangle in input order
+				while (emitted[cursor])
+					cursor++;
+
+				best = (unsigned int)cursor;
+			}
+
+			const unsigned int* tri = &indices[best * 3];
+			emitted[best] = 1;
+			output.insert(output.end(), tri, tri + 3);
+
+			for (int k = 0; k < 3; k++)
+			{
+				const unsigned int v = tri[k];
+				unsigned int* live = &adjacency[offsets[v]];
+				unsigned int* found = std::find(live, live + remaining[v], best);
+				std::swap(*found, live[remaining[v] - 1]);
+				remaining[v]--;
+			}
+
+			// the triangle's vertices move to the front, everything else shifts back and may fall out
+			nextCache.assign(tri, tri + 3);
+			for (auto v : cache)
+				if (v != tri[0] && v != tri[1] && v != tri[2])
+					nextCache.push_back(v);
+
+			for (size_t i = FORSYTH_CACHE_SIZE; i < nextCache.size(); i++)
+				cachePosition[nextCache[i]] = -1;
+
+			for (size_t i = 0; i < nextCache.size(); i++)
+			{
+				const unsigned int v = nextCache[i];
+				if (i < FORSYTH_CACHE_SIZE)
+					cachePosition[v] = (int)i;
+
+				const float score = vertexScore(cachePosition[v], remaining[v]);
+				const float delta = score - scores[v];
+				scores[v] = score;
+
+				for (unsigned int j = 0; j < remaining[v]; j++)
+					triangleScores[adjacency[offsets[v] + j]] += delta;
+			}
+
+			if (nextCache.size() > FORSYTH_CACHE_SIZE)
+				nextCache.resize(FORSYTH_CACHE_SIZE);
+
+			std::swap(cache, nextCache);
+
+			best = NO_TRIANGLE;
+			float bestScore = -1.0f;
+			for (auto v : cache)
+			{
+				for (unsigned int j = 0; j < remaining[v]; j++)
+				{
+					const unsigned int t = adjacency[offsets[v] + j];
+					if (triangleScores[t] > bestScore)
+					{
+						bestScore = triangleScores[t];
+						best = t;
+					}
+				}
+			}
+		}
+
+		indices.swap(output);
+	}
+
+	void MeshOptimizer::optimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices, float threshold)
+	{
+		const size_t triangleCount = indices.size() / 3;
+		if (triangleCount < 2)
+			return;
+
+		const float acmrBefore = analyzeVertexCache(indices, vertices.size()).acmr;
+
+		// a triangle missing on all three vertices starts over with a cold cache, so cutting there costs nothing
+		std::vector<size_t> clusterStarts;
+		{
+			std::vector<size_t> loadedAt(vertices.size(), 0);
+			size_t time = MeshOptimizer::cacheSize + 1;
+
+			for (size_t t = 0; t < triangleCount; t++)
+			{
+				int misses = 0;
+				for (int k = 0; k < 3; k++)
+				{
+					const unsigned int v = indices[t * 3 + k];
+					if (time - loadedAt[v] > MeshOptimizer::cacheSize)
+					{
+						loadedAt[v] = time++;
+						misses++;
+					}
+				}
+
+				if (t == 0 || misses == 3)
+					clusterStarts.push_back(t);
+			}
+		}
+
+		if (clusterStarts.size() < 2)
+			return;
+
+		clusterStarts.push_back(triangleCount);
+		const size_t clusterCount = clusterStarts.size() - 1;
+
+		std::vector<glm::vec3> centroids(clusterCount, glm::vec3(0.0f));
+		std::vector<glm::vec3> normals(clusterCount, glm::vec3(0.0f));
+		std::vector<float> areas(clusterCount, 0.0f);
+		glm::vec3 meshCentroid(0.0f);
+		float meshArea = 0.0f;
+
+		for (size_t c = 0; c < clusterCount; c++)
+		{
+			for (size_t t = clusterStarts[c]; t < clusterStarts[c + 1]; t++)
+			{
+				const glm::vec3& p0 = vertices[indices[t * 3]].position;
+				const glm::vec3& p1 = vertices[indices[t * 3 + 1]].position;
+				const glm::vec3& p2 = vertices[indices[t * 3 + 2]].position;
+
+				glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+				float area = glm::length(n);
+
+				centroids[c] = centroids[c] + (p0 + p1 + p2) * (area / 3.0f);
+				normals[c] = normals[c] + n;
+				areas[c] += area;
+			}
+
+			meshCentroid = meshCentroid + centroids[c];
+			meshArea += areas[c];
+
+			if (areas[c] > 0.0f)
+				centroids[c] = centroids[c] * (1.0f / areas[c]);
+		}
+
+		if (!(meshArea > 0.0f))
+			return;
+
+		meshCentroid = meshCentroid * (1.0f / meshArea);
+
+		// clusters facing away from the middle of the mesh are on its outside, and so are the likeliest occluders
+		std::vector<float> keys(clusterCount, 0.0f);
+		for (size_t c = 0; c < clusterCount; c++)
+		{
+			float len = glm::length(normals[c]);
+			if (len > 0.0f)
+				keys[c] = glm::dot(centroids[c] - meshCentroid, normals[c] * (1.0f / len));
+		}
+
+		std::vector<unsigned int> order(clusterCount);
+		for (size_t c = 0; c < clusterCount; c++)
+			order[c] = (unsigned int)c;
+
+		std::stable_sort(order.begin(), order.end(), [&keys](unsigned int a, unsigned int b) { return keys[a] > keys[b]; });
+
+		std::vector<unsigned int> sorted;
+		sorted.reserve(indices.size());
+		for (auto c : order)
+			sorted.insert(sorted.end(), indices.begin() + clusterStarts[c] * 3, indices.begin() + clusterStarts[c + 1] * 3);
+
+		if (analyzeVertexCache(sorted, vertices.size()).acmr > acmrBefore * threshold)
+			return;
+
+		indices.swap(sorted);
+	}
+
+	void MeshOptimizer::optimizeVertexFetch(Mesh* m)
+	{
+		const std::vector<Vertex>& vertices = m->getVertices();
+		std::vector<MeshLod> lods = m->getLods();
+
+		std::vector<unsigned int> remap(vertices.size(), NO_VERTEX);
+		unsigned int next = 0;
+
+		auto assign = [&](std::vector<unsigned int>& indices) {
+			for (auto& i : indices)
+			{
+				if (remap[i] == NO_VERTEX)
+					remap[i] = next++;
+
+				i = remap[i];
+			}
+		};
+
+		std::vector<unsigned int> indices = m->getIndices();
+		assign(indices);
+		for (auto& l : lods)
+			assign(l.indices);
+
+		std::vector<Vertex> remapped(next);
+		for (size_t v = 0; v < vertices.size(); v++)
+			if (remap[v] != NO_VERTEX)
+				remapped[remap[v]] = vertices[v];
+
+		if (remapped.size() < vertices.size())
+			SPDLOG_DEBUG("MeshOptimizer::optimizeVertexFetch: {} dropped {} unreferenced vertices", m->getName(), vertices.size() - remapped.size());
+
+		m->setVertices(remapped);
+		m->setIndices(indices);
+		replaceLodIndices(m, lods);
+	}
+
+	MeshOptimizationReport MeshOptimizer::optimize(Mesh* m)
+	{
+		MeshOptimizationReport report;
+		report.before = analyzeVertexCache(m->getIndices(), m->getVertices().size());
+
+		const size_t vertexCount = m->getVertices().size();
+
+		std::vector<unsigned int> indices = m->getIndices();
+		optimizeVertexCache(indices, vertexCount);
+		optimizeOverdraw(indices, m->getVertices());
+		m->setIndices(indices);
+
+		std::vector<MeshLod> lods = m->getLods();
+		for (auto& l : lods)
+			optimizeVertexCache(l.indices, vertexCount);
+		replaceLodIndices(m, lods);
+
+		optimizeVertexFetch(m);
+
+		report.after = analyzeVertexCache(m->getIndices(), m->getVertices().size());
+
+		SPDLOG_DEBUG("MeshOptimizer::optimize: {} acmr {:.3f} -> {:.3f}, atvr {:.3f} -> {:.3f}", m->getName(),
+			report.before.acmr, report.after.acmr, report.before.atvr, report.after.atvr);
+
+		return report;
+	}
+}
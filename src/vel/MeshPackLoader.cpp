@@ -0,0 +1,445 @@
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+
+#include "spdlog/spdlog.h"
+
+#include "vel/MeshPackLoader.h"
+#include "vel/MeshSimplifier.h"
+#include "vel/MeshOptimizer.h"
+
+
+namespace vel
+{
+	static const char MESH_PACK_MAGIC[8] = { 'V', 'E', 'L', 'M', 'E', 'S', 'H', '\0' };
+
+	static uint64_t alignTo16(uint64_t v)
+	{
+		return (v + 15) & ~uint64_t(15);
+	}
+
+	MeshPackLoader::MeshPackLoader(std::unique_ptr<MeshLoaderInterface> sourceLoader, size_t generatedLodLevels) :
+		sourceLoader(std::move(sourceLoader)),
+		entries(nullptr),
+		entryCount(0),
+		generatedLodLevels(generatedLodLevels)
+	{}
+
+	std::string MeshPackLoader::getPackPath(const std::string& sourcePath)
+	{
+		return sourcePath + ".velmesh";
+	}
+
+	void MeshPackLoader::reset()
+	{
+		this->pack.close();
+		this->entries = nullptr;
+		this->entryCount = 0;
+		this->meshesInFile.clear();
+		this->cookedMeshes.clear();
+	}
+
+	bool MeshPackLoader::packIsCurrent(const std::string& sourcePath, const std::string& packPath)
+	{
+		std::error_code ec;
+
+		if (!std::filesystem::exists(packPath, ec))
+			return false;
+
+		// shipping only the pack is allowed
+		if (!std::filesystem::exists(sourcePath, ec))
+			return true;
+
+		auto packTime = std::filesystem::last_write_time(packPath, ec);
+		if (ec)
+			return false;
+
+		auto sourceTime = std::filesystem::last_write_time(sourcePath, ec);
+		if (ec)
+			return true;
+
+		return packTime >= sourceTime;
+	}
+
+	bool MeshPackLoader::mapPack(const std::string& packPath)
+	{
+		if (!this->pack.open(packPath))
+			return false;
+
+		const unsigned char* base = this->pack.getData();
+		const size_t size = this->pack.getSize();
+
+		if (size < sizeof(MeshPackHeader))
+		{
+			SPDLOG_DEBUG("MeshPackLoader::mapPack: {} is truncated", packPath);
+			this->pack.close();
+			return false;
+		}
+
+		const MeshPackHeader* header = reinterpret_cast<const MeshPackHeader*>(base);
+
+		if (std::memcmp(header->magic, MESH_PACK_MAGIC, sizeof(MESH_PACK_MAGIC)) != 0 ||
+			header->version != MESH_PACK_VERSION || header->vertexSize != sizeof(Vertex))
+		{
+			SPDLOG_DEBUG("MeshPackLoader::mapPack: {} is not a compatible mesh pack", packPath);
+			this->pack.close();
+			return false;
+		}
+
+		uint64_t entriesOffset = alignTo16(sizeof(MeshPackHeader));
+		if (entriesOffset + (uint64_t)header->meshCount * sizeof(MeshPackEntry) > size)
+		{
+			SPDLOG_DEBUG("MeshPackLoader::mapPack: {} is truncated", packPath);
+			this->pack.close();
+			return false;
+		}
+
+		this->entries = reinterpret_cast<const MeshPackEntry*>(base + entriesOffset);
+		this->entryCount = header->meshCount;
+
+		// validate every range up front so load() can hand out spans without checking
+		for (uint32_t i = 0; i < this->entryCount; i++)
+		{
+			const MeshPackEntry& e = this->entries[i];
+
+			if (e.nameOffset + e.nameLength > size ||
+				e.boneOffset + (uint64_t)e.boneCount * sizeof(MeshPackBone) > size ||
+				e.vertexOffset + e.vertexCount * sizeof(Vertex) > size ||
+				e.indexOffset + e.indexCount * sizeof(unsigned int) > size ||
+				e.lodOffset + (uint64_t)e.lodCount * sizeof(MeshPackLod) > size)
+			{
+				SPDLOG_DEBUG("MeshPackLoader::mapPack: {} has an out of range entry", packPath);
+				this->reset();
+				return false;
+			}
+
+			const MeshPackBone* bones = reinterpret_cast<const MeshPackBone*>(base + e.boneOffset);
+			for (uint32_t j = 0; j < e.boneCount; j++)
+			{
+				if (bones[j].nameOffset + bones[j].nameLength > size)
+				{
+					SPDLOG_DEBUG("MeshPackLoader::mapPack: {} has an out of range bone name", packPath);
+					this->reset();
+					return false;
+				}
+			}
+
+			const MeshPackLod* lods = reinterpret_cast<const MeshPackLod*>(base + e.lodOffset);
+			for (uint32_t j = 0; j < e.lodCount; j++)
+			{
+				if (lods[j].indexOffset + lods[j].indexCount * sizeof(unsigned int) > size)
+				{
+					SPDLOG_DEBUG("MeshPackLoader::mapPack: {} has an out of range lod", packPath);
+					this->reset();
+					return false;
+				}
+			}
+
+			this->meshesInFile.push_back(std::string(reinterpret_cast<const char*>(base + e.nameOffset), e.nameLength));
+		}
+
+		return true;
+	}
+
+	bool MeshPackLoader::writePack(const std::string& packPath, const std::vector<std::unique_ptr<Mesh>>& meshes)
+	{
+		std::vector<MeshPackEntry> packEntries(meshes.size());
+		std::vector<MeshPackBone> packBones;
+		std::vector<MeshPackLod> packLods;
+		std::string names;
+
+		for (size_t i = 0; i < meshes.size(); i++)
+		{
+			Mesh* m = meshes[i].get();
+			MeshPackEntry& e = packEntries[i];
+			std::memset(&e, 0, sizeof(MeshPackEntry));
+
+			e.nameOffset = names.size(); // relative for now, fixed up below
+			e.nameLength = (uint32_t)m->getName().size();
+			names += m->getName();
+
+			e.boneOffset = packBones.size();
+			e.boneCount = (uint32_t)m->getBones().size();
+			for (auto& b : m->getBones())
+			{
+				MeshPackBone pb;
+				std::memset(&pb, 0, sizeof(MeshPackBone));
+				pb.nameOffset = names.size();
+				pb.nameLength = (uint32_t)b.name.size();
+				std::memcpy(pb.offsetMatrix, &b.offsetMatrix[0][0], sizeof(pb.offsetMatrix));
+				names += b.name;
+
+				packBones.push_back(pb);
+			}
+
+			e.vertexCount = m->getVertices().size();
+			e.indexCount = m->getIndices().size();
+
+			e.lodOffset = packLods.size();
+			e.lodCount = (uint32_t)m->getLods().size();
+			for (auto& l : m->getLods())
+			{
+				MeshPackLod pl;
+				std::memset(&pl, 0, sizeof(MeshPackLod));
+				pl.indexCount = l.indices.size();
+				pl.screenSize = l.screenSize;
+
+				packLods.push_back(pl);
+			}
+
+			AABB& aabb = m->getAABB();
+			glm::vec3 mn = aabb.getMinEdge();
+			glm::vec3 mx = aabb.getMaxEdge();
+			std::memcpy(e.aabbMin, &mn[0], sizeof(e.aabbMin));
+			std::memcpy(e.aabbMax, &mx[0], sizeof(e.aabbMax));
+		}
+
+		// lay out sections
+		uint64_t entriesOffset = alignTo16(sizeof(MeshPackHeader));
+		uint64_t bonesOffset = alignTo16(entriesOffset + packEntries.size() * sizeof(MeshPackEntry));
+		uint64_t lodsOffset = alignTo16(bonesOffset + packBones.size() * sizeof(MeshPackBone));
+		uint64_t namesOffset = alignTo16(lodsOffset + packLods.size() * sizeof(MeshPackLod));
+		uint64_t cursor = alignTo16(namesOffset + names.size());
+
+		for (size_t i = 0; i < meshes.size(); i++)
+		{
+			MeshPackEntry& e = packEntries[i];
+			e.nameOffset += namesOffset;
+			e.boneOffset = bonesOffset + e.boneOffset * sizeof(MeshPackBone);
+
+			e.vertexOffset = cursor;
+			cursor = alignTo16(cursor + e.vertexCount * sizeof(Vertex));
+		}
+
+		for (size_t i = 0; i < meshes.size(); i++)
+		{
+			MeshPackEntry& e = packEntries[i];
+			e.indexOffset = cursor;
+			cursor = alignTo16(cursor + e.indexCount * sizeof(unsigned int));
+
+			for (uint32_t j = 0; j < e.lodCount; j++)
+			{
+				MeshPackLod& pl = packLods[e.lodOffset + j];
+				pl.indexOffset = cursor;
+				cursor = alignTo16(cursor + pl.indexCount * sizeof(unsigned int));
+			}
+
+			e.lodOffset = lodsOffset + e.lodOffset * sizeof(MeshPackLod);
+		}
+
+		for (auto& pb : packBones)
+			pb.nameOffset += namesOffset;
+
+		MeshPackHeader header;
+		std::memset(&header, 0, sizeof(MeshPackHeader));
+		std::memcpy(header.magic, MESH_PACK_MAGIC, sizeof(MESH_PACK_MAGIC));
+		header.version = MESH_PACK_VERSION;
+		header.vertexSize = sizeof(Vertex);
+		header.meshCount = (uint32_t)meshes.size();
+
+		// write to a temporary file first so that an interrupted cook never leaves a valid looking, partial pack
+		std::string tmpPath = packPath + ".tmp";
+		{
+			std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+			if (!out)
+			{
+				SPDLOG_DEBUG("MeshPackLoader::writePack: unable to open {} for writing", tmpPath);
+				return false;
+			}
+
+			auto padTo = [&out](uint64_t offset) {
+				static const char zeros[16] = {};
+				uint64_t pos = (uint64_t)out.tellp();
+				if (offset > pos)
+					out.write(zeros, (std::streamsize)(offset - pos));
+			};
+
+			out.write(reinterpret_cast<const char*>(&header), sizeof(MeshPackHeader));
+
+			padTo(entriesOffset);
+			if (!packEntries.empty())
+				out.write(reinterpret_cast<const char*>(packEntries.data()), packEntries.size() * sizeof(MeshPackEntry));
+
+			padTo(bonesOffset);
+			if (!packBones.empty())
+				out.write(reinterpret_cast<const char*>(packBones.data()), packBones.size() * sizeof(MeshPackBone));
+
+			padTo(lodsOffset);
+			if (!packLods.empty())
+				out.write(reinterpret_cast<const char*>(packLods.data()), packLods.size() * sizeof(MeshPackLod));
+
+			padTo(namesOffset);
+			out.write(names.data(), names.size());
+
+			for (size_t i = 0; i < meshes.size(); i++)
+			{
+				padTo(packEntries[i].vertexOffset);
+				if (packEntries[i].vertexCount > 0)
+					out.write(reinterpret_cast<const char*>(meshes[i]->getVertices().data()), packEntries[i].vertexCount * sizeof(Vertex));
+			}
+
+			for (size_t i = 0; i < meshes.size(); i++)
+			{
+				padTo(packEntries[i].indexOffset);
+				if (packEntries[i].indexCount > 0)
+					out.write(reinterpret_cast<const char*>(meshes[i]->getIndices().data()), packEntries[i].indexCount * sizeof(unsigned int));
+
+				const std::vector<MeshLod>& lods = meshes[i]->getLods();
+				const size_t firstLod = (size_t)((packEntries[i].lodOffset - lodsOffset) / sizeof(MeshPackLod));
+				for (size_t j = 0; j < lods.size(); j++)
+				{
+					padTo(packLods[firstLod + j].indexOffset);
+					if (!lods[j].indices.empty())
+						out.write(reinterpret_cast<const char*>(lods[j].indices.data()), lods[j].indices.size() * sizeof(unsigned int));
+				}
+			}
+
+			if (!out)
+			{
+				SPDLOG_DEBUG("MeshPackLoader::writePack: failed writing {}", tmpPath);
+				return false;
+			}
+		}
+
+		std::error_code ec;
+		std::filesystem::rename(tmpPath, packPath, ec);
+		if (ec)
+		{
+			SPDLOG_DEBUG("MeshPackLoader::writePack: unable to move {} into place: {}", tmpPath, ec.message());
+			std::filesystem::remove(tmpPath, ec);
+			return false;
+		}
+
+		return true;
+	}
+
+	bool MeshPackLoader::cook(const std::string& sourcePath, const std::string& packPath)
+	{
+		if (!this->sourceLoader)
+		{
+			SPDLOG_DEBUG("MeshPackLoader::cook: no source loader to cook {} with", sourcePath);
+			return false;
+		}
+
+		std::vector<std::string> names = this->sourceLoader->preload(sourcePath);
+		if (names.empty())
+		{
+			this->sourceLoader->reset();
+			return false;
+		}
+
+		std::vector<std::unique_ptr<Mesh>> loaded = this->sourceLoader->load(&names);
+		this->sourceLoader->reset();
+
+		for (auto& m : loaded)
+		{
+			if (this->generatedLodLevels > 0 && m->getLods().empty())
+				MeshSimplifier::generateLods(m.get(), this->generatedLodLevels);
+
+			// last, so the lods generated above are reordered too
+			MeshOptimizer::optimize(m.get());
+		}
+
+		SPDLOG_DEBUG("MeshPackLoader::cook: cooking {} meshes from {}", loaded.size(), sourcePath);
+
+		if (writePack(packPath, loaded) && this->mapPack(packPath))
+			return true;
+
+		// cooking failed to produce a usable pack (read only data directory for example), serve what we loaded
+		for (auto& m : loaded)
+			this->meshesInFile.push_back(m->getName());
+
+		this->cookedMeshes = std::move(loaded);
+
+		return true;
+	}
+
+	const std::vector<std::string>& MeshPackLoader::preload(const std::string& filePath)
+	{
+		this->reset();
+
+		std::string packPath = getPackPath(filePath);
+
+		if (this->packIsCurrent(filePath, packPath) && this->mapPack(packPath))
+			return this->meshesInFile;
+
+		this->reset();
+		this->cook(filePath, packPath);
+
+		return this->meshesInFile;
+	}
+
+	std::unique_ptr<Mesh> MeshPackLoader::meshFromEntry(const MeshPackEntry& e)
+	{
+		const unsigned char* base = this->pack.getData();
+
+		std::unique_ptr<Mesh> m = std::make_unique<Mesh>(std::string(reinterpret_cast<const char*>(base + e.nameOffset), e.nameLength));
+
+		const Vertex* vertices = reinterpret_cast<const Vertex*>(base + e.vertexOffset);
+		const unsigned int* indices = reinterpret_cast<const unsigned int*>(base + e.indexOffset);
+
+		m->setVertices(vertices, (size_t)e.vertexCount);
+		m->setIndices(indices, (size_t)e.indexCount);
+
+		if (e.boneCount > 0)
+		{
+			const MeshPackBone* packBones = reinterpret_cast<const MeshPackBone*>(base + e.boneOffset);
+
+			std::vector<MeshBone> bones(e.boneCount);
+			for (uint32_t i = 0; i < e.boneCount; i++)
+			{
+				bones[i].name = std::string(reinterpret_cast<const char*>(base + packBones[i].nameOffset), packBones[i].nameLength);
+				std::memcpy(&bones[i].offsetMatrix[0][0], packBones[i].offsetMatrix, sizeof(packBones[i].offsetMatrix));
+			}
+
+			m->setBones(bones);
+		}
+
+		const MeshPackLod* lods = reinterpret_cast<const MeshPackLod*>(base + e.lodOffset);
+		for (uint32_t i = 0; i < e.lodCount; i++)
+		{
+			const unsigned int* lodIndices = reinterpret_cast<const unsigned int*>(base + lods[i].indexOffset);
+			m->addLod(std::vector<unsigned int>(lodIndices, lodIndices + lods[i].indexCount), lods[i].screenSize);
+		}
+
+		m->setAABB(AABB(
+			glm::vec3(e.aabbMin[0], e.aabbMin[1], e.aabbMin[2]),
+			glm::vec3(e.aabbMax[0], e.aabbMax[1], e.aabbMax[2])
+		));
+
+		return m;
+	}
+
+	std::vector<std::unique_ptr<Mesh>> MeshPackLoader::load(const std::vector<std::string>* loadables)
+	{
+		std::vector<std::unique_ptr<Mesh>> out;
+
+		for (auto& name : *loadables)
+		{
+			if (this->pack.isOpen())
+			{
+				for (uint32_t i = 0; i < this->entryCount; i++)
+				{
+					if (this->meshesInFile[i] == name)
+					{
+						out.push_back(this->meshFromEntry(this->entries[i]));
+						break;
+					}
+				}
+			}
+			else
+			{
+				for (auto& cm : this->cookedMeshes)
+				{
+					if (cm && cm->getName() == name)
+					{
+						out.push_back(std::move(cm));
+						break;
+					}
+				}
+			}
+		}
+
+		return out;
+	}
+}
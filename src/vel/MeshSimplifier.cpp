@@ -0,0 +1,359 @@
+#include <algorithm>
+#include <unordered_map>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+
+#include "spdlog/spdlog.h"
+
+#include "vel/MeshSimplifier.h"
+
+
+namespace vel
+{
+	// symmetric 4x4 plane quadric, w is the accumulated area so that errors are averaged rather than summed
+	struct Quadric
+	{
+		double a2, b2, c2, ab, ac, bc, ad, bd, cd, d2, w;
+	};
+
+	struct Collapse
+	{
+		unsigned int	from;
+		unsigned int	to;
+		double			error;
+	};
+
+	struct PositionKey
+	{
+		uint32_t		bits[3];
+
+		bool operator==(const PositionKey& o) const
+		{
+			return this->bits[0] == o.bits[0] && this->bits[1] == o.bits[1] && this->bits[2] == o.bits[2];
+		}
+	};
+
+	struct PositionKeyHash
+	{
+		size_t operator()(const PositionKey& k) const
+		{
+			return (size_t)(k.bits[0] * 73856093u ^ k.bits[1] * 19349663u ^ k.bits[2] * 83492791u);
+		}
+	};
+
+	static const unsigned int NO_COLLAPSE = 0xffffffffu;
+
+	static Quadric planeQuadric(const glm::vec3& n, float d, float w)
+	{
+		Quadric q;
+		q.a2 = w * n.x * n.x;
+		q.b2 = w * n.y * n.y;
+		q.c2 = w * n.z * n.z;
+		q.ab = w * n.x * n.y;
+		q.ac = w * n.x * n.z;
+		q.bc = w * n.y * n.z;
+		q.ad = w * n.x * d;
+		q.bd = w * n.y * d;
+		q.cd = w * n.z * d;
+		q.d2 = w * d * d;
+		q.w = w;
+		return q;
+	}
+
+	static void addQuadric(Quadric& q, const Quadric& r)
+	{
+		q.a2 += r.a2; q.b2 += r.b2; q.c2 += r.c2;
+		q.ab += r.ab; q.ac += r.ac; q.bc += r.bc;
+		q.ad += r.ad; q.bd += r.bd; q.cd += r.cd;
+		q.d2 += r.d2; q.w += r.w;
+	}
+
+	// mean squared distance from p to the planes accumulated in q
+	static double quadricError(const Quadric& q, const glm::vec3& p)
+	{
+		const double x = p.x, y = p.y, z = p.z;
+
+		double e = q.a2 * x * x + q.b2 * y * y + q.c2 * z * z
+			+ 2.0 * (q.ab * x * y + q.ac * x * z + q.bc * y * z)
+			+ 2.0 * (q.ad * x + q.bd * y + q.cd * z)
+			+ q.d2;
+
+		return q.w > 0.0 ? std::fabs(e) / q.w : 0.0;
+	}
+
+	std::vector<unsigned int> MeshSimplifier::simplify(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices,
+		size_t targetIndexCount, float targetError, float* resultError)
+	{
+		if (resultError)
+			*resultError = 0.0f;
+
+		std::vector<unsigned int> result = indices;
+
+		if (indices.size() % 3 != 0 || targetIndexCount >= indices.size())
+			return result;
+
+		const size_t vertexCount = vertices.size();
+
+		// weld referenced vertices by position, the first referenced vertex at a position represents all of them
+		std::vector<unsigned int> remap(vertexCount, NO_COLLAPSE);
+		std::vector<unsigned int> wedgeCount(vertexCount, 0);
+		std::unordered_map<PositionKey, unsigned int, PositionKeyHash> positions;
+		positions.reserve(vertexCount);
+
+		glm::vec3 minEdge(std::numeric_limits<float>::max());
+		glm::vec3 maxEdge(-std::numeric_limits<float>::max());
+
+		for (auto i : indices)
+		{
+			if (i >= vertexCount)
+			{
+				SPDLOG_DEBUG("MeshSimplifier::simplify: index {} is out of range", i);
+				return result;
+			}
+
+			if (remap[i] != NO_COLLAPSE)
+				continue;
+
+			const glm::vec3& p = vertices[i].position;
+
+			PositionKey key;
+			std::memcpy(key.bits, &p[0], sizeof(key.bits));
+
+			auto inserted = positions.emplace(key, i);
+			remap[i] = inserted.first->second;
+			wedgeCount[remap[i]]++;
+
+			minEdge = glm::min(minEdge, p);
+			maxEdge = glm::max(maxEdge, p);
+		}
+
+		const glm::vec3 size = maxEdge - minEdge;
+		const float extent = std::max(size.x, std::max(size.y, size.z));
+		if (!(extent > 0.0f))
+			return result;
+
+		// seams keep their wedges together by not moving at all
+		std::vector<char> locked(vertexCount, 0);
+		for (size_t v = 0; v < vertexCount; v++)
+			if (wedgeCount[v] > 1)
+				locked[v] = 1;
+
+		// so do open borders and non manifold edges, both are edges not shared by exactly two triangles
+		std::unordered_map<uint64_t, unsigned int> edgeUse;
+		edgeUse.reserve(indices.size());
+
+		std::vector<Quadric> quadrics(vertexCount);
+		std::memset(quadrics.data(), 0, quadrics.size() * sizeof(Quadric));
+
+		for (size_t t = 0; t < indices.size(); t += 3)
+		{
+			unsigned int r[3] = { remap[indices[t]], remap[indices[t + 1]], remap[indices[t + 2]] };
+
+			for (int e = 0; e < 3; e++)
+			{
+				unsigned int a = std::min(r[e], r[(e + 1) % 3]);
+				unsigned int b = std::max(r[e], r[(e + 1) % 3]);
+				if (a != b)
+					edgeUse[((uint64_t)a << 32) | b]++;
+			}
+
+			const glm::vec3& p0 = vertices[r[0]].position;
+			glm::vec3 n = glm::cross(vertices[r[1]].position - p0, vertices[r[2]].position - p0);
+			float len = glm::length(n);
+			if (!(len > 0.0f))
+				continue;
+
+			n /= len;
+			Quadric q = planeQuadric(n, -glm::dot(n, p0), len * 0.5f);
+
+			for (int c = 0; c < 3; c++)
+				addQuadric(quadrics[r[c]], q);
+		}
+
+		for (auto& e : edgeUse)
+		{
+			if (e.second != 2)
+			{
+				locked[(unsigned int)(e.first >> 32)] = 1;
+				locked[(unsigned int)(e.first & 0xffffffffu)] = 1;
+			}
+		}
+
+		const double maxError = (double)targetError * extent * (double)targetError * extent;
+		double reachedError = 0.0;
+
+		std::vector<unsigned int> collapseTo(vertexCount, NO_COLLAPSE);
+		std::vector<char> touched(vertexCount, 0);
+		std::vector<unsigned int> triangleOffsets(vertexCount + 1);
+		std::vector<unsigned int> triangles;
+		std::vector<Collapse> candidates;
+
+		while (result.size() > targetIndexCount)
+		{
+			// welded vertex -> triangle adjacency for the flip test
+			std::fill(triangleOffsets.begin(), triangleOffsets.end(), 0);
+			for (auto i : result)
+				triangleOffsets[remap[i] + 1]++;
+
+			for (size_t v = 0; v < vertexCount; v++)
+				triangleOffsets[v + 1] += triangleOffsets[v];
+
+			triangles.resize(result.size());
+			std::vector<unsigned int> fill(triangleOffsets.begin(), triangleOffsets.end() - 1);
+			for (size_t i = 0; i < result.size(); i++)
+				triangles[fill[remap[result[i]]]++] = (unsigned int)(i / 3);
+
+			// every half edge proposes folding its start onto its end, which is valid as long as the start isn't locked.
+			// Unlocked vertices have a single wedge, so the end vertex taken from the same triangle is the wedge on
+			// the correct side of any seam it sits on
+			candidates.clear();
+			for (size_t t = 0; t < result.size(); t += 3)
+			{
+				for (int e = 0; e < 3; e++)
+				{
+					unsigned int from = result[t + e];
+					unsigned int to = result[t + (e + 1) % 3];
+
+					if (locked[remap[from]] || remap[from] == remap[to])
+						continue;
+
+					Quadric q = quadrics[remap[from]];
+					addQuadric(q, quadrics[remap[to]]);
+
+					candidates.push_back({ from, to, quadricError(q, vertices[to].position) });
+				}
+			}
+
+			std::sort(candidates.begin(), candidates.end(), [](const Collapse& a, const Collapse& b) { return a.error < b.error; });
+
+			// an interior collapse removes two triangles
+			const size_t trianglesToRemove = (result.size() - targetIndexCount) / 3;
+			const size_t maxCollapses = std::max<size_t>((trianglesToRemove + 1) / 2, 1);
+
+			std::fill(touched.begin(), touched.end(), 0);
+			size_t collapses = 0;
+
+			for (auto& c : candidates)
+			{
+				if (c.error > maxError || collapses >= maxCollapses)
+					break;
+
+				const unsigned int r0 = remap[c.from];
+				const unsigned int r1 = remap[c.to];
+
+				if (touched[r0] || touched[r1])
+					continue;
+
+				// reject collapses that would flip any surviving triangle around the moving vertex, or tilt it far enough to leave a sliver
+				const glm::vec3& target = vertices[c.to].position;
+				bool flips = false;
+
+				for (unsigned int k = triangleOffsets[r0]; k < triangleOffsets[r0 + 1] && !flips; k++)
+				{
+					const unsigned int t = triangles[k] * 3;
+					unsigned int tr[3] = { remap[result[t]], remap[result[t + 1]], remap[result[t + 2]] };
+
+					if (tr[0] == r1 || tr[1] == r1 || tr[2] == r1)
+						continue;
+
+					glm::vec3 p[3] = { vertices[tr[0]].position, vertices[tr[1]].position, vertices[tr[2]].position };
+					glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+
+					for (int j = 0; j < 3; j++)
+						if (tr[j] == r0)
+							p[j] = target;
+
+					glm::vec3 after = glm::cross(p[1] - p[0], p[2] - p[0]);
+
+					if (glm::dot(before, after) <= 0.25f * glm::length(before) * glm::length(after))
+						flips = true;
+				}
+
+				if (flips)
+					continue;
+
+				collapseTo[c.from] = c.to;
+				addQuadric(quadrics[r1], quadrics[r0]);
+				reachedError = std::max(reachedError, c.error);
+				collapses++;
+
+				// the neighbourhood's flip tests are stale until the next pass
+				touched[r0] = 1;
+				touched[r1] = 1;
+				for (unsigned int k = triangleOffsets[r0]; k < triangleOffsets[r0 + 1]; k++)
+				{
+					const unsigned int t = triangles[k] * 3;
+					touched[remap[result[t]]] = 1;
+					touched[remap[result[t + 1]]] = 1;
+					touched[remap[result[t + 2]]] = 1;
+				}
+			}
+
+			if (collapses == 0)
+				break;
+
+			size_t written = 0;
+			for (size_t t = 0; t < result.size(); t += 3)
+			{
+				unsigned int tri[3];
+				for (int j = 0; j < 3; j++)
+				{
+					tri[j] = result[t + j];
+					if (collapseTo[tri[j]] != NO_COLLAPSE)
+						tri[j] = collapseTo[tri[j]];
+				}
+
+				if (remap[tri[0]] == remap[tri[1]] || remap[tri[1]] == remap[tri[2]] || remap[tri[0]] == remap[tri[2]])
+					continue;
+
+				result[written++] = tri[0];
+				result[written++] = tri[1];
+				result[written++] = tri[2];
+			}
+			result.resize(written);
+
+			for (auto& c : candidates)
+				collapseTo[c.from] = NO_COLLAPSE;
+		}
+
+		if (resultError)
+			*resultError = (float)(std::sqrt(reachedError) / extent);
+
+		return result;
+	}
+
+	size_t MeshSimplifier::generateLods(Mesh* m, size_t levels, float reduction, float maxError)
+	{
+		const std::vector<unsigned int>& base = m->getIndices();
+		size_t previous = base.size();
+		size_t added = 0;
+
+		for (size_t level = 1; level <= levels; level++)
+		{
+			const float ratio = std::pow(reduction, (float)level);
+			const size_t target = (size_t)(base.size() * ratio) / 3 * 3;
+			if (target < 3)
+				break;
+
+			// always simplified from the full mesh so errors don't compound level over level
+			float error = 0.0f;
+			std::vector<unsigned int> lod = MeshSimplifier::simplify(m->getVertices(), base, target, maxError, &error);
+
+			// stop once the error budget (locked borders / seams) no longer lets it shrink meaningfully
+			if (lod.empty() || lod.size() > previous - previous / 10)
+				break;
+
+			if (!m->addLod(lod, ratio))
+				break;
+
+			SPDLOG_DEBUG("MeshSimplifier::generateLods: {} lod {} has {} of {} triangles, error {}", m->getName(), level, lod.size() / 3, base.size() / 3, error);
+
+			previous = lod.size();
+			added++;
+		}
+
+		return added;
+	}
+}
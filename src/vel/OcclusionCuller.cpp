@@ -0,0 +1,143 @@
+#include "glm/gtc/matrix_transform.hpp"
+
+#include "vel/OcclusionCuller.h"
+#include "vel/GPU.h"
+
+
+namespace vel
+{
+	OcclusionCuller::OcclusionCuller(GPU* gpu, Mesh* proxyMesh, Shader* proxyShader, float inflation) :
+		gpu(gpu),
+		proxyMesh(proxyMesh),
+		proxyShader(proxyShader),
+		inflation(inflation),
+		frame(0)
+	{}
+
+	OcclusionCuller::~OcclusionCuller()
+	{
+		for (auto& cameraQueries : this->queries)
+			for (auto& q : cameraQueries.second)
+				this->gpu->clearOcclusionQuery(q.second.query);
+	}
+
+	std::unique_ptr<Mesh> OcclusionCuller::createProxyMesh(const std::string& name)
+	{
+		std::vector<Vertex> vertices;
+		for (unsigned int i = 0; i < 8; i++)
+		{
+			Vertex v;
+			v.position = glm::vec3((float)(i & 1), (float)((i >> 1) & 1), (float)((i >> 2) & 1));
+			v.normal = glm::vec3(0.0f, 1.0f, 0.0f);
+			v.textureCoordinates = glm::vec2(0.0f);
+			v.lightmapCoordinates = glm::vec2(0.0f);
+			v.materialUBOIndex = 0;
+			vertices.push_back(v);
+		}
+
+		// two triangles per face, wound ccw as seen from outside the box
+		std::vector<unsigned int> indices = {
+			0, 3, 1,  0, 2, 3, // -z
+			4, 7, 6,  4, 5, 7, // +z
+			0, 5, 4,  0, 1, 5, // -y
+			2, 7, 3,  2, 6, 7, // +y
+			0, 6, 2,  0, 4, 6, // -x
+			1, 7, 5,  1, 3, 7  // +x
+		};
+
+		std::unique_ptr<Mesh> m = std::make_unique<Mesh>(name);
+		m->setVertices(vertices);
+		m->setIndices(indices);
+
+		return m;
+	}
+
+	void OcclusionCuller::beginFrame()
+	{
+		this->frame++;
+	}
+
+	bool OcclusionCuller::beginActor(Camera* c, const Actor* a, const glm::vec3& minEdge, const glm::vec3& maxEdge)
+	{
+		// anything the near plane could cut through is drawn unconditionally and not tested
+		const glm::vec3 guard = glm::vec3(this->inflation + c->getNearPlane() * 2.0f);
+		const glm::vec3 cameraPosition = c->getPosition();
+		if (glm::all(glm::greaterThanEqual(cameraPosition, minEdge - guard)) && glm::all(glm::lessThanEqual(cameraPosition, maxEdge + guard)))
+			return false;
+
+		this->pendingProxies.push_back(OcclusionProxy{ a, minEdge, maxEdge });
+
+		auto& cameraQueries = this->queries[c];
+		auto it = cameraQueries.find(a);
+		if (it == cameraQueries.end() || !it->second.issued)
+			return false;
+
+		this->gpu->beginConditionalRender(it->second.query);
+		return true;
+	}
+
+	void OcclusionCuller::endActor()
+	{
+		this->gpu->endConditionalRender();
+	}
+
+	void OcclusionCuller::drawProxies(Camera* c)
+	{
+		if (this->pendingProxies.empty())
+			return;
+
+		auto& cameraQueries = this->queries[c];
+
+		this->gpu->setOcclusionProxyRenderState();
+		this->gpu->useShader(this->proxyShader);
+		this->gpu->useMesh(this->proxyMesh);
+		this->gpu->setShaderVec4("color", glm::vec4(1.0f));
+		this->gpu->setShaderMat4("view", c->getViewMatrix());
+		this->gpu->setShaderMat4("projection", c->getProjectionMatrix());
+
+		for (auto& p : this->pendingProxies)
+		{
+			auto it = cameraQueries.find(p.actor);
+			if (it == cameraQueries.end())
+				it = cameraQueries.emplace(p.actor, OcclusionQueryState{ this->gpu->createOcclusionQuery(), 0, false }).first;
+
+			const glm::vec3 minEdge = p.minEdge - glm::vec3(this->inflation);
+			const glm::vec3 size = (p.maxEdge + glm::vec3(this->inflation)) - minEdge;
+
+			this->gpu->setShaderMat4("model", glm::scale(glm::translate(glm::mat4(1.0f), minEdge), size));
+
+			this->gpu->beginOcclusionQuery(it->second.query);
+			this->gpu->drawGpuMesh();
+			this->gpu->endOcclusionQuery();
+
+			it->second.issued = true;
+			it->second.lastUsedFrame = this->frame;
+		}
+
+		this->gpu->endOcclusionProxyRenderState();
+
+		this->pendingProxies.clear();
+	}
+
+	void OcclusionCuller::endFrame()
+	{
+		this->pendingProxies.clear();
+
+		for (auto& cameraQueries : this->queries)
+		{
+			auto& qs = cameraQueries.second;
+			for (auto it = qs.begin(); it != qs.end();)
+			{
+				if (it->second.lastUsedFrame != this->frame)
+				{
+					this->gpu->clearOcclusionQuery(it->second.query);
+					it = qs.erase(it);
+				}
+				else
+				{
+					++it;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,255 @@
+#include <algorithm>
+#include <cmath>
+
+#include "ozz/base/maths/simd_math.h"
+
+#include "vel/ParticleEmitter.h"
+#include "vel/GPU.h"
+
+
+namespace vel
+{
+	ParticleEmitter::ParticleEmitter(const std::string& name, Actor* actor, const ParticleEmitterSettings& settings, GPU* gpu, Shader* computeShader) :
+		name(name),
+		actor(actor),
+		settings(settings),
+		gpu(gpu),
+		computeShader(computeShader),
+		stateBuffer(0),
+		nextGpuSlot(0),
+		aliveCount(0),
+		spawnAccumulator(0.0f),
+		pendingBurst(0),
+		emitting(true),
+		rng(std::random_device{}())
+	{
+		this->settings.maxParticles = std::max<size_t>(this->settings.maxParticles, 1);
+		this->settings.frameCount = std::max(this->settings.frameCount, 1u);
+
+		// padded so the simd loop can always read / write whole groups of 4
+		const size_t padded = (this->settings.maxParticles + 3) & ~size_t(3);
+		for (auto* v : { &this->posX, &this->posY, &this->posZ, &this->velX, &this->velY, &this->velZ, &this->age, &this->lifetime })
+			v->assign(padded, 0.0f);
+
+		this->instances.reserve(this->settings.maxParticles);
+
+		this->gpu->createInstanceBuffer(this->actor->getMesh(), this->settings.maxParticles);
+
+		if (this->computeShader != nullptr)
+			this->stateBuffer = this->gpu->createParticleStateBuffer(this->settings.maxParticles);
+	}
+
+	ParticleEmitter::~ParticleEmitter()
+	{
+		if (this->stateBuffer > 0)
+			this->gpu->clearBuffer(this->stateBuffer);
+	}
+
+	const std::string& ParticleEmitter::getName() const
+	{
+		return this->name;
+	}
+
+	Actor* ParticleEmitter::getActor() const
+	{
+		return this->actor;
+	}
+
+	const ParticleEmitterSettings& ParticleEmitter::getSettings() const
+	{
+		return this->settings;
+	}
+
+	void ParticleEmitter::setEmitting(bool e)
+	{
+		this->emitting = e;
+	}
+
+	bool ParticleEmitter::getEmitting() const
+	{
+		return this->emitting;
+	}
+
+	void ParticleEmitter::burst(size_t count)
+	{
+		this->pendingBurst += count;
+	}
+
+	void ParticleEmitter::clear()
+	{
+		this->aliveCount = 0;
+	}
+
+	size_t ParticleEmitter::getAliveCount() const
+	{
+		return this->aliveCount;
+	}
+
+	bool ParticleEmitter::usesComputeShader() const
+	{
+		return this->computeShader != nullptr;
+	}
+
+	size_t ParticleEmitter::takeSpawnCount(float dt)
+	{
+		size_t count = 0;
+
+		if (this->emitting)
+		{
+			this->spawnAccumulator += this->settings.spawnRate * dt;
+			count = (size_t)this->spawnAccumulator;
+			this->spawnAccumulator -= (float)count;
+		}
+		else
+		{
+			this->spawnAccumulator = 0.0f;
+		}
+
+		count += this->pendingBurst;
+		this->pendingBurst = 0;
+
+		return count;
+	}
+
+	void ParticleEmitter::randomParticle(glm::vec3& position, glm::vec3& velocity, float& life)
+	{
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+		const glm::vec3 origin = glm::vec3(this->actor->getWorldMatrix()[3]);
+		const glm::vec3 offset(unit(this->rng) * 2.0f - 1.0f, unit(this->rng) * 2.0f - 1.0f, unit(this->rng) * 2.0f - 1.0f);
+		const glm::vec3 mix(unit(this->rng), unit(this->rng), unit(this->rng));
+
+		position = origin + offset * this->settings.spawnExtents;
+		velocity = glm::mix(this->settings.minVelocity, this->settings.maxVelocity, mix);
+		life = glm::mix(this->settings.minLifetime, this->settings.maxLifetime, unit(this->rng));
+	}
+
+	void ParticleEmitter::simulate(float dt)
+	{
+		namespace sm = ozz::math::simd_float4;
+
+		// integrate every live particle, 4 lanes at a time
+		const ozz::math::SimdFloat4 vdt = sm::Load1(dt);
+		const ozz::math::SimdFloat4 gx = sm::Load1(this->settings.gravity.x * dt);
+		const ozz::math::SimdFloat4 gy = sm::Load1(this->settings.gravity.y * dt);
+		const ozz::math::SimdFloat4 gz = sm::Load1(this->settings.gravity.z * dt);
+
+		for (size_t i = 0; i < this->aliveCount; i += 4)
+		{
+			const ozz::math::SimdFloat4 vx = sm::LoadPtrU(&this->velX[i]) + gx;
+			const ozz::math::SimdFloat4 vy = sm::LoadPtrU(&this->velY[i]) + gy;
+			const ozz::math::SimdFloat4 vz = sm::LoadPtrU(&this->velZ[i]) + gz;
+
+			ozz::math::StorePtrU(vx, &this->velX[i]);
+			ozz::math::StorePtrU(vy, &this->velY[i]);
+			ozz::math::StorePtrU(vz, &this->velZ[i]);
+
+			ozz::math::StorePtrU(sm::LoadPtrU(&this->posX[i]) + vx * vdt, &this->posX[i]);
+			ozz::math::StorePtrU(sm::LoadPtrU(&this->posY[i]) + vy * vdt, &this->posY[i]);
+			ozz::math::StorePtrU(sm::LoadPtrU(&this->posZ[i]) + vz * vdt, &this->posZ[i]);
+
+			ozz::math::StorePtrU(sm::LoadPtrU(&this->age[i]) + vdt, &this->age[i]);
+		}
+
+		// swap expired particles with the last live one so the live range stays packed
+		size_t i = 0;
+		while (i < this->aliveCount)
+		{
+			if (this->age[i] < this->lifetime[i])
+			{
+				i++;
+				continue;
+			}
+
+			const size_t last = --this->aliveCount;
+			this->posX[i] = this->posX[last];
+			this->posY[i] = this->posY[last];
+			this->posZ[i] = this->posZ[last];
+			this->velX[i] = this->velX[last];
+			this->velY[i] = this->velY[last];
+			this->velZ[i] = this->velZ[last];
+			this->age[i] = this->age[last];
+			this->lifetime[i] = this->lifetime[last];
+		}
+
+		// spawn
+		const size_t spawnCount = std::min(this->takeSpawnCount(dt), this->settings.maxParticles - this->aliveCount);
+		for (size_t s = 0; s < spawnCount; s++)
+		{
+			glm::vec3 p, v;
+			float life;
+			this->randomParticle(p, v, life);
+
+			const size_t n = this->aliveCount++;
+			this->posX[n] = p.x;
+			this->posY[n] = p.y;
+			this->posZ[n] = p.z;
+			this->velX[n] = v.x;
+			this->velY[n] = v.y;
+			this->velZ[n] = v.z;
+			this->age[n] = 0.0f;
+			this->lifetime[n] = life;
+		}
+
+		// build instance data
+		this->instances.resize(this->aliveCount);
+
+		const float frames = (float)this->settings.frameCount;
+		for (size_t p = 0; p < this->aliveCount; p++)
+		{
+			const float t = std::min(this->age[p] / this->lifetime[p], 1.0f);
+
+			ParticleInstance& inst = this->instances[p];
+			inst.positionSize = glm::vec4(this->posX[p], this->posY[p], this->posZ[p], glm::mix(this->settings.startSize, this->settings.endSize, t));
+			inst.color = glm::mix(this->settings.startColor, this->settings.endColor, t);
+			inst.frame = std::min(std::floor(t * frames), frames - 1.0f);
+		}
+
+		this->gpu->updateInstanceBuffer(this->actor->getMesh(), this->instances);
+	}
+
+	void ParticleEmitter::simulateCompute(float dt)
+	{
+		// new particles overwrite the ring slot after the last one written, which for a steady spawn rate is the oldest
+		const size_t spawnCount = std::min(this->takeSpawnCount(dt), this->settings.maxParticles);
+
+		this->spawnScratch.clear();
+		for (size_t s = 0; s < spawnCount; s++)
+		{
+			glm::vec3 p, v;
+			float life;
+			this->randomParticle(p, v, life);
+
+			this->spawnScratch.push_back(ParticleGpuState{ glm::vec4(p, 0.0f), glm::vec4(v, life) });
+		}
+
+		// at most two contiguous uploads when the ring wraps
+		const size_t firstRun = std::min(spawnCount, this->settings.maxParticles - this->nextGpuSlot);
+		this->gpu->updateParticleStateBuffer(this->stateBuffer, this->nextGpuSlot, this->spawnScratch.data(), firstRun);
+		this->gpu->updateParticleStateBuffer(this->stateBuffer, 0, this->spawnScratch.data() + firstRun, spawnCount - firstRun);
+		this->nextGpuSlot = (this->nextGpuSlot + spawnCount) % this->settings.maxParticles;
+
+		this->gpu->useShader(this->computeShader);
+		this->gpu->setShaderFloat("deltaTime", dt);
+		this->gpu->setShaderVec3("gravity", this->settings.gravity);
+		this->gpu->setShaderFloat("startSize", this->settings.startSize);
+		this->gpu->setShaderFloat("endSize", this->settings.endSize);
+		this->gpu->setShaderVec4("startColor", this->settings.startColor);
+		this->gpu->setShaderVec4("endColor", this->settings.endColor);
+		this->gpu->setShaderInt("frameCount", (int)this->settings.frameCount);
+		this->gpu->setShaderInt("particleCount", (int)this->settings.maxParticles);
+
+		this->gpu->dispatchParticleCompute(this->stateBuffer, this->actor->getMesh());
+	}
+
+	void ParticleEmitter::update(float dt)
+	{
+		if (this->actor->getMesh() == nullptr || !this->actor->getMesh()->getGpuMesh())
+			return;
+
+		if (this->computeShader != nullptr)
+			this->simulateCompute(dt);
+		else
+			this->simulate(dt);
+	}
+}
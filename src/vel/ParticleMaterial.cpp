@@ -0,0 +1,31 @@
+#include "vel/ParticleMaterial.h"
+#include "vel/GPU.h"
+#include "vel/Actor.h"
+
+namespace vel
+{
+	std::vector<std::string> ParticleMaterial::shaderDefs = { "IS_PARTICLE" };
+
+	ParticleMaterial::ParticleMaterial(const std::string& name, Shader* shader) :
+		Material(name, shader)
+	{}
+
+	void ParticleMaterial::preDraw(float frameTime) {};
+
+	void ParticleMaterial::draw(float alphaTime, GPU* gpu, Actor* actor, const glm::mat4& viewMatrix, const glm::mat4& projMatrix)
+	{
+		for (unsigned int i = 0; i < this->getTextures().size(); i++)
+			gpu->updateTextureUBO(i, this->getTextures().at(i)->frames.at(0).dsaHandle);
+
+		gpu->setShaderVec4("color", this->getColor());
+		gpu->setShaderMat4("model", glm::mat4(1.0f));
+		gpu->setShaderMat4("view", viewMatrix);
+		gpu->setShaderMat4("projection", projMatrix);
+		gpu->drawGpuMeshInstanced();
+	}
+
+	std::unique_ptr<Material> ParticleMaterial::clone() const
+	{
+		return std::make_unique<ParticleMaterial>(*this);
+	}
+}
@@ -1,3 +1,4 @@
+#include <algorithm>
 
 #include "vel/RaycastCallback.h"
 
@@ -5,19 +6,32 @@ namespace vel
 {
 	RaycastCallback::RaycastCallback(btVector3 from, btVector3 to, std::vector<btCollisionObject*> blackList) :
 		btCollisionWorld::ClosestRayResultCallback(from, to),
-		blackList(blackList)
+		ownedBlackList(std::move(blackList)),
+		blackList(&this->ownedBlackList),
+		m_triangleIndex(-1)
 	{
-		
+		std::sort(this->ownedBlackList.begin(), this->ownedBlackList.end());
 	}
 
-	btScalar RaycastCallback::addSingleResult(btCollisionWorld::LocalRayResult& rayResult, bool normalInWorldSpace)
+	RaycastCallback::RaycastCallback(btVector3 from, btVector3 to, const std::vector<btCollisionObject*>* sortedBlackList) :
+		btCollisionWorld::ClosestRayResultCallback(from, to),
+		blackList(sortedBlackList),
+		m_triangleIndex(-1)
+	{
+
+	}
+
+	bool RaycastCallback::needsCollision(btBroadphaseProxy* proxy0) const
 	{
-		for (auto& co : this->blackList)
-		{
-			if (rayResult.m_collisionObject == co)
-				return 1.0f;
-		}
+		if (!ClosestRayResultCallback::needsCollision(proxy0))
+			return false;
+
+		return this->blackList->empty() ||
+			!std::binary_search(this->blackList->begin(), this->blackList->end(), static_cast<btCollisionObject*>(proxy0->m_clientObject));
+	}
 
+	btScalar RaycastCallback::addSingleResult(btCollisionWorld::LocalRayResult& rayResult, bool normalInWorldSpace)
+	{
 		if (rayResult.m_localShapeInfo == nullptr)
 			this->m_triangleIndex = -1;
 		else
@@ -1,5 +1,7 @@
 #include <iostream>
 #include <fstream>
+#include <algorithm>
+#include <chrono>
 
 #include "spdlog/spdlog.h"
 
@@ -29,14 +31,23 @@ namespace vel
 		audioGroupKey(-1),
 		animationTime(0.0f),
 		screenTint(glm::vec4(1.0f, 1.0f, 1.0f, 0.0f)),
+		lodBias(1.0f),
+		lodHysteresis(0.1f),
 		frameTime(0.0),
-		frameRate(0.0)
+		frameRate(0.0),
+		textBatchCount(0),
+		staticBatchCount(0)
 	{
 
 	}
 	
 	Scene::~Scene()
 	{
+		this->occlusionCuller.reset();
+
+		if (this->drawTimer)
+			this->gpu->clearGpuTimer(this->drawTimer.value());
+
 		this->freeAssets();
 	}
 
@@ -171,6 +182,10 @@ namespace vel
 	void Scene::freeAssets()
 	{
 		SPDLOG_DEBUG("Freeing assets for scene: {}", this->name);
+
+		// anything still in flight has to land before it can be released
+		this->assetManager->waitForPendingLoads();
+		this->collectAsyncLoads();
 		
 		for (auto& pMaterial : this->materialsInUse)
 			this->assetManager->removeMaterial(pMaterial);
@@ -188,7 +203,10 @@ namespace vel
 			this->assetManager->removeShader(pShader);
 
 		for (auto& cw : this->collisionWorlds)
+		{
+			this->assetManager->removeMeshRemovedListener(cw);
 			delete cw;
+		}
 
 		for (auto& s : this->soundsInUse)
 			this->audioDevice->removeSound(s);
@@ -239,10 +257,64 @@ namespace vel
 	{
 		Texture* t = this->assetManager->loadTexture(name, path, options);
 
-		this->texturesInUse.push_back(t);
+		if (t)
+			this->texturesInUse.push_back(t);
 
 		return t;
 	}
+
+	std::shared_future<Texture*> Scene::loadTextureAsync(const std::string& name, const std::string& path, int options)
+	{
+		std::shared_future<Texture*> f = this->assetManager->loadTextureAsync(name, path, options);
+
+		this->pendingTextureLoads.push_back(f);
+
+		return f;
+	}
+
+	std::shared_future<FontBitmap*> Scene::loadFontBitmapAsync(const std::string& fontName, int fontSize, const std::string& fontPath)
+	{
+		std::shared_future<FontBitmap*> f = this->assetManager->loadFontBitmapAsync(fontName, fontSize, fontPath);
+
+		this->pendingFontBitmapLoads.push_back(f);
+
+		return f;
+	}
+
+	void Scene::collectAsyncLoads()
+	{
+		HeadlessScene::collectAsyncLoads();
+
+		for (size_t i = 0; i < this->pendingTextureLoads.size();)
+		{
+			auto& f = this->pendingTextureLoads.at(i);
+			if (f.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			{
+				i++;
+				continue;
+			}
+
+			if (f.get())
+				this->texturesInUse.push_back(f.get());
+
+			this->pendingTextureLoads.erase(this->pendingTextureLoads.begin() + i);
+		}
+
+		for (size_t i = 0; i < this->pendingFontBitmapLoads.size();)
+		{
+			auto& f = this->pendingFontBitmapLoads.at(i);
+			if (f.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			{
+				i++;
+				continue;
+			}
+
+			if (f.get())
+				this->fontBitmapsInUse.push_back(f.get());
+
+			this->pendingFontBitmapLoads.erase(this->pendingFontBitmapLoads.begin() + i);
+		}
+	}
 	
 	void Scene::addShaderInUse(Shader* s)
 	{
@@ -267,6 +339,28 @@ namespace vel
 			defs.push_back("IS_CUTOUT");
 			shaderName += "Cutout";
 		}
+
+		if (opts & MTRL_OPT_COMPACT_VERTEX)
+		{
+			bool skinned = std::find(defs.begin(), defs.end(), "IS_SKINNED") != defs.end();
+
+			for (auto& d : getVertexFormatShaderDefs(skinned ? VertexFormat::SKINNED_COMPACT : VertexFormat::STATIC_COMPACT))
+				defs.push_back(d);
+
+			shaderName += "Compact";
+		}
+
+		if (opts & MTRL_OPT_TEXTURE_ARRAY)
+		{
+			defs.push_back("USE_TEXTURE_ARRAY");
+			shaderName += "TexArray";
+		}
+
+		if (opts & MTRL_OPT_GPU_BILLBOARD)
+		{
+			defs.push_back("GPU_BILLBOARD");
+			shaderName += "GpuBillboard";
+		}
 	}
 
 	DiffuseMaterial* Scene::addDiffuseMaterial(const std::string& name, int opts)
@@ -284,6 +378,8 @@ namespace vel
 		if (opts & MTRL_OPT_TRANSLUCENT)
 			m->setHasAlphaChannel(true);
 
+		m->setOptions(opts);
+
 		Material* pMaterial = this->assetManager->addMaterial(std::move(m));
 		this->materialsInUse.push_back(pMaterial);
 
@@ -305,6 +401,8 @@ namespace vel
 		if (opts & MTRL_OPT_TRANSLUCENT)
 			m->setHasAlphaChannel(true);
 
+		m->setOptions(opts);
+
 		Material* pMaterial = this->assetManager->addMaterial(std::move(m));
 		this->materialsInUse.push_back(pMaterial);
 
@@ -326,6 +424,8 @@ namespace vel
 		if (opts & MTRL_OPT_TRANSLUCENT)
 			m->setHasAlphaChannel(true);
 
+		m->setOptions(opts);
+
 		Material* pMaterial = this->assetManager->addMaterial(std::move(m));
 		this->materialsInUse.push_back(pMaterial);
 
@@ -347,6 +447,8 @@ namespace vel
 		if (opts & MTRL_OPT_TRANSLUCENT)
 			m->setHasAlphaChannel(true);
 
+		m->setOptions(opts);
+
 		Material* pMaterial = this->assetManager->addMaterial(std::move(m));
 		this->materialsInUse.push_back(pMaterial);
 
@@ -368,6 +470,8 @@ namespace vel
 		if (opts & MTRL_OPT_TRANSLUCENT)
 			m->setHasAlphaChannel(true);
 
+		m->setOptions(opts);
+
 		Material* pMaterial = this->assetManager->addMaterial(std::move(m));
 		this->materialsInUse.push_back(pMaterial);
 
@@ -391,6 +495,8 @@ namespace vel
 		if (opts & MTRL_OPT_TRANSLUCENT)
 			m->setHasAlphaChannel(true);
 
+		m->setOptions(opts);
+
 		Material* pMaterial = this->assetManager->addMaterial(std::move(m));
 		this->materialsInUse.push_back(pMaterial);
 
@@ -412,6 +518,8 @@ namespace vel
 		if (opts & MTRL_OPT_TRANSLUCENT)
 			m->setHasAlphaChannel(true);
 
+		m->setOptions(opts);
+
 		Material* pMaterial = this->assetManager->addMaterial(std::move(m));
 		this->materialsInUse.push_back(pMaterial);
 
@@ -433,6 +541,8 @@ namespace vel
 		if (opts & MTRL_OPT_TRANSLUCENT)
 			m->setHasAlphaChannel(true);
 
+		m->setOptions(opts);
+
 		Material* pMaterial = this->assetManager->addMaterial(std::move(m));
 		this->materialsInUse.push_back(pMaterial);
 
@@ -454,6 +564,8 @@ namespace vel
 		if (opts & MTRL_OPT_TRANSLUCENT)
 			m->setHasAlphaChannel(true);
 
+		m->setOptions(opts);
+
 		Material* pMaterial = this->assetManager->addMaterial(std::move(m));
 		this->materialsInUse.push_back(pMaterial);
 
@@ -475,6 +587,8 @@ namespace vel
 		if (opts & MTRL_OPT_TRANSLUCENT)
 			m->setHasAlphaChannel(true);
 
+		m->setOptions(opts);
+
 		Material* pMaterial = this->assetManager->addMaterial(std::move(m));
 		this->materialsInUse.push_back(pMaterial);
 
@@ -496,6 +610,8 @@ namespace vel
 		if (opts & MTRL_OPT_TRANSLUCENT)
 			m->setHasAlphaChannel(true);
 
+		m->setOptions(opts);
+
 		Material* pMaterial = this->assetManager->addMaterial(std::move(m));
 		this->materialsInUse.push_back(pMaterial);
 
@@ -517,6 +633,8 @@ namespace vel
 		if (opts & MTRL_OPT_TRANSLUCENT)
 			m->setHasAlphaChannel(true);
 
+		m->setOptions(opts);
+
 		Material* pMaterial = this->assetManager->addMaterial(std::move(m));
 		this->materialsInUse.push_back(pMaterial);
 
@@ -538,6 +656,8 @@ namespace vel
 		if (opts & MTRL_OPT_TRANSLUCENT)
 			m->setHasAlphaChannel(true);
 
+		m->setOptions(opts);
+
 		Material* pMaterial = this->assetManager->addMaterial(std::move(m));
 		this->materialsInUse.push_back(pMaterial);
 
@@ -559,12 +679,37 @@ namespace vel
 		if (opts & MTRL_OPT_TRANSLUCENT)
 			m->setHasAlphaChannel(true);
 
+		m->setOptions(opts);
+
 		Material* pMaterial = this->assetManager->addMaterial(std::move(m));
 		this->materialsInUse.push_back(pMaterial);
 
 		return static_cast<DiffuseCausticLightmapMaterial*>(pMaterial);
 	}
 
+	ParticleMaterial* Scene::addParticleMaterial(const std::string& name, int opts)
+	{
+		std::vector<std::string> defs = ParticleMaterial::shaderDefs;
+		std::string shaderName = "particleMaterialShader";
+
+		this->setShaderOpts(opts, defs, shaderName);
+
+		Shader* particleMaterialShader = this->assetManager->loadShader(shaderName, "uber.vert", "", "uber.frag", defs); // returns existing if already loaded
+		this->shadersInUse.push_back(particleMaterialShader);
+
+		std::unique_ptr<ParticleMaterial> m = std::make_unique<ParticleMaterial>(name, particleMaterialShader);
+
+		if (opts & MTRL_OPT_TRANSLUCENT)
+			m->setHasAlphaChannel(true);
+
+		m->setOptions(opts);
+
+		Material* pMaterial = this->assetManager->addMaterial(std::move(m));
+		this->materialsInUse.push_back(pMaterial);
+
+		return static_cast<ParticleMaterial*>(pMaterial);
+	}
+
 
 
 	Shader* Scene::getShader(const std::string& name)
@@ -596,8 +741,10 @@ namespace vel
 		ta->fontBitmap = fb;
 		ta->originType = originType;
 
-		// create the mesh using provided FontBitmap and text string
-		Mesh* pTam = this->assetManager->addMesh(std::move(this->assetManager->loadTextActorMesh(ta.get())));
+		// create the mesh using provided FontBitmap and text string, dynamic as it's rewritten whenever the text changes
+		std::unique_ptr<Mesh> tam = this->assetManager->loadTextActorMesh(ta.get());
+		tam->setDynamic(true);
+		Mesh* pTam = this->assetManager->addMesh(std::move(tam));
 		this->meshesInUse.push_back(pTam);
 
 		// create material
@@ -607,6 +754,11 @@ namespace vel
 
 		// create actor
 		Actor* pTextActor = stage->addActor(name, pTam, taMaterial);
+		if (!pTextActor)
+		{
+			SPDLOG_DEBUG("Scene::addTextActor: unable to add actor for {}", name);
+			return nullptr;
+		}
 
 		// add actor pointer to TextActor.actor
 		ta->actor = pTextActor;
@@ -615,13 +767,56 @@ namespace vel
 		return stage->addTextActor(std::move(ta));
 	}
 
+	TextActor* Scene::addBatchedTextActor(Stage* stage, const std::string& name, const std::string& theText, FontBitmap* fb,
+		glm::vec4 color, PlaneOrigin originType)
+	{
+		TextBatch* batch = stage->getTextBatch(fb, color);
+
+		if (batch == nullptr)
+		{
+			std::string batchName = stage->getName() + "_" + fb->fontName + "_textBatch_" + std::to_string(this->textBatchCount++);
+
+			Mesh* pBatchMesh = this->assetManager->addMesh(TextBatch::createMesh(batchName + "_mesh"));
+			this->meshesInUse.push_back(pBatchMesh);
+
+			Material* batchMaterial = this->addTextMaterial(batchName + "_material", MTRL_OPT_TRANSLUCENT);
+			batchMaterial->addTexture(&fb->texture);
+			batchMaterial->setColor(color);
+
+			Actor* pBatchActor = stage->addActor(batchName, pBatchMesh, batchMaterial);
+			if (!pBatchActor)
+			{
+				SPDLOG_DEBUG("Scene::addBatchedTextActor: unable to add batch actor {}, not adding {}", batchName, name);
+				return nullptr;
+			}
+
+			batch = stage->addTextBatch(std::make_unique<TextBatch>(batchName, fb, color));
+			batch->setActor(pBatchActor);
+		}
+
+		std::unique_ptr<TextActor> ta = std::make_unique<TextActor>();
+		ta->name = name;
+		ta->text = theText;
+		ta->fontBitmap = fb;
+		ta->originType = originType;
+
+		// meshless actor, only used for its transform / visibility, the draw loop skips it
+		ta->actor = stage->addActor(name);
+
+		batch->addTextActor(ta.get());
+
+		return stage->addTextActor(std::move(ta));
+	}
+
 	LineActor* Scene::addLineActor(Stage* stage, const std::string& name, const std::vector<std::tuple<glm::vec2, glm::vec2, unsigned int>>& points, std::vector<glm::vec4> colors)
 	{
 		// create the LineActor
 		std::unique_ptr<LineActor> la = std::make_unique<LineActor>(name);
 
 		// create the mesh
-		Mesh* pMesh = this->assetManager->addMesh(std::move(LineActor::segmentsToMesh(name, points)));
+		std::unique_ptr<Mesh> lam = LineActor::segmentsToMesh(name, points);
+		lam->setDynamic(true);
+		Mesh* pMesh = this->assetManager->addMesh(std::move(lam));
 		this->meshesInUse.push_back(pMesh);
 
 		bool hasAlpha = false;
@@ -641,6 +836,11 @@ namespace vel
 
 		// create actor
 		Actor* pActor = stage->addActor(name, pMesh, pMaterial);
+		if (!pActor)
+		{
+			SPDLOG_DEBUG("Scene::addLineActor: unable to add actor for {}", name);
+			return nullptr;
+		}
 
 		// add actor pointer to LineActor
 		la->actor = pActor;
@@ -652,7 +852,9 @@ namespace vel
 	{
 		std::unique_ptr<LineActor> la = std::make_unique<LineActor>(name);
 
-		Mesh* pMesh = this->assetManager->addMesh(std::move(LineActor::pointsToMesh(name, points)));
+		std::unique_ptr<Mesh> lam = LineActor::pointsToMesh(name, points);
+		lam->setDynamic(true);
+		Mesh* pMesh = this->assetManager->addMesh(std::move(lam));
 		this->meshesInUse.push_back(pMesh);
 
 		bool hasAlpha = color.w < 0.999f;
@@ -661,6 +863,11 @@ namespace vel
 		pMaterial->setLineColor(0, color);
 
 		Actor* pActor = stage->addActor(name, pMesh, pMaterial);
+		if (!pActor)
+		{
+			SPDLOG_DEBUG("Scene::addContinuousLineActor: unable to add actor for {}", name);
+			return nullptr;
+		}
 
 		la->actor = pActor;
 
@@ -679,6 +886,12 @@ namespace vel
 
 		// create actor
 		Actor* a = stage->addActor(name, m, material);
+		if (!a)
+		{
+			SPDLOG_DEBUG("Scene::addBillboard: unable to add actor for {}", name);
+			return nullptr;
+		}
+
 		a->setDynamic(true);
 
 		// create the billboard, add to stage, return pointer
@@ -691,11 +904,271 @@ namespace vel
 		this->meshesInUse.push_back(mesh);
 
 		Actor* a = stage->addActor(name, mesh, material);
+		if (!a)
+		{
+			SPDLOG_DEBUG("Scene::addBillboard: unable to add actor for {}", name);
+			return nullptr;
+		}
+
 		a->setDynamic(true);
 
 		return stage->addBillboard(std::make_unique<Billboard>(a, parentCamera));
 	}
 
+	ParticleEmitter* Scene::addParticleEmitter(Stage* stage, const std::string& name, Material* material, const ParticleEmitterSettings& settings, bool useComputeShader)
+	{
+		// each emitter gets its own quad since the instance buffer is attached to the mesh's vao
+		std::unique_ptr<Mesh> tmpM = std::make_unique<Mesh>(name + "_mesh");
+		tmpM->initBillboardQuad(1.0f, 1.0f);
+
+		Mesh* m = this->assetManager->addMesh(std::move(tmpM));
+		this->meshesInUse.push_back(m);
+
+		Shader* computeShader = nullptr;
+		if (useComputeShader)
+		{
+			computeShader = this->assetManager->loadComputeShader("particleComputeShader", "particle.comp"); // returns existing if already loaded
+
+			if (computeShader != nullptr)
+				this->shadersInUse.push_back(computeShader);
+			else
+				SPDLOG_DEBUG("Scene::addParticleEmitter: compute shader unavailable, simulating {} on the cpu", name);
+		}
+
+		Actor* a = stage->addActor(name, m, material);
+		if (!a)
+		{
+			SPDLOG_DEBUG("Scene::addParticleEmitter: unable to add actor for {}", name);
+			return nullptr;
+		}
+
+		a->setDynamic(true);
+		a->setCullable(false); // particles travel well outside the quad's bounds
+
+		return stage->addParticleEmitter(std::make_unique<ParticleEmitter>(name, a, settings, this->gpu, computeShader));
+	}
+
+
+	void Scene::setOcclusionCulling(bool b)
+	{
+		if (!b)
+		{
+			this->occlusionCuller.reset();
+			return;
+		}
+
+		if (this->occlusionCuller)
+			return;
+
+		// proxies are drawn with the plain color variant of the uber shader, color writes are masked off anyway
+		std::vector<std::string> defs = RGBAMaterial::shaderDefs;
+		std::string shaderName = "RGBAMaterialShader";
+		this->setShaderOpts(0, defs, shaderName);
+
+		Shader* proxyShader = this->assetManager->loadShader(shaderName, "uber.vert", "", "uber.frag", defs); // returns existing if already loaded
+		this->shadersInUse.push_back(proxyShader);
+
+		Mesh* proxyMesh = this->assetManager->addMesh(OcclusionCuller::createProxyMesh(this->name + "_occlusionProxyMesh"));
+		this->meshesInUse.push_back(proxyMesh);
+
+		this->occlusionCuller = std::make_unique<OcclusionCuller>(this->gpu, proxyMesh, proxyShader);
+	}
+
+	bool Scene::getOcclusionCulling() const
+	{
+		return this->occlusionCuller != nullptr;
+	}
+
+	void Scene::setGpuTimers(bool b)
+	{
+		if (b && !this->drawTimer)
+		{
+			this->drawTimer = this->gpu->createGpuTimer();
+		}
+		else if (!b && this->drawTimer)
+		{
+			this->gpu->clearGpuTimer(this->drawTimer.value());
+			this->drawTimer.reset();
+		}
+	}
+
+	double Scene::getDrawGpuMilliseconds() const
+	{
+		return this->drawTimer ? this->drawTimer->milliseconds : 0.0;
+	}
+
+	void Scene::setLodBias(float b)
+	{
+		this->lodBias = b;
+	}
+
+	float Scene::getLodBias() const
+	{
+		return this->lodBias;
+	}
+
+	void Scene::setLodHysteresis(float h)
+	{
+		this->lodHysteresis = h;
+	}
+
+	size_t Scene::selectActorLod(Camera* c, Actor* a, const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+	{
+		// projected diameter of the bounding sphere as a fraction of the viewport height, proj[1][1] is
+		// 1 / tan(fov / 2) for perspective and 2 / height for orthographic projections
+		const glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+		const float radius = glm::length(boundsMax - boundsMin) * 0.5f;
+
+		float screenSize = radius * c->getProjectionMatrix()[1][1] * this->lodBias;
+		if (c->getType() == CameraType::PERSPECTIVE)
+			screenSize /= std::max(glm::length(center - c->getPosition()), c->getNearPlane());
+
+		size_t lod = a->getMesh()->selectLod(screenSize, a->getLod(c), this->lodHysteresis);
+		a->setLod(c, lod);
+
+		return lod;
+	}
+
+	unsigned int Scene::buildStaticBatches(Stage* stage, float cellSize)
+	{
+		struct StaticBatchGroup
+		{
+			glm::ivec3				cell;
+			std::vector<Actor*>		actors;
+		};
+
+		std::vector<StaticBatchGroup> groups;
+
+		// gather first, adding the batch actors below inserts into the same map
+		for (auto& pair : stage->getActors())
+		{
+			for (auto& a : pair.second)
+			{
+				if (!StaticBatch::canBatch(a.get()))
+					continue;
+
+				AABB bounds = a->getWorldAABB();
+				glm::vec3 center = (bounds.getMinEdge() + bounds.getMaxEdge()) * 0.5f;
+				glm::ivec3 cell = glm::ivec3(glm::floor(center / cellSize));
+
+				auto it = std::find_if(groups.begin(), groups.end(), [&](const StaticBatchGroup& g) {
+					return g.cell == cell && StaticBatch::compatible(g.actors.front(), a.get());
+				});
+
+				if (it == groups.end())
+					groups.push_back(StaticBatchGroup{ cell, { a.get() } });
+				else
+					it->actors.push_back(a.get());
+			}
+		}
+
+		unsigned int built = 0;
+
+		for (auto& g : groups)
+		{
+			// a single actor gains nothing from being batched
+			if (g.actors.size() < 2)
+				continue;
+
+			size_t next = 0;
+			while (next < g.actors.size())
+			{
+				std::unique_ptr<StaticBatch> sb = std::make_unique<StaticBatch>(stage->getName() + "_staticBatch_" + std::to_string(this->staticBatchCount++));
+
+				// split further only when the union of textures outgrows the texture ubo
+				while (next < g.actors.size() && sb->addMember(g.actors.at(next)))
+					next++;
+
+				if (sb->getMembers().size() < 2)
+					continue;
+
+				Mesh* pBatchMesh = this->assetManager->addMesh(sb->createMesh(sb->getName() + "_mesh"));
+				this->meshesInUse.push_back(pBatchMesh);
+
+				Actor* first = sb->getMembers().front().actor;
+				std::unique_ptr<Material> batchMaterial = first->getMaterial()->clone();
+				batchMaterial->getTextures() = sb->getTextures();
+
+				Actor* pBatchActor = stage->addActor(sb->getName(), pBatchMesh, batchMaterial.get()); // actor keeps its own clone
+				if (!pBatchActor)
+				{
+					// members stay unbatched and keep drawing on their own
+					SPDLOG_DEBUG("Scene::buildStaticBatches: unable to add actor for {}, leaving its members unbatched", sb->getName());
+					this->meshesInUse.pop_back();
+					this->assetManager->removeMesh(pBatchMesh);
+					continue;
+				}
+
+				sb->setActor(pBatchActor);
+
+				for (auto& m : sb->getMembers())
+					m.actor->setStaticBatched(true);
+
+				stage->addStaticBatch(std::move(sb));
+				built++;
+			}
+		}
+
+		return built;
+	}
+
+	SkinnedMeshCache* Scene::enablePreSkinning(Stage* stage, Actor* actor, bool skipUnchangedPose)
+	{
+		Mesh* sourceMesh = actor->getMesh();
+		SkinnedMaterialMixin* skinnedMaterial = dynamic_cast<SkinnedMaterialMixin*>(actor->getMaterial());
+
+		if (!sourceMesh || !sourceMesh->hasBones() || !actor->getAnimator() || !skinnedMaterial)
+		{
+			SPDLOG_DEBUG("Scene::enablePreSkinning: actor {} is not a skinned, animated actor", actor->getName());
+			return nullptr;
+		}
+
+		if (SkinnedMeshCache* existing = stage->getSkinnedMeshCache(actor))
+			return existing;
+
+		// static shader variant of the actor's material, what remains once IS_SKINNED is dropped
+		std::vector<std::string> defs;
+		std::string shaderName;
+
+		if (dynamic_cast<DiffuseAmbientCubeSkinnedMaterial*>(actor->getMaterial()))
+		{
+			defs = DiffuseAmbientCubeMaterial::shaderDefs;
+			shaderName = "diffuseAmbientCubeMaterialShader";
+		}
+		else
+		{
+			defs = DiffuseMaterial::shaderDefs;
+			shaderName = "diffuseMaterialShader";
+		}
+
+		// every option of the skinned material carries over, so the static variant draws the same way. Compact skinned
+		// meshes become compact static ones, the pre-skinned copy below is given the matching format
+		const int opts = actor->getMaterial()->getOptions();
+		this->setShaderOpts(opts, defs, shaderName);
+
+		Shader* staticShader = this->assetManager->loadShader(shaderName, "uber.vert", "", "uber.frag", defs); // returns existing if already loaded
+		this->shadersInUse.push_back(staticShader);
+
+		// per actor copy of the mesh which receives the skinned vertices
+		std::unique_ptr<Mesh> tmpM = std::make_unique<Mesh>(actor->getName() + "_preskinned");
+		tmpM->setVertices(sourceMesh->getVertices());
+		tmpM->setIndices(sourceMesh->getIndices());
+		if (opts & MTRL_OPT_COMPACT_VERTEX)
+			tmpM->setVertexFormat(VertexFormat::STATIC_COMPACT);
+
+		Mesh* skinnedMesh = this->assetManager->addMesh(std::move(tmpM));
+		this->meshesInUse.push_back(skinnedMesh);
+
+		skinnedMaterial->setPreSkinned(skinnedMesh, staticShader);
+
+		SkinnedMeshCache* smc = stage->addSkinnedMeshCache(std::make_unique<SkinnedMeshCache>(actor, skinnedMesh, skipUnchangedPose));
+
+		// populate the buffer now so the first frame does not draw the bind pose
+		if (smc->update())
+			this->assetManager->updateMeshVertices(skinnedMesh);
+
+		return smc;
+	}
 
 	void Scene::lerpAnimators(float alpha)
 	{
@@ -714,10 +1187,37 @@ namespace vel
 		for (auto& s : this->stages)
 			s->updateBillboards();
 	}
+
+	void Scene::updateParticleEmitters(float dt)
+	{
+		for (auto& s : this->stages)
+			if (s->getVisible())
+				s->updateParticleEmitters(dt);
+	}
+
+	void Scene::updateStaticBatches()
+	{
+		for (auto& s : this->stages)
+			if (s->getVisible())
+				s->updateStaticBatches();
+	}
+
+	void Scene::updateSkinnedMeshCaches()
+	{
+		for (auto& s : this->stages)
+			if (s->getVisible())
+				s->updateSkinnedMeshCaches();
+	}
 	
 
 	void Scene::draw(float frameTime, float alpha)
 	{
+		if (this->drawTimer)
+			gpu->beginGpuTimer(this->drawTimer.value());
+
+		if (this->occlusionCuller)
+			this->occlusionCuller->beginFrame();
+
 		for (auto& s : this->stages)
 		{
 			if (!s->getVisible())
@@ -725,10 +1225,14 @@ namespace vel
 
 			bool actorsFirstPass = true;
 
+			s->updateActorTree();
+
 			for (auto& c : s->getCameras())
 			{
 				c->update();
 
+				uint32_t visibleStamp = s->markVisibleActors(c->getProjectionMatrix() * c->getViewMatrix());
+
 				gpu->updateCameraViewportSize(c->getResolution().x, c->getResolution().y); // different cameras can have different resolutions
 
 				gpu->setRenderTarget(c->getRenderTarget());
@@ -737,15 +1241,25 @@ namespace vel
 
 				bool foundFirstAlpha = false;
 
+				// results from screen space / orthographic passes aren't worth the queries
+				OcclusionCuller* occlusion = c->getType() == CameraType::PERSPECTIVE ? this->occlusionCuller.get() : nullptr;
+
 				for (auto& pair : s->getActors())
 				{
 					for (auto& a : pair.second)
 					{
-						if (!a->getMesh() || !a->isVisible() || !a->getMaterial()->getShader())
+						if (!a->getMesh() || !a->isVisible() || a->isStaticBatched() || !a->getMaterial()->getShader())
+							continue;
+
+						if (!s->isActorMarkedVisible(a.get(), visibleStamp))
 							continue;
 
 						if (a->getMaterial()->getHasAlphaChannel() && !foundFirstAlpha)
 						{
+							// opaque depth is complete, test this pass's proxies against it before it's used for alpha
+							if (occlusion)
+								occlusion->drawProxies(c);
+
 							foundFirstAlpha = true;
 							gpu->setAlphaRenderState();
 						}
@@ -757,16 +1271,47 @@ namespace vel
 						gpu->useMesh(a->getMesh()); // only alters gpu state if necessary
 						gpu->setActiveMaterial(a->getMaterial());
 
+						const bool occlusionTested = occlusion && !foundFirstAlpha && a->isCullable();
+						const bool hasLods = a->getMesh()->getLodCount() > 1;
+
+						bool conditional = false;
+						size_t lod = 0;
+						glm::vec3 boundsMin, boundsMax;
+						if ((occlusionTested || hasLods) && s->getActorBounds(a.get(), boundsMin, boundsMax))
+						{
+							if (hasLods)
+								lod = this->selectActorLod(c, a.get(), boundsMin, boundsMax);
+
+							if (occlusionTested)
+								conditional = occlusion->beginActor(c, a.get(), boundsMin, boundsMax);
+						}
+
+						gpu->setActiveLod(lod);
+
 						a->getMaterial()->draw(alpha, gpu, a.get(), c->getViewMatrix(), c->getProjectionMatrix());
+
+						if (conditional)
+							occlusion->endActor();
 					}
 				}
 
+				gpu->setActiveLod(0);
+
+				if (occlusion && !foundFirstAlpha)
+					occlusion->drawProxies(c);
+
 				actorsFirstPass = false;
 
 				gpu->composeFBOs();
 			}
 		}
 
+		if (this->occlusionCuller)
+			this->occlusionCuller->endFrame();
+
+		if (this->drawTimer)
+			gpu->endGpuTimer(this->drawTimer.value());
+
 
 		// all stage camera's framebuffers are now updated, loop through each stage camera and check if it should display it's contents 
 
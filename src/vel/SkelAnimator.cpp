@@ -1,5 +1,6 @@
 
 #include <string>
+#include <cstring>
 
 #include "ozz/animation/runtime/local_to_model_job.h"
 #include "ozz/animation/runtime/sampling_job.h"
@@ -12,7 +13,8 @@ namespace vel
 		simTime(0.0f),
 		skeleton(skeleton),
 		simPrevLocalTransforms(&this->localTransformsA),
-		simLocalTransforms(&this->localTransformsB)
+		simLocalTransforms(&this->localTransformsB),
+		renderPoseVersion(0)
 	{
 		// Allocate runtime buffers.
 		this->localTransformsA.resize(this->skeleton->num_soa_joints());
@@ -130,22 +132,37 @@ namespace vel
 		const ozz::math::SoaTransform* cur = simLocalTransforms->data();
 		ozz::math::SoaTransform* out = renderLocalTransforms.data();
 
+		bool poseChanged = false;
+
 		for (int i = 0; i < n; ++i)
 		{
 			const ozz::math::SoaTransform& A = prev[i];
 			const ozz::math::SoaTransform& B = cur[i];
 			ozz::math::SoaTransform& O = out[i];
 
-			O.translation = lerpSoaFloat3(A.translation, B.translation, t);
-			O.scale = lerpSoaFloat3(A.scale, B.scale, t);
-			O.rotation = nLerpSoaQuaternion(A.rotation, B.rotation, t);
+			ozz::math::SoaTransform lerped;
+			lerped.translation = lerpSoaFloat3(A.translation, B.translation, t);
+			lerped.scale = lerpSoaFloat3(A.scale, B.scale, t);
+			lerped.rotation = nLerpSoaQuaternion(A.rotation, B.rotation, t);
+
+			if (!poseChanged && std::memcmp(&lerped, &O, sizeof(ozz::math::SoaTransform)) != 0)
+				poseChanged = true;
+
+			O = lerped;
 		}
 
+		// identical local pose means the model matrices from the last lerp are still valid, which lets anything
+		// consuming them (see SkinnedMeshCache) skip work for characters that are standing still
+		if (!poseChanged && this->renderPoseVersion != 0)
+			return;
+
 		ozz::animation::LocalToModelJob ltm;
 		ltm.skeleton = this->skeleton;
 		ltm.input = make_span(this->renderLocalTransforms);
 		ltm.output = make_span(this->renderModelMatrices);
 		ltm.Run();
+
+		this->renderPoseVersion++;
 	}
 
 	const ozz::math::Float4x4& SkelAnimator::getSimBoneMatrix(unsigned int i)
@@ -158,6 +175,11 @@ namespace vel
 		return this->renderModelMatrices.at(i);
 	}
 
+	uint32_t SkelAnimator::getRenderPoseVersion() const
+	{
+		return this->renderPoseVersion;
+	}
+
 	int SkelAnimator::getBoneIndex(const std::string& name)
 	{
 		const auto& names = this->skeleton->joint_names();
@@ -5,7 +5,51 @@
 
 namespace vel
 {
-	SkinnedMaterialMixin::SkinnedMaterialMixin() {}
+	SkinnedMaterialMixin::SkinnedMaterialMixin() :
+		preSkinnedMesh(nullptr),
+		preSkinnedShader(nullptr)
+	{}
+
+	SkinnedMaterialMixin::SkinnedMaterialMixin(const SkinnedMaterialMixin&) :
+		preSkinnedMesh(nullptr),
+		preSkinnedShader(nullptr)
+	{}
+
+	SkinnedMaterialMixin& SkinnedMaterialMixin::operator=(const SkinnedMaterialMixin&)
+	{
+		return *this;
+	}
+
+	void SkinnedMaterialMixin::setPreSkinned(Mesh* skinnedMesh, Shader* staticShader)
+	{
+		this->preSkinnedMesh = skinnedMesh;
+		this->preSkinnedShader = staticShader;
+	}
+
+	void SkinnedMaterialMixin::clearPreSkinned()
+	{
+		this->preSkinnedMesh = nullptr;
+		this->preSkinnedShader = nullptr;
+	}
+
+	bool SkinnedMaterialMixin::isPreSkinned() const
+	{
+		return this->preSkinnedMesh != nullptr && this->preSkinnedShader != nullptr;
+	}
+
+	void SkinnedMaterialMixin::prepareSkinning(float alphaTime, GPU* gpu, Actor* a)
+	{
+		if (!this->isPreSkinned())
+		{
+			this->updateBones(alphaTime, gpu, a);
+			return;
+		}
+
+		// Scene::draw has already bound the skinned shader and source mesh, swapping them here is fine as both
+		// calls only alter gpu state when necessary and the next actor will rebind what it needs
+		gpu->useShader(this->preSkinnedShader);
+		gpu->useMesh(this->preSkinnedMesh);
+	}
 
 	void SkinnedMaterialMixin::updateBones(float alphaTime, GPU* gpu, Actor* a)
 	{
@@ -23,4 +67,4 @@ namespace vel
 
 		gpu->updateBonesUBO(boneData);
 	}
-}
\ No newline at end of file
+}
@@ -0,0 +1,120 @@
+#include "spdlog/spdlog.h"
+
+#include "vel/SkinnedMeshCache.h"
+#include "vel/functions.h"
+#include "vel/VertexFormat.h"
+
+namespace vel
+{
+	SkinnedMeshCache::SkinnedMeshCache(Actor* actor, Mesh* skinnedMesh, bool skipUnchangedPose) :
+		actor(actor),
+		skinnedMesh(skinnedMesh),
+		skipUnchangedPose(skipUnchangedPose),
+		initialized(false),
+		lastPoseVersion(0)
+	{}
+
+	Actor* SkinnedMeshCache::getActor() const
+	{
+		return this->actor;
+	}
+
+	Mesh* SkinnedMeshCache::getSkinnedMesh() const
+	{
+		return this->skinnedMesh;
+	}
+
+	void SkinnedMeshCache::setSkipUnchangedPose(bool b)
+	{
+		this->skipUnchangedPose = b;
+	}
+
+	bool SkinnedMeshCache::getSkipUnchangedPose() const
+	{
+		return this->skipUnchangedPose;
+	}
+
+	bool SkinnedMeshCache::update()
+	{
+		Mesh* sourceMesh = this->actor->getMesh();
+		SkelAnimator* animator = this->actor->getAnimator();
+
+		// no render pose exists until the animator has been lerped at least once, keep the bind pose until then
+		if (!sourceMesh || !animator || animator->getRenderPoseVersion() == 0)
+			return false;
+
+		if (this->initialized && this->skipUnchangedPose && animator->getRenderPoseVersion() == this->lastPoseVersion)
+			return false;
+
+		const std::vector<Vertex>& sourceVertices = sourceMesh->getVertices();
+		std::vector<Vertex>& skinnedVertices = this->skinnedMesh->getMutableVertices();
+
+		if (skinnedVertices.size() != sourceVertices.size())
+		{
+			SPDLOG_DEBUG("SkinnedMeshCache::update: vertex count mismatch between {} and {}", sourceMesh->getName(), this->skinnedMesh->getName());
+			return false;
+		}
+
+		// bones that are not driven by the animator keep an identity transform, which matches the zero filled
+		// bone UBO the skinned shader would otherwise be reading from
+		this->boneMatrices.assign(sourceMesh->getBones().size(), glm::mat4(1.0f));
+
+		for (auto& activeBone : this->actor->getActiveBones())
+			this->boneMatrices[activeBone.second] = ozzFloat4x4ToGlmMat4(animator->getRenderBoneMatrix(activeBone.first)) *
+				sourceMesh->getBone(activeBone.second).offsetMatrix;
+
+		const size_t boneCount = this->boneMatrices.size();
+
+		// compact skinned meshes only reach the gpu with their 4 heaviest, renormalized and quantized influences, use
+		// exactly those so the pre-skinned mesh matches what the skinned shader would have drawn
+		const bool topFourWeights = sourceMesh->getVertexFormat() == VertexFormat::SKINNED_COMPACT;
+		VertexBoneData influences;
+
+		for (size_t i = 0; i < sourceVertices.size(); i++)
+		{
+			const Vertex& in = sourceVertices[i];
+			Vertex& out = skinnedVertices[i];
+
+			influences = in.weights;
+			if (topFourWeights)
+			{
+				uint8_t ids[4];
+				uint8_t weights[4];
+				packTopFourBoneWeights(in.weights, ids, weights);
+
+				for (unsigned int j = 0; j < 8; j++)
+				{
+					influences.ids[j] = j < 4 ? ids[j] : 0;
+					influences.weights[j] = j < 4 ? weights[j] / 255.0f : 0.0f;
+				}
+			}
+
+			glm::mat4 skinMatrix(0.0f);
+			float totalWeight = 0.0f;
+
+			for (unsigned int j = 0; j < 8; j++)
+			{
+				float w = influences.weights[j];
+				if (w == 0.0f || influences.ids[j] >= boneCount)
+					continue;
+
+				skinMatrix += this->boneMatrices[influences.ids[j]] * w;
+				totalWeight += w;
+			}
+
+			if (totalWeight == 0.0f)
+				skinMatrix = glm::mat4(1.0f);
+
+			out.position = glm::vec3(skinMatrix * glm::vec4(in.position, 1.0f));
+
+			glm::vec3 n = glm::mat3(skinMatrix) * in.normal;
+			float len = glm::length(n);
+			out.normal = len > 0.0f ? n / len : in.normal;
+		}
+
+		this->lastPoseVersion = animator->getRenderPoseVersion();
+		this->initialized = true;
+
+		return true;
+	}
+}
@@ -1,4 +1,8 @@
 
+#include <algorithm>
+
+#include "spdlog/spdlog.h"
+
 #include "vel/Stage.h"
 #include "vel/Scene.h"
 
@@ -90,6 +94,31 @@ namespace vel
 			return;
 
 		auto al = actorLocation.value();
+		Actor* a = this->actors[al.first].at(al.second).get();
+
+		this->removeSkinnedMeshCache(a);
+
+		if (a->getSpatialProxy() != -1)
+			this->actorTree.remove(a->getSpatialProxy());
+
+		if (a->isStaticBatched())
+		{
+			for (auto& sb : this->staticBatches)
+				if (sb->removeMember(a, this->assetManager))
+					break;
+		}
+		else
+		{
+			// removing a batch's own actor releases its members to be drawn individually again
+			auto it = std::find_if(this->staticBatches.begin(), this->staticBatches.end(), [a](const std::unique_ptr<StaticBatch>& sb) { return sb->getActor() == a; });
+			if (it != this->staticBatches.end())
+			{
+				for (auto& m : (*it)->getMembers())
+					m.actor->setStaticBatched(false);
+
+				this->staticBatches.erase(it);
+			}
+		}
 
 		this->actors[al.first].erase(this->actors[al.first].begin() + al.second);
 	}
@@ -106,6 +135,12 @@ namespace vel
 
 	Actor* Stage::addActor(const Actor& actorIn)
 	{
+		if (!actorIn.hasMatchingVertexFormat())
+		{
+			SPDLOG_DEBUG("Stage::addActor: not adding {}, its mesh and material vertex formats differ", actorIn.getName());
+			return nullptr;
+		}
+
 		// ogl uses 0 to indicate error, so we'll never have an index of 0, so we use that for empty
 		unsigned int fboToUse = actorIn.getMaterial()->getHasAlphaChannel() ? 2 : 1; // always either opaque or has alpha
 		unsigned int shaderProgramId = actorIn.getMaterial()->getShader() == nullptr ? 0 : actorIn.getMaterial()->getShader()->id;
@@ -122,6 +157,8 @@ namespace vel
 
 		this->actors[key].push_back(std::move(a));
 
+		this->_insertActorProxy(ptrA);
+
 		return ptrA;
 	}
 
@@ -138,8 +175,11 @@ namespace vel
 		std::unique_ptr<Actor> a = std::make_unique<Actor>(name);
 		a->setMesh(mesh);
 
-		if (material) // actor default to EmptyMaterial if none provided
-			a->setMaterial(material);
+		if (material && !a->setMaterial(material)) // actor default to EmptyMaterial if none provided
+		{
+			SPDLOG_DEBUG("Stage::addActor: not adding {}, its mesh and material vertex formats differ", name);
+			return nullptr;
+		}
 
 		a->setUpdateTick(this->logicTickPtr);
 
@@ -149,6 +189,8 @@ namespace vel
 
 		this->actors[key].push_back(std::move(a));
 
+		this->_insertActorProxy(ptrA);
+
 		return ptrA;
 	}
 
@@ -162,6 +204,103 @@ namespace vel
 		return nullptr;
 	}
 
+	void Stage::_getActorWorldBounds(Actor* a, glm::vec3& minEdge, glm::vec3& maxEdge)
+	{
+		Mesh* m = a->getMesh();
+
+		if (m == nullptr || m->getVertices().empty())
+		{
+			minEdge = maxEdge = glm::vec3(a->getWorldMatrix()[3]);
+			return;
+		}
+
+		AABB& local = m->getAABB();
+		AABBTree::transformBounds(a->getWorldMatrix(), local.getMinEdge(), local.getMaxEdge(), minEdge, maxEdge);
+
+		// drawn somewhere between the previous and current transform, so cover both
+		if (a->isDynamic() && a->isLerpable())
+		{
+			glm::vec3 previousMin, previousMax;
+			AABBTree::transformBounds(a->getWorldRenderMatrix(0.0f), local.getMinEdge(), local.getMaxEdge(), previousMin, previousMax);
+
+			minEdge = glm::min(minEdge, previousMin);
+			maxEdge = glm::max(maxEdge, previousMax);
+		}
+	}
+
+	void Stage::_insertActorProxy(Actor* a)
+	{
+		glm::vec3 minEdge, maxEdge;
+		this->_getActorWorldBounds(a, minEdge, maxEdge);
+
+		a->setSpatialProxy(this->actorTree.insert(a, minEdge, maxEdge));
+		a->clearBoundsDirty();
+	}
+
+	void Stage::updateActorTree()
+	{
+		this->refitScratch.clear();
+
+		this->actorTree.forEachLeaf([this](int proxy, Actor* a) {
+			if (a->isDynamic() || a->isBoundsDirty() || (a->getMesh() != nullptr && a->getMesh()->isDynamic()))
+				this->refitScratch.push_back(a);
+		});
+
+		// moving re-inserts leaves, so gather first
+		for (Actor* a : this->refitScratch)
+		{
+			glm::vec3 minEdge, maxEdge;
+			this->_getActorWorldBounds(a, minEdge, maxEdge);
+
+			this->actorTree.move(a->getSpatialProxy(), minEdge, maxEdge);
+			a->clearBoundsDirty();
+		}
+	}
+
+	AABBTree& Stage::getActorTree()
+	{
+		return this->actorTree;
+	}
+
+	uint32_t Stage::markVisibleActors(const glm::mat4& viewProjection)
+	{
+		return this->actorTree.markFrustum(viewProjection);
+	}
+
+	bool Stage::isActorMarkedVisible(const Actor* a, uint32_t stamp) const
+	{
+		return !a->isCullable() || a->getSpatialProxy() == -1 || this->actorTree.isMarked(a->getSpatialProxy(), stamp);
+	}
+
+	bool Stage::getActorBounds(const Actor* a, glm::vec3& minEdge, glm::vec3& maxEdge) const
+	{
+		if (a->getSpatialProxy() == -1)
+			return false;
+
+		this->actorTree.getBounds(a->getSpatialProxy(), minEdge, maxEdge);
+		return true;
+	}
+
+	void Stage::queryActors(Camera* c, std::vector<Actor*>& out)
+	{
+		this->actorTree.queryFrustum(c->getProjectionMatrix() * c->getViewMatrix(), out);
+	}
+
+	void Stage::queryActors(const glm::vec3& center, float radius, std::vector<Actor*>& out)
+	{
+		this->actorTree.querySphere(center, radius, out);
+	}
+
+	void Stage::queryActors(AABB& box, std::vector<Actor*>& out)
+	{
+		this->actorTree.queryBox(box, out);
+	}
+
+	void Stage::queryActorsOnRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, std::vector<Actor*>& out)
+	{
+		this->actorTree.queryRay(origin, direction, maxDistance, out);
+	}
+
 	std::map<ActCompositeKey, std::vector<std::unique_ptr<Actor>>>& Stage::getActors()
 	{
 		return this->actors;
@@ -264,6 +403,9 @@ namespace vel
 	{
 		TextActor* ta = this->textActors.at(textActorIndex).get();
 
+		if (ta->batch != nullptr)
+			ta->batch->removeTextActor(ta);
+
 		this->_removeActor(this->_getActorLocation(ta->actor));
 
 		this->textActors.erase(this->textActors.begin() + textActorIndex);
@@ -292,9 +434,9 @@ namespace vel
 
 	void Stage::updateTextActor(TextActor* ta)
 	{
-		std::unique_ptr<Mesh> updatedMesh = std::move(this->assetManager->loadTextActorMesh(ta));
-		ta->actor->getMesh()->setVertices(updatedMesh->getVertices());
-		ta->actor->getMesh()->setIndices(updatedMesh->getIndices());
+		this->assetManager->buildTextActorGeometry(ta, this->textVertexScratch, this->textIndexScratch);
+		ta->actor->getMesh()->setVertices(this->textVertexScratch);
+		ta->actor->getMesh()->setIndices(this->textIndexScratch);
 
 		this->assetManager->updateMesh(ta->actor->getMesh());
 		ta->requiresUpdate = false;
@@ -303,8 +445,48 @@ namespace vel
 	void Stage::updateTextActors()
 	{
 		for (auto& ta : this->textActors)
-			if (ta->requiresUpdate)
+			if (ta->requiresUpdate && ta->batch == nullptr)
 				this->updateTextActor(ta.get());
+
+		for (auto& tb : this->textBatches)
+			tb->update(this->assetManager);
+	}
+
+	TextBatch* Stage::addTextBatch(std::unique_ptr<TextBatch> tb)
+	{
+		this->textBatches.push_back(std::move(tb));
+		return this->textBatches.back().get();
+	}
+
+	TextBatch* Stage::getTextBatch(const FontBitmap* fb, const glm::vec4& color)
+	{
+		for (auto& tb : this->textBatches)
+			if (tb->getFontBitmap() == fb && tb->getColor() == color)
+				return tb.get();
+
+		return nullptr;
+	}
+
+
+	//
+	// StaticBatches
+	//
+
+	StaticBatch* Stage::addStaticBatch(std::unique_ptr<StaticBatch> sb)
+	{
+		this->staticBatches.push_back(std::move(sb));
+		return this->staticBatches.back().get();
+	}
+
+	std::vector<std::unique_ptr<StaticBatch>>& Stage::getStaticBatches()
+	{
+		return this->staticBatches;
+	}
+
+	void Stage::updateStaticBatches()
+	{
+		for (auto& sb : this->staticBatches)
+			sb->update(this->assetManager);
 	}
 
 
@@ -362,9 +544,110 @@ namespace vel
 
 	void Stage::updateBillboards()
 	{
-		for (auto& b : this->billboards)
-			b->update();
+		Billboard::updateBatch(this->billboards, this->billboardScratch);
+	}
+
+
+	//
+	// ParticleEmitters
+	//
+
+	int Stage::_getParticleEmitterIndex(const std::string& name)
+	{
+		for (int i = 0; i < this->particleEmitters.size(); i++)
+			if (this->particleEmitters.at(i)->getName() == name)
+				return i;
+
+		return -1;
+	}
+
+	int Stage::_getParticleEmitterIndex(const ParticleEmitter* pe)
+	{
+		for (int i = 0; i < this->particleEmitters.size(); i++)
+			if (this->particleEmitters.at(i).get() == pe)
+				return i;
+
+		return -1;
+	}
+
+	void Stage::_removeParticleEmitter(int particleEmitterIndex)
+	{
+		ParticleEmitter* pe = this->particleEmitters.at(particleEmitterIndex).get();
+
+		this->_removeActor(this->_getActorLocation(pe->getActor()));
+
+		this->particleEmitters.erase(this->particleEmitters.begin() + particleEmitterIndex);
+	}
+
+	ParticleEmitter* Stage::addParticleEmitter(std::unique_ptr<ParticleEmitter> pe)
+	{
+		this->particleEmitters.push_back(std::move(pe));
+		return this->particleEmitters.back().get();
+	}
+
+	ParticleEmitter* Stage::getParticleEmitter(const std::string& name)
+	{
+		int index = this->_getParticleEmitterIndex(name);
+		if (index == -1)
+			return nullptr;
+
+		return this->particleEmitters.at(index).get();
+	}
+
+	void Stage::removeParticleEmitter(ParticleEmitter* pe)
+	{
+		this->_removeParticleEmitter(this->_getParticleEmitterIndex(pe));
 	}
 
+	void Stage::removeParticleEmitter(const std::string& name)
+	{
+		this->_removeParticleEmitter(this->_getParticleEmitterIndex(name));
+	}
+
+	void Stage::updateParticleEmitters(float dt)
+	{
+		for (auto& pe : this->particleEmitters)
+			pe->update(dt);
+	}
+
+
+	//
+	// SkinnedMeshCaches
+	//
+
+	SkinnedMeshCache* Stage::addSkinnedMeshCache(std::unique_ptr<SkinnedMeshCache> smc)
+	{
+		this->skinnedMeshCaches.push_back(std::move(smc));
+		return this->skinnedMeshCaches.back().get();
+	}
+
+	SkinnedMeshCache* Stage::getSkinnedMeshCache(const Actor* a)
+	{
+		for (auto& smc : this->skinnedMeshCaches)
+			if (smc->getActor() == a)
+				return smc.get();
+
+		return nullptr;
+	}
+
+	void Stage::removeSkinnedMeshCache(const Actor* a)
+	{
+		for (size_t i = 0; i < this->skinnedMeshCaches.size(); i++)
+		{
+			if (this->skinnedMeshCaches.at(i)->getActor() == a)
+			{
+				this->skinnedMeshCaches.erase(this->skinnedMeshCaches.begin() + i);
+				return;
+			}
+		}
+	}
+
+	void Stage::updateSkinnedMeshCaches()
+	{
+		// runs once per frame after lerpAnimators(), no matter how many cameras / passes end up drawing the actor
+		for (auto& smc : this->skinnedMeshCaches)
+			if (smc->getActor()->isVisible() && smc->update())
+				this->assetManager->updateMeshVertices(smc->getSkinnedMesh());
+	}
 
 }
\ No newline at end of file
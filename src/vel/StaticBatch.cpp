@@ -0,0 +1,215 @@
+#include <algorithm>
+#include <typeinfo>
+
+#include "vel/StaticBatch.h"
+#include "vel/AssetManager.h"
+#include "vel/Material.h"
+#include "vel/AnimatedMaterial.h"
+#include "vel/LightmapMaterialMixin.h"
+#include "vel/AmbientCubeMaterialMixin.h"
+#include "vel/RGBALineMaterial.h"
+
+
+namespace vel
+{
+	static Texture* lightmapOf(Actor* a)
+	{
+		LightmapMaterialMixin* lm = dynamic_cast<LightmapMaterialMixin*>(a->getMaterial());
+		return lm == nullptr ? nullptr : lm->getLightmapTexture();
+	}
+
+	StaticBatch::StaticBatch(const std::string& name) :
+		name(name),
+		actor(nullptr),
+		vertexFormat(VertexFormat::FULL)
+	{}
+
+	bool StaticBatch::canBatch(Actor* a)
+	{
+		if (a->isDynamic() || a->isStaticBatched() || a->getAnimator() != nullptr)
+			return false;
+
+		Mesh* m = a->getMesh();
+		if (m == nullptr || !m->getGpuMesh() || m->isDynamic() || m->hasBones() || m->getIndices().empty())
+			return false;
+
+		Material* mat = a->getMaterial();
+		if (mat->getShader() == nullptr || dynamic_cast<AnimatedMaterial*>(mat) != nullptr)
+			return false;
+
+		// line thickness / colors are per material uniforms with no per vertex equivalent
+		if (dynamic_cast<RGBALineMaterial*>(mat) != nullptr)
+			return false;
+
+		return true;
+	}
+
+	bool StaticBatch::compatible(Actor* a, Actor* b)
+	{
+		Material* ma = a->getMaterial();
+		Material* mb = b->getMaterial();
+
+		if (ma->getShader() != mb->getShader() ||
+			typeid(*ma) != typeid(*mb) ||
+			ma->getColor() != mb->getColor() ||
+			ma->getHasAlphaChannel() != mb->getHasAlphaChannel() ||
+			lightmapOf(a) != lightmapOf(b) ||
+			a->getMesh()->getVertexFormat() != b->getMesh()->getVertexFormat())
+			return false;
+
+		// the batch is drawn with its first member's material, so every other uniform it sets has to agree as well
+		AmbientCubeMaterialMixin* ca = dynamic_cast<AmbientCubeMaterialMixin*>(ma);
+		AmbientCubeMaterialMixin* cb = dynamic_cast<AmbientCubeMaterialMixin*>(mb);
+		if (ca && cb && ca->getAmbientCube() != cb->getAmbientCube())
+			return false;
+
+		return true;
+	}
+
+	bool StaticBatch::addMember(Actor* a)
+	{
+		std::vector<Texture*>& memberTextures = a->getMaterial()->getTextures();
+
+		size_t newTextures = 0;
+		for (Texture* t : memberTextures)
+			if (std::find(this->textures.begin(), this->textures.end(), t) == this->textures.end())
+				newTextures++;
+
+		if (!this->members.empty() && this->textures.size() + newTextures > StaticBatch::maxTextures)
+			return false;
+
+		// texture slot within the batch for each slot of the member's material
+		std::vector<unsigned int> slots;
+		for (Texture* t : memberTextures)
+		{
+			auto it = std::find(this->textures.begin(), this->textures.end(), t);
+			if (it == this->textures.end())
+			{
+				this->textures.push_back(t);
+				it = this->textures.end() - 1;
+			}
+
+			slots.push_back((unsigned int)(it - this->textures.begin()));
+		}
+
+		Mesh* m = a->getMesh();
+		const glm::mat4 world = a->getWorldMatrix();
+		const glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(world)));
+		const unsigned int baseVertex = (unsigned int)this->vertices.size();
+
+		for (Vertex v : m->getVertices())
+		{
+			v.position = glm::vec3(world * glm::vec4(v.position, 1.0f));
+			v.normal = glm::normalize(normalMatrix * v.normal);
+
+			if (v.materialUBOIndex < slots.size())
+				v.materialUBOIndex = slots[v.materialUBOIndex];
+
+			this->vertices.push_back(v);
+		}
+
+		StaticBatchMember member;
+		member.actor = a;
+		member.firstIndex = this->sourceIndices.size();
+		member.indexCount = m->getIndices().size();
+		member.lastVisible = true;
+
+		for (unsigned int i : m->getIndices())
+			this->sourceIndices.push_back(baseVertex + i);
+
+		this->members.push_back(member);
+		this->vertexFormat = m->getVertexFormat();
+
+		return true;
+	}
+
+	std::unique_ptr<Mesh> StaticBatch::createMesh(const std::string& meshName)
+	{
+		std::unique_ptr<Mesh> m = std::make_unique<Mesh>(meshName);
+		m->setVertexFormat(this->vertexFormat);
+		m->setDynamic(true);
+		m->setVertices(this->vertices);
+		m->setIndices(this->sourceIndices);
+
+		std::vector<Vertex>().swap(this->vertices);
+
+		return m;
+	}
+
+	void StaticBatch::writeMember(const StaticBatchMember& m, std::vector<unsigned int>& indices, bool visible)
+	{
+		auto first = indices.begin() + m.firstIndex;
+
+		if (visible)
+			std::copy(this->sourceIndices.begin() + m.firstIndex, this->sourceIndices.begin() + m.firstIndex + m.indexCount, first);
+		else
+			std::fill(first, first + m.indexCount, this->sourceIndices[m.firstIndex]); // zero area, nothing rasterized
+	}
+
+	bool StaticBatch::removeMember(const Actor* a, AssetManager* am)
+	{
+		auto it = std::find_if(this->members.begin(), this->members.end(), [a](const StaticBatchMember& m) { return m.actor == a; });
+		if (it == this->members.end())
+			return false;
+
+		// the range stays in the mesh, just never drawn again
+		if (this->actor != nullptr && this->actor->getMesh() != nullptr)
+		{
+			Mesh* mesh = this->actor->getMesh();
+			this->writeMember(*it, mesh->getIndices(), false);
+			mesh->markIndicesDirty(it->firstIndex, it->firstIndex + it->indexCount);
+			am->updateMesh(mesh);
+		}
+
+		this->members.erase(it);
+
+		return true;
+	}
+
+	const std::string& StaticBatch::getName() const
+	{
+		return this->name;
+	}
+
+	const std::vector<Texture*>& StaticBatch::getTextures() const
+	{
+		return this->textures;
+	}
+
+	const std::vector<StaticBatchMember>& StaticBatch::getMembers() const
+	{
+		return this->members;
+	}
+
+	void StaticBatch::setActor(Actor* a)
+	{
+		this->actor = a;
+	}
+
+	Actor* StaticBatch::getActor() const
+	{
+		return this->actor;
+	}
+
+	void StaticBatch::update(AssetManager* am)
+	{
+		if (this->actor == nullptr || this->actor->getMesh() == nullptr)
+			return;
+
+		Mesh* mesh = this->actor->getMesh();
+
+		for (auto& m : this->members)
+		{
+			const bool visible = m.actor->isVisible();
+			if (visible == m.lastVisible)
+				continue;
+
+			this->writeMember(m, mesh->getIndices(), visible);
+			mesh->markIndicesDirty(m.firstIndex, m.firstIndex + m.indexCount);
+			m.lastVisible = visible;
+		}
+
+		if (mesh->hasDirtyIndices())
+			am->updateMesh(mesh);
+	}
+}
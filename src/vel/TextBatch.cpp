@@ -0,0 +1,218 @@
+#include <algorithm>
+
+#include "vel/TextBatch.h"
+#include "vel/AssetManager.h"
+
+
+namespace vel
+{
+	// unused glyph slots are filled with zero area quads so they rasterize nothing. Value initialized, dynamic meshes
+	// compare vertices bytewise to find what changed
+	static Vertex degenerateGlyphVertex()
+	{
+		Vertex v{};
+		v.position = glm::vec3(0.0f);
+		v.normal = glm::vec3(0.0f, 0.0f, 1.0f);
+		v.textureCoordinates = glm::vec2(0.0f);
+		v.lightmapCoordinates = glm::vec2(0.0f);
+		v.materialUBOIndex = 0;
+		return v;
+	}
+
+	// same winding as AssetManager::buildTextActorGeometry()
+	static void appendGlyphIndices(std::vector<unsigned int>& indices, size_t glyphCount)
+	{
+		indices.reserve(indices.size() + glyphCount * 6);
+
+		for (size_t g = 0; g < glyphCount; g++)
+		{
+			unsigned int base = (unsigned int)(g * 4);
+			indices.push_back(base + 1);
+			indices.push_back(base);
+			indices.push_back(base + 3);
+			indices.push_back(base + 1);
+			indices.push_back(base + 3);
+			indices.push_back(base + 2);
+		}
+	}
+
+	TextBatch::TextBatch(const std::string& name, FontBitmap* fb, glm::vec4 color) :
+		name(name),
+		fontBitmap(fb),
+		color(color),
+		actor(nullptr),
+		glyphCapacity(TextBatch::initialGlyphCapacity),
+		requiresRelayout(false)
+	{}
+
+	std::unique_ptr<Mesh> TextBatch::createMesh(const std::string& name)
+	{
+		std::vector<Vertex> vertices(TextBatch::initialGlyphCapacity * 4, degenerateGlyphVertex());
+		std::vector<unsigned int> indices;
+		appendGlyphIndices(indices, TextBatch::initialGlyphCapacity);
+
+		std::unique_ptr<Mesh> m = std::make_unique<Mesh>(name);
+		m->setDynamic(true);
+		m->setVertices(vertices);
+		m->setIndices(indices);
+
+		return m;
+	}
+
+	const std::string& TextBatch::getName() const
+	{
+		return this->name;
+	}
+
+	FontBitmap* TextBatch::getFontBitmap() const
+	{
+		return this->fontBitmap;
+	}
+
+	const glm::vec4& TextBatch::getColor() const
+	{
+		return this->color;
+	}
+
+	void TextBatch::setActor(Actor* a)
+	{
+		this->actor = a;
+	}
+
+	Actor* TextBatch::getActor() const
+	{
+		return this->actor;
+	}
+
+	void TextBatch::addTextActor(TextActor* ta)
+	{
+		TextBatchSlot slot;
+		slot.textActor = ta;
+		slot.firstGlyph = 0;
+		slot.glyphCapacity = 0;
+		slot.lastWorldMatrix = glm::mat4(0.0f);
+		slot.lastVisible = false;
+
+		this->slots.push_back(slot);
+
+		ta->batch = this;
+		ta->requiresUpdate = true;
+		this->requiresRelayout = true;
+	}
+
+	void TextBatch::removeTextActor(const TextActor* ta)
+	{
+		auto it = std::find_if(this->slots.begin(), this->slots.end(), [ta](const TextBatchSlot& s) { return s.textActor == ta; });
+		if (it == this->slots.end())
+			return;
+
+		this->slots.erase(it);
+		this->requiresRelayout = true;
+	}
+
+	size_t TextBatch::buildSlotGlyphs(TextBatchSlot& slot, AssetManager* am)
+	{
+		TextActor* ta = slot.textActor;
+
+		am->buildTextActorGeometry(ta, this->glyphVertices, this->glyphIndices);
+		ta->requiresUpdate = false;
+
+		slot.lastWorldMatrix = ta->actor->getWorldMatrix();
+		slot.lastVisible = ta->actor->isVisible();
+
+		if (!slot.lastVisible)
+		{
+			this->glyphVertices.clear();
+			return 0;
+		}
+
+		for (auto& v : this->glyphVertices)
+			v.position = glm::vec3(slot.lastWorldMatrix * glm::vec4(v.position, 1.0f));
+
+		return this->glyphVertices.size() / 4;
+	}
+
+	void TextBatch::writeSlot(TextBatchSlot& slot, std::vector<Vertex>& vertices)
+	{
+		const size_t first = slot.firstGlyph * 4;
+		const size_t written = this->glyphVertices.size();
+
+		std::copy(this->glyphVertices.begin(), this->glyphVertices.end(), vertices.begin() + first);
+		std::fill(vertices.begin() + first + written, vertices.begin() + first + (slot.glyphCapacity * 4), degenerateGlyphVertex());
+	}
+
+	void TextBatch::relayout(AssetManager* am)
+	{
+		Mesh* mesh = this->actor->getMesh();
+
+		std::vector<Vertex> vertices;
+		size_t nextGlyph = 0;
+
+		for (auto& slot : this->slots)
+		{
+			size_t glyphCount = this->buildSlotGlyphs(slot, am);
+
+			// every label gets some headroom so that small text changes (timers, counters) don't trigger another relayout
+			slot.firstGlyph = nextGlyph;
+			slot.glyphCapacity = std::max<size_t>(std::max(glyphCount, slot.textActor->text.size()) + 8, slot.glyphCapacity);
+			nextGlyph += slot.glyphCapacity;
+
+			vertices.resize(nextGlyph * 4);
+			this->writeSlot(slot, vertices);
+		}
+
+		this->glyphCapacity = std::max(nextGlyph, TextBatch::initialGlyphCapacity);
+		vertices.resize(this->glyphCapacity * 4, degenerateGlyphVertex());
+
+		std::vector<unsigned int> indices;
+		appendGlyphIndices(indices, this->glyphCapacity);
+
+		mesh->setVertices(vertices);
+		mesh->setIndices(indices);
+		am->updateMesh(mesh);
+
+		this->requiresRelayout = false;
+	}
+
+	void TextBatch::update(AssetManager* am)
+	{
+		if (this->actor == nullptr || this->actor->getMesh() == nullptr)
+			return;
+
+		if (this->requiresRelayout)
+		{
+			this->relayout(am);
+			return;
+		}
+
+		// getMutableVertices() marks the mesh's aabb stale, only take them once a slot actually has to be rewritten
+		Mesh* mesh = this->actor->getMesh();
+		std::vector<Vertex>* vertices = nullptr;
+
+		for (auto& slot : this->slots)
+		{
+			TextActor* ta = slot.textActor;
+
+			if (!ta->requiresUpdate && slot.lastVisible == ta->actor->isVisible() && slot.lastWorldMatrix == ta->actor->getWorldMatrix())
+				continue;
+
+			size_t glyphCount = this->buildSlotGlyphs(slot, am);
+
+			if (glyphCount > slot.glyphCapacity)
+			{
+				this->relayout(am);
+				return;
+			}
+
+			if (vertices == nullptr)
+				vertices = &mesh->getMutableVertices();
+
+			this->writeSlot(slot, *vertices);
+			mesh->markVerticesDirty(slot.firstGlyph * 4, (slot.firstGlyph + slot.glyphCapacity) * 4);
+		}
+
+		// one upload spanning every rewritten slot, labels that change together tend to be neighbours in the buffer
+		if (mesh->hasDirtyVertices())
+			am->updateMesh(mesh);
+	}
+}
@@ -0,0 +1,509 @@
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+#include <algorithm>
+#include <cmath>
+#include <atomic>
+#include <thread>
+#include <functional>
+
+#include "spdlog/spdlog.h"
+
+#include "stb_headers/stb_image.h"
+
+#include "vel/TextureCache.h"
+
+
+namespace vel
+{
+	static const char TEXTURE_CACHE_MAGIC[8] = { 'V', 'E', 'L', 'T', 'E', 'X', '\0', '\0' };
+
+	static uint64_t alignTo16(uint64_t v)
+	{
+		return (v + 15) & ~uint64_t(15);
+	}
+
+	static size_t blockSize(BlockFormat format)
+	{
+		return (format == BlockFormat::BC1 || format == BlockFormat::BC4) ? 8 : 16;
+	}
+
+	const unsigned char* CompressedImage::getLevelData(size_t level) const
+	{
+		return this->file.getData() + this->levels.at(level).offset;
+	}
+
+	std::string TextureCache::getCachePath(const std::string& sourcePath)
+	{
+		return sourcePath + ".veltex";
+	}
+
+	BlockFormat TextureCache::chooseFormat(int components, bool normalMap)
+	{
+		if (components == 1)
+			return BlockFormat::BC4;
+
+		if (normalMap)
+			return BlockFormat::BC5;
+
+		// two channel images are grey + alpha, decoded to rgba with the grey replicated
+		if (components == 2 || components == 4)
+			return BlockFormat::BC3;
+
+		return BlockFormat::BC1;
+	}
+
+	bool TextureCache::isCurrent(const std::string& sourcePath, const std::string& cachePath)
+	{
+		std::error_code ec;
+
+		if (!std::filesystem::exists(cachePath, ec))
+			return false;
+
+		// shipping only the cache is allowed
+		if (!std::filesystem::exists(sourcePath, ec))
+			return true;
+
+		auto cacheTime = std::filesystem::last_write_time(cachePath, ec);
+		if (ec)
+			return false;
+
+		auto sourceTime = std::filesystem::last_write_time(sourcePath, ec);
+		if (ec)
+			return true;
+
+		return cacheTime >= sourceTime;
+	}
+
+
+	/***********************************************************************************************
+	* BLOCK ENCODERS
+	************************************************************************************************/
+	static uint16_t packRGB565(const float* c)
+	{
+		int r = std::clamp((int)(c[0] * (31.0f / 255.0f) + 0.5f), 0, 31);
+		int g = std::clamp((int)(c[1] * (63.0f / 255.0f) + 0.5f), 0, 63);
+		int b = std::clamp((int)(c[2] * (31.0f / 255.0f) + 0.5f), 0, 31);
+		return (uint16_t)((r << 11) | (g << 5) | b);
+	}
+
+	static void unpackRGB565(uint16_t c, float* out)
+	{
+		int r = (c >> 11) & 31;
+		int g = (c >> 5) & 63;
+		int b = c & 31;
+		out[0] = (float)((r << 3) | (r >> 2));
+		out[1] = (float)((g << 2) | (g >> 4));
+		out[2] = (float)((b << 3) | (b >> 2));
+	}
+
+	static void writeU16(unsigned char* out, uint16_t v)
+	{
+		out[0] = (unsigned char)(v & 0xff);
+		out[1] = (unsigned char)(v >> 8);
+	}
+
+	// endpoints from the extent of the block along its principal axis, always in four color mode (c0 > c1)
+	void TextureCache::encodeBC1Block(const unsigned char* rgba, unsigned char* out)
+	{
+		float mean[3] = { 0.0f, 0.0f, 0.0f };
+		for (int i = 0; i < 16; i++)
+			for (int c = 0; c < 3; c++)
+				mean[c] += rgba[i * 4 + c] / 16.0f;
+
+		float cov[6] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f }; // rr, rg, rb, gg, gb, bb
+		for (int i = 0; i < 16; i++)
+		{
+			float d[3] = { rgba[i * 4] - mean[0], rgba[i * 4 + 1] - mean[1], rgba[i * 4 + 2] - mean[2] };
+			cov[0] += d[0] * d[0]; cov[1] += d[0] * d[1]; cov[2] += d[0] * d[2];
+			cov[3] += d[1] * d[1]; cov[4] += d[1] * d[2]; cov[5] += d[2] * d[2];
+		}
+
+		// a few power iterations are plenty for a 3x3
+		float axis[3] = { 1.0f, 1.0f, 1.0f };
+		for (int it = 0; it < 4; it++)
+		{
+			float n[3] = {
+				cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2],
+				cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2],
+				cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2]
+			};
+
+			float len = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+			if (len <= 0.0f)
+				break;
+
+			axis[0] = n[0] / len; axis[1] = n[1] / len; axis[2] = n[2] / len;
+		}
+
+		float minT = 0.0f, maxT = 0.0f;
+		for (int i = 0; i < 16; i++)
+		{
+			float t = (rgba[i * 4] - mean[0]) * axis[0] + (rgba[i * 4 + 1] - mean[1]) * axis[1] + (rgba[i * 4 + 2] - mean[2]) * axis[2];
+			minT = std::min(minT, t);
+			maxT = std::max(maxT, t);
+		}
+
+		// pull the endpoints in slightly, the extremes are usually outliers and the palette covers them anyway
+		const float inset = (maxT - minT) / 16.0f;
+		minT += inset;
+		maxT -= inset;
+
+		float e0[3], e1[3];
+		for (int c = 0; c < 3; c++)
+		{
+			e0[c] = mean[c] + axis[c] * maxT;
+			e1[c] = mean[c] + axis[c] * minT;
+		}
+
+		uint16_t c0 = packRGB565(e0);
+		uint16_t c1 = packRGB565(e1);
+		if (c0 < c1)
+			std::swap(c0, c1);
+
+		uint32_t indices = 0;
+
+		if (c0 != c1)
+		{
+			float palette[4][3];
+			unpackRGB565(c0, palette[0]);
+			unpackRGB565(c1, palette[1]);
+			for (int c = 0; c < 3; c++)
+			{
+				palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+				palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+			}
+
+			for (int i = 0; i < 16; i++)
+			{
+				uint32_t best = 0;
+				float bestDistance = 1e30f;
+				for (uint32_t p = 0; p < 4; p++)
+				{
+					float dr = rgba[i * 4] - palette[p][0];
+					float dg = rgba[i * 4 + 1] - palette[p][1];
+					float db = rgba[i * 4 + 2] - palette[p][2];
+					float d = dr * dr + dg * dg + db * db;
+					if (d < bestDistance)
+					{
+						bestDistance = d;
+						best = p;
+					}
+				}
+
+				indices |= best << (i * 2);
+			}
+		}
+
+		writeU16(out, c0);
+		writeU16(out + 2, c1);
+		out[4] = (unsigned char)(indices & 0xff);
+		out[5] = (unsigned char)((indices >> 8) & 0xff);
+		out[6] = (unsigned char)((indices >> 16) & 0xff);
+		out[7] = (unsigned char)((indices >> 24) & 0xff);
+	}
+
+	// eight value mode (a0 > a1) spanning the block's min / max
+	void TextureCache::encodeBC4Block(const unsigned char* rgba, int channel, unsigned char* out)
+	{
+		int mn = 255, mx = 0;
+		for (int i = 0; i < 16; i++)
+		{
+			mn = std::min(mn, (int)rgba[i * 4 + channel]);
+			mx = std::max(mx, (int)rgba[i * 4 + channel]);
+		}
+
+		out[0] = (unsigned char)mx;
+		out[1] = (unsigned char)mn;
+
+		uint64_t indices = 0;
+
+		if (mx != mn)
+		{
+			float palette[8];
+			palette[0] = (float)mx;
+			palette[1] = (float)mn;
+			for (int i = 2; i < 8; i++)
+				palette[i] = ((8 - i) * mx + (i - 1) * mn) / 7.0f;
+
+			for (int i = 0; i < 16; i++)
+			{
+				float v = (float)rgba[i * 4 + channel];
+				uint64_t best = 0;
+				float bestDistance = 1e30f;
+				for (uint64_t p = 0; p < 8; p++)
+				{
+					float d = std::fabs(v - palette[p]);
+					if (d < bestDistance)
+					{
+						bestDistance = d;
+						best = p;
+					}
+				}
+
+				indices |= best << (i * 3);
+			}
+		}
+
+		for (int b = 0; b < 6; b++)
+			out[2 + b] = (unsigned char)((indices >> (b * 8)) & 0xff);
+	}
+
+	void TextureCache::encodeBC3Block(const unsigned char* rgba, unsigned char* out)
+	{
+		encodeBC4Block(rgba, 3, out);
+		encodeBC1Block(rgba, out + 8);
+	}
+
+	void TextureCache::encodeBC5Block(const unsigned char* rgba, unsigned char* out)
+	{
+		encodeBC4Block(rgba, 0, out);
+		encodeBC4Block(rgba, 1, out + 8);
+	}
+
+
+	/***********************************************************************************************
+	* COOKING
+	************************************************************************************************/
+	static std::vector<unsigned char> downsample(const std::vector<unsigned char>& src, uint32_t width, uint32_t height)
+	{
+		const uint32_t w = std::max(1u, width / 2);
+		const uint32_t h = std::max(1u, height / 2);
+		std::vector<unsigned char> dst(w * h * 4);
+
+		for (uint32_t y = 0; y < h; y++)
+		{
+			const uint32_t y0 = std::min(y * 2, height - 1);
+			const uint32_t y1 = std::min(y * 2 + 1, height - 1);
+
+			for (uint32_t x = 0; x < w; x++)
+			{
+				const uint32_t x0 = std::min(x * 2, width - 1);
+				const uint32_t x1 = std::min(x * 2 + 1, width - 1);
+
+				for (int c = 0; c < 4; c++)
+				{
+					unsigned int sum = src[(y0 * width + x0) * 4 + c] + src[(y0 * width + x1) * 4 + c] +
+						src[(y1 * width + x0) * 4 + c] + src[(y1 * width + x1) * 4 + c];
+					dst[(y * w + x) * 4 + c] = (unsigned char)((sum + 2) / 4);
+				}
+			}
+		}
+
+		return dst;
+	}
+
+	static std::vector<unsigned char> encodeLevel(const std::vector<unsigned char>& rgba, uint32_t width, uint32_t height, BlockFormat format)
+	{
+		const uint32_t blocksX = (width + 3) / 4;
+		const uint32_t blocksY = (height + 3) / 4;
+		const size_t size = blockSize(format);
+
+		std::vector<unsigned char> out(blocksX * blocksY * size);
+		unsigned char block[16 * 4];
+
+		for (uint32_t by = 0; by < blocksY; by++)
+		{
+			for (uint32_t bx = 0; bx < blocksX; bx++)
+			{
+				// levels smaller than a block (and odd edges) repeat their last row / column
+				for (uint32_t py = 0; py < 4; py++)
+				{
+					const uint32_t y = std::min(by * 4 + py, height - 1);
+					for (uint32_t px = 0; px < 4; px++)
+					{
+						const uint32_t x = std::min(bx * 4 + px, width - 1);
+						std::memcpy(&block[(py * 4 + px) * 4], &rgba[(y * width + x) * 4], 4);
+					}
+				}
+
+				unsigned char* dst = &out[(by * blocksX + bx) * size];
+
+				switch (format)
+				{
+				case BlockFormat::BC1: TextureCache::encodeBC1Block(block, dst); break;
+				case BlockFormat::BC3: TextureCache::encodeBC3Block(block, dst); break;
+				case BlockFormat::BC4: TextureCache::encodeBC4Block(block, 0, dst); break;
+				case BlockFormat::BC5: TextureCache::encodeBC5Block(block, dst); break;
+				}
+			}
+		}
+
+		return out;
+	}
+
+	bool TextureCache::cook(const std::string& sourcePath, const std::string& cachePath, bool normalMap)
+	{
+		int width, height, components;
+		unsigned char* pixels = stbi_load(sourcePath.c_str(), &width, &height, &components, 4);
+		if (!pixels)
+		{
+			SPDLOG_DEBUG("TextureCache::cook: unable to decode {}", sourcePath);
+			return false;
+		}
+
+		const BlockFormat format = chooseFormat(components, normalMap);
+
+		std::vector<unsigned char> level(pixels, pixels + (size_t)width * height * 4);
+		stbi_image_free(pixels);
+
+		std::vector<TextureCacheLevel> levels;
+		std::vector<std::vector<unsigned char>> encoded;
+
+		uint32_t w = (uint32_t)width;
+		uint32_t h = (uint32_t)height;
+		while (true)
+		{
+			TextureCacheLevel l;
+			std::memset(&l, 0, sizeof(TextureCacheLevel));
+			l.width = w;
+			l.height = h;
+
+			encoded.push_back(encodeLevel(level, w, h, format));
+			l.size = encoded.back().size();
+			levels.push_back(l);
+
+			if (w == 1 && h == 1)
+				break;
+
+			level = downsample(level, w, h);
+			w = std::max(1u, w / 2);
+			h = std::max(1u, h / 2);
+		}
+
+		uint64_t cursor = alignTo16(alignTo16(sizeof(TextureCacheHeader)) + levels.size() * sizeof(TextureCacheLevel));
+		for (auto& l : levels)
+		{
+			l.offset = cursor;
+			cursor = alignTo16(cursor + l.size);
+		}
+
+		TextureCacheHeader header;
+		std::memset(&header, 0, sizeof(TextureCacheHeader));
+		std::memcpy(header.magic, TEXTURE_CACHE_MAGIC, sizeof(TEXTURE_CACHE_MAGIC));
+		header.version = TEXTURE_CACHE_VERSION;
+		header.format = (uint32_t)format;
+		header.width = (uint32_t)width;
+		header.height = (uint32_t)height;
+		header.levelCount = (uint32_t)levels.size();
+		header.hasAlpha = (components == 2 || components == 4) ? 1 : 0;
+		header.sourceComponents = (uint32_t)components;
+
+		// write to a temporary file first so that an interrupted cook never leaves a valid looking, partial cache, named
+		// per writer so that concurrent cooks of the same source never write into each other's file
+		static std::atomic<uint32_t> tmpCounter(0);
+		std::string tmpPath = cachePath + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) +
+			"_" + std::to_string(tmpCounter++) + ".tmp";
+		{
+			std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+			if (!out)
+			{
+				SPDLOG_DEBUG("TextureCache::cook: unable to open {} for writing", tmpPath);
+				return false;
+			}
+
+			auto padTo = [&out](uint64_t offset) {
+				static const char zeros[16] = {};
+				uint64_t pos = (uint64_t)out.tellp();
+				if (offset > pos)
+					out.write(zeros, (std::streamsize)(offset - pos));
+			};
+
+			out.write(reinterpret_cast<const char*>(&header), sizeof(TextureCacheHeader));
+
+			padTo(alignTo16(sizeof(TextureCacheHeader)));
+			out.write(reinterpret_cast<const char*>(levels.data()), levels.size() * sizeof(TextureCacheLevel));
+
+			for (size_t i = 0; i < levels.size(); i++)
+			{
+				padTo(levels[i].offset);
+				out.write(reinterpret_cast<const char*>(encoded[i].data()), encoded[i].size());
+			}
+
+			if (!out)
+			{
+				SPDLOG_DEBUG("TextureCache::cook: failed writing {}", tmpPath);
+				return false;
+			}
+		}
+
+		std::error_code ec;
+		std::filesystem::rename(tmpPath, cachePath, ec);
+		if (ec)
+		{
+			SPDLOG_DEBUG("TextureCache::cook: unable to move {} into place: {}", tmpPath, ec.message());
+			std::filesystem::remove(tmpPath, ec);
+			return false;
+		}
+
+		return true;
+	}
+
+	static bool mapCache(const std::string& cachePath, CompressedImage& img)
+	{
+		if (!img.file.open(cachePath))
+			return false;
+
+		const unsigned char* base = img.file.getData();
+		const size_t size = img.file.getSize();
+		const uint64_t levelsOffset = alignTo16(sizeof(TextureCacheHeader));
+
+		const TextureCacheHeader* header = reinterpret_cast<const TextureCacheHeader*>(base);
+
+		if (size < levelsOffset || std::memcmp(header->magic, TEXTURE_CACHE_MAGIC, sizeof(TEXTURE_CACHE_MAGIC)) != 0 ||
+			header->version != TEXTURE_CACHE_VERSION || header->levelCount == 0 ||
+			levelsOffset + (uint64_t)header->levelCount * sizeof(TextureCacheLevel) > size)
+		{
+			SPDLOG_DEBUG("TextureCache: {} is not a compatible texture cache", cachePath);
+			img.file.close();
+			return false;
+		}
+
+		const BlockFormat format = (BlockFormat)header->format;
+		if (format != BlockFormat::BC1 && format != BlockFormat::BC3 && format != BlockFormat::BC4 && format != BlockFormat::BC5)
+		{
+			SPDLOG_DEBUG("TextureCache: {} has an unknown block format", cachePath);
+			img.file.close();
+			return false;
+		}
+
+		const TextureCacheLevel* levels = reinterpret_cast<const TextureCacheLevel*>(base + levelsOffset);
+		for (uint32_t i = 0; i < header->levelCount; i++)
+		{
+			const uint64_t expected = (uint64_t)((levels[i].width + 3) / 4) * ((levels[i].height + 3) / 4) * blockSize(format);
+			if (levels[i].size != expected || levels[i].offset + levels[i].size > size)
+			{
+				SPDLOG_DEBUG("TextureCache: {} has an out of range level", cachePath);
+				img.file.close();
+				return false;
+			}
+		}
+
+		img.format = format;
+		img.hasAlpha = header->hasAlpha != 0;
+		img.sourceComponents = (int)header->sourceComponents;
+		img.levels.assign(levels, levels + header->levelCount);
+
+		return true;
+	}
+
+	std::shared_ptr<CompressedImage> TextureCache::load(const std::string& sourcePath, bool normalMap)
+	{
+		const std::string cachePath = getCachePath(sourcePath);
+		std::shared_ptr<CompressedImage> img = std::make_shared<CompressedImage>();
+
+		if (isCurrent(sourcePath, cachePath) && mapCache(cachePath, *img))
+		{
+			// cooked with the other normal map setting, re-cook if the source is around
+			if (img->format == chooseFormat(img->sourceComponents, normalMap) || !std::filesystem::exists(sourcePath))
+				return img;
+
+			img->file.close();
+		}
+
+		if (!cook(sourcePath, cachePath, normalMap) || !mapCache(cachePath, *img))
+			return nullptr;
+
+		return img;
+	}
+}
@@ -0,0 +1,124 @@
+#include <atomic>
+#include <algorithm>
+
+#include "vel/ThreadPool.h"
+
+
+namespace vel
+{
+	ThreadPool::ThreadPool(unsigned int threadCount) :
+		stopping(false)
+	{
+		if (threadCount == 0)
+		{
+			unsigned int hc = std::thread::hardware_concurrency();
+			threadCount = hc > 1 ? hc - 1 : 1;
+		}
+
+		for (unsigned int i = 0; i < threadCount; i++)
+			this->workers.emplace_back(&ThreadPool::workerLoop, this);
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(this->tasksMutex);
+			this->stopping = true;
+		}
+
+		this->tasksCondition.notify_all();
+
+		for (auto& w : this->workers)
+			w.join();
+	}
+
+	unsigned int ThreadPool::getThreadCount() const
+	{
+		return (unsigned int)this->workers.size();
+	}
+
+	void ThreadPool::enqueue(std::function<void()> task)
+	{
+		{
+			std::lock_guard<std::mutex> lock(this->tasksMutex);
+			this->tasks.push_back(std::move(task));
+		}
+
+		this->tasksCondition.notify_one();
+	}
+
+	void ThreadPool::workerLoop()
+	{
+		while (true)
+		{
+			std::function<void()> task;
+
+			{
+				std::unique_lock<std::mutex> lock(this->tasksMutex);
+				this->tasksCondition.wait(lock, [this]() { return this->stopping || !this->tasks.empty(); });
+
+				// remaining tasks are drained before shutting down so no future is left without a value
+				if (this->stopping && this->tasks.empty())
+					return;
+
+				task = std::move(this->tasks.front());
+				this->tasks.pop_front();
+			}
+
+			task();
+		}
+	}
+
+	void ThreadPool::parallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& fn)
+	{
+		if (count == 0)
+			return;
+
+		grainSize = std::max<size_t>(grainSize, 1);
+		const size_t chunkCount = (count + grainSize - 1) / grainSize;
+
+		if (chunkCount == 1 || this->workers.empty())
+		{
+			fn(0, count);
+			return;
+		}
+
+		// shared so that helpers which only get scheduled after the caller has returned never touch dead stack memory
+		struct State
+		{
+			std::atomic<size_t>			nextChunk{ 0 };
+			std::atomic<size_t>			completedChunks{ 0 };
+			std::mutex					doneMutex;
+			std::condition_variable		doneCondition;
+		};
+
+		auto state = std::make_shared<State>();
+		const std::function<void(size_t, size_t)>* pFn = &fn;
+
+		auto work = [state, pFn, count, grainSize, chunkCount]() {
+			size_t chunk;
+			while ((chunk = state->nextChunk.fetch_add(1)) < chunkCount)
+			{
+				size_t begin = chunk * grainSize;
+				(*pFn)(begin, std::min(begin + grainSize, count));
+
+				if (state->completedChunks.fetch_add(1) + 1 == chunkCount)
+				{
+					std::lock_guard<std::mutex> lock(state->doneMutex);
+					state->doneCondition.notify_all();
+				}
+			}
+		};
+
+		// fn is only dereferenced while a chunk is claimed, and the caller does not return until every claimed chunk
+		// has completed, so handing helpers a pointer to it is safe
+		size_t helpers = std::min<size_t>(this->workers.size(), chunkCount - 1);
+		for (size_t i = 0; i < helpers; i++)
+			this->enqueue(work);
+
+		work();
+
+		std::unique_lock<std::mutex> lock(state->doneMutex);
+		state->doneCondition.wait(lock, [&state, chunkCount]() { return state->completedChunks.load() == chunkCount; });
+	}
+}
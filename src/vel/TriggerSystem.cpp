@@ -0,0 +1,190 @@
+#include <algorithm>
+#include <functional>
+
+#include "LinearMath/btAabbUtil2.h"
+
+#include "vel/TriggerSystem.h"
+#include "vel/CollisionWorld.h"
+
+
+namespace vel
+{
+	static bool overlapLess(const TriggerOverlap& a, const TriggerOverlap& b)
+	{
+		return std::less<const btCollisionObject*>()(a.object, b.object);
+	}
+
+	// the tight bounds the broadphase was last given, rather than whatever fattened volume it keeps pairs for
+	static bool boundsOverlap(const btCollisionObject* a, const btCollisionObject* b)
+	{
+		const btBroadphaseProxy* pa = a->getBroadphaseHandle();
+		const btBroadphaseProxy* pb = b->getBroadphaseHandle();
+
+		return pa && pb && TestAabbAgainstAabb2(pa->m_aabbMin, pa->m_aabbMax, pb->m_aabbMin, pb->m_aabbMax);
+	}
+
+	TriggerVolume* TriggerSystem::findTrigger(const btBroadphaseProxy* proxy)
+	{
+		const btCollisionObject* co = static_cast<const btCollisionObject*>(proxy->m_clientObject);
+
+		// the flag test spares the lookup for the vast majority of pairs
+		if (!co || !(co->getCollisionFlags() & btCollisionObject::CF_NO_CONTACT_RESPONSE))
+			return nullptr;
+
+		auto it = this->triggers.find(co);
+		return it == this->triggers.end() ? nullptr : &it->second;
+	}
+
+	void TriggerSystem::addOverlap(TriggerVolume* trigger, const btCollisionObject* object)
+	{
+		TriggerOverlap overlap = { object, nullptr };
+
+		auto it = std::lower_bound(trigger->overlaps.begin(), trigger->overlaps.end(), overlap, overlapLess);
+		if (it != trigger->overlaps.end() && it->object == object)
+			return;
+
+		overlap.actor = CollisionWorld::actorFromCollisionObject(object);
+		trigger->overlaps.insert(it, overlap);
+		trigger->dirty = true;
+	}
+
+	void TriggerSystem::removeOverlap(TriggerVolume* trigger, const btCollisionObject* object)
+	{
+		TriggerOverlap overlap = { object, nullptr };
+
+		auto it = std::lower_bound(trigger->overlaps.begin(), trigger->overlaps.end(), overlap, overlapLess);
+		if (it == trigger->overlaps.end() || it->object != object)
+			return;
+
+		trigger->overlaps.erase(it);
+		trigger->dirty = true;
+	}
+
+	btBroadphasePair* TriggerSystem::addOverlappingPair(btBroadphaseProxy* proxy0, btBroadphaseProxy* proxy1)
+	{
+		this->ghostPairCallback.addOverlappingPair(proxy0, proxy1);
+
+		if (TriggerVolume* trigger = this->findTrigger(proxy0))
+			this->addOverlap(trigger, static_cast<const btCollisionObject*>(proxy1->m_clientObject));
+
+		if (TriggerVolume* trigger = this->findTrigger(proxy1))
+			this->addOverlap(trigger, static_cast<const btCollisionObject*>(proxy0->m_clientObject));
+
+		return nullptr;
+	}
+
+	void* TriggerSystem::removeOverlappingPair(btBroadphaseProxy* proxy0, btBroadphaseProxy* proxy1, btDispatcher* dispatcher)
+	{
+		this->ghostPairCallback.removeOverlappingPair(proxy0, proxy1, dispatcher);
+
+		if (TriggerVolume* trigger = this->findTrigger(proxy0))
+			this->removeOverlap(trigger, static_cast<const btCollisionObject*>(proxy1->m_clientObject));
+
+		if (TriggerVolume* trigger = this->findTrigger(proxy1))
+			this->removeOverlap(trigger, static_cast<const btCollisionObject*>(proxy0->m_clientObject));
+
+		return nullptr;
+	}
+
+	void TriggerSystem::removeOverlappingPairsContainingProxy(btBroadphaseProxy* proxy0, btDispatcher* dispatcher)
+	{
+		// the hashed pair caches remove pairs one by one through removeOverlappingPair, as btGhostPairCallback expects
+	}
+
+	void TriggerSystem::addTrigger(btCollisionObject* trigger, Actor* actor)
+	{
+		auto [it, inserted] = this->triggers.try_emplace(trigger);
+		if (inserted)
+			this->volumes.push_back(&it->second);
+
+		TriggerVolume& volume = it->second;
+		volume.object = trigger;
+		volume.actor = actor;
+		volume.overlaps.clear();
+		volume.reported.clear();
+		volume.dirty = false;
+	}
+
+	void TriggerSystem::removeTrigger(const btCollisionObject* trigger)
+	{
+		auto it = this->triggers.find(trigger);
+		if (it == this->triggers.end())
+			return;
+
+		TriggerVolume& volume = it->second;
+
+		for (auto& overlap : volume.reported)
+			this->events.push_back({ TriggerEventType::EXIT, volume.object, overlap.object, volume.actor, overlap.actor });
+
+		this->volumes.erase(std::find(this->volumes.begin(), this->volumes.end(), &volume));
+
+		this->triggers.erase(it);
+	}
+
+	bool TriggerSystem::isTrigger(const btCollisionObject* co) const
+	{
+		return this->triggers.find(co) != this->triggers.end();
+	}
+
+	const std::vector<TriggerOverlap>* TriggerSystem::getOverlaps(const btCollisionObject* co) const
+	{
+		auto it = this->triggers.find(co);
+		return it == this->triggers.end() ? nullptr : &it->second.reported;
+	}
+
+	void TriggerSystem::update()
+	{
+		for (auto trigger : this->volumes)
+		{
+			// nothing reported can have changed without a pair change or a pair whose bounds may have separated
+			if (!trigger->dirty && trigger->overlaps.empty())
+				continue;
+
+			// pairs the broadphase still holds are only inside while the bounds actually overlap, dbvt for one only
+			// checks a tenth of its pairs for removal each step by default. Still sorted by object
+			this->overlapScratch.clear();
+			for (auto& overlap : trigger->overlaps)
+				if (boundsOverlap(trigger->object, overlap.object))
+					this->overlapScratch.push_back(overlap);
+
+			const std::vector<TriggerOverlap>& before = trigger->reported;
+			const std::vector<TriggerOverlap>& after = this->overlapScratch;
+
+			size_t b = 0;
+			size_t a = 0;
+
+			while (b < before.size() || a < after.size())
+			{
+				if (a == after.size() || (b < before.size() && overlapLess(before[b], after[a])))
+				{
+					this->events.push_back({ TriggerEventType::EXIT, trigger->object, before[b].object, trigger->actor, before[b].actor });
+					b++;
+				}
+				else if (b == before.size() || overlapLess(after[a], before[b]))
+				{
+					this->events.push_back({ TriggerEventType::ENTER, trigger->object, after[a].object, trigger->actor, after[a].actor });
+					a++;
+				}
+				else
+				{
+					b++;
+					a++;
+				}
+			}
+
+			// assign reuses reported's storage
+			trigger->reported.assign(after.begin(), after.end());
+			trigger->dirty = false;
+		}
+	}
+
+	size_t TriggerSystem::size() const
+	{
+		return this->events.size();
+	}
+
+	void TriggerSystem::clear()
+	{
+		this->events.clear();
+	}
+}
@@ -0,0 +1,302 @@
+#include <algorithm>
+#include <cmath>
+
+#include "spdlog/spdlog.h"
+
+#include "vel/UniformGridBroadphase.h"
+
+
+namespace vel
+{
+	// drops pairs whose bounds no longer overlap, the grid pass re-adds everything that does
+	struct RemoveSeparatedPairsCallback : public btOverlapCallback
+	{
+		bool processOverlap(btBroadphasePair& pair)
+		{
+			return !TestAabbAgainstAabb2(pair.m_pProxy0->m_aabbMin, pair.m_pProxy0->m_aabbMax, pair.m_pProxy1->m_aabbMin, pair.m_pProxy1->m_aabbMax);
+		}
+	};
+
+	static bool filtersPass(const btBroadphaseProxy* a, const btBroadphaseProxy* b)
+	{
+		return (a->m_collisionFilterGroup & b->m_collisionFilterMask) != 0 && (b->m_collisionFilterGroup & a->m_collisionFilterMask) != 0;
+	}
+
+	static uint32_t nextPowerOfTwo(uint32_t v)
+	{
+		uint32_t p = 1;
+		while (p < v)
+			p <<= 1;
+
+		return p;
+	}
+
+	UniformGridBroadphase::UniformGridBroadphase(btScalar cellSize, int maxCellsPerProxy) :
+		cellSize(cellSize > btScalar(0) ? cellSize : btScalar(1)),
+		inverseCellSize(btScalar(1) / this->cellSize),
+		maxCellsPerProxy(std::max(maxCellsPerProxy, 1)),
+		pairCache(new btHashedOverlappingPairCache())
+	{}
+
+	UniformGridBroadphase::~UniformGridBroadphase()
+	{
+		delete this->pairCache;
+	}
+
+	int UniformGridBroadphase::cellCoordinate(btScalar v) const
+	{
+		// clamped so that absurd bounds can't overflow, such proxies end up in the large list anyway
+		btScalar c = std::floor(v * this->inverseCellSize);
+		c = btClamped(c, btScalar(-(1 << 28)), btScalar(1 << 28));
+
+		return (int)c;
+	}
+
+	uint32_t UniformGridBroadphase::cellHash(int x, int y, int z, uint32_t mask) const
+	{
+		return ((uint32_t)x * 73856093u ^ (uint32_t)y * 19349663u ^ (uint32_t)z * 83492791u) & mask;
+	}
+
+	void UniformGridBroadphase::addPair(const UniformGridItem& a, const UniformGridItem& b)
+	{
+		if (!filtersPass(a.proxy, b.proxy) || !TestAabbAgainstAabb2(a.aabbMin, a.aabbMax, b.aabbMin, b.aabbMax))
+			return;
+
+		// the cache returns the existing pair for pairs that are already known
+		this->pairCache->addOverlappingPair(a.proxy, b.proxy);
+	}
+
+	btBroadphaseProxy* UniformGridBroadphase::createProxy(const btVector3& aabbMin, const btVector3& aabbMax, int shapeType, void* userPtr, int collisionFilterGroup, int collisionFilterMask, btDispatcher* dispatcher)
+	{
+		int slot;
+		if (!this->freeProxies.empty())
+		{
+			slot = this->freeProxies.back();
+			this->freeProxies.pop_back();
+		}
+		else
+		{
+			slot = (int)this->proxies.size();
+			this->proxies.push_back(std::make_unique<UniformGridProxy>());
+		}
+
+		UniformGridProxy* proxy = this->proxies[slot].get();
+		proxy->m_aabbMin = aabbMin;
+		proxy->m_aabbMax = aabbMax;
+		proxy->m_clientObject = userPtr;
+		proxy->m_collisionFilterGroup = collisionFilterGroup;
+		proxy->m_collisionFilterMask = collisionFilterMask;
+		proxy->m_uniqueId = slot + 1; // the pair cache hashes and orders pairs by this
+		proxy->liveIndex = (int)this->live.size();
+
+		this->live.push_back(proxy);
+
+		return proxy;
+	}
+
+	void UniformGridBroadphase::destroyProxy(btBroadphaseProxy* proxy, btDispatcher* dispatcher)
+	{
+		UniformGridProxy* gridProxy = static_cast<UniformGridProxy*>(proxy);
+
+		this->pairCache->removeOverlappingPairsContainingProxy(proxy, dispatcher);
+
+		UniformGridProxy* moved = this->live.back();
+		this->live[gridProxy->liveIndex] = moved;
+		moved->liveIndex = gridProxy->liveIndex;
+		this->live.pop_back();
+
+		gridProxy->liveIndex = -1;
+		gridProxy->m_clientObject = nullptr;
+		this->freeProxies.push_back(gridProxy->m_uniqueId - 1);
+	}
+
+	void UniformGridBroadphase::setAabb(btBroadphaseProxy* proxy, const btVector3& aabbMin, const btVector3& aabbMax, btDispatcher* dispatcher)
+	{
+		proxy->m_aabbMin = aabbMin;
+		proxy->m_aabbMax = aabbMax;
+	}
+
+	void UniformGridBroadphase::getAabb(btBroadphaseProxy* proxy, btVector3& aabbMin, btVector3& aabbMax) const
+	{
+		aabbMin = proxy->m_aabbMin;
+		aabbMax = proxy->m_aabbMax;
+	}
+
+	void UniformGridBroadphase::rayTest(const btVector3& rayFrom, const btVector3& rayTo, btBroadphaseRayCallback& rayCallback, const btVector3& aabbMin, const btVector3& aabbMax)
+	{
+		for (auto proxy : this->live)
+		{
+			// bounds grown by the cast shape's extents, as btDbvt does for sweeps
+			btVector3 bounds[2] = { proxy->m_aabbMin - aabbMax, proxy->m_aabbMax - aabbMin };
+			btScalar tmin = btScalar(1);
+
+			if (btRayAabb2(rayFrom, rayCallback.m_rayDirectionInverse, rayCallback.m_signs, bounds, tmin, btScalar(0), rayCallback.m_lambda_max))
+				rayCallback.process(proxy);
+		}
+	}
+
+	void UniformGridBroadphase::aabbTest(const btVector3& aabbMin, const btVector3& aabbMax, btBroadphaseAabbCallback& callback)
+	{
+		for (auto proxy : this->live)
+			if (TestAabbAgainstAabb2(aabbMin, aabbMax, proxy->m_aabbMin, proxy->m_aabbMax))
+				callback.process(proxy);
+	}
+
+	void UniformGridBroadphase::calculateOverlappingPairs(btDispatcher* dispatcher)
+	{
+		RemoveSeparatedPairsCallback removeSeparated;
+		this->pairCache->processAllOverlappingPairs(&removeSeparated, dispatcher);
+
+		// gather
+		this->items.resize(this->live.size());
+		this->largeItems.clear();
+
+		size_t entryCount = 0;
+
+		for (size_t i = 0; i < this->live.size(); i++)
+		{
+			UniformGridItem& item = this->items[i];
+			item.proxy = this->live[i];
+			item.aabbMin = item.proxy->m_aabbMin;
+			item.aabbMax = item.proxy->m_aabbMax;
+
+			int64_t cells = 1;
+			for (int a = 0; a < 3; a++)
+			{
+				item.cellMin[a] = this->cellCoordinate(item.aabbMin[a]);
+				item.cellMax[a] = this->cellCoordinate(item.aabbMax[a]);
+
+				// checked per axis so the product of huge ranges can't overflow
+				if (cells <= this->maxCellsPerProxy)
+					cells *= (int64_t)(item.cellMax[a] - item.cellMin[a] + 1);
+			}
+
+			if (cells > this->maxCellsPerProxy)
+			{
+				this->largeItems.push_back((int)i);
+				for (int a = 0; a < 3; a++)
+				{
+					item.cellMin[a] = 1;
+					item.cellMax[a] = 0; // empty range, keeps it out of the grid
+				}
+				continue;
+			}
+
+			entryCount += (size_t)cells;
+		}
+
+		// bin, twice as many buckets as entries keeps unrelated cells sharing a bucket rare
+		const uint32_t bucketCount = nextPowerOfTwo((uint32_t)std::max<size_t>(entryCount * 2, 64));
+		const uint32_t mask = bucketCount - 1;
+
+		this->bucketStarts.assign(bucketCount + 1, 0);
+		this->entries.resize(entryCount);
+
+		for (auto& item : this->items)
+			for (int z = item.cellMin[2]; z <= item.cellMax[2]; z++)
+				for (int y = item.cellMin[1]; y <= item.cellMax[1]; y++)
+					for (int x = item.cellMin[0]; x <= item.cellMax[0]; x++)
+						this->bucketStarts[this->cellHash(x, y, z, mask) + 1]++;
+
+		for (uint32_t b = 0; b < bucketCount; b++)
+			this->bucketStarts[b + 1] += this->bucketStarts[b];
+
+		// bucketStarts[b] is the fill cursor for bucket b, leaving it at the start of b + 1, shifted back afterwards
+		for (size_t i = 0; i < this->items.size(); i++)
+		{
+			const UniformGridItem& item = this->items[i];
+
+			for (int z = item.cellMin[2]; z <= item.cellMax[2]; z++)
+				for (int y = item.cellMin[1]; y <= item.cellMax[1]; y++)
+					for (int x = item.cellMin[0]; x <= item.cellMax[0]; x++)
+					{
+						UniformGridEntry& e = this->entries[this->bucketStarts[this->cellHash(x, y, z, mask)]++];
+						e.cell[0] = x;
+						e.cell[1] = y;
+						e.cell[2] = z;
+						e.item = (int)i;
+					}
+		}
+
+		for (uint32_t b = bucketCount; b > 0; b--)
+			this->bucketStarts[b] = this->bucketStarts[b - 1];
+		this->bucketStarts[0] = 0;
+
+		// pairs within each cell
+		for (uint32_t b = 0; b < bucketCount; b++)
+		{
+			const uint32_t begin = this->bucketStarts[b];
+			const uint32_t end = this->bucketStarts[b + 1];
+
+			for (uint32_t i = begin; i < end; i++)
+			{
+				const UniformGridEntry& ei = this->entries[i];
+				const UniformGridItem& a = this->items[ei.item];
+
+				for (uint32_t j = i + 1; j < end; j++)
+				{
+					const UniformGridEntry& ej = this->entries[j];
+
+					if (ei.cell[0] != ej.cell[0] || ei.cell[1] != ej.cell[1] || ei.cell[2] != ej.cell[2])
+						continue;
+
+					const UniformGridItem& bItem = this->items[ej.item];
+
+					// only the cell holding the intersection's minimum corner reports the pair
+					bool owner = true;
+					for (int c = 0; c < 3 && owner; c++)
+						owner = this->cellCoordinate(btMax(a.aabbMin[c], bItem.aabbMin[c])) == ei.cell[c];
+
+					if (owner)
+						this->addPair(a, bItem);
+				}
+			}
+		}
+
+		// large proxies against everything, large pairs once
+		for (size_t l = 0; l < this->largeItems.size(); l++)
+		{
+			const int li = this->largeItems[l];
+
+			for (size_t i = 0; i < this->items.size(); i++)
+			{
+				if ((int)i == li)
+					continue;
+
+				// pairs of two large proxies are handled by whichever comes first in largeItems
+				if (this->items[i].cellMin[0] > this->items[i].cellMax[0] && (int)i < li)
+					continue;
+
+				this->addPair(this->items[li], this->items[i]);
+			}
+		}
+	}
+
+	btOverlappingPairCache* UniformGridBroadphase::getOverlappingPairCache()
+	{
+		return this->pairCache;
+	}
+
+	const btOverlappingPairCache* UniformGridBroadphase::getOverlappingPairCache() const
+	{
+		return this->pairCache;
+	}
+
+	void UniformGridBroadphase::getBroadphaseAabb(btVector3& aabbMin, btVector3& aabbMax) const
+	{
+		// unbounded, like btSimpleBroadphase
+		aabbMin.setValue(-BT_LARGE_FLOAT, -BT_LARGE_FLOAT, -BT_LARGE_FLOAT);
+		aabbMax.setValue(BT_LARGE_FLOAT, BT_LARGE_FLOAT, BT_LARGE_FLOAT);
+	}
+
+	void UniformGridBroadphase::printStats()
+	{
+		SPDLOG_DEBUG("UniformGridBroadphase: {} proxies, {} grid entries, {} large proxies, {} pairs", this->live.size(),
+			this->entries.size(), this->largeItems.size(), this->pairCache->getNumOverlappingPairs());
+	}
+
+	btScalar UniformGridBroadphase::getCellSize() const
+	{
+		return this->cellSize;
+	}
+}
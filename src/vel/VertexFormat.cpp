@@ -0,0 +1,141 @@
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+#include "glm/gtc/packing.hpp"
+
+#include "vel/VertexFormat.h"
+
+
+namespace vel
+{
+	size_t getVertexFormatStride(VertexFormat format)
+	{
+		switch (format)
+		{
+		case VertexFormat::STATIC_COMPACT:
+			return sizeof(CompactStaticVertex);
+		case VertexFormat::SKINNED_COMPACT:
+			return sizeof(CompactSkinnedVertex);
+		default:
+			return sizeof(Vertex);
+		}
+	}
+
+	std::vector<std::string> getVertexFormatShaderDefs(VertexFormat format)
+	{
+		switch (format)
+		{
+		case VertexFormat::STATIC_COMPACT:
+			return { "OCT_NORMALS" };
+		case VertexFormat::SKINNED_COMPACT:
+			return { "OCT_NORMALS", "FOUR_BONE_WEIGHTS" };
+		default:
+			return {};
+		}
+	}
+
+	VertexFormat resolveVertexFormat(VertexFormat requested, bool hasBones, size_t boneCount)
+	{
+		if (requested == VertexFormat::FULL)
+			return VertexFormat::FULL;
+
+		if (!hasBones)
+			return VertexFormat::STATIC_COMPACT;
+
+		if (boneCount > 256)
+			return VertexFormat::FULL;
+
+		return VertexFormat::SKINNED_COMPACT;
+	}
+
+	glm::vec2 octEncodeNormal(const glm::vec3& n)
+	{
+		float l1 = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+		if (l1 == 0.0f)
+			return glm::vec2(0.0f);
+
+		glm::vec2 p = glm::vec2(n.x, n.y) / l1;
+
+		// fold the lower hemisphere over the diagonals
+		if (n.z < 0.0f)
+		{
+			p = glm::vec2(
+				(1.0f - std::abs(p.y)) * (p.x >= 0.0f ? 1.0f : -1.0f),
+				(1.0f - std::abs(p.x)) * (p.y >= 0.0f ? 1.0f : -1.0f)
+			);
+		}
+
+		return p;
+	}
+
+	glm::vec3 octDecodeNormal(const glm::vec2& e)
+	{
+		glm::vec3 n(e.x, e.y, 1.0f - std::abs(e.x) - std::abs(e.y));
+		float t = std::max(-n.z, 0.0f);
+		n.x += n.x >= 0.0f ? -t : t;
+		n.y += n.y >= 0.0f ? -t : t;
+
+		return glm::normalize(n);
+	}
+
+	void packTopFourBoneWeights(const VertexBoneData& bd, uint8_t ids[4], uint8_t weights[4])
+	{
+		unsigned int order[8] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+		std::sort(std::begin(order), std::end(order), [&bd](unsigned int a, unsigned int b) {
+			return bd.weights[a] > bd.weights[b];
+		});
+
+		float total = 0.0f;
+		for (unsigned int i = 0; i < 4; i++)
+			total += std::max(bd.weights[order[i]], 0.0f);
+
+		if (total <= 0.0f)
+		{
+			std::memset(ids, 0, 4);
+			std::memset(weights, 0, 4);
+			return;
+		}
+
+		// quantize, then hand whatever rounding error remains to the heaviest influence so the weights still sum to 1
+		int sum = 0;
+		for (unsigned int i = 0; i < 4; i++)
+		{
+			float w = std::max(bd.weights[order[i]], 0.0f) / total;
+			ids[i] = static_cast<uint8_t>(w > 0.0f ? bd.ids[order[i]] : 0);
+			weights[i] = static_cast<uint8_t>(std::lround(w * 255.0f));
+			sum += weights[i];
+		}
+
+		weights[0] = static_cast<uint8_t>(std::clamp(weights[0] + (255 - sum), 0, 255));
+	}
+
+	void packVertices(const std::vector<Vertex>& vertices, VertexFormat format, size_t first, size_t count, std::vector<unsigned char>& out)
+	{
+		const size_t stride = getVertexFormatStride(format);
+		out.resize(count * stride);
+
+		if (format == VertexFormat::FULL)
+		{
+			std::memcpy(out.data(), &vertices[first], count * stride);
+			return;
+		}
+
+		for (size_t i = 0; i < count; i++)
+		{
+			const Vertex& v = vertices[first + i];
+
+			CompactSkinnedVertex cv; // static layout is a prefix of the skinned one
+			cv.position = v.position;
+			cv.normal = glm::packSnorm2x16(octEncodeNormal(v.normal));
+			cv.textureCoordinates = glm::packHalf2x16(v.textureCoordinates);
+			cv.lightmapCoordinates = glm::packHalf2x16(v.lightmapCoordinates);
+			cv.materialUBOIndex = v.materialUBOIndex;
+
+			if (format == VertexFormat::SKINNED_COMPACT)
+				packTopFourBoneWeights(v.weights, cv.boneIds, cv.boneWeights);
+
+			std::memcpy(out.data() + (i * stride), &cv, stride);
+		}
+	}
+}
@@ -148,6 +148,23 @@ namespace vel
 		return btTransform(glmMat3ToBulletMat3(m3), glmToBulletVec3(glm::vec3(m[3][0], m[3][1], m[3][2])));
 	}
 
+	// splits m into a rigid transform and the per axis scale taken out of it, shear can't be represented. A mirroring
+	// m gets a negative x scale, as the remainder would otherwise be a reflection rather than a rotation
+	btTransform glmMat4ToBulletRigidTransform(const glm::mat4& m, glm::vec3& outScale)
+	{
+		outScale = glm::vec3(glm::length(glm::vec3(m[0])), glm::length(glm::vec3(m[1])), glm::length(glm::vec3(m[2])));
+
+		if (glm::determinant(glm::mat3(m)) < 0.0f)
+			outScale.x = -outScale.x;
+
+		glm::mat4 rigid = m;
+		for (int c = 0; c < 3; c++)
+			if (outScale[c] != 0.0f)
+				rigid[c] /= outScale[c];
+
+		return glmMat4ToBulletTransform(rigid);
+	}
+
 	//https://stackoverflow.com/questions/4353525/floating-point-linear-interpolation
 	float lerpf(float a, float b, float f)
 	{